@@ -0,0 +1,152 @@
+#ifndef LAB2_BIGINT_H
+#define LAB2_BIGINT_H
+
+#include "common.h"
+
+/*
+ * Неотрицательное целое произвольной длины.
+ * Разряды по основанию 2^32 хранятся от младшего к старшему; старший разряд ненулевой
+ * (у нуля size == 0).
+ */
+typedef struct BigInt
+{
+    uint32_t* limbs;                /* разряды, limbs[0] — младший */
+    int size;                       /* число значащих разрядов */
+    int capacity;                   /* выделено разрядов */
+} BigInt;
+
+/*
+ * Матрица больших целых: элементы хранятся по строкам в data[i * cols + j].
+ */
+typedef struct BigMatrix
+{
+    BigInt* data;                   /* rows * cols элементов */
+    int rows;                       /* число строк */
+    int cols;                       /* число столбцов */
+} BigMatrix;
+
+/*
+ * Инициализировать число нулём (без выделения памяти).
+ */
+void bigint_init(BigInt* value);
+
+/*
+ * Освободить разряды числа. Безопасно при передаче NULL.
+ */
+void bigint_free(BigInt* value);
+
+/*
+ * Присвоить числу значение 64-битного целого.
+ * [IN] value — число
+ * [IN] x — значение
+ * [RETURN] MATRIX_SUCCESS или MATRIX_ERROR_CREATION
+ */
+int bigint_set_ull(BigInt* value, unsigned long long x);
+
+/*
+ * value = value * multiplier + addend.
+ * [IN] value — число
+ * [IN] multiplier, addend — малые множитель и слагаемое
+ * [RETURN] MATRIX_SUCCESS или MATRIX_ERROR_CREATION
+ */
+int bigint_mul_add_small(BigInt* value, uint32_t multiplier, uint32_t addend);
+
+/*
+ * Скопировать src в dst.
+ * [RETURN] MATRIX_SUCCESS или MATRIX_ERROR_CREATION
+ */
+int bigint_copy(BigInt* dst, const BigInt* src);
+
+/*
+ * Прочитать десятичную запись без знака (только цифры, ведущие пробелы допускаются).
+ * [IN] str — строка с числом
+ * [OUT] value — число
+ * [RETURN] MATRIX_SUCCESS, MATRIX_ERROR_INVALID_NUMBER или MATRIX_ERROR_CREATION
+ */
+int bigint_from_decimal(BigInt* value, const char* str);
+
+/*
+ * Получить значение числа, если оно помещается в 64 бита.
+ * [OUT] x — значение
+ * [RETURN] 1 — помещается, 0 — нет
+ */
+int bigint_to_ull(const BigInt* value, unsigned long long* x);
+
+/*
+ * Сравнить числа.
+ * [RETURN] -1, 0 или 1 при a < b, a == b, a > b
+ */
+int bigint_compare(const BigInt* a, const BigInt* b);
+
+/*
+ * Число значащих бит (0 для нуля).
+ */
+int bigint_bit_length(const BigInt* value);
+
+/*
+ * Значение бита с номером bit (0 — младший).
+ */
+static inline int bigint_test_bit(const BigInt* value, int bit)
+{
+    int limb = bit >> 5;
+    return (limb < value->size) ? (int)((value->limbs[limb] >> (bit & 31)) & 1u) : 0;
+}
+
+/*
+ * result = a + b (result может совпадать с a или b).
+ * [RETURN] MATRIX_SUCCESS или MATRIX_ERROR_CREATION
+ */
+int bigint_add(const BigInt* a, const BigInt* b, BigInt* result);
+
+/*
+ * result = a - b при a >= b (result может совпадать с a или b).
+ * [RETURN] MATRIX_SUCCESS, MATRIX_ERROR_INVALID_NUMBER при a < b или MATRIX_ERROR_CREATION
+ */
+int bigint_sub(const BigInt* a, const BigInt* b, BigInt* result);
+
+/*
+ * result = a * b (result может совпадать с a или b).
+ * [RETURN] MATRIX_SUCCESS или MATRIX_ERROR_CREATION
+ */
+int bigint_mul(const BigInt* a, const BigInt* b, BigInt* result);
+
+/*
+ * Деление с остатком: a = quotient * b + remainder (алгоритм D Кнута).
+ * quotient или remainder могут быть NULL; допускается совпадение с a или b.
+ * [RETURN] MATRIX_SUCCESS, MATRIX_ERROR_INVALID_NUMBER при b == 0 или MATRIX_ERROR_CREATION
+ */
+int bigint_divmod(const BigInt* a, const BigInt* b, BigInt* quotient, BigInt* remainder);
+
+/*
+ * Наибольший общий делитель (алгоритм Евклида).
+ * [RETURN] MATRIX_SUCCESS или MATRIX_ERROR_CREATION
+ */
+int bigint_gcd(const BigInt* a, const BigInt* b, BigInt* result);
+
+/*
+ * Число десятичных цифр в записи value (не меньше 1).
+ */
+size_t bigint_decimal_length(const BigInt* value);
+
+/*
+ * Записать десятичную запись числа в buffer (без завершающего нуля).
+ * [IN] value — число
+ * [OUT] buffer — буфер не короче bigint_decimal_length(value)
+ * [RETURN] число записанных символов или 0 при ошибке выделения памяти
+ */
+size_t bigint_write_decimal(const BigInt* value, char* buffer);
+
+/*
+ * Создать нулевую матрицу больших целых rows x cols.
+ * [OUT] result — указатель на созданную матрицу
+ * [RETURN] MATRIX_SUCCESS или код ошибки MATRIX_STATUS
+ */
+int big_matrix_create(int rows, int cols, BigMatrix** result);
+
+/*
+ * Освободить матрицу больших целых. Безопасно при передаче NULL.
+ * [RETURN] MATRIX_SUCCESS
+ */
+int big_matrix_free(BigMatrix* matrix);
+
+#endif //LAB2_BIGINT_H
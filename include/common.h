@@ -30,7 +30,12 @@ enum MATRIX_STATUS
     MATRIX_ERROR_CREATION,
     MATRIX_ERROR_NULL_POINTER,
     MATRIX_ERROR_INVALID_FIELD,
-    MATRIX_ERROR_INVALID_NUMBER
+    MATRIX_ERROR_INVALID_NUMBER,
+    MATRIX_ERROR_OVERFLOW,
+    MATRIX_ERROR_SINGULAR,
+    MATRIX_ERROR_VERIFICATION,
+    MATRIX_ERROR_FILE,
+    MATRIX_ERROR_MEMORY_BUDGET
 };
 
 /* STRING_STATUS — коды ошибок при работе со строками/парсингом */
@@ -54,6 +59,26 @@ enum TEST_STATUS
     TEST_ERROR_OVERFLOW
 };
 
+/* TUNE_STATUS — коды ошибок профиля автонастройки (matrix_tune.h) */
+enum TUNE_STATUS
+{
+    TUNE_SUCCESS = 0,
+    TUNE_ERROR_FILE_READ,
+    TUNE_ERROR_FILE_WRITE,
+    TUNE_ERROR_FORMAT,
+    TUNE_ERROR_MEASURE
+};
+
+/* SERVER_STATUS — коды ошибок режима сервера (matrix_server.h) */
+enum SERVER_STATUS
+{
+    SERVER_SUCCESS = 0,
+    SERVER_ERROR_SOCKET,
+    SERVER_ERROR_PROTOCOL,
+    SERVER_ERROR_TOO_LARGE,
+    SERVER_ERROR_THREAD
+};
+
 /* UI_STATUS — коды ошибок пользовательского интерфейса/печати */
 enum UI_STATUS
 {
@@ -0,0 +1,77 @@
+#ifndef LAB2_GF2_H
+#define LAB2_GF2_H
+
+#include "matrix.h"
+
+/*
+ * Матрица над GF(2) с упаковкой 64 элемента в слово.
+ * Бит j строки i хранится в words[i * words_per_row + j / 64], разряд j % 64.
+ * Разряды за последним столбцом всегда нулевые.
+ */
+typedef struct Gf2Matrix
+{
+    ULL* words;                     /* строки по words_per_row слов, выравнивание 64 байта */
+    int rows;                       /* число строк */
+    int cols;                       /* число столбцов */
+    int words_per_row;              /* (cols + 63) / 64 */
+} Gf2Matrix;
+
+/*
+ * Создать нулевую матрицу над GF(2) размера rows x cols.
+ * [IN] rows, cols — размеры матрицы
+ * [OUT] result — указатель на созданную матрицу
+ * [RETURN] MATRIX_SUCCESS или код ошибки MATRIX_STATUS
+ */
+int gf2_matrix_create(int rows, int cols, Gf2Matrix** result);
+
+/*
+ * Освободить матрицу над GF(2). Безопасно при передаче NULL.
+ * [RETURN] MATRIX_SUCCESS
+ */
+int gf2_matrix_free(Gf2Matrix* matrix);
+
+/*
+ * Получить значение элемента (0 или 1).
+ */
+static inline int gf2_matrix_get(const Gf2Matrix* m, int row, int col)
+{
+    return (int)((m->words[(size_t)row * m->words_per_row + (col >> 6)] >> (col & 63)) & 1ULL);
+}
+
+/*
+ * Упаковать обычную матрицу в GF(2): берётся младший бит каждого элемента.
+ * [IN] src — исходная матрица
+ * [OUT] result — указатель на созданную матрицу над GF(2)
+ * [RETURN] MATRIX_SUCCESS или код ошибки MATRIX_STATUS
+ */
+int gf2_matrix_from_matrix(const Matrix* src, Gf2Matrix** result);
+
+/*
+ * Распаковать матрицу над GF(2) в обычную матрицу с field_size = 2.
+ * [IN] src — матрица над GF(2)
+ * [OUT] result — указатель на созданную матрицу
+ * [RETURN] MATRIX_SUCCESS или код ошибки MATRIX_STATUS
+ */
+int gf2_matrix_to_matrix(const Gf2Matrix* src, Matrix** result);
+
+/*
+ * Перемножить матрицы над GF(2): c = a × b.
+ * Малые матрицы умножаются через AND + popcount по строкам a и столбцам b,
+ * большие — методом четырёх русских (M4RM) с таблицами в порядке кода Грея.
+ * С привязанным контекстом проверки (matrix_verify.h) результат проверяется методом Фрейвалдса.
+ * [IN] a, b — множители (a->cols == b->rows)
+ * [OUT] c — созданная матрица a->rows x b->cols, не совпадающая с a и b
+ * [RETURN] MATRIX_SUCCESS или код ошибки MATRIX_STATUS
+ */
+int gf2_matrix_multiply(const Gf2Matrix* a, const Gf2Matrix* b, Gf2Matrix* c);
+
+/*
+ * Возвести квадратную матрицу над GF(2) в степень exponent (бинарное возведение).
+ * [IN] base — квадратная матрица
+ * [IN] exponent — показатель степени
+ * [OUT] result — указатель на созданную матрицу-результат
+ * [RETURN] MATRIX_SUCCESS или код ошибки MATRIX_STATUS
+ */
+int gf2_matrix_power(const Gf2Matrix* base, ULL exponent, Gf2Matrix** result);
+
+#endif //LAB2_GF2_H
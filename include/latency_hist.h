@@ -0,0 +1,107 @@
+#ifndef LAB2_LATENCY_HIST_H
+#define LAB2_LATENCY_HIST_H
+
+#include "matrix.h"
+
+#include <stdatomic.h>
+#include <stdio.h>
+
+/*
+ * Гистограммы задержек в духе HdrHistogram для генератора тестов и режима сервера.
+ *
+ * Шкала лог-линейная: значения меньше 2^LATENCY_SUB_BITS нс считаются точно, дальше каждая
+ * октава [2^k, 2^(k+1)) делится на 2^LATENCY_SUB_BITS равных корзин, так что относительная
+ * ошибка любого процентиля не больше 2^-LATENCY_SUB_BITS (около 1.6%) на всём диапазоне до
+ * 2^LATENCY_MAX_BITS нс; большие значения попадают в последнюю корзину.
+ *
+ * LatencyRecorder держит по гистограмме на ключ (класс n, битовая длина показателя, класс
+ * поля): n — степень двойки [2^k, 2^(k+1)), класс поля — tune_field_class. Гистограммы
+ * создаются при первой записи с ключом, всего не больше LATENCY_MAX_KEYS; записи с другими
+ * ключами идут в общую гистограмму «прочее». Память поэтому ограничена независимо от числа
+ * тестов.
+ *
+ * Запись и слияние без блокировок: счётчики атомарные, новая гистограмма занимает ячейку
+ * таблицы через compare-and-swap. Писать в один объект можно из любого числа потоков;
+ * печать и слияние во время записи видят согласованный, но, возможно, неполный срез.
+ */
+
+#define LATENCY_SUB_BITS 6                  /* корзин на октаву: 2^6 */
+#define LATENCY_MAX_BITS 44                 /* верхняя граница шкалы: 2^44 нс (около 4.9 ч) */
+#define LATENCY_BUCKETS ((LATENCY_MAX_BITS - LATENCY_SUB_BITS + 1) << LATENCY_SUB_BITS)
+#define LATENCY_MAX_KEYS 512
+
+/* Одна гистограмма */
+typedef struct LatencyHistogram
+{
+    atomic_ullong counts[LATENCY_BUCKETS];
+    atomic_ullong total;        /* число записей */
+    atomic_ullong sum;          /* сумма значений (для среднего) */
+    atomic_ullong min;          /* ULLONG_MAX, пока записей нет */
+    atomic_ullong max;
+} LatencyHistogram;
+
+typedef struct LatencyRecorder LatencyRecorder;
+
+/*
+ * Создать пустой набор гистограмм.
+ * [OUT] result — указатель на созданный объект
+ * [RETURN] MATRIX_SUCCESS или код ошибки MATRIX_STATUS
+ */
+int latency_recorder_create(LatencyRecorder** result);
+
+/*
+ * Освободить набор гистограмм. Безопасно при передаче NULL.
+ * [IN] recorder — набор гистограмм
+ */
+void latency_recorder_destroy(LatencyRecorder* recorder);
+
+/*
+ * Записать одно значение в гистограмму ключа (size, exponent, field_size).
+ * [IN] recorder — набор гистограмм (NULL — ничего не делать)
+ * [IN] size — размер матрицы
+ * [IN] exponent — показатель степени (в ключ идёт его битовая длина)
+ * [IN] field_size — размер поля
+ * [IN] value_ns — задержка в наносекундах
+ */
+void latency_record(LatencyRecorder* recorder, int size, ULL exponent, ULL field_size, ULL value_ns);
+
+/*
+ * Добавить все гистограммы src к гистограммам тех же ключей в dst.
+ * [IN] dst — набор, в который сливаются значения
+ * [IN] src — набор-источник (не меняется)
+ * [RETURN] MATRIX_SUCCESS или MATRIX_ERROR_NULL_POINTER
+ */
+int latency_recorder_merge(LatencyRecorder* dst, const LatencyRecorder* src);
+
+/*
+ * Добавить гистограмму src к dst.
+ */
+void latency_histogram_merge(LatencyHistogram* dst, const LatencyHistogram* src);
+
+/*
+ * Значение процентиля: верхняя граница корзины, в которую попадает доля percentile записей.
+ * [IN] histogram — гистограмма
+ * [IN] percentile — от 0 до 100
+ * [RETURN] задержка в наносекундах (0 для пустой гистограммы)
+ */
+ULL latency_histogram_percentile(const LatencyHistogram* histogram, double percentile);
+
+/*
+ * Напечатать таблицу процентилей: строка на каждый ключ по возрастанию n, длины показателя
+ * и класса поля, затем строка «прочее» (если есть) и строка по всем записям.
+ * Столбцы: n, биты показателя, класс поля, число записей, min, p50, p90, p99, p99.9, max (нс).
+ * [IN] recorder — набор гистограмм
+ * [IN] out — поток вывода
+ * [RETURN] MATRIX_SUCCESS или код ошибки MATRIX_STATUS
+ */
+int latency_recorder_print(const LatencyRecorder* recorder, FILE* out);
+
+/*
+ * Получить гистограмму по всем записям набора.
+ * [IN] recorder — набор гистограмм
+ * [OUT] result — заполняемая гистограмма (перезаписывается)
+ * [RETURN] MATRIX_SUCCESS или MATRIX_ERROR_NULL_POINTER
+ */
+int latency_recorder_total(const LatencyRecorder* recorder, LatencyHistogram* result);
+
+#endif //LAB2_LATENCY_HIST_H
@@ -2,16 +2,24 @@
 #define LAB2_MATRIX_H
 
 #include "common.h"
+#include "matrix_alloc.h"
 
 typedef unsigned long long ULL;
 
-/* Структура данных для матрицы */
+/*
+ * Структура данных для матрицы.
+ * Заголовок, массив указателей на строки и элементы лежат в одном блоке памяти;
+ * элементы хранятся непрерывно по строкам (data[i] == data[0] + i * cols),
+ * начало data[0] выровнено на 64 байта.
+ */
 typedef struct Matrix
 {
     ULL** data;      /* указатель на массив строк */
     int rows;                       /* число строк */
     int cols;                       /* число столбцов */
     ULL field_size;  /* модуль (размер конечного поля) */
+    int element_width;              /* байт на элемент в упакованных ядрах: 1, 2, 4 или 8 */
+    MatrixAllocator* allocator;     /* контекст, из которого выделена память (NULL — куча) */
 } Matrix;
 
 /* ---------- Функции (матрицы) ---------- */
@@ -27,6 +35,28 @@ typedef struct Matrix
  */
 int matrix_create(int rows, int cols, ULL field_size, Matrix** result);
 
+/*
+ * Выбрать ширину элемента (в байтах) для поля field_size.
+ * Все значения поля лежат в [0, field_size - 1], поэтому при field_size <= 256
+ * хватает 1 байта, <= 65536 — 2 байт, <= 2^32 — 4 байт; большие модули
+ * и field_size == 0 (арифметика по модулю 2^64) хранятся в 8 байтах.
+ * [IN] field_size — размер конечного поля
+ * [RETURN] 1, 2, 4 или 8
+ */
+int matrix_element_width(ULL field_size);
+
+/*
+ * Создать матрицу rows x cols без обнуления элементов.
+ * Для результатов, которые сразу полностью перезаписываются (копии, произведения).
+ * Память берётся из контекста, привязанного к потоку (matrix_allocator_bind), или из кучи.
+ * [IN] rows - количество строк матрицы
+ * [IN] cols - количество столбцов матрицы
+ * [IN] field_size - размер конечного поля
+ * [OUT] result - указатель на созданную матрицу
+ * [RETURN] MATRIX_SUCCESS или код ошибки MATRIX_STATUS
+ */
+int matrix_create_uninit(int rows, int cols, ULL field_size, Matrix** result);
+
 /*
  * Освободить память, выделенную под матрицу.
  * Уничтожает структуру и внутренние данные, предотвращая утечку памяти.
@@ -75,9 +105,32 @@ int matrix_subtract(const Matrix* a, const Matrix* b, Matrix** result);
  */
 int matrix_scalar_multiply(const Matrix* a, ULL scalar, Matrix** result);
 
+/*
+ * Варианты поэлементных операций с готовой матрицей-приёмником (без выделения памяти).
+ * result должна иметь тот же размер и field_size; допускается result == a или result == b
+ * (операция на месте). Элементы a и b лежат в [0, field_size). Приведение по модулю —
+ * условным вычитанием, умножение на скаляр — методом Шоупа; циклы векторизуются.
+ * [IN] a, b — операнды
+ * [OUT] result — матрица-приёмник
+ * [RETURN] MATRIX_SUCCESS или код ошибки MATRIX_STATUS
+ */
+int matrix_sum_into(const Matrix* a, const Matrix* b, Matrix* result);
+int matrix_subtract_into(const Matrix* a, const Matrix* b, Matrix* result);
+int matrix_scalar_multiply_into(const Matrix* a, ULL scalar, Matrix* result);
+
+/*
+ * Линейная комбинация за один проход: result = alpha * a + beta * b в поле field_size.
+ * [IN] alpha, beta — коэффициенты
+ * [IN] a, b — матрицы одного размера и поля
+ * [OUT] result — матрица-приёмник (может совпадать с a или b)
+ * [RETURN] MATRIX_SUCCESS или код ошибки MATRIX_STATUS
+ */
+int matrix_axpby(ULL alpha, const Matrix* a, ULL beta, const Matrix* b, Matrix* result);
+
 /*
  * Транспонировать матрицу a (перевернуть строки и столбцы).
- * Результирующая матрица имеет размеры cols x rows.
+ * Результирующая матрица имеет размеры cols x rows; копирование кэш-независимое (transpose_block).
+ * Без копирования — matrix_transpose_view (matrix_view.h).
  * [IN] a — исходная матрица
  * [OUT] result — указатель на транспонированную матрицу
  * [RETURN] MATRIX_SUCCESS или код ошибки MATRIX_STATUS
@@ -85,13 +138,21 @@ int matrix_scalar_multiply(const Matrix* a, ULL scalar, Matrix** result);
 int matrix_transpose(const Matrix* a, Matrix** result);
 
 /*
- * Вырезать подматрицу из матрицы a по указанным индексам.
- * Диапазоны [start_row, end_row) и [start_col, end_col) должны быть корректными.
+ * Транспонировать квадратную матрицу a на месте (без дополнительной памяти).
+ * [IN/OUT] a — квадратная матрица
+ * [RETURN] MATRIX_SUCCESS или код ошибки MATRIX_STATUS
+ */
+int matrix_transpose_in_place(Matrix* a);
+
+/*
+ * Вырезать подматрицу из матрицы a по указанным индексам (копия).
+ * Диапазоны [start_row, end_row] и [start_col, end_col] должны быть корректными;
+ * без копирования — matrix_submatrix_view (matrix_view.h).
  * [IN] a — исходная матрица
  * [IN] start_row — начальный индекс строки
- * [IN] end_row — конечный индекс строки (не включая)
+ * [IN] end_row — конечный индекс строки (включительно)
  * [IN] start_col — начальный индекс столбца
- * [IN] end_col — конечный индекс столбца (не включая)
+ * [IN] end_col — конечный индекс столбца (включительно)
  * [OUT] result — указатель на вырезанную подматрицу
  * [RETURN] MATRIX_SUCCESS или код ошибки MATRIX_STATUS
  */
@@ -100,6 +161,7 @@ int matrix_submatrix(const Matrix* a, int start_row, int end_row, int start_col,
 /*
  * Перемножить матрицы a и b: a × b.
  * Количество столбцов в a должно совпадать с количеством строк в b.
+ * Вычисление идёт в упакованных ядрах ширины element_width (см. matrix_kernels.h).
  * [IN] a — первая матрица (левый множитель)
  * [IN] b — вторая матрица (правый множитель)
  * [OUT] result — указатель на новую матрицу с произведением
@@ -120,7 +182,14 @@ ULL multiply_mod(ULL a, ULL b, ULL mod);
 /*
  * Возвести квадратную матрицу base в степень exponent.
  * Используется метод бинарного возведения для эффективности.
- * Операции выполняются в поле field_size.
+ * Операции выполняются в поле field_size; все промежуточные степени хранятся
+ * в упакованном виде ширины element_width, а при field_size == 2 — в битовом
+ * представлении GF(2) с умножением методом четырёх русских (см. gf2.h).
+ * Над простым полем показатель при выгоде записывается в wNAF (цифры со знаком):
+ * для обратимой A отрицательные цифры умножают на степени A^-1, и серия из k
+ * единичных битов стоит двух умножений вместо k.
+ * Сопровождающая матрица линейной рекурренты (см. matrix_companion_form) при
+ * field_size >= 2 возводится методом Китамасы за O(n^2 log e).
  * [IN] base — квадратная матрица (n x n)
  * [IN] exponent — показатель степени
  * [OUT] result — указатель на результирующую матрицу
@@ -128,6 +197,85 @@ ULL multiply_mod(ULL a, ULL b, ULL mod);
  */
 int matrix_power(const Matrix* base, ULL exponent, Matrix** result);
 
+/*
+ * Возвести квадратную матрицу base в целую степень, в том числе отрицательную:
+ * A^(-e) = (A^-1)^e, обратная находится блочным методом Гаусса (см. matrix_lu.h).
+ * [IN] base — квадратная матрица (n x n); при exponent < 0 field_size — простое
+ * [IN] exponent — показатель степени
+ * [OUT] result — указатель на результирующую матрицу
+ * [RETURN] MATRIX_SUCCESS, MATRIX_ERROR_SINGULAR для вырожденной base при exponent < 0
+ *          или другой код ошибки MATRIX_STATUS
+ */
+int matrix_power_signed(const Matrix* base, long long exponent, Matrix** result);
+
+/*
+ * Возвести пачку матриц одного размера над одним полем каждую в свою степень.
+ * Бинарный метод идёт по битам общим циклом: на каждом бите накопления и квадраты всех
+ * матриц пачки выполняются одним параллельным проходом (задачами matrix_sched.h), а
+ * упакованные буферы создаются один раз на пачку. Выгодно для множества малых матриц,
+ * каждая из которых слишком мала, чтобы занять рабочие потоки.
+ * [IN] bases — count квадратных матриц n x n с одинаковым field_size
+ * [IN] exponents — показатели степени
+ * [IN] count — размер пачки (не меньше 1)
+ * [OUT] results — массив из count указателей на результирующие матрицы
+ * [RETURN] MATRIX_SUCCESS или код ошибки MATRIX_STATUS (при ошибке results не заполняется)
+ */
+int matrix_power_batch(const Matrix* const* bases, const ULL* exponents, int count, Matrix** results);
+
+/*
+ * Вычислить сумму степеней I + A + A^2 + ... + A^exponent за O(log exponent) умножений:
+ * удвоением S_2k = S_k + A^k S_k по битам показателя (не больше трёх умножений на бит).
+ * Обращение (A - I) не требуется, поэтому подходит любой field_size, в том числе 0.
+ * [IN] base — квадратная матрица (n x n)
+ * [IN] exponent — старшая степень суммы
+ * [OUT] result — указатель на результирующую матрицу
+ * [RETURN] MATRIX_SUCCESS или код ошибки MATRIX_STATUS
+ */
+int matrix_power_series(const Matrix* base, ULL exponent, Matrix** result);
+
+/*
+ * Дополнительные режимы возведения в степень (matrix_power_ex).
+ * Нулевая структура соответствует обычному matrix_power.
+ */
+typedef struct MatrixPowerOptions
+{
+    int decompose_modulus;          /* 1 — разложить field_size на множители p^k и считать по компонентам */
+    int reduce_exponent;            /* 1 — при простом field_size привести показатель по периоду степеней */
+} MatrixPowerOptions;
+
+/*
+ * Возвести квадратную матрицу base в степень exponent с дополнительными режимами.
+ * При decompose_modulus составной field_size раскладывается на взаимно простые
+ * множители p^k (разложения кэшируются), степень считается по каждому множителю
+ * в отдельном потоке, а результаты объединяются по китайской теореме об остатках.
+ * Для простых множителей при выгоде используется теорема Гамильтона — Кэли
+ * (см. matrix_poly.h).
+ * [IN] base — квадратная матрица (n x n)
+ * [IN] exponent — показатель степени
+ * [IN] options — режимы (NULL — как matrix_power)
+ * [OUT] result — указатель на результирующую матрицу
+ * [RETURN] MATRIX_SUCCESS или код ошибки MATRIX_STATUS
+ */
+int matrix_power_ex(const Matrix* base, ULL exponent, const MatrixPowerOptions* options, Matrix** result);
+
+struct BigInt;
+
+/*
+ * Возвести квадратную матрицу base в степень, заданную длинным числом.
+ * При reduce_exponent и простом field_size показатель сначала приводится по
+ * периоду степеней base (см. matrix_reduce_exponent в matrix_poly.h), поэтому
+ * показатели из тысяч цифр стоят столько же, сколько показатели порядка p^n.
+ * Показатель, помещающийся в ULL, передаётся в matrix_power_ex; больший
+ * возводится бинарным методом по его битам.
+ * [IN] base — квадратная матрица (n x n)
+ * [IN] exponent — показатель степени (BigInt, см. bigint.h)
+ * [IN] options — режимы (NULL — без приведения и разложения модуля)
+ * [OUT] result — указатель на результирующую матрицу
+ * [RETURN] MATRIX_SUCCESS или код ошибки MATRIX_STATUS
+ */
+int matrix_power_big(const Matrix* base, const struct BigInt* exponent, const MatrixPowerOptions* options,
+                     Matrix** result);
+
 /*
  * Напечатать матрицу в стандартный поток вывода.
  * Формат вывода зависит от field_size (по модулю или обычные значения).
@@ -0,0 +1,81 @@
+#ifndef LAB2_MATRIX_ALLOC_H
+#define LAB2_MATRIX_ALLOC_H
+
+#include "common.h"
+
+/*
+ * Контекст выделения памяти под матрицы: арена (bump-аллокатор) крупными кусками
+ * плюс списки свободных блоков по классам размеров. Блоки матриц одной формы
+ * попадают в один класс и переиспользуются без обращения к malloc/calloc.
+ *
+ * Контекст не потокобезопасен: каждый поток привязывает свой контекст через
+ * matrix_allocator_bind, и матрицы из него освобождаются в том же потоке.
+ * Если к потоку не привязан контекст, matrix_create использует обычную кучу.
+ */
+typedef struct MatrixAllocator MatrixAllocator;
+
+/* Статистика контекста выделения */
+typedef struct MatrixAllocatorStats
+{
+    size_t acquired;        /* всего выдано блоков */
+    size_t reused;          /* из них взято из списков свободных блоков */
+    size_t arena_bytes;     /* памяти запрошено у системы под арену */
+    size_t live_bytes;      /* размер блоков, выданных и ещё не возвращённых */
+} MatrixAllocatorStats;
+
+/*
+ * Создать контекст выделения памяти.
+ * [IN] chunk_size — размер куска арены в байтах (0 — по умолчанию, 64 МиБ);
+ *      блоки больше четверти куска получают отдельный кусок своего размера
+ * [OUT] result — указатель на созданный контекст
+ * [RETURN] MATRIX_SUCCESS или код ошибки MATRIX_STATUS
+ */
+int matrix_allocator_create(size_t chunk_size, MatrixAllocator** result);
+
+/*
+ * Уничтожить контекст и вернуть всю его память системе.
+ * Все матрицы, созданные в контексте, к этому моменту должны быть освобождены.
+ * Безопасно при передаче NULL.
+ * [IN] allocator — контекст выделения
+ * [RETURN] MATRIX_SUCCESS
+ */
+int matrix_allocator_destroy(MatrixAllocator* allocator);
+
+/*
+ * Привязать контекст к текущему потоку: все последующие matrix_create в этом
+ * потоке берут память из него. NULL — вернуться к обычной куче.
+ * [IN] allocator — контекст выделения или NULL
+ * [RETURN] контекст, который был привязан до вызова
+ */
+MatrixAllocator* matrix_allocator_bind(MatrixAllocator* allocator);
+
+/*
+ * Получить контекст, привязанный к текущему потоку (NULL — куча).
+ */
+MatrixAllocator* matrix_allocator_current(void);
+
+/*
+ * Выделить блок не меньше size байт, выровненный на 64 байта (память не обнуляется).
+ * [IN] allocator — контекст выделения
+ * [IN] size — требуемый размер в байтах
+ * [RETURN] указатель на блок или NULL при нехватке памяти
+ */
+void* matrix_allocator_acquire(MatrixAllocator* allocator, size_t size);
+
+/*
+ * Вернуть блок в список свободных блоков его класса размера.
+ * [IN] allocator — контекст, из которого был выделен блок
+ * [IN] block — указатель на блок
+ * [IN] size — тот же размер, что был передан в matrix_allocator_acquire
+ */
+void matrix_allocator_release(MatrixAllocator* allocator, void* block, size_t size);
+
+/*
+ * Получить статистику контекста выделения.
+ * [IN] allocator — контекст выделения
+ * [OUT] stats — заполняемая структура статистики
+ * [RETURN] MATRIX_SUCCESS или MATRIX_ERROR_NULL_POINTER
+ */
+int matrix_allocator_stats(const MatrixAllocator* allocator, MatrixAllocatorStats* stats);
+
+#endif //LAB2_MATRIX_ALLOC_H
@@ -0,0 +1,73 @@
+#ifndef LAB2_MATRIX_FMA_H
+#define LAB2_MATRIX_FMA_H
+
+#include "matrix.h"
+
+/*
+ * Умножение матриц над малыми полями в арифметике double (FFLAS-подобная схема).
+ *
+ * При field_size < 2^26 произведение двух элементов меньше 2^52, и сумма нескольких
+ * таких произведений представима в double точно (мантисса 53 бита). Поэтому внутренний
+ * цикл — обычный блочный векторизуемый GEMM на FMA, а приведение по модулю делается
+ * только между блоками по k, размер которых подобран так, чтобы сумма не превысила 2^53.
+ * Внутренний блок 4 x 2 вектора элементов c держится в регистрах.
+ * Результат побитово совпадает с целочисленным путём.
+ */
+
+/* Граница поля для ядра double: field_size < 2^26 */
+#define FMA_FIELD_LIMIT (1ULL << 26)
+
+/*
+ * Проверить, подходит ли поле для ядра double.
+ * [IN] field_size — модуль
+ * [RETURN] 1, если 2 <= field_size < FMA_FIELD_LIMIT, иначе 0
+ */
+int fma_field_supported(ULL field_size);
+
+/* Выше этой границы блоки по k короче 16 и приведение обходится дороже выигрыша */
+#define FMA_PREFERRED_LIMIT (1ULL << 25)
+
+/*
+ * Проверить, выгоднее ли ядро double целочисленного для поля field_size.
+ * Ядро double выигрывает только с 256-битными векторами (сборка с AVX) и для
+ * 2^8 < field_size < FMA_PREFERRED_LIMIT; при field_size <= 2^8 однобайтовые
+ * целые элементы экономят больше пропускной способности памяти.
+ * [IN] field_size — модуль
+ * [RETURN] 1, если для поля следует использовать ядро double
+ */
+int fma_field_preferred(ULL field_size);
+
+/*
+ * Наибольшее число произведений, которое можно сложить в double без потери точности
+ * к аккумулятору, уже приведённому по модулю field_size.
+ * [IN] field_size — модуль
+ * [RETURN] длина блока по k (не меньше 1)
+ */
+int fma_max_inner_block(ULL field_size);
+
+/*
+ * c = a × b по модулю field_size; все элементы a и b лежат в [0, field_size).
+ * [IN] a — матрица rows x inner
+ * [IN] b — матрица inner x cols
+ * [OUT] c — матрица rows x cols (не совпадает с a и b)
+ * [IN] field_size — модуль, fma_field_supported(field_size) == 1
+ */
+void fma_multiply(const double* a, const double* b, double* c, int rows, int inner, int cols,
+                  ULL field_size);
+
+/*
+ * c = a + b по модулю field_size (c может совпадать с a или b).
+ */
+void fma_add(const double* a, const double* b, double* c, size_t count, ULL field_size);
+
+/*
+ * Преобразовать элементы ULL в double с приведением по модулю field_size.
+ */
+void fma_from_ull(const ULL* src, double* dst, size_t count, ULL field_size);
+
+/*
+ * Преобразовать элементы double (целые из [0, field_size)) обратно в ULL.
+ */
+void fma_to_ull(const double* src, ULL* dst, size_t count);
+
+#endif //LAB2_MATRIX_FMA_H
@@ -0,0 +1,165 @@
+#ifndef LAB2_MATRIX_KERNELS_H
+#define LAB2_MATRIX_KERNELS_H
+
+#include "matrix.h"
+#include "matrix_view.h"
+
+/* Формат элементов упакованной матрицы */
+enum PACKED_FORMAT
+{
+    PACKED_INTEGER = 0,             /* целые ширины width */
+    PACKED_DOUBLE                   /* double с целыми значениями (ядро FMA, см. matrix_fma.h) */
+};
+
+/*
+ * Упакованная матрица: элементы хранятся непрерывно по строкам в типе ширины width
+ * (uint8_t / uint16_t / uint32_t / ULL), выбранной по field_size (см. matrix_element_width),
+ * либо в double для средних простых полей.
+ * Ядра умножения и сложения сгенерированы отдельно для каждой ширины и расширяют
+ * тип только в аккумуляторах, откладывая приведение по модулю, пока сумма не может
+ * переполниться.
+ */
+typedef struct PackedMatrix
+{
+    void* data;                     /* элементы rows x cols, выравнивание 64 байта */
+    int rows;                       /* число строк */
+    int cols;                       /* число столбцов */
+    int width;                      /* байт на элемент: 1, 2, 4 или 8 */
+    int format;                     /* PACKED_INTEGER или PACKED_DOUBLE */
+    ULL field_size;                 /* модуль (0 — арифметика по модулю 2^64) */
+    int owns_data;                  /* 1 — буфер выделен этой структурой */
+    MatrixAllocator* allocator;     /* контекст, из которого выделен буфер (NULL — куча) */
+} PackedMatrix;
+
+/*
+ * Выбрать формат упакованных элементов для поля field_size.
+ * double используется там, где ядро FMA быстрее целочисленного: по профилю настройки
+ * (matrix_tune.h), а без него — по fma_field_preferred.
+ * [IN] field_size — модуль
+ * [RETURN] PACKED_INTEGER или PACKED_DOUBLE
+ */
+int packed_matrix_format(ULL field_size);
+
+/*
+ * Создать упакованную матрицу rows x cols (элементы не инициализируются).
+ * [IN] rows, cols — размеры матрицы
+ * [IN] field_size — модуль, по нему выбирается ширина элемента
+ * [OUT] result — заполняемая структура
+ * [RETURN] MATRIX_SUCCESS или код ошибки MATRIX_STATUS
+ */
+int packed_matrix_create(int rows, int cols, ULL field_size, PackedMatrix* result);
+
+/*
+ * Получить упакованное представление матрицы src.
+ * При ширине 8 байт буфер не копируется: результат ссылается на src->data[0].
+ * Иначе создаётся новый буфер узкой ширины.
+ * [IN] src — исходная матрица
+ * [OUT] result — заполняемая структура
+ * [RETURN] MATRIX_SUCCESS или код ошибки MATRIX_STATUS
+ */
+int packed_matrix_view(const Matrix* src, PackedMatrix* result);
+
+/*
+ * Получить упакованный буфер для записи результата в матрицу dst.
+ * При ширине 8 байт результат ссылается на dst->data[0], иначе создаётся новый
+ * неинициализированный буфер (после вычисления его нужно сохранить packed_matrix_store).
+ * [IN] dst — матрица-приёмник
+ * [OUT] result — заполняемая структура
+ * [RETURN] MATRIX_SUCCESS или код ошибки MATRIX_STATUS
+ */
+int packed_matrix_target(Matrix* dst, PackedMatrix* result);
+
+/*
+ * Загрузить элементы матрицы src в созданную упакованную матрицу dst того же размера.
+ * [IN] src — исходная матрица
+ * [OUT] dst — упакованная матрица-приёмник
+ * [RETURN] MATRIX_SUCCESS или код ошибки MATRIX_STATUS
+ */
+int packed_matrix_load(const Matrix* src, PackedMatrix* dst);
+
+/*
+ * Скопировать элементы src в матрицу dst того же размера (с расширением до ULL).
+ * [IN] src — упакованная матрица
+ * [OUT] dst — матрица-приёмник
+ * [RETURN] MATRIX_SUCCESS или код ошибки MATRIX_STATUS
+ */
+int packed_matrix_store(const PackedMatrix* src, Matrix* dst);
+
+/*
+ * Транспонировать блок: dst[j][i] = src[i][j] для i < rows, j < cols (шаги строк в элементах).
+ * Кэш-независимый алгоритм: большая сторона делится пополам, пока блок не станет не больше
+ * 32 x 32, а он транспонируется регистровыми блоками 4x4. src и dst не должны перекрываться.
+ * [IN] src, src_stride — исходный блок rows x cols
+ * [OUT] dst, dst_stride — блок-приёмник cols x rows
+ */
+void transpose_block(const ULL* src, ptrdiff_t src_stride, ULL* dst, ptrdiff_t dst_stride, int rows, int cols);
+
+/*
+ * Транспонировать квадратный блок n x n на месте тем же рекурсивным делением:
+ * диагональные четверти транспонируются на месте, внедиагональные меняются местами.
+ */
+void transpose_square_in_place(ULL* a, ptrdiff_t stride, int n);
+
+/*
+ * Загрузить элементы представления src (см. matrix_view.h) в упакованную матрицу dst
+ * того же размера. Транспонированное представление читается по строкам хранения.
+ * [RETURN] MATRIX_SUCCESS или код ошибки MATRIX_STATUS
+ */
+int packed_matrix_load_view(const MatrixView* src, PackedMatrix* dst);
+
+/*
+ * Записать элементы src в представление dst того же размера.
+ * [RETURN] MATRIX_SUCCESS или код ошибки MATRIX_STATUS
+ */
+int packed_matrix_store_view(const PackedMatrix* src, const MatrixView* dst);
+
+/*
+ * Скопировать элементы src (той же формы и ширины) в dst.
+ * [RETURN] MATRIX_SUCCESS или код ошибки MATRIX_STATUS
+ */
+int packed_matrix_copy(const PackedMatrix* src, PackedMatrix* dst);
+
+/*
+ * Записать в квадратную матрицу m единичную матрицу.
+ * [RETURN] MATRIX_SUCCESS или код ошибки MATRIX_STATUS
+ */
+int packed_matrix_identity(PackedMatrix* m);
+
+/*
+ * Прибавить к квадратной матрице m скалярную матрицу: m += scalar * I.
+ * [IN] m — квадратная упакованная матрица
+ * [IN] scalar — слагаемое из [0, field_size) (при field_size == 0 — любое)
+ * [RETURN] MATRIX_SUCCESS или код ошибки MATRIX_STATUS
+ */
+int packed_matrix_add_identity(PackedMatrix* m, ULL scalar);
+
+/*
+ * Перемножить упакованные матрицы: c = a × b (c не должна совпадать с a или b).
+ * Если к потоку привязан контекст проверки (matrix_verify.h), результат проверяется
+ * методом Фрейвалдса; при несовпадении возвращается MATRIX_ERROR_VERIFICATION.
+ * [IN] a, b — множители одной ширины и модуля
+ * [OUT] c — созданная матрица-приёмник размера a->rows x b->cols
+ * [RETURN] MATRIX_SUCCESS или код ошибки MATRIX_STATUS
+ */
+int packed_matrix_multiply(const PackedMatrix* a, const PackedMatrix* b, PackedMatrix* c);
+
+/*
+ * То же, что packed_matrix_multiply, но без перехода к RNS для широких модулей: произведение
+ * считается целочисленным ядром прямо в c, упакованных матриц каналов не выделяется.
+ * Для движков с жёстким бюджетом памяти (matrix_tiled.h).
+ * [RETURN] MATRIX_SUCCESS или код ошибки MATRIX_STATUS
+ */
+int packed_matrix_multiply_inplace(const PackedMatrix* a, const PackedMatrix* b, PackedMatrix* c);
+
+/*
+ * Сложить упакованные матрицы: c = a + b (c может совпадать с a или b).
+ * [RETURN] MATRIX_SUCCESS или код ошибки MATRIX_STATUS
+ */
+int packed_matrix_add(const PackedMatrix* a, const PackedMatrix* b, PackedMatrix* c);
+
+/*
+ * Освободить буфер упакованной матрицы (если он принадлежит ей). Безопасно для NULL.
+ */
+void packed_matrix_free(PackedMatrix* m);
+
+#endif //LAB2_MATRIX_KERNELS_H
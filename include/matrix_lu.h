@@ -0,0 +1,35 @@
+#ifndef LAB2_MATRIX_LU_H
+#define LAB2_MATRIX_LU_H
+
+#include "matrix.h"
+
+/*
+ * LU-разложение над простым полем GF(p): PA = LU, L — нижняя унитреугольная.
+ * Исключение идёт панелями по LU_BLOCK столбцов: внутри панели — обычный метод Гаусса
+ * с выбором ненулевого ведущего элемента, затем остаток матрицы обновляется одним
+ * проходом ранга LU_BLOCK с отложенным приведением по модулю (как в ядрах умножения).
+ * Так каждая строка остатка читается n / LU_BLOCK раз вместо n.
+ */
+
+/* Ширина панели исключения */
+#define LU_BLOCK 64
+
+/*
+ * Вычислить определитель квадратной матрицы над простым полем.
+ * [IN] a — квадратная матрица, a->field_size — простое
+ * [OUT] result — определитель из [0, field_size)
+ * [RETURN] MATRIX_SUCCESS или код ошибки MATRIX_STATUS
+ */
+int matrix_determinant(const Matrix* a, ULL* result);
+
+/*
+ * Обратить квадратную матрицу над простым полем: PA = LU, затем блочные прямая
+ * и обратная подстановки для всех столбцов единичной матрицы сразу.
+ * [IN] a — квадратная матрица, a->field_size — простое
+ * [OUT] result — указатель на созданную матрицу A^-1
+ * [RETURN] MATRIX_SUCCESS, MATRIX_ERROR_SINGULAR для вырожденной матрицы
+ *          или другой код ошибки MATRIX_STATUS
+ */
+int matrix_inverse(const Matrix* a, Matrix** result);
+
+#endif //LAB2_MATRIX_LU_H
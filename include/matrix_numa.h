@@ -0,0 +1,91 @@
+#ifndef LAB2_MATRIX_NUMA_H
+#define LAB2_MATRIX_NUMA_H
+
+#include "common.h"
+
+/*
+ * Размещение больших буферов и потоков с учётом NUMA (без libnuma, через системные вызовы).
+ *
+ * Включается переменной окружения MATRIX_NUMA: "on" — включить, "report" — включить и
+ * печатать каждое решение в stderr (так режим проверяется и на машине с одним узлом).
+ * Без переменной все функции сводятся к обычному выделению памяти.
+ *
+ * Решения:
+ * - буферы от NUMA_MIN_BYTES выравниваются на NUMA_HUGE_PAGE и помечаются madvise(MADV_HUGEPAGE);
+ * - упакованные множители, создаваемые вызывающим потоком, читаются всеми рабочими потоками
+ *   и размещаются чередованием по узлам (mbind, MPOL_INTERLEAVE);
+ * - новая матрица, созданная вызывающим потоком, тоже размещается чередованием: её строки
+ *   считают задачи, которые крадут рабочие потоки всех узлов, и заранее неизвестно, какой узел
+ *   какие строки запишет;
+ * - буферы, созданные закреплённым рабочим потоком, остаются в памяти его узла (first touch);
+ * - рабочие потоки планировщика (matrix_sched.h) закрепляются за ядрами, по очереди на разных узлах.
+ *
+ * Буферы из matrix_numa_alloc освобождаются обычным free.
+ */
+
+#define NUMA_MIN_BYTES (4u << 20)           /* меньшие буферы размещаются как обычно */
+#define NUMA_HUGE_PAGE (2u << 20)           /* размер большой страницы x86-64 */
+#define NUMA_MAX_NODES 64
+#define NUMA_MAX_CPUS 1024
+
+/* Размещение буфера */
+enum NUMA_PLACEMENT
+{
+    NUMA_PLACE_LOCAL = 0,                   /* на узле потока, который первым запишет страницу */
+    NUMA_PLACE_INTERLEAVE                   /* страницы по очереди на всех узлах */
+};
+
+/* Топология машины по /sys/devices/system/node с учётом маски доступных процессу ядер */
+typedef struct NumaTopology
+{
+    int nodes;                              /* число узлов (не меньше 1) */
+    int cpus;                               /* число доступных ядер */
+    int cpu_ids[NUMA_MAX_CPUS];             /* ядра в порядке закрепления: по одному с каждого узла по кругу */
+    int cpu_nodes[NUMA_MAX_CPUS];           /* узел каждого ядра из cpu_ids */
+} NumaTopology;
+
+/* Состояние: -1 — ещё не инициализировано, 0 — выключено, 1 — включено, 2 — включено с отчётом */
+extern int matrix_numa_state;
+
+/*
+ * Инициализировать режим по переменной MATRIX_NUMA и прочитать топологию.
+ * Вызывается автоматически при первом обращении; повторный вызов ничего не делает.
+ * [RETURN] 1, если режим включён, иначе 0
+ */
+int matrix_numa_init(void);
+
+/*
+ * Проверить, включён ли режим (одно чтение глобального флага после инициализации).
+ */
+static inline int matrix_numa_enabled(void)
+{
+    return matrix_numa_state < 0 ? matrix_numa_init() : matrix_numa_state > 0;
+}
+
+/*
+ * Получить топологию (NULL, если режим выключен).
+ */
+const NumaTopology* matrix_numa_topology(void);
+
+/*
+ * Выделить буфер с выравниванием на большую страницу и размещением placement.
+ * [IN] bytes — размер буфера
+ * [IN] placement — NUMA_PLACEMENT
+ * [IN] what — имя буфера для отчёта (строковый литерал)
+ * [RETURN] указатель на буфер (освобождается free) или NULL
+ */
+void* matrix_numa_alloc(size_t bytes, int placement, const char* what);
+
+/*
+ * Закрепить текущий поток за ядром для рабочего потока с номером worker.
+ * [RETURN] номер ядра или -1, если режим выключен или закрепить не удалось
+ */
+int matrix_numa_pin_worker(int worker);
+
+/*
+ * Проверить, закреплён ли текущий поток через matrix_numa_pin_worker.
+ * Буферы такого потока размещаются локально, а не чередованием.
+ */
+int matrix_numa_pinned(void);
+
+#endif //LAB2_MATRIX_NUMA_H
@@ -0,0 +1,139 @@
+#ifndef LAB2_MATRIX_POLY_H
+#define LAB2_MATRIX_POLY_H
+
+#include "matrix.h"
+#include "bigint.h"
+
+/*
+ * Многочлены от матриц над простым полем GF(p).
+ * Многочлен степени d хранится массивом коэффициентов coeffs[0..d], coeffs[i] при x^i.
+ */
+
+/*
+ * Вычислить характеристический многочлен det(xI - A) над GF(p), p = a->field_size — простое.
+ * Матрица приводится подобием к верхней форме Хессенберга (исключение Гаусса с выбором
+ * ненулевого ведущего элемента), затем многочлен находится рекуррентно по её столбцам.
+ * Сложность O(n^3).
+ * [IN] a — квадратная матрица n x n
+ * [OUT] coeffs — массив из n + 1 коэффициентов (старший coeffs[n] == 1)
+ * [RETURN] MATRIX_SUCCESS или код ошибки MATRIX_STATUS
+ */
+int matrix_charpoly(const Matrix* a, ULL* coeffs);
+
+/*
+ * Вычислить значение многочлена от матрицы схемой Патерсона — Стокмейера:
+ * при s = ceil(sqrt(degree + 1)) считаются степени A^1 ... A^s, многочлен делится на блоки
+ * из s коэффициентов, блоки вычисляются линейными комбинациями степеней (matrix_axpby),
+ * а многочлен от A^s — схемой Горнера. Всего около 2 sqrt(degree) умножений матриц
+ * (см. matrix_poly_eval_multiplies) вместо degree.
+ * [IN] a — квадратная матрица над Z_p (field_size == 0 — по модулю 2^64)
+ * [IN] coeffs — коэффициенты coeffs[0..degree] (приводятся по модулю field_size)
+ * [IN] degree — степень многочлена (>= 0)
+ * [OUT] result — указатель на созданную матрицу coeffs[0] I + coeffs[1] A + ...
+ * [RETURN] MATRIX_SUCCESS или код ошибки MATRIX_STATUS
+ */
+int matrix_poly_eval(const Matrix* a, const ULL* coeffs, int degree, Matrix** result);
+
+/*
+ * Число умножений матриц в matrix_poly_eval для многочлена степени degree
+ * (без учёта нулевых старших коэффициентов).
+ */
+int matrix_poly_eval_multiplies(int degree);
+
+/*
+ * Проверить, выгоднее ли возведение через теорему Гамильтона — Кэли, чем бинарное:
+ * умножения matrix_poly_eval для многочлена степени n - 1 плюс оценка стоимости
+ * многочленной части сравниваются с числом умножений бинарного возведения в степень exponent. Для полей с элементами
+ * уже 4 байт и для ядра double скалярная часть не окупается, и ответ всегда 0.
+ * [IN] field_size — простой модуль
+ * [IN] n — размер матрицы
+ * [IN] exponent — показатель степени
+ * [RETURN] 1, если следует использовать matrix_power_cayley_hamilton
+ */
+int matrix_cayley_hamilton_preferred(ULL field_size, int n, ULL exponent);
+
+/*
+ * То же для показателя произвольной длины (см. matrix_cayley_hamilton_preferred).
+ */
+int matrix_cayley_hamilton_preferred_big(ULL field_size, int n, const BigInt* exponent);
+
+/*
+ * Возвести матрицу в степень через теорему Гамильтона — Кэли: A^e = r(A), где
+ * r(x) = x^e mod χ(x), χ — характеристический многочлен A. Остаток считается бинарным
+ * возведением многочленов за O(n^2 log e), затем r(A) — matrix_poly_eval.
+ * [IN] base — квадратная матрица над простым полем GF(p)
+ * [IN] exponent — показатель степени
+ * [OUT] result — указатель на результирующую матрицу
+ * [RETURN] MATRIX_SUCCESS или код ошибки MATRIX_STATUS
+ */
+int matrix_power_cayley_hamilton(const Matrix* base, ULL exponent, Matrix** result);
+
+/*
+ * То же для показателя произвольной длины: остаток x^e mod χ(x) считается по битам
+ * exponent, поэтому стоимость матричной части не зависит от длины показателя.
+ */
+int matrix_power_cayley_hamilton_big(const Matrix* base, const BigInt* exponent, Matrix** result);
+
+/* Вид сопровождающей матрицы линейной рекурренты x_(k+1) = a_1 x_k + ... + a_n x_(k-n+1) */
+enum COMPANION_FORM
+{
+    COMPANION_NONE = 0,
+    COMPANION_TOP_ROW,              /* a_1 ... a_n в первой строке, единицы под диагональю: (1,1;1,0) */
+    COMPANION_BOTTOM_ROW,           /* a_n ... a_1 в последней строке, единицы над диагональю */
+    COMPANION_LEFT_COLUMN,          /* a_1 ... a_n в первом столбце, единицы над диагональю */
+    COMPANION_RIGHT_COLUMN          /* a_n ... a_1 в последнем столбце, единицы под диагональю */
+};
+
+/*
+ * Определить, является ли a сопровождающей матрицей рекурренты (сдвиг плюс одна строка
+ * или один столбец коэффициентов). Проверка за O(n^2).
+ * [IN] a — матрица
+ * [OUT] recurrence — коэффициенты a_1 ... a_n (может быть NULL)
+ * [RETURN] вид COMPANION_FORM или COMPANION_NONE
+ */
+int matrix_companion_form(const Matrix* a, ULL* recurrence);
+
+/*
+ * Возвести сопровождающую матрицу в степень методом Китамасы за O(n^2 log e):
+ * r = x^e mod χ(x) бинарным возведением многочленов, затем строки A^e восстанавливаются
+ * из r по одной n шагами рекурренты (r = x r mod χ). Умножений матриц нет.
+ * [IN] base — сопровождающая матрица (см. matrix_companion_form), field_size >= 2
+ * [IN] exponent — показатель степени
+ * [OUT] result — указатель на результирующую матрицу
+ * [RETURN] MATRIX_SUCCESS, MATRIX_ERROR_INVALID_NUMBER для матрицы не сопровождающего вида
+ *          или другой код ошибки MATRIX_STATUS
+ */
+int matrix_power_companion(const Matrix* base, ULL exponent, Matrix** result);
+
+/*
+ * То же для показателя произвольной длины.
+ */
+int matrix_power_companion_big(const Matrix* base, const BigInt* exponent, Matrix** result);
+
+/*
+ * Найти период последовательности степеней A над простым полем GF(p):
+ * A^(k + period) = A^k для всех k >= preperiod.
+ * Характеристический многочлен раскладывается как x^m * f(x): preperiod = m.
+ * f раскладывается на свободные от квадратов множители и затем по степеням
+ * неприводимых множителей (distinct-degree factorization); порядок обратимой части
+ * делит period = lcm(p^d - 1 по степеням d неприводимых множителей) * p^t,
+ * где p^t — наименьшая степень p, не меньшая наибольшей кратности множителя.
+ * [IN] a — квадратная матрица над GF(p), p = a->field_size — простое
+ * [OUT] period — кратное порядка обратимой части A
+ * [OUT] preperiod — кратность собственного значения 0
+ * [RETURN] MATRIX_SUCCESS или код ошибки MATRIX_STATUS
+ */
+int matrix_order_bound(const Matrix* a, BigInt* period, int* preperiod);
+
+/*
+ * Привести показатель: reduced = exponent, если exponent < preperiod, иначе
+ * preperiod + (exponent - preperiod) mod period (см. matrix_order_bound).
+ * A^reduced == A^exponent.
+ * [IN] a — квадратная матрица над простым полем
+ * [IN] exponent — показатель степени
+ * [OUT] reduced — приведённый показатель
+ * [RETURN] MATRIX_SUCCESS или код ошибки MATRIX_STATUS
+ */
+int matrix_reduce_exponent(const Matrix* a, const BigInt* exponent, BigInt* reduced);
+
+#endif //LAB2_MATRIX_POLY_H
@@ -0,0 +1,102 @@
+#ifndef LAB2_MATRIX_RNS_H
+#define LAB2_MATRIX_RNS_H
+
+#include "matrix.h"
+#include "bigint.h"
+
+/*
+ * Многомодульная арифметика (система остаточных классов, RNS).
+ *
+ * Целочисленная матрица считается независимо по нескольким простым модулям-каналам
+ * меньше rns_channel_bound(), каждый канал — быстрыми ядрами малых полей (double/FMA
+ * или 32-битными), а результат восстанавливается по китайской теореме об остатках
+ * (схема Гарнера в смешанной системе счисления). Каналы независимы и выполняются
+ * в отдельных потоках.
+ *
+ * Используется двумя способами:
+ *  - умножение по большому модулю: точное произведение (меньше inner * (field_size-1)^2)
+ *    считается в каналах и затем приводится по field_size. Используется для
+ *    field_size > 2^62, где прямое ядро приводит 128-битный аккумулятор почти на каждом
+ *    шаге, а на многоядерных машинах — уже с field_size >= 2^32;
+ *  - точное возведение в степень над целыми числами: число каналов выбирается по
+ *    оценке размера результата, каждый канал возводит матрицу в степень целиком.
+ */
+
+/* Наибольшее число каналов (ограничивает размер точного результата) */
+#define RNS_MAX_CHANNELS 4096
+
+/* База каналов: простые модули и константы схемы Гарнера */
+typedef struct RnsBasis
+{
+    int count;                      /* число каналов */
+    ULL* primes;                    /* простые модули по убыванию */
+    ULL* barrett;                   /* floor((2^64 - 1) / primes[i]) для быстрого приведения */
+    ULL* inverses;                  /* inverses[i * count + j] = primes[j]^(-1) mod primes[i], j < i */
+} RnsBasis;
+
+/*
+ * Верхняя граница простых модулей каналов: 2^23, если ядро double выгоднее на этой
+ * машине (блок по k не короче 128 произведений), иначе 2^28 (32-битные элементы
+ * с 64-битным аккумулятором).
+ * [RETURN] граница (не включая)
+ */
+ULL rns_channel_bound(void);
+
+/*
+ * Построить базу каналов, произведение модулей которой больше 2^bits.
+ * [IN] bits — требуемое число бит
+ * [OUT] basis — заполняемая база (освободить rns_basis_free)
+ * [RETURN] MATRIX_SUCCESS, MATRIX_ERROR_OVERFLOW при превышении RNS_MAX_CHANNELS
+ *          или другой код ошибки MATRIX_STATUS
+ */
+int rns_basis_create(double bits, RnsBasis* basis);
+
+/*
+ * Освободить массивы базы каналов. Безопасно при передаче NULL.
+ */
+void rns_basis_free(RnsBasis* basis);
+
+/*
+ * Проверить, выгоднее ли многомодульное умножение прямого 128-битного для модуля
+ * field_size и размеров множителей.
+ * [IN] field_size — модуль
+ * [IN] rows, inner, cols — размеры произведения (rows x inner) × (inner x cols)
+ * [RETURN] 1, если следует использовать rns_multiply
+ */
+int rns_multiply_preferred(ULL field_size, int rows, int inner, int cols);
+
+/*
+ * c = a × b по модулю field_size через каналы RNS; элементы a и b лежат в [0, field_size).
+ * [IN] a — матрица rows x inner по строкам
+ * [IN] b — матрица inner x cols по строкам
+ * [OUT] c — матрица rows x cols (может совпадать с a или b)
+ * [IN] field_size — модуль (> 1)
+ * [RETURN] MATRIX_SUCCESS или код ошибки MATRIX_STATUS
+ */
+int rns_multiply(const ULL* a, const ULL* b, ULL* c, int rows, int inner, int cols, ULL field_size);
+
+/*
+ * Возвести квадратную матрицу в степень exponent точно, над целыми числами.
+ * Элементы base рассматриваются как неотрицательные целые (field_size не используется).
+ * Число каналов выбирается по оценке max|A^e| <= n^(e-1) * max|a|^e.
+ * [IN] base — квадратная матрица
+ * [IN] exponent — показатель степени
+ * [OUT] result — указатель на созданную матрицу больших целых
+ * [RETURN] MATRIX_SUCCESS, MATRIX_ERROR_OVERFLOW, если результат не помещается
+ *          в RNS_MAX_CHANNELS каналов, или другой код ошибки MATRIX_STATUS
+ */
+int matrix_power_exact(const Matrix* base, ULL exponent, BigMatrix** result);
+
+/*
+ * Возвести матрицу в степень по составному модулю base->field_size по компонентам:
+ * модуль раскладывается на p^k (modular_factor), степень по каждому p^k считается
+ * в отдельном потоке (для простых p — через теорему Гамильтона — Кэли, если она
+ * выгоднее), результаты объединяются по китайской теореме об остатках.
+ * [IN] base — квадратная матрица, field_size >= 2
+ * [IN] exponent — показатель степени
+ * [OUT] result — указатель на результирующую матрицу
+ * [RETURN] MATRIX_SUCCESS или код ошибки MATRIX_STATUS
+ */
+int matrix_power_components(const Matrix* base, ULL exponent, Matrix** result);
+
+#endif //LAB2_MATRIX_RNS_H
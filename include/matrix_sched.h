@@ -0,0 +1,115 @@
+#ifndef LAB2_MATRIX_SCHED_H
+#define LAB2_MATRIX_SCHED_H
+
+#include "common.h"
+
+#include <stdatomic.h>
+
+/*
+ * Планировщик задач с перехватом работы (work stealing) для умножения и поэлементных операций.
+ *
+ * У каждого потока, который порождает задачи, есть своя двусторонняя очередь Чейза–Лева:
+ * владелец кладёт и забирает задачи с нижнего конца без блокировок, свободные рабочие
+ * потоки крадут самые старые (самые крупные) задачи с верхнего конца. Поэтому рекурсивное
+ * деление работы само выравнивает нагрузку, в том числе на рваных краях при n, не кратных
+ * степени двойки.
+ *
+ * Модель fork/join: sched_spawn кладёт задачу в очередь текущего потока, sched_sync ждёт её,
+ * а пока ждёт — выполняет свои и чужие задачи. Поэтому задачи могут порождать задачи
+ * (вложенный параллелизм) без опасности взаимной блокировки.
+ *
+ * Пул из SCHED_ENV рабочих потоков (по умолчанию число процессоров минус один) создаётся
+ * при первом обращении и живёт до конца программы; простаивающий поток сначала крутится,
+ * затем уступает процессор и в конце засыпает до появления задач. При MATRIX_NUMA рабочие
+ * потоки закрепляются за ядрами (matrix_numa.h). Без рабочих потоков задачи выполняются сразу.
+ *
+ * Группы задач (sched_group_enter): задача принадлежит группе потока, который её породил,
+ * а поток, выполняющий задачу, на это время переходит в её группу. Поток, ждущий в sched_sync
+ * задачу группы G (не NULL), выполняет только задачи группы G: чужую задачу он не возьмёт
+ * ни из своей очереди, ни из чужих. Поэтому время, замеренное внутри группы (например,
+ * одного теста генератора при нескольких тестах сразу), не включает чужой работы.
+ * Без групп (NULL) ожидающий поток выполняет любые задачи.
+ *
+ * Задачи, выполняемые через очередь, видят пустые контексты выделения и проверки
+ * (matrix_alloc.h, matrix_verify.h): контекст не потокобезопасен и не должен попадать
+ * в чужой поток. Кому контекст нужен, привязывает его сам.
+ */
+
+#define SCHED_ENV "MATRIX_THREADS"          /* число рабочих потоков (0 — без параллелизма) */
+#define SCHED_MAX_WORKERS 64
+#define SCHED_MAX_QUEUES 256                /* рабочие потоки и внешние потоки, порождающие задачи */
+#define SCHED_QUEUE_CAPACITY 4096           /* при переполнении задача выполняется сразу */
+
+/* Задача: заполняется sched_spawn, живёт у порождающего до sched_sync */
+typedef struct SchedTask
+{
+    void (*run)(void* arg);
+    void* arg;
+    const void* group;                      /* группа порождающего потока */
+    atomic_int done;
+} SchedTask;
+
+/* Счётчики планировщика (с начала работы программы) */
+typedef struct SchedStats
+{
+    int workers;            /* число рабочих потоков */
+    size_t spawned;         /* задач положено в очереди */
+    size_t inlined;         /* задач выполнено сразу (нет рабочих потоков, очередь заполнена) */
+    size_t stolen;          /* задач выполнено не тем потоком, который их породил */
+    size_t sleeps;          /* засыпаний простаивающих рабочих потоков */
+} SchedStats;
+
+/*
+ * Число рабочих потоков пула (пул создаётся при первом вызове).
+ * [RETURN] 0, если параллелизм выключен или потоки не удалось создать
+ */
+int sched_workers(void);
+
+/*
+ * Отключить пул в дочернем процессе сразу после fork: рабочие потоки в него не копируются,
+ * а блокировки пула могли быть захвачены в момент fork. После вызова все задачи процесса
+ * выполняются сразу в порождающем потоке, новый пул не создаётся.
+ */
+void sched_fork_child(void);
+
+/*
+ * Породить задачу run(arg). Задача может начать выполняться в любом потоке сразу же;
+ * до sched_sync(task) нельзя трогать ни task, ни данные, которые она пишет.
+ * [IN] task — описание задачи (память вызывающего, обычно на стеке)
+ * [IN] run, arg — функция задачи и её аргумент
+ */
+void sched_spawn(SchedTask* task, void (*run)(void*), void* arg);
+
+/*
+ * Дождаться завершения задачи, выполняя тем временем другие задачи её группы
+ * (при группе NULL — любые).
+ * Задачи одного потока синхронизируются в обратном порядке порождения.
+ * [IN] task — задача из sched_spawn
+ */
+void sched_sync(SchedTask* task);
+
+/*
+ * Перевести текущий поток в группу задач group (NULL — вне групп). Вызовы вкладываются:
+ * предыдущую группу нужно вернуть тем же вызовом до sched_sync задач, порождённых в ней.
+ * [IN] group — любой уникальный адрес, например структура, описывающая работу
+ * [RETURN] предыдущая группа потока
+ */
+const void* sched_group_enter(const void* group);
+
+/*
+ * Выполнить body(context, i0, i1) по отрезкам [begin, end) рекурсивным делением пополам
+ * до отрезков не длиннее grain. Возвращается, когда обработан весь диапазон.
+ * [IN] begin, end — диапазон индексов
+ * [IN] grain — наибольшая длина отрезка, обрабатываемого одним вызовом body (не меньше 1)
+ * [IN] body, context — обработчик отрезка и его общий аргумент
+ */
+void sched_parallel_for(int begin, int end, int grain, void (*body)(void* context, int begin, int end),
+                        void* context);
+
+/*
+ * Получить счётчики планировщика.
+ * [OUT] stats — заполняемая структура
+ */
+void sched_stats(SchedStats* stats);
+
+#endif //LAB2_MATRIX_SCHED_H
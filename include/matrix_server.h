@@ -0,0 +1,94 @@
+#ifndef LAB2_MATRIX_SERVER_H
+#define LAB2_MATRIX_SERVER_H
+
+#include "common.h"
+
+/*
+ * Режим сервера: долгоживущий процесс, принимающий запросы на возведение в степень
+ * через Unix-сокет, без затрат на запуск программы и разбор текста на каждый запрос.
+ *
+ * Протокол. Каждое сообщение в обе стороны — кадр: uint32_t длина (байт после неё),
+ * затем заголовок и данные; все числа в порядке байтов машины (сокет локальный).
+ *   Запрос:  ServerRequestHeader, для SERVER_REQUEST_POWER затем size * size элементов
+ *            по строкам, по width байт (width == matrix_element_width(field_size)).
+ *   Ответ:   ServerResponseHeader, при status == MATRIX_SUCCESS затем элементы результата
+ *            в том же виде; на SERVER_REQUEST_STATS — ServerStats; на SERVER_REQUEST_HISTOGRAMS —
+ *            текст таблицы процентилей задержек по ключам (latency_recorder_print).
+ * Ответы на POWER могут приходить не в порядке запросов: их сопоставляют по id.
+ *
+ * Поток чтения каждого соединения кладёт задания в общую ограниченную очередь
+ * (SERVER_QUEUE_CAPACITY). Когда очередь полна, поток чтения ждёт и перестаёт читать сокет,
+ * так что клиент упирается в заполненный буфер сокета (обратное давление). Рабочие потоки
+ * (SERVER_WORKERS_ENV) берут задание и, если матрица не больше SERVER_BATCH_MAX_SIZE,
+ * забирают вместе с ним до SERVER_BATCH_MAX ожидающих заданий того же размера и поля —
+ * пачка возводится одним вызовом matrix_power_batch.
+ */
+
+#define SERVER_DEFAULT_SOCKET "matrix_power.sock"
+#define SERVER_WORKERS_ENV "MATRIX_SERVER_WORKERS"  /* рабочих потоков (по умолчанию число процессоров) */
+#define SERVER_QUEUE_CAPACITY 256                   /* заданий в очереди */
+#define SERVER_BATCH_MAX 32                         /* заданий в одной пачке */
+#define SERVER_BATCH_MAX_SIZE 64                    /* наибольший n, при котором задания объединяются */
+#define SERVER_MAX_SIZE 4096                        /* наибольший n в запросе */
+#define SERVER_LATENCY_WINDOW 4096                  /* последних задержек для процентилей */
+
+/* Тип запроса */
+enum SERVER_REQUEST
+{
+    SERVER_REQUEST_POWER = 1,
+    SERVER_REQUEST_STATS,
+    SERVER_REQUEST_SHUTDOWN,
+    SERVER_REQUEST_HISTOGRAMS
+};
+
+/* Заголовок запроса */
+typedef struct ServerRequestHeader
+{
+    uint32_t type;          /* SERVER_REQUEST */
+    uint32_t size;          /* n (только POWER) */
+    uint64_t id;            /* возвращается в ответе */
+    uint64_t exponent;
+    uint64_t field_size;
+    uint32_t width;         /* байт на элемент */
+    uint32_t reserved;
+} ServerRequestHeader;
+
+/* Заголовок ответа */
+typedef struct ServerResponseHeader
+{
+    uint64_t id;
+    int32_t status;         /* MATRIX_STATUS; SERVER_STATUS для ошибок протокола — с обратным знаком */
+    uint32_t size;
+    uint64_t queue_ns;      /* от приёма запроса до начала вычисления */
+    uint64_t compute_ns;    /* вычисление (всей пачки) */
+    uint32_t batch;         /* заданий в пачке, с которой посчитан результат */
+    uint32_t width;
+} ServerResponseHeader;
+
+/* Статистика сервера (ответ на SERVER_REQUEST_STATS) */
+typedef struct ServerStats
+{
+    uint64_t requests;      /* принято заданий POWER */
+    uint64_t completed;     /* отправлено ответов на них */
+    uint64_t batches;       /* вычислений (пачка из одного задания — тоже вычисление) */
+    uint64_t batched;       /* заданий, посчитанных в пачках больше одного */
+    uint64_t full_waits;    /* раз поток чтения ждал места в очереди */
+    uint32_t queue_depth;   /* заданий в очереди сейчас */
+    uint32_t queue_peak;    /* наибольшая глубина очереди */
+    uint32_t connections;   /* открытых соединений */
+    uint32_t workers;
+    uint64_t latency_p50_ns;    /* задержка от приёма запроса до отправки ответа, */
+    uint64_t latency_p90_ns;    /* по последним SERVER_LATENCY_WINDOW заданиям */
+    uint64_t latency_p99_ns;
+    uint64_t latency_max_ns;
+} ServerStats;
+
+/*
+ * Запустить сервер на сокете socket_path и обслуживать запросы до SERVER_REQUEST_SHUTDOWN.
+ * Существующий файл сокета заменяется, при завершении удаляется.
+ * [IN] socket_path — путь к сокету (NULL — SERVER_DEFAULT_SOCKET)
+ * [RETURN] SERVER_SUCCESS или код ошибки SERVER_STATUS
+ */
+int server_run(const char* socket_path);
+
+#endif //LAB2_MATRIX_SERVER_H
@@ -0,0 +1,100 @@
+#ifndef LAB2_MATRIX_SHARD_H
+#define LAB2_MATRIX_SHARD_H
+
+#include "matrix.h"
+
+#include <sys/types.h>
+
+/*
+ * Возведение в степень несколькими процессами над общей памятью.
+ *
+ * Координатор создаёт общую область (ShardTransport), кладёт в неё три упакованные матрицы
+ * (результат, текущая степень, приёмник) и запускает workers процессов. Каждое умножение
+ * бинарного метода справа налево — команда в общей области: координатор записывает, какие
+ * буферы перемножить, и проходит барьер; процесс r считает свою полосу строк приёмника
+ * packed_matrix_multiply и проходит второй барьер. Буферы меняются ролями без копирования.
+ *
+ * Транспорт подключаемый: всё, что зависит от того, где живут процессы (выделение общей
+ * области, запуск, барьер, передача полосы остальным, ожидание завершения), собрано в
+ * ShardTransport. Встроенный shard_transport_shm работает в пределах одной машины: область —
+ * объект POSIX shm_open + mmap, процессы — fork, барьер — futex в общей памяти, публикация
+ * полосы не нужна (память общая). Транспорт между машинами реализует те же функции.
+ *
+ * В дочернем процессе пул потоков отключается (sched_fork_child): параллельность даёт
+ * число процессов. Контекст проверки (matrix_verify.h), привязанный к координатору,
+ * наследуется процессами и проверяет каждую полосу; счётчики проверок процессы пишут
+ * в общую область, и перед возвратом координатор прибавляет их к своему контексту.
+ */
+
+#define SHARD_ENV "MATRIX_SHARDS"           /* число процессов для ручного ввода (0 — без них) */
+#define SHARD_MAX_WORKERS 64
+
+/* Подключаемый транспорт. Участник 0 — координатор, 1 ... workers — рабочие процессы */
+typedef struct ShardTransport
+{
+    const char* name;
+
+    /* Создать общую область bytes байт для workers + 1 участников; memory — её адрес у координатора */
+    int (*create)(size_t bytes, int workers, void** state, void** memory);
+
+    /* Запустить участника rank, выполняющего run(context, memory, rank); memory — адрес области у него */
+    int (*launch)(void* state, int rank, int (*run)(void* context, void* memory, int rank), void* context);
+
+    /* Дождаться всех участников. [RETURN] 0 или -1, если участник завершился аварийно */
+    int (*barrier)(void* state, int rank);
+
+    /* Сделать байты [offset, offset + bytes) области, записанные участником rank, видимыми остальным */
+    int (*publish)(void* state, int rank, size_t offset, size_t bytes);
+
+    /* Дождаться завершения всех запущенных участников и освободить область */
+    void (*destroy)(void* state);
+} ShardTransport;
+
+/* Один компьютер: shm_open + mmap, fork, futex-барьер */
+extern const ShardTransport shard_transport_shm;
+
+/* Параметры */
+typedef struct ShardOptions
+{
+    int workers;                            /* число рабочих процессов (1 ... SHARD_MAX_WORKERS) */
+    const ShardTransport* transport;        /* NULL — shard_transport_shm */
+} ShardOptions;
+
+/* Время одного рабочего процесса */
+typedef struct ShardWorkerReport
+{
+    pid_t pid;
+    int rows;                               /* строк в полосе */
+    int multiplies;                         /* посчитано полос */
+    ULL compute_ns;                         /* в умножениях */
+    ULL wait_ns;                            /* в барьерах */
+} ShardWorkerReport;
+
+/* Отчёт о вычислении */
+typedef struct ShardReport
+{
+    int workers;
+    int multiplies;                         /* умножений всей матрицы */
+    ULL total_ns;                           /* у координатора от запуска до остановки процессов */
+    ShardWorkerReport ranks[SHARD_MAX_WORKERS];
+} ShardReport;
+
+/*
+ * Возвести квадратную матрицу base в степень exponent, деля каждое умножение по строкам
+ * между процессами.
+ * [IN] base — квадратная матрица
+ * [IN] exponent — показатель степени
+ * [IN] options — число процессов и транспорт
+ * [OUT] result — указатель на результирующую матрицу
+ * [OUT] report — время по процессам (NULL — не нужно)
+ * [RETURN] MATRIX_SUCCESS или код ошибки MATRIX_STATUS
+ */
+int matrix_power_sharded(const Matrix* base, ULL exponent, const ShardOptions* options, Matrix** result,
+                         ShardReport* report);
+
+/*
+ * Напечатать отчёт: по строке на процесс (полоса, умножения, вычисление, ожидание).
+ */
+void shard_report_print(const ShardReport* report, FILE* out);
+
+#endif //LAB2_MATRIX_SHARD_H
@@ -0,0 +1,187 @@
+#ifndef LAB2_MATRIX_TILED_H
+#define LAB2_MATRIX_TILED_H
+
+#include "matrix.h"
+
+#include <stddef.h>
+
+/*
+ * Возведение в степень матриц, не помещающихся в память (out-of-core).
+ *
+ * Матрица хранится в файле плитками tile x tile: заголовок TiledFileHeader, с отступа
+ * TILED_DATA_OFFSET — плитки по строкам плиток, каждая по строкам элементов по width байт
+ * (width == matrix_element_width(field_size)). Крайние плитки дополнены нулями до полного
+ * размера, поэтому любая плитка читается и пишется одним pread/pwrite по известному смещению.
+ *
+ * Умножение C = A × B идёт блоками C из r x c плиток. Блок целиком лежит в памяти как
+ * аккумуляторы, а для каждого k через память проходят столбец плиток A (r штук) и строка
+ * плиток B (c штук): каждая плитка A читается ceil(N / c) раз, плитка B — ceil(N / r) раз
+ * (N — плиток на сторону). r и c выбираются наибольшими, при которых всё помещается в бюджет.
+ * Порядок обхода змейкой (k в соседних блоках в обратном порядке, блоки в соседних строках
+ * блоков — тоже), так что столбец или строка плиток на стыке блоков не читается повторно.
+ *
+ * Чтение и запись выполняет отдельный поток ввода-вывода по кольцу заявок (pread/pwrite в
+ * духе io_uring: заявка получает номер, вычисление ждёт только нужный номер). Плитки следующего
+ * шага k читаются, пока считается текущий; готовый блок C пишется плитка за плиткой, и первое
+ * произведение следующего блока в плитку-аккумулятор ждёт только её записи.
+ *
+ * Бюджет памяти жёсткий: все буферы плиток выделяются одним блоком не больше
+ * memory_budget байт. Каждая плитка занимает слот из tile_bytes, округлённых вверх до
+ * TILED_ALIGN байт: r * c аккумуляторов, по два (текущий и предвыборка) столбца A и
+ * строки B и плитка-произведение — r * c + 2 * (r + c) + 1 слотов, при r = c = 1 это
+ * TILED_MIN_SLOTS (см. tiled_min_budget). Плитки перемножаются целочисленным ядром на месте
+ * (packed_matrix_multiply_inplace): для широких модулей RNS не используется, так как её
+ * каналы — целые плитки вне бюджета. Сверх бюджета остаются только служебные структуры
+ * и рабочие строки ядра умножения.
+ *
+ * Промежуточные степени хранятся во временных файлах рядом с результатом
+ * (<result_path>.tmp0 ... .tmp2) и удаляются; итоговый файл переименовывается в result_path.
+ */
+
+#define TILED_MAGIC "MPTILE1"
+#define TILED_DATA_OFFSET 4096              /* начало плиток в файле */
+#define TILED_DEFAULT_TILE 1024             /* сторона плитки по умолчанию */
+#define TILED_IO_DEPTH 256                  /* заявок в кольце ввода-вывода */
+#define TILED_ALIGN 64                      /* выравнивание слота плитки в памяти */
+#define TILED_MIN_SLOTS 6                   /* слотов в бюджете при блоке C из одной плитки */
+
+/* Заголовок файла */
+typedef struct TiledFileHeader
+{
+    char magic[8];                          /* TILED_MAGIC */
+    uint64_t field_size;
+    uint32_t size;                          /* n */
+    uint32_t tile;                          /* сторона плитки */
+    uint32_t width;                         /* байт на элемент */
+    uint32_t reserved;
+} TiledFileHeader;
+
+/* Открытая матрица в файле */
+typedef struct TiledMatrix
+{
+    int fd;
+    char* path;
+    int size;                               /* n */
+    int tile;                               /* сторона плитки */
+    int tiles;                              /* плиток на сторону: ceil(n / tile) */
+    int width;                              /* байт на элемент */
+    ULL field_size;
+    size_t tile_bytes;                      /* tile * tile * width */
+} TiledMatrix;
+
+/* Параметры */
+typedef struct TiledOptions
+{
+    size_t memory_budget;                   /* байт на буферы плиток (жёсткий предел) */
+} TiledOptions;
+
+/* Отчёт о вычислении */
+typedef struct TiledReport
+{
+    int block_rows;                         /* плиток в блоке C: r */
+    int block_cols;                         /* c */
+    size_t memory_used;                     /* байт буферов плиток */
+    int multiplies;                         /* умножений всей матрицы */
+    ULL tiles_read;
+    ULL tiles_reused;                       /* плиток, не прочитанных повторно на стыке блоков */
+    ULL tiles_written;
+    ULL bytes_read;
+    ULL bytes_written;
+    ULL compute_ns;                         /* в умножениях плиток */
+    ULL io_wait_ns;                         /* в ожидании ввода-вывода */
+    ULL total_ns;
+} TiledReport;
+
+/*
+ * Создать файл матрицы n x n из нулей (файл разреженный: место занимают только
+ * записанные плитки). Существующий файл перезаписывается.
+ * [IN] path — путь к файлу
+ * [IN] size — n
+ * [IN] field_size — модуль
+ * [IN] tile — сторона плитки (0 — TILED_DEFAULT_TILE, не больше n)
+ * [OUT] result — открытая матрица
+ * [RETURN] MATRIX_SUCCESS или код ошибки MATRIX_STATUS
+ */
+int tiled_matrix_create(const char* path, int size, ULL field_size, int tile, TiledMatrix** result);
+
+/*
+ * Открыть существующий файл матрицы для чтения.
+ * [IN] path — путь к файлу
+ * [OUT] result — открытая матрица
+ * [RETURN] MATRIX_SUCCESS, MATRIX_ERROR_FILE или MATRIX_ERROR_INVALID_NUMBER для чужого формата
+ */
+int tiled_matrix_open(const char* path, TiledMatrix** result);
+
+/*
+ * Закрыть файл матрицы (файл остаётся). Безопасно при передаче NULL.
+ */
+void tiled_matrix_close(TiledMatrix* matrix);
+
+/*
+ * Прочитать плитку (row, col) в buffer размера tile_bytes.
+ * [RETURN] MATRIX_SUCCESS или код ошибки MATRIX_STATUS
+ */
+int tiled_matrix_read_tile(const TiledMatrix* matrix, int row, int col, void* buffer);
+
+/*
+ * Записать плитку (row, col) из buffer размера tile_bytes.
+ * [RETURN] MATRIX_SUCCESS или код ошибки MATRIX_STATUS
+ */
+int tiled_matrix_write_tile(TiledMatrix* matrix, int row, int col, const void* buffer);
+
+/*
+ * Записать матрицу в файл плитками.
+ * [IN] src — квадратная матрица
+ * [IN] path — путь к файлу
+ * [IN] tile — сторона плитки (0 — TILED_DEFAULT_TILE)
+ * [OUT] result — открытая матрица
+ * [RETURN] MATRIX_SUCCESS или код ошибки MATRIX_STATUS
+ */
+int tiled_matrix_from_matrix(const Matrix* src, const char* path, int tile, TiledMatrix** result);
+
+/*
+ * Прочитать матрицу из файла целиком в память.
+ * [IN] src — открытая матрица
+ * [OUT] result — указатель на созданную матрицу
+ * [RETURN] MATRIX_SUCCESS или код ошибки MATRIX_STATUS
+ */
+int tiled_matrix_to_matrix(const TiledMatrix* src, Matrix** result);
+
+/*
+ * Создать файл матрицы со случайными элементами из [0, field_size), плитка за плиткой.
+ * [IN] path, size, field_size, tile — как в tiled_matrix_create
+ * [IN] seed — начальное значение генератора
+ * [OUT] result — открытая матрица
+ * [RETURN] MATRIX_SUCCESS или код ошибки MATRIX_STATUS
+ */
+int tiled_matrix_random(const char* path, int size, ULL field_size, int tile, ULL seed, TiledMatrix** result);
+
+/*
+ * Наименьший бюджет памяти для matrix_power_tiled над этой матрицей:
+ * TILED_MIN_SLOTS слотов по tile_bytes, округлённых вверх до TILED_ALIGN.
+ * [RETURN] байт
+ */
+size_t tiled_min_budget(const TiledMatrix* matrix);
+
+/*
+ * Возвести матрицу из файла в степень exponent, держа в памяти не больше options->memory_budget
+ * байт плиток. Бинарный метод справа налево; каждое умножение — блочное, как описано выше.
+ * [IN] base — открытая матрица (не меняется)
+ * [IN] exponent — показатель степени
+ * [IN] options — бюджет памяти
+ * [IN] result_path — путь к файлу результата (не должен совпадать с base->path)
+ * [OUT] result — открытая матрица результата
+ * [OUT] report — статистика (NULL — не нужна)
+ * [RETURN] MATRIX_SUCCESS, MATRIX_ERROR_MEMORY_BUDGET, если бюджет меньше
+ *          tiled_min_budget(base), MATRIX_ERROR_FILE или другой код ошибки MATRIX_STATUS
+ */
+int matrix_power_tiled(const TiledMatrix* base, ULL exponent, const TiledOptions* options,
+                       const char* result_path, TiledMatrix** result, TiledReport* report);
+
+/*
+ * Напечатать отчёт: размер блока, память, прочитанные и записанные плитки, время
+ * вычисления и ожидания ввода-вывода.
+ */
+void tiled_report_print(const TiledReport* report, FILE* out);
+
+#endif //LAB2_MATRIX_TILED_H
@@ -0,0 +1,106 @@
+#ifndef LAB2_MATRIX_TUNE_H
+#define LAB2_MATRIX_TUNE_H
+
+#include "matrix.h"
+
+#include <stdio.h>
+
+/*
+ * Профиль автонастройки умножения.
+ * Лучшие формат элементов, порядок циклов, ширина блока и способ приведения зависят от
+ * машины, поэтому режим настройки замеряет варианты packed_matrix_multiply на сетке
+ * «класс поля x класс размера» и записывает победителей в файл профиля.
+ * Файл — образ структуры TuneProfile: при запуске он отображается в память (mmap) и
+ * используется как есть, так что выбор ядра на горячем пути — одно обращение к таблице.
+ * Без профиля действуют встроенные правила (fma_field_preferred, rns_multiply_preferred).
+ *
+ * Профиль загружается до начала вычислений и не меняется, пока они идут.
+ */
+
+#define MATRIX_TUNE_FILE "matrix_tune.bin"      /* профиль по умолчанию (в текущем каталоге) */
+#define MATRIX_TUNE_ENV "MATRIX_TUNE_FILE"      /* переменная окружения с другим путём */
+
+#define TUNE_FIELD_CLASSES 7    /* 0; <= 2^8; <= 2^16; < 2^26; <= 2^32; <= 2^62; > 2^62 */
+#define TUNE_SIZE_CLASSES 5     /* наименьшая размерность < 32; < 96; < 192; < 384; >= 384 */
+
+/* Варианты целочисленного умножения */
+enum MULTIPLY_VARIANT
+{
+    MULTIPLY_ROWS = 0,          /* строка c целиком в аккумуляторах: циклы i-k-j */
+    MULTIPLY_BLOCKED,           /* то же по полосам из block столбцов: полоса b остаётся в кэше */
+    MULTIPLY_RNS                /* каналы RNS и CRT (только ширина 8, см. matrix_rns.h) */
+};
+
+/* Выбор для одной клетки сетки */
+typedef struct TuneChoice
+{
+    uint8_t variant;            /* MULTIPLY_VARIANT */
+    uint8_t reserved;
+    uint16_t block;             /* ширина полосы для MULTIPLY_BLOCKED */
+} TuneChoice;
+
+/* Образ файла профиля (порядок байтов машины, на которой он записан) */
+typedef struct TuneProfile
+{
+    char magic[8];                                          /* "MPTUNE" */
+    uint32_t version;                                       /* TUNE_PROFILE_VERSION */
+    uint32_t size;                                          /* sizeof(TuneProfile) */
+    uint8_t formats[TUNE_FIELD_CLASSES];                    /* PACKED_FORMAT по классу поля */
+    uint8_t reserved;
+    TuneChoice choices[TUNE_FIELD_CLASSES][TUNE_SIZE_CLASSES];
+} TuneProfile;
+
+#define TUNE_PROFILE_VERSION 1
+
+/*
+ * Класс поля field_size в сетке профиля (0 ... TUNE_FIELD_CLASSES - 1).
+ */
+int tune_field_class(ULL field_size);
+
+/*
+ * Класс размера произведения rows x inner на inner x cols (0 ... TUNE_SIZE_CLASSES - 1).
+ */
+int tune_size_class(int rows, int inner, int cols);
+
+/*
+ * Формат упакованных элементов для поля (см. packed_matrix_format).
+ * [RETURN] PACKED_INTEGER или PACKED_DOUBLE
+ */
+int matrix_tune_format(ULL field_size);
+
+/*
+ * Вариант целочисленного умножения для поля и размеров множителей.
+ * [RETURN] выбор из профиля или встроенный по умолчанию
+ */
+TuneChoice matrix_tune_choice(ULL field_size, int rows, int inner, int cols);
+
+/*
+ * Отобразить файл профиля в память и сделать его текущим (предыдущий освобождается).
+ * [IN] path — путь к файлу (NULL — из MATRIX_TUNE_ENV, иначе MATRIX_TUNE_FILE)
+ * [RETURN] TUNE_SUCCESS, TUNE_ERROR_FILE_READ, если файла нет, или TUNE_ERROR_FORMAT,
+ *          если он записан другой версией; в случае ошибки действуют правила по умолчанию
+ */
+int matrix_tune_load(const char* path);
+
+/*
+ * Отключить профиль и вернуться к правилам по умолчанию.
+ */
+void matrix_tune_unload(void);
+
+/*
+ * Проверить, загружен ли профиль.
+ * [RETURN] 1, если выбор идёт по профилю, иначе 0
+ */
+int matrix_tune_active(void);
+
+/*
+ * Замерить варианты умножения на сетке классов, записать профиль и загрузить его.
+ * Для каждого класса поля берётся характерный модуль, для каждого класса размера —
+ * характерное n; время — лучшее из повторов packed_matrix_multiply.
+ * [IN] path — путь к файлу (NULL — как в matrix_tune_load)
+ * [IN] log — куда печатать таблицу замеров (NULL — не печатать)
+ * [RETURN] TUNE_SUCCESS или код ошибки TUNE_STATUS
+ */
+int matrix_tune_run(const char* path, FILE* log);
+
+#endif //LAB2_MATRIX_TUNE_H
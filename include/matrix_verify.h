@@ -0,0 +1,92 @@
+#ifndef LAB2_MATRIX_VERIFY_H
+#define LAB2_MATRIX_VERIFY_H
+
+#include "matrix.h"
+
+/*
+ * Вероятностная проверка произведений матриц методом Фрейвалдса.
+ * Пока к потоку привязан контекст проверки (matrix_verifier_bind), каждое произведение
+ * C = A·B, вычисленное packed_matrix_multiply или gf2_matrix_multiply, проверяется за O(n^2):
+ * для случайного вектора r сравниваются A(Br) и Cr. Неверное произведение проходит один
+ * раунд с вероятностью не больше 1/2 (над простым полем GF(p) — не больше 1/p).
+ * При несовпадении умножение возвращает MATRIX_ERROR_VERIFICATION, и возведение в степень
+ * прерывается с этим кодом.
+ *
+ * Счётчики контекста атомарные: один контекст можно привязать к нескольким потокам
+ * (так делают каналы matrix_rns.c, выполняемые задачами планировщика).
+ */
+
+#define MATRIX_VERIFY_ENV "MATRIX_VERIFY"     /* раундов проверки для ручного ввода (0 — без проверки) */
+#define MATRIX_VERIFY_MAX_ROUNDS 64
+
+typedef struct MatrixVerifier MatrixVerifier;
+
+/* Статистика контекста проверки */
+typedef struct MatrixVerifierStats
+{
+    size_t checks;          /* проверено произведений */
+    size_t rounds;          /* выполнено раундов (случайных векторов) */
+    size_t failures;        /* найдено неверных произведений */
+} MatrixVerifierStats;
+
+struct PackedMatrix;
+struct Gf2Matrix;
+
+/*
+ * Создать контекст проверки.
+ * [IN] rounds — число случайных векторов на одно произведение (>= 1)
+ * [IN] seed — начальное значение генератора случайных векторов
+ * [OUT] result — указатель на созданный контекст
+ * [RETURN] MATRIX_SUCCESS или код ошибки MATRIX_STATUS
+ */
+int matrix_verifier_create(int rounds, ULL seed, MatrixVerifier** result);
+
+/*
+ * Уничтожить контекст проверки. Безопасно при передаче NULL.
+ * [RETURN] MATRIX_SUCCESS
+ */
+int matrix_verifier_destroy(MatrixVerifier* verifier);
+
+/*
+ * Привязать контекст к текущему потоку (NULL — отключить проверку).
+ * [RETURN] контекст, который был привязан до вызова
+ */
+MatrixVerifier* matrix_verifier_bind(MatrixVerifier* verifier);
+
+/*
+ * Получить контекст, привязанный к текущему потоку (NULL — проверка выключена).
+ */
+MatrixVerifier* matrix_verifier_current(void);
+
+/*
+ * Получить статистику контекста проверки.
+ * [OUT] stats — заполняемая структура статистики
+ * [RETURN] MATRIX_SUCCESS или MATRIX_ERROR_NULL_POINTER
+ */
+int matrix_verifier_stats(const MatrixVerifier* verifier, MatrixVerifierStats* stats);
+
+/*
+ * Добавить к счётчикам контекста статистику его копии из другого процесса
+ * (так matrix_shard.c возвращает проверки рабочих процессов координатору).
+ * [IN] stats — прибавляемые счётчики
+ * [RETURN] MATRIX_SUCCESS или MATRIX_ERROR_NULL_POINTER
+ */
+int matrix_verifier_add(MatrixVerifier* verifier, const MatrixVerifierStats* stats);
+
+/*
+ * Проверить упакованное произведение c = a × b (см. matrix_kernels.h).
+ * [RETURN] MATRIX_SUCCESS, MATRIX_ERROR_VERIFICATION при несовпадении
+ *          или другой код ошибки MATRIX_STATUS
+ */
+int matrix_verify_packed(MatrixVerifier* verifier, const struct PackedMatrix* a, const struct PackedMatrix* b,
+                         const struct PackedMatrix* c);
+
+/*
+ * Проверить произведение c = a × b над GF(2) (см. gf2.h); векторы — биты в словах.
+ * [RETURN] MATRIX_SUCCESS, MATRIX_ERROR_VERIFICATION при несовпадении
+ *          или другой код ошибки MATRIX_STATUS
+ */
+int matrix_verify_gf2(MatrixVerifier* verifier, const struct Gf2Matrix* a, const struct Gf2Matrix* b,
+                      const struct Gf2Matrix* c);
+
+#endif //LAB2_MATRIX_VERIFY_H
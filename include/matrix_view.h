@@ -0,0 +1,115 @@
+#ifndef LAB2_MATRIX_VIEW_H
+#define LAB2_MATRIX_VIEW_H
+
+#include "matrix.h"
+
+#include <stddef.h>
+
+/*
+ * Представление (view) части матрицы без копирования элементов.
+ * Хранение описывается указателем на элемент (0, 0) и шагом между строками хранения;
+ * флаг transposed меняет роли строк и столбцов, поэтому транспонирование и вырезание
+ * подматрицы — операции O(1). Представление не владеет памятью: исходная матрица
+ * должна жить дольше него. Копия создаётся только явно (matrix_materialize).
+ */
+typedef struct MatrixView
+{
+    ULL* base;                      /* элемент (0, 0) */
+    int rows;                       /* число строк представления */
+    int cols;                       /* число столбцов представления */
+    ptrdiff_t row_stride;           /* шаг между строками хранения, в элементах */
+    int transposed;                 /* 1 — элемент (i, j) хранится в base[j * row_stride + i] */
+    ULL field_size;                 /* модуль (0 — арифметика по модулю 2^64) */
+} MatrixView;
+
+/*
+ * Адрес элемента (row, col) представления.
+ */
+static inline ULL* matrix_view_at(const MatrixView* view, int row, int col)
+{
+    return view->transposed ? view->base + (ptrdiff_t)col * view->row_stride + row
+                            : view->base + (ptrdiff_t)row * view->row_stride + col;
+}
+
+/*
+ * Получить представление всей матрицы.
+ * [IN] matrix — исходная матрица
+ * [OUT] result — представление
+ * [RETURN] MATRIX_SUCCESS или код ошибки MATRIX_STATUS
+ */
+int matrix_view_of(const Matrix* matrix, MatrixView* result);
+
+/*
+ * Вырезать подматрицу представления: строки start_row..end_row и столбцы
+ * start_col..end_col включительно (как в matrix_submatrix). Элементы не копируются.
+ * [IN] view — исходное представление
+ * [OUT] result — представление подматрицы (может совпадать с view)
+ * [RETURN] MATRIX_SUCCESS или код ошибки MATRIX_STATUS
+ */
+int matrix_view_submatrix(const MatrixView* view, int start_row, int end_row,
+                          int start_col, int end_col, MatrixView* result);
+
+/*
+ * Подматрица матрицы a как представление (см. matrix_view_submatrix).
+ */
+int matrix_submatrix_view(const Matrix* a, int start_row, int end_row,
+                          int start_col, int end_col, MatrixView* result);
+
+/*
+ * Транспонировать представление: меняются размеры и флаг transposed.
+ * [IN] view — исходное представление
+ * [OUT] result — транспонированное представление (может совпадать с view)
+ * [RETURN] MATRIX_SUCCESS или код ошибки MATRIX_STATUS
+ */
+int matrix_view_transpose(const MatrixView* view, MatrixView* result);
+
+/*
+ * Транспонированная матрица a как представление (без копирования).
+ */
+int matrix_transpose_view(const Matrix* a, MatrixView* result);
+
+/*
+ * Скопировать представление в новую непрерывную матрицу.
+ * [IN] view — представление
+ * [OUT] result — указатель на созданную матрицу view->rows x view->cols
+ * [RETURN] MATRIX_SUCCESS или код ошибки MATRIX_STATUS
+ */
+int matrix_materialize(const MatrixView* view, Matrix** result);
+
+/*
+ * Скопировать элементы src в представление dst того же размера.
+ * При разной ориентации копирование идёт кэш-независимым транспонированием (transpose_block);
+ * если src и dst — одно квадратное хранение в разной ориентации, оно транспонируется на месте.
+ * Иначе src и dst не должны перекрываться.
+ * [RETURN] MATRIX_SUCCESS или код ошибки MATRIX_STATUS
+ */
+int matrix_view_copy(const MatrixView* src, const MatrixView* dst);
+
+/*
+ * Поэлементные операции над представлениями (см. matrix_sum_into и др.):
+ * result = a + b, a - b, scalar * a, alpha * a + beta * b.
+ * Все представления одного размера и поля; result может совпадать с a или b. Если хранение
+ * операнда перекрывается с result иначе (например, result = A, а операнд — Aᵀ или сдвинутая
+ * подматрица A), операнд сначала копируется (matrix_materialize), так что результат тот же,
+ * что при записи в отдельную матрицу. Элементы операндов могут быть не приведены по модулю:
+ * отрезок с элементом не меньше field_size приводится перед операцией, результат всегда в [0, p).
+ * Если транспонированы все операнды, проход идёт по строкам хранения; иначе — плитками,
+ * чтобы транспонированный операнд читался строками кэша.
+ * [RETURN] MATRIX_SUCCESS или код ошибки MATRIX_STATUS
+ */
+int matrix_view_sum(const MatrixView* a, const MatrixView* b, const MatrixView* result);
+int matrix_view_subtract(const MatrixView* a, const MatrixView* b, const MatrixView* result);
+int matrix_view_scalar_multiply(const MatrixView* a, ULL scalar, const MatrixView* result);
+int matrix_view_axpby(ULL alpha, const MatrixView* a, ULL beta, const MatrixView* b, const MatrixView* result);
+
+/*
+ * Перемножить представления: c = a × b в поле field_size.
+ * Множители упаковываются ядрами matrix_kernels.h прямо из представлений, результат
+ * записывается в c; c может перекрываться с a или b.
+ * [IN] a, b — множители (a->cols == b->rows)
+ * [OUT] c — представление-приёмник a->rows x b->cols
+ * [RETURN] MATRIX_SUCCESS или код ошибки MATRIX_STATUS
+ */
+int matrix_view_multiply(const MatrixView* a, const MatrixView* b, const MatrixView* c);
+
+#endif //LAB2_MATRIX_VIEW_H
@@ -0,0 +1,99 @@
+#ifndef LAB2_MODULAR_H
+#define LAB2_MODULAR_H
+
+#include "common.h"
+
+typedef unsigned long long ULL;
+
+/* ---------- Арифметика по модулю для 64-битных чисел ---------- */
+
+/*
+ * Умножить a * b по модулю mod через 128-битное произведение.
+ * [IN] a, b — множители
+ * [IN] mod — модуль (> 0)
+ * [RETURN] (a * b) % mod
+ */
+ULL modular_mul(ULL a, ULL b, ULL mod);
+
+/*
+ * Предвычисление для умножения на фиксированный множитель w (метод Шоупа).
+ * [IN] w — множитель (< mod)
+ * [IN] mod — модуль (< 2^63)
+ * [RETURN] floor(w * 2^64 / mod)
+ */
+static inline ULL modular_shoup(ULL w, ULL mod)
+{
+    return (ULL)(((unsigned __int128)w << 64) / mod);
+}
+
+/*
+ * Умножить x на фиксированный w по модулю mod без деления: частное оценивается
+ * через w_shoup = modular_shoup(w, mod) с ошибкой не больше 1.
+ * [IN] x — множитель (< 2^64)
+ * [IN] w, w_shoup — фиксированный множитель и его предвычисление
+ * [IN] mod — модуль (< 2^63)
+ * [RETURN] (x * w) % mod
+ */
+static inline ULL modular_mul_shoup(ULL x, ULL w, ULL w_shoup, ULL mod)
+{
+    ULL q = (ULL)(((unsigned __int128)x * w_shoup) >> 64);
+    ULL r = x * w - q * mod;
+    return r >= mod ? r - mod : r;
+}
+
+/*
+ * Возвести base в степень exponent по модулю mod.
+ * [IN] base — основание
+ * [IN] exponent — показатель
+ * [IN] mod — модуль (> 0)
+ * [RETURN] base^exponent % mod
+ */
+ULL modular_pow(ULL base, ULL exponent, ULL mod);
+
+/*
+ * Найти обратный к a элемент по модулю mod (расширенный алгоритм Евклида).
+ * [IN] a — число
+ * [IN] mod — модуль (> 1)
+ * [RETURN] a^(-1) mod mod или 0, если НОД(a, mod) != 1
+ */
+ULL modular_inverse(ULL a, ULL mod);
+
+/*
+ * Проверить число на простоту (детерминированный тест Миллера — Рабина для 64 бит).
+ * [IN] n — проверяемое число
+ * [RETURN] 1 — простое, 0 — составное (или n < 2)
+ */
+int modular_is_prime(ULL n);
+
+/*
+ * Найти наибольшее простое число, меньшее bound.
+ * [IN] bound — верхняя граница (не включая)
+ * [RETURN] простое число или 0, если его нет
+ */
+ULL modular_prev_prime(ULL bound);
+
+/* ---------- Разложение на множители ---------- */
+
+/* У 64-битного числа не больше 15 различных простых делителей */
+#define MODULAR_MAX_FACTORS 15
+
+/* Разложение n = powers[0] * powers[1] * ..., powers[i] = primes[i]^exponents[i] */
+typedef struct ModularFactorization
+{
+    int count;                              /* число различных простых делителей */
+    ULL primes[MODULAR_MAX_FACTORS];        /* простые делители по возрастанию */
+    int exponents[MODULAR_MAX_FACTORS];     /* их кратности */
+    ULL powers[MODULAR_MAX_FACTORS];        /* primes[i]^exponents[i] */
+} ModularFactorization;
+
+/*
+ * Разложить n на простые множители: пробное деление на малые простые, затем
+ * ро-метод Полларда (вариант Брента) для оставшегося составного множителя.
+ * Разложения кэшируются по значению n (кэш общий для всех потоков).
+ * [IN] n — раскладываемое число (>= 1; у n == 1 нет делителей)
+ * [OUT] result — разложение
+ * [RETURN] MATRIX_SUCCESS или MATRIX_ERROR_NULL_POINTER
+ */
+int modular_factor(ULL n, ModularFactorization* result);
+
+#endif //LAB2_MODULAR_H
@@ -2,6 +2,8 @@
 #define LAB2_STRING_UTILS_H
 
 #include "matrix.h"
+#include "gf2.h"
+#include "bigint.h"
 
 /*
  * Преобразовать матрицу в строковый формат.
@@ -23,4 +25,39 @@ int matrix_to_string(const Matrix* matrix, char** result);
  */
 int string_to_matrix(const char* str, unsigned long long field_size, Matrix** result);
 
+/*
+ * Преобразовать строку вида "(...)" сразу в матрицу над GF(2) без промежуточной
+ * матрицы ULL: от каждого числа берётся только чётность последней цифры.
+ * [IN] str — входная строка с данными матрицы
+ * [OUT] result — указатель на созданную матрицу над GF(2)
+ * [RETURN] STRING_SUCCESS или код ошибки STRING_STATUS
+ */
+int string_to_gf2_matrix(const char* str, Gf2Matrix** result);
+
+/*
+ * Преобразовать матрицу над GF(2) в строковый формат (a11,a12;a21,a22,...).
+ * Строка выделяется через malloc, необходимо освободить через free.
+ * [IN] matrix — матрица над GF(2)
+ * [OUT] result — указатель на строку с результатом
+ * [RETURN] STRING_SUCCESS или код ошибки STRING_STATUS
+ */
+int gf2_matrix_to_string(const Gf2Matrix* matrix, char** result);
+
+/*
+ * Преобразовать матрицу больших целых в строковый формат (a11,a12;a21,a22,...).
+ * Строка выделяется через malloc, необходимо освободить через free.
+ * [IN] matrix — матрица больших целых
+ * [OUT] result — указатель на строку с результатом
+ * [RETURN] STRING_SUCCESS или код ошибки STRING_STATUS
+ */
+int big_matrix_to_string(const BigMatrix* matrix, char** result);
+
+/*
+ * Преобразовать десятичную строку (показатель степени любой длины) в BigInt.
+ * [IN] str — строка из десятичных цифр
+ * [OUT] value — инициализированное число (bigint_init)
+ * [RETURN] STRING_SUCCESS или код ошибки STRING_STATUS
+ */
+int string_to_bigint(const char* str, BigInt* value);
+
 #endif //LAB2_STRING_UTILS_H
\ No newline at end of file
@@ -0,0 +1,85 @@
+#ifndef LAB2_TEST_WRITER_H
+#define LAB2_TEST_WRITER_H
+
+#include "matrix.h"
+
+/*
+ * Асинхронная запись результатов генератора тестов (generate_test_cases).
+ *
+ * Генератор кладёт записи в кольцевую очередь с одним производителем и одним потребителем
+ * (без блокировок), а отдельный поток пишет их в stdout, output-short.txt и CSV через
+ * большие буферы stdio. Замер времени возведения поэтому никогда не включает ожидание
+ * ввода-вывода.
+ *
+ * Если задана переменная окружения TEST_DUMP_ENV, поток записи дополнительно сохраняет
+ * исходную матрицу и результат каждого теста в двоичном файле: заголовок TEST_DUMP_MAGIC,
+ * затем для каждого теста TestDumpHeader и элементы по строкам, по matrix_element_width
+ * байт на элемент (порядок байтов машины). Без переменной матрицы не копируются и никак
+ * не сериализуются.
+ */
+
+#define TEST_WRITER_QUEUE 1024                  /* записей в очереди */
+#define TEST_WRITER_BUFFER (1u << 20)           /* буфер stdio каждого файла */
+#define TEST_DUMP_ENV "MATRIX_DUMP"             /* путь к файлу двоичных дампов */
+#define TEST_DUMP_MAGIC "MPDUMP1"               /* 8 байт с завершающим нулём */
+
+/* Результат одного теста */
+typedef struct TestRecord
+{
+    int index;              /* сквозной номер теста */
+    int size;               /* размер матрицы */
+    ULL exponent;
+    ULL field_size;
+    ULL time_ns;            /* время matrix_power */
+    int error;              /* код matrix_power */
+    ULL* matrix;            /* элементы исходной матрицы для дампа (malloc) или NULL */
+    ULL* power;             /* элементы результата для дампа (malloc) или NULL */
+} TestRecord;
+
+/* Заголовок теста в файле дампов */
+typedef struct TestDumpHeader
+{
+    uint32_t index;
+    uint32_t size;
+    uint64_t exponent;
+    uint64_t field_size;
+    uint64_t time_ns;
+    int32_t error;          /* при ошибке результат не записывается */
+    uint32_t width;         /* байт на элемент */
+} TestDumpHeader;
+
+typedef struct TestWriter TestWriter;
+
+/*
+ * Открыть файлы, записать заголовки и запустить поток записи.
+ * [IN] csv_path — путь к CSV-файлу
+ * [IN] short_path — путь к краткому файлу (output-short.txt)
+ * [IN] dump_path — путь к файлу дампов (NULL — без дампов)
+ * [OUT] result — указатель на созданный объект
+ * [RETURN] TEST_SUCCESS или TEST_ERROR_FILE_WRITE
+ */
+int test_writer_open(const char* csv_path, const char* short_path, const char* dump_path, TestWriter** result);
+
+/*
+ * Проверить, пишутся ли дампы матриц (нужно ли заполнять matrix и power в записях).
+ */
+int test_writer_dumps(const TestWriter* writer);
+
+/*
+ * Поставить запись в очередь. Если очередь полна, ждёт, пока поток записи её разберёт.
+ * Владение буферами matrix и power переходит к потоку записи.
+ * [IN] writer — объект записи
+ * [IN] record — запись (копируется)
+ * [RETURN] TEST_SUCCESS или TEST_ERROR_INVALID_PARAMS
+ */
+int test_writer_push(TestWriter* writer, const TestRecord* record);
+
+/*
+ * Дописать все записи из очереди, остановить поток и закрыть файлы.
+ * Безопасно при передаче NULL.
+ * [IN] writer — объект записи
+ * [RETURN] TEST_SUCCESS или TEST_ERROR_FILE_WRITE, если какая-то запись не удалась
+ */
+int test_writer_close(TestWriter* writer);
+
+#endif //LAB2_TEST_WRITER_H
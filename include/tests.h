@@ -26,8 +26,14 @@ int generate_random_matrix(int size, ULL field_size, Matrix** result);
  *     - exponent для matrix_power выбирается случайно в диапазоне [min_exponent, max_exponent]
  *       (если хочешь фиксировать exponent == текущая степень — можно изменить).
  * - Измерение времени делается через clock_gettime(CLOCK_MONOTONIC).
- * - Формируется два файла:
+ * - Переменная окружения MATRIX_JOBS задаёт, сколько тестов считается одновременно
+ *   (задачами планировщика matrix_sched.h); строки пишутся в порядке тестов.
+ * - Вывод пишет отдельный поток (test_writer.h); с переменной MATRIX_DUMP=<путь> он
+ *   также сохраняет исходные матрицы и результаты в двоичном файле.
+ * - Формируется три файла:
  *     output-short.txt   (matrix_size exponent field_size computation_time_ns)
+ *     output-latency.txt (процентили времени по ключам: класс n, биты показателя, класс поля;
+ *                         гистограммы latency_hist.h, память не растёт с числом тестов)
  *     filename (CSV)     (matrix_size,exponent,field_size,matrix_data,result_data,computation_time_ns)
 
  * [IN] filename — имя выходного CSV-файла
@@ -63,4 +69,19 @@ int input_test(void);
  */
 int manual_test(void);
 
+/*
+ * Замер пропускной способности транспонирования на матрицах 256..4096:
+ * memcpy того же объёма, наивный обход, кэш-независимое ядро matrix_transpose и
+ * matrix_transpose_in_place.
+ * [RETURN] UI_SUCCESS или код ошибки UI_STATUS
+ */
+int transpose_benchmark(void);
+
+/*
+ * Автонастройка умножения (matrix_tune_run): замеры вариантов на сетке классов поля и
+ * размера, запись профиля MATRIX_TUNE_FILE (или из MATRIX_TUNE_ENV) и его загрузка.
+ * [RETURN] UI_SUCCESS или код ошибки UI_STATUS
+ */
+int tune_multiply(void);
+
 #endif //LAB2_TESTS_H
\ No newline at end of file
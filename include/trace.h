@@ -0,0 +1,83 @@
+#ifndef LAB2_TRACE_H
+#define LAB2_TRACE_H
+
+#include "common.h"
+
+#include <stdatomic.h>
+
+/*
+ * Трассировка фаз вычислений в формате Chrome trace JSON (открывается в Perfetto).
+ *
+ * Включается переменной окружения MATRIX_TRACE=<путь к файлу>. Каждый поток
+ * пишет события в собственный кольцевой буфер (без блокировок), при завершении
+ * программы все буферы сбрасываются в файл. Размер буфера (число событий на поток)
+ * задаётся переменной MATRIX_TRACE_CAPACITY (по умолчанию 65536).
+ * При выключенной трассировке каждая точка стоит одно чтение глобального флага
+ * (атомарное, relaxed — на x86 и ARM это обычная загрузка).
+ *
+ * Имена событий должны быть строковыми литералами (хранится только указатель).
+ */
+
+/* Состояние трассировки: -1 — ещё не инициализирована, 0 — выключена, 1 — включена */
+extern atomic_int trace_state;
+
+static inline int trace_state_relaxed(void)
+{
+    return atomic_load_explicit(&trace_state, memory_order_relaxed);
+}
+
+/*
+ * Инициализировать трассировку по переменным окружения.
+ * Вызывается автоматически при первом событии; повторный вызов ничего не делает.
+ * [RETURN] 1, если трассировка включена, иначе 0
+ */
+int trace_init(void);
+
+/*
+ * Начать интервал name в текущем потоке.
+ * [IN] name — имя интервала (строковый литерал)
+ */
+void trace_begin(const char* name);
+
+/*
+ * Завершить последний открытый интервал текущего потока.
+ * Записывает в кольцевой буфер потока одно событие с началом и длительностью.
+ */
+void trace_end(void);
+
+/*
+ * Назвать текущий поток в трассе (например, "worker-3").
+ * [IN] name — имя потока (строковый литерал)
+ */
+void trace_thread_name(const char* name);
+
+/*
+ * Записать все накопленные события в файл в формате Chrome trace JSON.
+ * Вызывается автоматически при выходе из программы, если трассировка включена.
+ * Перед записью трассировка выключается и дамп ждёт, пока потоки допишут начатые
+ * события, так что события не рвутся; интервалы, закрытые после дампа, не попадают в файл.
+ * [IN] path — путь к выходному файлу (NULL — путь из MATRIX_TRACE)
+ * [RETURN] SUCCESS или ERROR_FILE_OPERATION
+ */
+int trace_dump(const char* path);
+
+#define TRACE_ACTIVE() (__builtin_expect(trace_state_relaxed() != 0, 0))
+
+#define TRACE_BEGIN(name) do { if (TRACE_ACTIVE()) trace_begin(name); } while (0)
+#define TRACE_END() do { if (TRACE_ACTIVE()) trace_end(); } while (0)
+
+/*
+ * TRACE_SCOPE(name) — интервал до конца текущего блока (закрывается на любом return).
+ */
+static inline void trace_scope_cleanup(int* opened)
+{
+    if (*opened) trace_end();
+}
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_SCOPE(name) \
+    int TRACE_CONCAT(trace_scope_, __LINE__) __attribute__((cleanup(trace_scope_cleanup))) = \
+        (TRACE_ACTIVE() ? (trace_begin(name), trace_state_relaxed() > 0) : 0)
+
+#endif //LAB2_TRACE_H
@@ -0,0 +1,511 @@
+#include "../include/bigint.h"
+
+#define BIGINT_DECIMAL_BASE 1000000000u     /* 10^9 — девять цифр на шаг деления */
+
+void bigint_init(BigInt* value)
+{
+    value->limbs = NULL;
+    value->size = 0;
+    value->capacity = 0;
+}
+
+void bigint_free(BigInt* value)
+{
+    if (!value)
+    {
+        return;
+    }
+
+    free(value->limbs);
+    bigint_init(value);
+}
+
+static int bigint_reserve(BigInt* value, int capacity)
+{
+    if (capacity <= value->capacity)
+    {
+        return MATRIX_SUCCESS;
+    }
+
+    int new_capacity = value->capacity ? value->capacity : 4;
+    while (new_capacity < capacity)
+    {
+        new_capacity *= 2;
+    }
+
+    uint32_t* limbs = (uint32_t*)realloc(value->limbs, (size_t)new_capacity * sizeof(uint32_t));
+    if (!limbs)
+    {
+        return MATRIX_ERROR_CREATION;
+    }
+    value->limbs = limbs;
+    value->capacity = new_capacity;
+    return MATRIX_SUCCESS;
+}
+
+int bigint_set_ull(BigInt* value, unsigned long long x)
+{
+    int error = bigint_reserve(value, 2);
+    if (error != MATRIX_SUCCESS) return error;
+
+    value->limbs[0] = (uint32_t)x;
+    value->limbs[1] = (uint32_t)(x >> 32);
+    value->size = value->limbs[1] ? 2 : (value->limbs[0] ? 1 : 0);
+    return MATRIX_SUCCESS;
+}
+
+int bigint_mul_add_small(BigInt* value, uint32_t multiplier, uint32_t addend)
+{
+    uint64_t carry = addend;
+    for (int i = 0; i < value->size; i++)
+    {
+        carry += (uint64_t)value->limbs[i] * multiplier;
+        value->limbs[i] = (uint32_t)carry;
+        carry >>= 32;
+    }
+
+    if (carry != 0)
+    {
+        int error = bigint_reserve(value, value->size + 1);
+        if (error != MATRIX_SUCCESS) return error;
+        value->limbs[value->size++] = (uint32_t)carry;
+    }
+    return MATRIX_SUCCESS;
+}
+
+static void bigint_normalize(BigInt* value)
+{
+    while (value->size > 0 && value->limbs[value->size - 1] == 0)
+    {
+        value->size--;
+    }
+}
+
+int bigint_copy(BigInt* dst, const BigInt* src)
+{
+    if (dst == src)
+    {
+        return MATRIX_SUCCESS;
+    }
+
+    int error = bigint_reserve(dst, src->size);
+    if (error != MATRIX_SUCCESS) return error;
+
+    if (src->size > 0) memcpy(dst->limbs, src->limbs, (size_t)src->size * sizeof(uint32_t));
+    dst->size = src->size;
+    return MATRIX_SUCCESS;
+}
+
+int bigint_from_decimal(BigInt* value, const char* str)
+{
+    while (*str == ' ' || *str == '\t')
+    {
+        str++;
+    }
+    if (*str < '0' || *str > '9')
+    {
+        return MATRIX_ERROR_INVALID_NUMBER;
+    }
+
+    int error = bigint_set_ull(value, 0);
+    while (error == MATRIX_SUCCESS && *str >= '0' && *str <= '9')
+    {
+        /* По девять цифр за шаг: value = value * 10^k + группа */
+        uint32_t group = 0, scale = 1;
+        for (int k = 0; k < 9 && *str >= '0' && *str <= '9'; k++, str++)
+        {
+            group = group * 10 + (uint32_t)(*str - '0');
+            scale *= 10;
+        }
+        error = bigint_mul_add_small(value, scale, group);
+    }
+    while (*str == ' ' || *str == '\t' || *str == '\r' || *str == '\n')
+    {
+        str++;
+    }
+    if (error == MATRIX_SUCCESS && *str != '\0')
+    {
+        error = MATRIX_ERROR_INVALID_NUMBER;
+    }
+    return error;
+}
+
+int bigint_to_ull(const BigInt* value, unsigned long long* x)
+{
+    if (value->size > 2)
+    {
+        return 0;
+    }
+
+    *x = 0;
+    if (value->size > 0) *x = value->limbs[0];
+    if (value->size > 1) *x |= (unsigned long long)value->limbs[1] << 32;
+    return 1;
+}
+
+int bigint_compare(const BigInt* a, const BigInt* b)
+{
+    if (a->size != b->size)
+    {
+        return (a->size < b->size) ? -1 : 1;
+    }
+    for (int i = a->size - 1; i >= 0; i--)
+    {
+        if (a->limbs[i] != b->limbs[i])
+        {
+            return (a->limbs[i] < b->limbs[i]) ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+int bigint_bit_length(const BigInt* value)
+{
+    if (value->size == 0)
+    {
+        return 0;
+    }
+    return (value->size - 1) * 32 + (32 - __builtin_clz(value->limbs[value->size - 1]));
+}
+
+int bigint_add(const BigInt* a, const BigInt* b, BigInt* result)
+{
+    if (a->size < b->size)
+    {
+        const BigInt* t = a;
+        a = b;
+        b = t;
+    }
+
+    int a_size = a->size, b_size = b->size;
+    int error = bigint_reserve(result, a_size + 1);
+    if (error != MATRIX_SUCCESS) return error;
+
+    /* После reserve указатели на разряды a и b могли измениться, если result совпадает с ними */
+    const uint32_t* x = a->limbs;
+    const uint32_t* y = b->limbs;
+    uint64_t carry = 0;
+    for (int i = 0; i < a_size; i++)
+    {
+        carry += (uint64_t)x[i] + (i < b_size ? y[i] : 0);
+        result->limbs[i] = (uint32_t)carry;
+        carry >>= 32;
+    }
+    result->limbs[a_size] = (uint32_t)carry;
+    result->size = a_size + 1;
+    bigint_normalize(result);
+    return MATRIX_SUCCESS;
+}
+
+int bigint_sub(const BigInt* a, const BigInt* b, BigInt* result)
+{
+    if (bigint_compare(a, b) < 0)
+    {
+        return MATRIX_ERROR_INVALID_NUMBER;
+    }
+
+    int a_size = a->size, b_size = b->size;
+    int error = bigint_reserve(result, a_size);
+    if (error != MATRIX_SUCCESS) return error;
+
+    const uint32_t* x = a->limbs;
+    const uint32_t* y = b->limbs;
+    int64_t borrow = 0;
+    for (int i = 0; i < a_size; i++)
+    {
+        int64_t diff = (int64_t)x[i] - (i < b_size ? (int64_t)y[i] : 0) - borrow;
+        borrow = diff < 0;
+        result->limbs[i] = (uint32_t)(diff + (borrow ? ((int64_t)1 << 32) : 0));
+    }
+    result->size = a_size;
+    bigint_normalize(result);
+    return MATRIX_SUCCESS;
+}
+
+int bigint_mul(const BigInt* a, const BigInt* b, BigInt* result)
+{
+    if (a->size == 0 || b->size == 0)
+    {
+        return bigint_set_ull(result, 0);
+    }
+
+    int size = a->size + b->size;
+    uint32_t* limbs = (uint32_t*)calloc((size_t)size, sizeof(uint32_t));
+    if (!limbs)
+    {
+        return MATRIX_ERROR_CREATION;
+    }
+
+    for (int i = 0; i < a->size; i++)
+    {
+        uint64_t carry = 0;
+        uint64_t x = a->limbs[i];
+        for (int j = 0; j < b->size; j++)
+        {
+            carry += x * b->limbs[j] + limbs[i + j];
+            limbs[i + j] = (uint32_t)carry;
+            carry >>= 32;
+        }
+        limbs[i + b->size] = (uint32_t)carry;
+    }
+
+    free(result->limbs);
+    result->limbs = limbs;
+    result->capacity = size;
+    result->size = size;
+    bigint_normalize(result);
+    return MATRIX_SUCCESS;
+}
+
+int bigint_divmod(const BigInt* a, const BigInt* b, BigInt* quotient, BigInt* remainder)
+{
+    if (b->size == 0)
+    {
+        return MATRIX_ERROR_INVALID_NUMBER;
+    }
+
+    int n = b->size, m = a->size - b->size;
+    uint32_t* q = (uint32_t*)calloc((size_t)(m > 0 ? m + 1 : 1), sizeof(uint32_t));
+    uint32_t* u = (uint32_t*)calloc((size_t)a->size + 1, sizeof(uint32_t));
+    uint32_t* v = (uint32_t*)calloc((size_t)n, sizeof(uint32_t));
+    if (!q || !u || !v)
+    {
+        free(q);
+        free(u);
+        free(v);
+        return MATRIX_ERROR_CREATION;
+    }
+
+    if (m < 0)
+    {
+        /* a < b: частное 0, остаток a */
+        if (a->size > 0) memcpy(u, a->limbs, (size_t)a->size * sizeof(uint32_t));
+        m = -1;
+    }
+    else
+    {
+        /* Нормализация: старший разряд делителя с единичным старшим битом */
+        int shift = __builtin_clz(b->limbs[n - 1]);
+        for (int i = n - 1; i > 0; i--)
+        {
+            v[i] = (b->limbs[i] << shift) | (shift ? (uint32_t)((uint64_t)b->limbs[i - 1] >> (32 - shift)) : 0);
+        }
+        v[0] = b->limbs[0] << shift;
+        u[a->size] = shift ? (uint32_t)((uint64_t)a->limbs[a->size - 1] >> (32 - shift)) : 0;
+        for (int i = a->size - 1; i > 0; i--)
+        {
+            u[i] = (a->limbs[i] << shift) | (shift ? (uint32_t)((uint64_t)a->limbs[i - 1] >> (32 - shift)) : 0);
+        }
+        u[0] = a->limbs[0] << shift;
+
+        for (int j = m; j >= 0; j--)
+        {
+            /* Оценка очередной цифры частного по двум старшим разрядам */
+            uint64_t numerator = ((uint64_t)u[j + n] << 32) | u[j + n - 1];
+            uint64_t qhat = numerator / v[n - 1];
+            uint64_t rhat = numerator % v[n - 1];
+            while (qhat > UINT32_MAX ||
+                   (n > 1 && qhat * v[n - 2] > ((rhat << 32) | u[j + n - 2])))
+            {
+                qhat--;
+                rhat += v[n - 1];
+                if (rhat > UINT32_MAX) break;
+            }
+
+            /* u[j..j+n] -= qhat * v */
+            int64_t borrow = 0;
+            uint64_t carry = 0;
+            for (int i = 0; i < n; i++)
+            {
+                uint64_t product = qhat * v[i] + carry;
+                carry = product >> 32;
+                int64_t diff = (int64_t)u[i + j] - borrow - (int64_t)(product & UINT32_MAX);
+                u[i + j] = (uint32_t)diff;
+                borrow = diff < 0;
+            }
+            int64_t diff = (int64_t)u[j + n] - borrow - (int64_t)carry;
+            u[j + n] = (uint32_t)diff;
+
+            /* Оценка оказалась на единицу больше — вернуть делитель */
+            if (diff < 0)
+            {
+                qhat--;
+                uint64_t sum = 0;
+                for (int i = 0; i < n; i++)
+                {
+                    sum += (uint64_t)u[i + j] + v[i];
+                    u[i + j] = (uint32_t)sum;
+                    sum >>= 32;
+                }
+                u[j + n] += (uint32_t)sum;
+            }
+            q[j] = (uint32_t)qhat;
+        }
+
+        /* Денормализация остатка */
+        for (int i = 0; i < n; i++)
+        {
+            u[i] = (u[i] >> shift) | (shift ? (uint32_t)((uint64_t)u[i + 1] << (32 - shift)) : 0);
+        }
+        memset(u + n, 0, (size_t)(a->size + 1 - n) * sizeof(uint32_t));
+    }
+
+    int a_size = a->size;
+    int error = MATRIX_SUCCESS;
+    if (remainder)
+    {
+        error = bigint_reserve(remainder, a_size + 1);
+        if (error == MATRIX_SUCCESS)
+        {
+            memcpy(remainder->limbs, u, (size_t)(a_size + 1) * sizeof(uint32_t));
+            remainder->size = a_size + 1;
+            bigint_normalize(remainder);
+        }
+    }
+    if (quotient && error == MATRIX_SUCCESS)
+    {
+        error = bigint_reserve(quotient, m + 1 > 0 ? m + 1 : 1);
+        if (error == MATRIX_SUCCESS)
+        {
+            memcpy(quotient->limbs, q, (size_t)(m + 1 > 0 ? m + 1 : 0) * sizeof(uint32_t));
+            quotient->size = m + 1 > 0 ? m + 1 : 0;
+            bigint_normalize(quotient);
+        }
+    }
+
+    free(q);
+    free(u);
+    free(v);
+    return error;
+}
+
+int bigint_gcd(const BigInt* a, const BigInt* b, BigInt* result)
+{
+    BigInt x, y;
+    bigint_init(&x);
+    bigint_init(&y);
+
+    int error = bigint_copy(&x, a);
+    if (error == MATRIX_SUCCESS) error = bigint_copy(&y, b);
+    while (error == MATRIX_SUCCESS && y.size > 0)
+    {
+        error = bigint_divmod(&x, &y, NULL, &x);
+        BigInt t = x;
+        x = y;
+        y = t;
+    }
+    if (error == MATRIX_SUCCESS) error = bigint_copy(result, &x);
+
+    bigint_free(&x);
+    bigint_free(&y);
+    return error;
+}
+
+size_t bigint_decimal_length(const BigInt* value)
+{
+    if (value->size == 0)
+    {
+        return 1;
+    }
+
+    /* Оценка сверху: 32 * log10(2) < 9.64 цифры на разряд */
+    return (size_t)value->size * 10 + 1;
+}
+
+size_t bigint_write_decimal(const BigInt* value, char* buffer)
+{
+    if (value->size == 0)
+    {
+        buffer[0] = '0';
+        return 1;
+    }
+
+    /* Копия делится на 10^9, остатки — группы по девять цифр от младших к старшим */
+    uint32_t* work = (uint32_t*)malloc((size_t)value->size * sizeof(uint32_t));
+    uint32_t* groups = (uint32_t*)malloc(((size_t)value->size * 10 / 9 + 2) * sizeof(uint32_t));
+    if (!work || !groups)
+    {
+        free(work);
+        free(groups);
+        return 0;
+    }
+    memcpy(work, value->limbs, (size_t)value->size * sizeof(uint32_t));
+
+    int size = value->size;
+    size_t group_count = 0;
+    do
+    {
+        uint64_t remainder = 0;
+        for (int i = size - 1; i >= 0; i--)
+        {
+            uint64_t current = (remainder << 32) | work[i];
+            work[i] = (uint32_t)(current / BIGINT_DECIMAL_BASE);
+            remainder = current % BIGINT_DECIMAL_BASE;
+        }
+        groups[group_count++] = (uint32_t)remainder;
+        while (size > 0 && work[size - 1] == 0)
+        {
+            size--;
+        }
+    } while (size > 0);
+
+    size_t pos = (size_t)sprintf(buffer, "%u", groups[group_count - 1]);
+    for (size_t g = group_count - 1; g-- > 0;)
+    {
+        pos += (size_t)sprintf(buffer + pos, "%09u", groups[g]);
+    }
+
+    free(work);
+    free(groups);
+    return pos;
+}
+
+int big_matrix_create(int rows, int cols, BigMatrix** result)
+{
+    if (!result)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+    if (rows < 1 || cols < 1)
+    {
+        return MATRIX_ERROR_INVALID_SIZE;
+    }
+
+    BigMatrix* matrix = (BigMatrix*)malloc(sizeof(BigMatrix));
+    if (!matrix)
+    {
+        return MATRIX_ERROR_CREATION;
+    }
+
+    matrix->data = (BigInt*)malloc((size_t)rows * cols * sizeof(BigInt));
+    if (!matrix->data)
+    {
+        free(matrix);
+        return MATRIX_ERROR_CREATION;
+    }
+    for (size_t i = 0; i < (size_t)rows * cols; i++)
+    {
+        bigint_init(&matrix->data[i]);
+    }
+    matrix->rows = rows;
+    matrix->cols = cols;
+
+    *result = matrix;
+    return MATRIX_SUCCESS;
+}
+
+int big_matrix_free(BigMatrix* matrix)
+{
+    if (!matrix)
+    {
+        return MATRIX_SUCCESS;
+    }
+
+    for (size_t i = 0; i < (size_t)matrix->rows * matrix->cols; i++)
+    {
+        bigint_free(&matrix->data[i]);
+    }
+    free(matrix->data);
+    free(matrix);
+    return MATRIX_SUCCESS;
+}
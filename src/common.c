@@ -9,7 +9,13 @@ const char* get_matrix_error_message(int error)
         "\nEN: Matrix is not square \nRU: Матрица не является квадратной\n",
         "\nEN: Memory allocation failed \nRU: Ошибка выделения памяти\n",
         "\nEN: Null pointer passed to function \nRU: Передан NULL указатель\n",
-        "\nEN: Field/modulus mismatch or invalid \nRU: Несовпадение поля/модуля или недопустимое значение\n"
+        "\nEN: Field/modulus mismatch or invalid \nRU: Несовпадение поля/модуля или недопустимое значение\n",
+        "\nEN: Invalid number \nRU: Недопустимое число\n",
+        "\nEN: Result is too large \nRU: Результат слишком велик\n",
+        "\nEN: Matrix is singular \nRU: Матрица вырождена\n",
+        "\nEN: Product verification failed \nRU: Проверка произведения не пройдена\n",
+        "\nEN: Matrix file read/write failed \nRU: Ошибка чтения или записи файла матрицы\n",
+        "\nEN: Memory budget is too small \nRU: Бюджет памяти слишком мал\n"
     };
     return ( (error >= 0) && (error < sizeof(messages)/sizeof(messages[0])) ) ? messages[error] : "EN: Unknown matrix error \nRU: Неизвестная ошибка матрицы";
 }
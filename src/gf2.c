@@ -0,0 +1,313 @@
+#include "../include/gf2.h"
+#include "../include/trace.h"
+#include "../include/matrix_verify.h"
+
+#define GF2_TABLE_BITS 8                                 /* строк b на одну таблицу Грея */
+#define GF2_TABLES (64 / GF2_TABLE_BITS)                 /* таблиц на одно слово строки a */
+#define GF2_BLOCK_WORDS 16                               /* ширина блока столбцов c в словах */
+#define GF2_POPCOUNT_LIMIT 128                           /* до этого размера — AND + popcount */
+
+int gf2_matrix_create(int rows, int cols, Gf2Matrix** result)
+{
+    if (!result)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+    if (rows < 1 || cols < 1)
+    {
+        return MATRIX_ERROR_INVALID_SIZE;
+    }
+
+    Gf2Matrix* matrix = (Gf2Matrix*)malloc(sizeof(Gf2Matrix));
+    if (!matrix)
+    {
+        return MATRIX_ERROR_CREATION;
+    }
+
+    matrix->rows = rows;
+    matrix->cols = cols;
+    matrix->words_per_row = (cols + 63) / 64;
+
+    size_t bytes = (size_t)rows * matrix->words_per_row * sizeof(ULL);
+    matrix->words = (ULL*)aligned_alloc(64, (bytes + 63) & ~(size_t)63);
+    if (!matrix->words)
+    {
+        free(matrix);
+        return MATRIX_ERROR_CREATION;
+    }
+    memset(matrix->words, 0, bytes);
+
+    *result = matrix;
+    return MATRIX_SUCCESS;
+}
+
+int gf2_matrix_free(Gf2Matrix* matrix)
+{
+    if (!matrix)
+    {
+        return MATRIX_SUCCESS;
+    }
+
+    free(matrix->words);
+    free(matrix);
+    return MATRIX_SUCCESS;
+}
+
+int gf2_matrix_from_matrix(const Matrix* src, Gf2Matrix** result)
+{
+    if (!src || !result)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+
+    Gf2Matrix* matrix;
+    int error = gf2_matrix_create(src->rows, src->cols, &matrix);
+    if (error != MATRIX_SUCCESS) return error;
+
+    for (int i = 0; i < src->rows; i++)
+    {
+        const ULL* row = src->data[i];
+        ULL* words = matrix->words + (size_t)i * matrix->words_per_row;
+        for (int w = 0; w < matrix->words_per_row; w++)
+        {
+            int end = (w + 1) * 64 < src->cols ? 64 : src->cols - w * 64;
+            ULL word = 0;
+            for (int bit = 0; bit < end; bit++)
+            {
+                word |= (row[w * 64 + bit] & 1ULL) << bit;
+            }
+            words[w] = word;
+        }
+    }
+
+    *result = matrix;
+    return MATRIX_SUCCESS;
+}
+
+int gf2_matrix_to_matrix(const Gf2Matrix* src, Matrix** result)
+{
+    if (!src || !result)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+
+    Matrix* matrix;
+    int error = matrix_create_uninit(src->rows, src->cols, 2, &matrix);
+    if (error != MATRIX_SUCCESS) return error;
+
+    for (int i = 0; i < src->rows; i++)
+    {
+        const ULL* words = src->words + (size_t)i * src->words_per_row;
+        ULL* row = matrix->data[i];
+        for (int j = 0; j < src->cols; j++)
+        {
+            row[j] = (words[j >> 6] >> (j & 63)) & 1ULL;
+        }
+    }
+
+    *result = matrix;
+    return MATRIX_SUCCESS;
+}
+
+/* Малые матрицы: c[i][j] = чётность popcount(a_i AND столбец_j(b)) */
+static int gf2_multiply_popcount(const Gf2Matrix* a, const Gf2Matrix* b, Gf2Matrix* c)
+{
+    Gf2Matrix* bt;
+    int error = gf2_matrix_create(b->cols, b->rows, &bt);
+    if (error != MATRIX_SUCCESS) return error;
+
+    for (int k = 0; k < b->rows; k++)
+    {
+        for (int j = 0; j < b->cols; j++)
+        {
+            if (gf2_matrix_get(b, k, j))
+            {
+                bt->words[(size_t)j * bt->words_per_row + (k >> 6)] |= 1ULL << (k & 63);
+            }
+        }
+    }
+
+    memset(c->words, 0, (size_t)c->rows * c->words_per_row * sizeof(ULL));
+    for (int i = 0; i < a->rows; i++)
+    {
+        const ULL* a_row = a->words + (size_t)i * a->words_per_row;
+        ULL* c_row = c->words + (size_t)i * c->words_per_row;
+        for (int j = 0; j < b->cols; j++)
+        {
+            const ULL* bt_row = bt->words + (size_t)j * bt->words_per_row;
+            ULL parity = 0;
+            for (int w = 0; w < a->words_per_row; w++)
+            {
+                parity ^= a_row[w] & bt_row[w];
+            }
+            c_row[j >> 6] |= (ULL)(__builtin_popcountll(parity) & 1) << (j & 63);
+        }
+    }
+
+    gf2_matrix_free(bt);
+    return MATRIX_SUCCESS;
+}
+
+/*
+ * Метод четырёх русских. Для каждых 8 строк b строится таблица всех 256 их
+ * XOR-комбинаций (в порядке кода Грея — одно XOR строки на элемент), после чего
+ * байт строки a выбирает готовую комбинацию. Столбцы c обрабатываются блоками по
+ * GF2_BLOCK_WORDS слов, чтобы таблицы и строки c оставались в кэше.
+ */
+static int gf2_multiply_m4rm(const Gf2Matrix* a, const Gf2Matrix* b, Gf2Matrix* c)
+{
+    const size_t entry_words = GF2_BLOCK_WORDS;
+    ULL* tables = (ULL*)aligned_alloc(64, GF2_TABLES * 256 * entry_words * sizeof(ULL));
+    if (!tables)
+    {
+        return MATRIX_ERROR_CREATION;
+    }
+
+    memset(c->words, 0, (size_t)c->rows * c->words_per_row * sizeof(ULL));
+
+    for (int w0 = 0; w0 < b->words_per_row; w0 += GF2_BLOCK_WORDS)
+    {
+        int width = (b->words_per_row - w0 < GF2_BLOCK_WORDS) ? b->words_per_row - w0 : GF2_BLOCK_WORDS;
+
+        for (int g = 0; g < a->words_per_row; g++)
+        {
+            int used_tables = 0;
+            for (int t = 0; t < GF2_TABLES; t++)
+            {
+                int first_row = g * 64 + t * GF2_TABLE_BITS;
+                if (first_row >= b->rows) break;
+                int bits = (b->rows - first_row < GF2_TABLE_BITS) ? b->rows - first_row : GF2_TABLE_BITS;
+
+                ULL* table = tables + (size_t)t * 256 * entry_words;
+                memset(table, 0, (size_t)width * sizeof(ULL));
+                int previous = 0;
+                for (int index = 1; index < (1 << bits); index++)
+                {
+                    int gray = index ^ (index >> 1);
+                    int row = first_row + __builtin_ctz(index);
+                    const ULL* b_row = b->words + (size_t)row * b->words_per_row + w0;
+                    const ULL* from = table + (size_t)previous * entry_words;
+                    ULL* to = table + (size_t)gray * entry_words;
+                    for (int w = 0; w < width; w++)
+                    {
+                        to[w] = from[w] ^ b_row[w];
+                    }
+                    previous = gray;
+                }
+                used_tables++;
+            }
+
+            for (int i = 0; i < a->rows; i++)
+            {
+                ULL word = a->words[(size_t)i * a->words_per_row + g];
+                if (word == 0) continue;
+
+                ULL* c_row = c->words + (size_t)i * c->words_per_row + w0;
+                for (int t = 0; t < used_tables; t++)
+                {
+                    unsigned index = (unsigned)(word >> (t * GF2_TABLE_BITS)) & 0xFFu;
+                    if (index == 0) continue;
+
+                    const ULL* entry = tables + ((size_t)t * 256 + index) * entry_words;
+                    for (int w = 0; w < width; w++)
+                    {
+                        c_row[w] ^= entry[w];
+                    }
+                }
+            }
+        }
+    }
+
+    free(tables);
+    return MATRIX_SUCCESS;
+}
+
+int gf2_matrix_multiply(const Gf2Matrix* a, const Gf2Matrix* b, Gf2Matrix* c)
+{
+    if (!a || !b || !c)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+    if (a->cols != b->rows || c->rows != a->rows || c->cols != b->cols)
+    {
+        return MATRIX_ERROR_DIMENSION;
+    }
+
+    int error = (a->rows < GF2_POPCOUNT_LIMIT && b->cols < GF2_POPCOUNT_LIMIT)
+                    ? gf2_multiply_popcount(a, b, c)
+                    : gf2_multiply_m4rm(a, b, c);
+
+    MatrixVerifier* verifier = matrix_verifier_current();
+    if (error == MATRIX_SUCCESS && verifier) error = matrix_verify_gf2(verifier, a, b, c);
+    return error;
+}
+
+int gf2_matrix_power(const Gf2Matrix* base, ULL exponent, Gf2Matrix** result)
+{
+    if (!base || !result)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+    if (base->rows != base->cols)
+    {
+        return MATRIX_ERROR_NOT_SQUARE;
+    }
+
+    int n = base->rows;
+    size_t bytes = (size_t)n * base->words_per_row * sizeof(ULL);
+    Gf2Matrix* result_matrix = NULL;
+    Gf2Matrix* power = NULL;
+    Gf2Matrix* temp = NULL;
+
+    TRACE_BEGIN("setup");
+    int error = gf2_matrix_create(n, n, &result_matrix);
+    if (error == MATRIX_SUCCESS) error = gf2_matrix_create(n, n, &power);
+    if (error == MATRIX_SUCCESS) error = gf2_matrix_create(n, n, &temp);
+    if (error == MATRIX_SUCCESS)
+    {
+        for (int i = 0; i < n; i++)
+        {
+            result_matrix->words[(size_t)i * result_matrix->words_per_row + (i >> 6)] = 1ULL << (i & 63);
+        }
+        memcpy(power->words, base->words, bytes);
+    }
+    TRACE_END();
+
+    ULL exp = exponent;
+    while (error == MATRIX_SUCCESS && exp > 0)
+    {
+        if (exp & 1)
+        {
+            TRACE_BEGIN("accumulate");
+            error = gf2_matrix_multiply(result_matrix, power, temp);
+            TRACE_END();
+
+            Gf2Matrix* swap = result_matrix;
+            result_matrix = temp;
+            temp = swap;
+        }
+
+        exp >>= 1;
+        if (error == MATRIX_SUCCESS && exp > 0)
+        {
+            TRACE_BEGIN("square");
+            error = gf2_matrix_multiply(power, power, temp);
+            TRACE_END();
+
+            Gf2Matrix* swap = power;
+            power = temp;
+            temp = swap;
+        }
+    }
+
+    gf2_matrix_free(power);
+    gf2_matrix_free(temp);
+    if (error != MATRIX_SUCCESS)
+    {
+        gf2_matrix_free(result_matrix);
+        return error;
+    }
+
+    *result = result_matrix;
+    return MATRIX_SUCCESS;
+}
@@ -0,0 +1,334 @@
+#include "../include/latency_hist.h"
+#include "../include/matrix_tune.h"
+
+#include <limits.h>
+#include <sched.h>
+
+#define LATENCY_SUB_COUNT (1 << LATENCY_SUB_BITS)
+
+/* Ячейка таблицы ключей: ключ 0 — свободна; гистограмма появляется чуть позже ключа */
+typedef struct LatencySlot
+{
+    atomic_uint key;
+    _Atomic(LatencyHistogram*) histogram;
+} LatencySlot;
+
+struct LatencyRecorder
+{
+    LatencySlot slots[LATENCY_MAX_KEYS];
+    LatencyHistogram other;                 /* таблица заполнена или не хватило памяти */
+};
+
+static const char* const latency_field_names[TUNE_FIELD_CLASSES] =
+{
+    "0", "<=2^8", "<=2^16", "<2^26", "<=2^32", "<=2^62", ">2^62"
+};
+
+/* ---------- Шкала ---------- */
+
+static int latency_bucket(ULL value)
+{
+    if (value < LATENCY_SUB_COUNT)
+    {
+        return (int)value;
+    }
+    int shift = 63 - __builtin_clzll(value) - LATENCY_SUB_BITS;
+    if (shift > LATENCY_MAX_BITS - 1 - LATENCY_SUB_BITS)
+    {
+        return LATENCY_BUCKETS - 1;
+    }
+    return ((shift + 1) << LATENCY_SUB_BITS) + (int)(value >> shift) - LATENCY_SUB_COUNT;
+}
+
+/* Наибольшее значение, попадающее в корзину */
+static ULL latency_bucket_upper(int bucket)
+{
+    if (bucket < LATENCY_SUB_COUNT)
+    {
+        return (ULL)bucket;
+    }
+    int shift = (bucket >> LATENCY_SUB_BITS) - 1;
+    ULL lower = (ULL)((bucket & (LATENCY_SUB_COUNT - 1)) + LATENCY_SUB_COUNT) << shift;
+    return lower + (1ULL << shift) - 1;
+}
+
+static void latency_histogram_init(LatencyHistogram* histogram)
+{
+    memset(histogram, 0, sizeof(*histogram));
+    atomic_init(&histogram->min, ULLONG_MAX);
+}
+
+static void latency_store_min(atomic_ullong* target, ULL value)
+{
+    ULL seen = atomic_load_explicit(target, memory_order_relaxed);
+    while (value < seen && !atomic_compare_exchange_weak_explicit(target, &seen, value, memory_order_relaxed,
+                                                                  memory_order_relaxed))
+    {
+    }
+}
+
+static void latency_store_max(atomic_ullong* target, ULL value)
+{
+    ULL seen = atomic_load_explicit(target, memory_order_relaxed);
+    while (value > seen && !atomic_compare_exchange_weak_explicit(target, &seen, value, memory_order_relaxed,
+                                                                  memory_order_relaxed))
+    {
+    }
+}
+
+static void latency_histogram_record(LatencyHistogram* histogram, ULL value)
+{
+    atomic_fetch_add_explicit(&histogram->counts[latency_bucket(value)], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&histogram->sum, value, memory_order_relaxed);
+    latency_store_min(&histogram->min, value);
+    latency_store_max(&histogram->max, value);
+    atomic_fetch_add_explicit(&histogram->total, 1, memory_order_release);
+}
+
+void latency_histogram_merge(LatencyHistogram* dst, const LatencyHistogram* src)
+{
+    if (!dst || !src) return;
+
+    ULL total = atomic_load_explicit(&src->total, memory_order_acquire);
+    if (total == 0) return;
+
+    /* Итог считается по самим корзинам: параллельная запись в src не нарушит сумму */
+    ULL merged = 0;
+    for (int i = 0; i < LATENCY_BUCKETS; i++)
+    {
+        ULL count = atomic_load_explicit(&src->counts[i], memory_order_relaxed);
+        if (count == 0) continue;
+        atomic_fetch_add_explicit(&dst->counts[i], count, memory_order_relaxed);
+        merged += count;
+    }
+    atomic_fetch_add_explicit(&dst->sum, atomic_load_explicit(&src->sum, memory_order_relaxed),
+                              memory_order_relaxed);
+    latency_store_min(&dst->min, atomic_load_explicit(&src->min, memory_order_relaxed));
+    latency_store_max(&dst->max, atomic_load_explicit(&src->max, memory_order_relaxed));
+    atomic_fetch_add_explicit(&dst->total, merged, memory_order_release);
+}
+
+ULL latency_histogram_percentile(const LatencyHistogram* histogram, double percentile)
+{
+    if (!histogram) return 0;
+
+    ULL total = 0;
+    for (int i = 0; i < LATENCY_BUCKETS; i++)
+    {
+        total += atomic_load_explicit(&histogram->counts[i], memory_order_relaxed);
+    }
+    if (total == 0) return 0;
+
+    if (percentile < 0) percentile = 0;
+    if (percentile > 100) percentile = 100;
+    ULL rank = (ULL)(percentile / 100.0 * (double)total + 0.999999);
+    if (rank < 1) rank = 1;
+    if (rank > total) rank = total;
+
+    ULL min = atomic_load_explicit(&histogram->min, memory_order_relaxed);
+    ULL max = atomic_load_explicit(&histogram->max, memory_order_relaxed);
+    ULL seen = 0;
+    for (int i = 0; i < LATENCY_BUCKETS; i++)
+    {
+        seen += atomic_load_explicit(&histogram->counts[i], memory_order_relaxed);
+        if (seen >= rank)
+        {
+            ULL value = latency_bucket_upper(i);
+            if (value > max) value = max;
+            if (value < min) value = min;
+            return value;
+        }
+    }
+    return max;
+}
+
+/* ---------- Набор гистограмм ---------- */
+
+static unsigned latency_key(int size, ULL exponent, ULL field_size)
+{
+    unsigned size_class = size > 0 ? (unsigned)(31 - __builtin_clz((unsigned)size)) : 0;
+    unsigned exponent_bits = exponent ? (unsigned)(64 - __builtin_clzll(exponent)) : 0;
+    /* +1: ключ 0 означает свободную ячейку */
+    return ((size_class << 16) | (exponent_bits << 8) | (unsigned)tune_field_class(field_size)) + 1;
+}
+
+/* Найти гистограмму ключа или занять под неё ячейку */
+static LatencyHistogram* latency_find(LatencyRecorder* recorder, unsigned key)
+{
+    unsigned start = (key * 2654435761u) % LATENCY_MAX_KEYS;
+    for (unsigned probe = 0; probe < LATENCY_MAX_KEYS; probe++)
+    {
+        LatencySlot* slot = &recorder->slots[(start + probe) % LATENCY_MAX_KEYS];
+        unsigned seen = atomic_load_explicit(&slot->key, memory_order_acquire);
+        if (seen == 0)
+        {
+            if (atomic_compare_exchange_strong(&slot->key, &seen, key))
+            {
+                LatencyHistogram* histogram = (LatencyHistogram*)malloc(sizeof(LatencyHistogram));
+                if (histogram)
+                {
+                    latency_histogram_init(histogram);
+                }
+                else
+                {
+                    histogram = &recorder->other;
+                }
+                atomic_store_explicit(&slot->histogram, histogram, memory_order_release);
+                return histogram;
+            }
+            /* Ячейку только что занял другой поток: seen — его ключ */
+        }
+        if (seen == key)
+        {
+            LatencyHistogram* histogram;
+            while (!(histogram = atomic_load_explicit(&slot->histogram, memory_order_acquire)))
+            {
+                sched_yield();
+            }
+            return histogram;
+        }
+    }
+    return &recorder->other;
+}
+
+int latency_recorder_create(LatencyRecorder** result)
+{
+    if (!result)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+
+    LatencyRecorder* recorder = (LatencyRecorder*)calloc(1, sizeof(LatencyRecorder));
+    if (!recorder)
+    {
+        return MATRIX_ERROR_CREATION;
+    }
+    latency_histogram_init(&recorder->other);
+
+    *result = recorder;
+    return MATRIX_SUCCESS;
+}
+
+void latency_recorder_destroy(LatencyRecorder* recorder)
+{
+    if (!recorder) return;
+
+    for (int i = 0; i < LATENCY_MAX_KEYS; i++)
+    {
+        LatencyHistogram* histogram = atomic_load(&recorder->slots[i].histogram);
+        if (histogram != &recorder->other) free(histogram);
+    }
+    free(recorder);
+}
+
+void latency_record(LatencyRecorder* recorder, int size, ULL exponent, ULL field_size, ULL value_ns)
+{
+    if (!recorder) return;
+
+    latency_histogram_record(latency_find(recorder, latency_key(size, exponent, field_size)), value_ns);
+}
+
+int latency_recorder_merge(LatencyRecorder* dst, const LatencyRecorder* src)
+{
+    if (!dst || !src)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+
+    for (int i = 0; i < LATENCY_MAX_KEYS; i++)
+    {
+        unsigned key = atomic_load_explicit(&src->slots[i].key, memory_order_acquire);
+        LatencyHistogram* histogram = atomic_load_explicit(&src->slots[i].histogram, memory_order_acquire);
+        if (key == 0 || !histogram) continue;
+
+        LatencyHistogram* target = histogram == &src->other ? &dst->other : latency_find(dst, key);
+        latency_histogram_merge(target, histogram);
+    }
+    latency_histogram_merge(&dst->other, &src->other);
+    return MATRIX_SUCCESS;
+}
+
+int latency_recorder_total(const LatencyRecorder* recorder, LatencyHistogram* result)
+{
+    if (!recorder || !result)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+
+    latency_histogram_init(result);
+    for (int i = 0; i < LATENCY_MAX_KEYS; i++)
+    {
+        LatencyHistogram* histogram = atomic_load_explicit(&recorder->slots[i].histogram, memory_order_acquire);
+        if (histogram && histogram != &recorder->other) latency_histogram_merge(result, histogram);
+    }
+    latency_histogram_merge(result, &recorder->other);
+    return MATRIX_SUCCESS;
+}
+
+/* ---------- Печать ---------- */
+
+static int latency_compare_keys(const void* a, const void* b)
+{
+    const LatencySlot* x = *(const LatencySlot* const*)a;
+    const LatencySlot* y = *(const LatencySlot* const*)b;
+    unsigned kx = atomic_load(&x->key);
+    unsigned ky = atomic_load(&y->key);
+    return (kx > ky) - (kx < ky);
+}
+
+static void latency_print_row(FILE* out, const char* size, const char* bits, const char* field,
+                              const LatencyHistogram* histogram)
+{
+    ULL count = atomic_load(&histogram->total);
+    fprintf(out, "%-14s %5s %-7s %10llu %12llu %12llu %12llu %12llu %12llu %12llu\n", size, bits, field, count,
+            latency_histogram_percentile(histogram, 0), latency_histogram_percentile(histogram, 50),
+            latency_histogram_percentile(histogram, 90), latency_histogram_percentile(histogram, 99),
+            latency_histogram_percentile(histogram, 99.9), latency_histogram_percentile(histogram, 100));
+}
+
+int latency_recorder_print(const LatencyRecorder* recorder, FILE* out)
+{
+    if (!recorder || !out)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+
+    const LatencySlot* used[LATENCY_MAX_KEYS];
+    int count = 0;
+    for (int i = 0; i < LATENCY_MAX_KEYS; i++)
+    {
+        const LatencySlot* slot = &recorder->slots[i];
+        LatencyHistogram* histogram = atomic_load_explicit(&slot->histogram, memory_order_acquire);
+        if (histogram && histogram != &recorder->other) used[count++] = slot;
+    }
+    qsort(used, (size_t)count, sizeof(used[0]), latency_compare_keys);
+
+    fprintf(out, "%-14s %5s %-7s %10s %12s %12s %12s %12s %12s %12s\n", "n", "bits", "field", "count",
+            "min_ns", "p50_ns", "p90_ns", "p99_ns", "p99.9_ns", "max_ns");
+
+    for (int i = 0; i < count; i++)
+    {
+        unsigned key = atomic_load(&used[i]->key) - 1;
+        unsigned size_class = key >> 16;
+        char size[32];
+        char bits[8];
+        snprintf(size, sizeof(size), "%u-%u", 1u << size_class, (2u << size_class) - 1);
+        snprintf(bits, sizeof(bits), "%u", (key >> 8) & 0xFF);
+        latency_print_row(out, size, bits, latency_field_names[key & 0xFF], atomic_load(&used[i]->histogram));
+    }
+
+    if (atomic_load(&recorder->other.total) > 0)
+    {
+        latency_print_row(out, "other", "-", "-", &recorder->other);
+    }
+
+    LatencyHistogram* total = (LatencyHistogram*)malloc(sizeof(LatencyHistogram));
+    if (!total)
+    {
+        return MATRIX_ERROR_CREATION;
+    }
+    latency_recorder_total(recorder, total);
+    latency_print_row(out, "all", "-", "-", total);
+    free(total);
+    return MATRIX_SUCCESS;
+}
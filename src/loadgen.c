@@ -0,0 +1,476 @@
+/*
+ * Генератор нагрузки для режима сервера (matrix_server.h).
+ *
+ * Запускает несколько клиентов, каждый в своём потоке и со своим соединением. Клиент держит
+ * до window запросов в полёте, проверяет каждый ответ наивным возведением в степень и
+ * замеряет задержку от отправки до ответа. В конце печатает пропускную способность,
+ * процентили задержек клиента и статистику сервера.
+ *
+ * lab2_loadgen [-s сокет] [-c клиентов] [-r запросов на клиента] [-n размер] [-p поле]
+ *              [-e степень] [-w окно] [-q] [-H]
+ * -q — после замера остановить сервер.
+ * -H — напечатать таблицу процентилей задержек сервера по ключам (SERVER_REQUEST_HISTOGRAMS).
+ */
+
+#include "../include/matrix_server.h"
+
+#include <getopt.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#define LOADGEN_MAX_WINDOW 64
+
+typedef struct LoadgenOptions
+{
+    const char* socket_path;
+    int clients;
+    int requests;
+    int size;
+    uint64_t field_size;
+    uint64_t exponent;
+    int window;
+} LoadgenOptions;
+
+typedef struct LoadgenClient
+{
+    const LoadgenOptions* options;
+    int index;
+    uint64_t* latencies;        /* requests задержек в наносекундах */
+    int completed;
+    int mismatches;
+    int errors;
+    uint64_t batched;           /* ответов, посчитанных в пачке больше одного */
+} LoadgenClient;
+
+static int64_t loadgen_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static int loadgen_width(uint64_t field_size)
+{
+    if (field_size == 0 || field_size > (1ULL << 32)) return 8;
+    if (field_size > (1ULL << 16)) return 4;
+    if (field_size > (1ULL << 8)) return 2;
+    return 1;
+}
+
+static int loadgen_read_full(int fd, void* buffer, size_t bytes)
+{
+    char* at = (char*)buffer;
+    while (bytes > 0)
+    {
+        ssize_t got = recv(fd, at, bytes, 0);
+        if (got <= 0) return 0;
+        at += got;
+        bytes -= (size_t)got;
+    }
+    return 1;
+}
+
+static int loadgen_write_full(int fd, const void* buffer, size_t bytes)
+{
+    const char* at = (const char*)buffer;
+    while (bytes > 0)
+    {
+        ssize_t sent = send(fd, at, bytes, MSG_NOSIGNAL);
+        if (sent <= 0) return 0;
+        at += sent;
+        bytes -= (size_t)sent;
+    }
+    return 1;
+}
+
+static int loadgen_connect(const char* path)
+{
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, path, sizeof(address.sun_path) - 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd >= 0 && connect(fd, (struct sockaddr*)&address, sizeof(address)) != 0)
+    {
+        close(fd);
+        fd = -1;
+    }
+    return fd;
+}
+
+/* Прочитать кадр ответа: заголовок и данные (malloc, NULL если их нет) */
+static int loadgen_receive(int fd, ServerResponseHeader* header, void** payload, size_t* payload_bytes)
+{
+    uint32_t length;
+    if (!loadgen_read_full(fd, &length, sizeof(length)) || length < sizeof(*header) ||
+        !loadgen_read_full(fd, header, sizeof(*header)))
+    {
+        return 0;
+    }
+    *payload_bytes = length - sizeof(*header);
+    *payload = *payload_bytes ? malloc(*payload_bytes) : NULL;
+    if (*payload_bytes && (!*payload || !loadgen_read_full(fd, *payload, *payload_bytes)))
+    {
+        free(*payload);
+        *payload = NULL;
+        return 0;
+    }
+    return 1;
+}
+
+/* ---------- Эталон ---------- */
+
+static uint64_t loadgen_mulmod(uint64_t a, uint64_t b, uint64_t p)
+{
+    unsigned __int128 product = (unsigned __int128)a * b;
+    return p ? (uint64_t)(product % p) : (uint64_t)product;
+}
+
+static void loadgen_multiply(const uint64_t* a, const uint64_t* b, uint64_t* c, int n, uint64_t p)
+{
+    for (int i = 0; i < n; i++)
+    {
+        for (int j = 0; j < n; j++)
+        {
+            uint64_t sum = 0;
+            for (int k = 0; k < n; k++)
+            {
+                /* Оба слагаемых меньше p, но при p > 2^63 сумма переполняет 64 бита:
+                   вычитаем p, если сумма дошла до p или перешла через 2^64 */
+                uint64_t term = loadgen_mulmod(a[i * n + k], b[k * n + j], p);
+                sum += term;
+                if (p && (sum < term || sum >= p)) sum -= p;
+            }
+            c[i * n + j] = sum;
+        }
+    }
+}
+
+static void loadgen_power(const uint64_t* base, uint64_t exponent, uint64_t* result, int n, uint64_t p)
+{
+    size_t count = (size_t)n * n;
+    uint64_t* power = (uint64_t*)malloc(count * sizeof(uint64_t));
+    uint64_t* temp = (uint64_t*)malloc(count * sizeof(uint64_t));
+    memcpy(power, base, count * sizeof(uint64_t));
+    memset(result, 0, count * sizeof(uint64_t));
+    for (int i = 0; i < n; i++) result[i * n + i] = p == 1 ? 0 : 1;
+
+    while (exponent)
+    {
+        if (exponent & 1)
+        {
+            loadgen_multiply(result, power, temp, n, p);
+            memcpy(result, temp, count * sizeof(uint64_t));
+        }
+        exponent >>= 1;
+        if (exponent)
+        {
+            loadgen_multiply(power, power, temp, n, p);
+            memcpy(power, temp, count * sizeof(uint64_t));
+        }
+    }
+    free(power);
+    free(temp);
+}
+
+static uint64_t loadgen_element(const void* data, int width, size_t i)
+{
+    switch (width)
+    {
+        case 1: return ((const uint8_t*)data)[i];
+        case 2: return ((const uint16_t*)data)[i];
+        case 4: return ((const uint32_t*)data)[i];
+        default: return ((const uint64_t*)data)[i];
+    }
+}
+
+/* ---------- Клиент ---------- */
+
+/* Слот окна: запрос в полёте и его эталон */
+typedef struct LoadgenSlot
+{
+    uint64_t id;
+    int64_t sent_ns;
+    uint64_t* expected;
+} LoadgenSlot;
+
+static int loadgen_send(int fd, const LoadgenOptions* options, uint64_t id, uint64_t* state,
+                        char* frame, LoadgenSlot* slot)
+{
+    int n = options->size;
+    int width = loadgen_width(options->field_size);
+    size_t count = (size_t)n * n;
+    size_t payload = count * (size_t)width;
+
+    uint32_t length = (uint32_t)(sizeof(ServerRequestHeader) + payload);
+    ServerRequestHeader header = {SERVER_REQUEST_POWER, (uint32_t)n, id, options->exponent,
+                                  options->field_size, (uint32_t)width, 0};
+    memcpy(frame, &length, sizeof(length));
+    memcpy(frame + sizeof(length), &header, sizeof(header));
+
+    uint64_t* base = (uint64_t*)malloc(count * sizeof(uint64_t));
+    char* data = frame + sizeof(length) + sizeof(header);
+    for (size_t i = 0; i < count; i++)
+    {
+        /* xorshift64 */
+        *state ^= *state << 13;
+        *state ^= *state >> 7;
+        *state ^= *state << 17;
+        base[i] = options->field_size ? *state % options->field_size : *state;
+        switch (width)
+        {
+            case 1: ((uint8_t*)data)[i] = (uint8_t)base[i]; break;
+            case 2: ((uint16_t*)data)[i] = (uint16_t)base[i]; break;
+            case 4: ((uint32_t*)data)[i] = (uint32_t)base[i]; break;
+            default: memcpy(data + i * sizeof(uint64_t), &base[i], sizeof(uint64_t)); break;  /* кадр не выровнен на 8 */
+        }
+    }
+
+    slot->id = id;
+    slot->expected = (uint64_t*)malloc(count * sizeof(uint64_t));
+    loadgen_power(base, options->exponent, slot->expected, n, options->field_size);
+    free(base);
+
+    slot->sent_ns = loadgen_now_ns();
+    return loadgen_write_full(fd, frame, sizeof(length) + sizeof(header) + payload);
+}
+
+static void* loadgen_client(void* arg)
+{
+    LoadgenClient* client = (LoadgenClient*)arg;
+    const LoadgenOptions* options = client->options;
+    int fd = loadgen_connect(options->socket_path);
+    if (fd < 0)
+    {
+        client->errors = options->requests;
+        return NULL;
+    }
+
+    int n = options->size;
+    int width = loadgen_width(options->field_size);
+    size_t count = (size_t)n * n;
+    char* frame = (char*)malloc(sizeof(uint32_t) + sizeof(ServerRequestHeader) + count * (size_t)width);
+    LoadgenSlot slots[LOADGEN_MAX_WINDOW];
+    memset(slots, 0, sizeof(slots));
+    uint64_t state = 0x9E3779B97F4A7C15ULL * (uint64_t)(client->index + 1);
+    uint64_t first_id = (uint64_t)client->index * (uint64_t)options->requests;
+
+    int sent = 0;
+    int alive = 1;
+    for (; sent < options->window && sent < options->requests && alive; sent++)
+    {
+        alive = loadgen_send(fd, options, first_id + (uint64_t)sent, &state, frame, &slots[sent]);
+    }
+
+    while (alive && client->completed + client->errors < sent)
+    {
+        ServerResponseHeader header;
+        void* payload;
+        size_t payload_bytes;
+        if (!loadgen_receive(fd, &header, &payload, &payload_bytes))
+        {
+            break;
+        }
+        int64_t now = loadgen_now_ns();
+
+        /* Ответы приходят не по порядку: слот ищется по id */
+        LoadgenSlot* slot = NULL;
+        for (int i = 0; i < options->window && !slot; i++)
+        {
+            if (slots[i].expected && slots[i].id == header.id) slot = &slots[i];
+        }
+        if (!slot)
+        {
+            client->errors++;
+            free(payload);
+            break;
+        }
+        if (header.status != MATRIX_SUCCESS || payload_bytes != count * (size_t)width)
+        {
+            client->errors++;
+        }
+        else
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                if (loadgen_element(payload, width, i) != slot->expected[i])
+                {
+                    client->mismatches++;
+                    break;
+                }
+            }
+            client->latencies[client->completed++] = (uint64_t)(now - slot->sent_ns);
+            if (header.batch > 1) client->batched++;
+        }
+        free(payload);
+        free(slot->expected);
+        slot->expected = NULL;
+
+        if (sent < options->requests)
+        {
+            alive = loadgen_send(fd, options, first_id + (uint64_t)sent, &state, frame, slot);
+            sent++;
+        }
+    }
+
+    client->errors += options->requests - client->completed - client->errors;
+    for (int i = 0; i < LOADGEN_MAX_WINDOW; i++) free(slots[i].expected);
+    free(frame);
+    close(fd);
+    return NULL;
+}
+
+/* ---------- Служебные запросы ---------- */
+
+/* Служебный запрос без тела. [OUT] payload — данные ответа (malloc) или NULL */
+static int loadgen_control(const char* path, uint32_t type, void** payload, size_t* payload_bytes)
+{
+    *payload = NULL;
+    *payload_bytes = 0;
+    int fd = loadgen_connect(path);
+    if (fd < 0) return 0;
+
+    uint32_t length = sizeof(ServerRequestHeader);
+    ServerRequestHeader header = {type, 0, 0, 0, 0, 0, 0};
+    ServerResponseHeader response;
+    int done = loadgen_write_full(fd, &length, sizeof(length)) && loadgen_write_full(fd, &header, sizeof(header)) &&
+               loadgen_receive(fd, &response, payload, payload_bytes) && response.status == SERVER_SUCCESS;
+    if (!done)
+    {
+        free(*payload);
+        *payload = NULL;
+    }
+    close(fd);
+    return done;
+}
+
+static int loadgen_compare_u64(const void* a, const void* b)
+{
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+int main(int argc, char** argv)
+{
+    LoadgenOptions options = {SERVER_DEFAULT_SOCKET, 8, 200, 16, 1000003, 1000, 8};
+    int shutdown_server = 0;
+    int histograms = 0;
+
+    int option;
+    while ((option = getopt(argc, argv, "s:c:r:n:p:e:w:qH")) != -1)
+    {
+        switch (option)
+        {
+            case 's': options.socket_path = optarg; break;
+            case 'c': options.clients = atoi(optarg); break;
+            case 'r': options.requests = atoi(optarg); break;
+            case 'n': options.size = atoi(optarg); break;
+            case 'p': options.field_size = strtoull(optarg, NULL, 10); break;
+            case 'e': options.exponent = strtoull(optarg, NULL, 10); break;
+            case 'w': options.window = atoi(optarg); break;
+            case 'q': shutdown_server = 1; break;
+            case 'H': histograms = 1; break;
+            default:
+                fprintf(stderr, "Использование: %s [-s сокет] [-c клиентов] [-r запросов] [-n размер] "
+                                "[-p поле] [-e степень] [-w окно] [-q] [-H]\n", argv[0]);
+                return ERROR_INVALID_INPUT;
+        }
+    }
+    if (options.clients < 1 || options.requests < 1 || options.size < 1 || options.size > SERVER_MAX_SIZE ||
+        options.window < 1 || options.window > LOADGEN_MAX_WINDOW)
+    {
+        fprintf(stderr, "Неверные параметры нагрузки\n");
+        return ERROR_INVALID_INPUT;
+    }
+
+    LoadgenClient* clients = (LoadgenClient*)calloc((size_t)options.clients, sizeof(LoadgenClient));
+    pthread_t* threads = (pthread_t*)calloc((size_t)options.clients, sizeof(pthread_t));
+    if (!clients || !threads)
+    {
+        return ERROR_MEMORY_ALLOCATION;
+    }
+
+    int64_t started = loadgen_now_ns();
+    for (int i = 0; i < options.clients; i++)
+    {
+        clients[i].options = &options;
+        clients[i].index = i;
+        clients[i].latencies = (uint64_t*)calloc((size_t)options.requests, sizeof(uint64_t));
+        pthread_create(&threads[i], NULL, loadgen_client, &clients[i]);
+    }
+
+    size_t total = 0;
+    int mismatches = 0;
+    int errors = 0;
+    uint64_t batched = 0;
+    for (int i = 0; i < options.clients; i++)
+    {
+        pthread_join(threads[i], NULL);
+        total += (size_t)clients[i].completed;
+        mismatches += clients[i].mismatches;
+        errors += clients[i].errors;
+        batched += clients[i].batched;
+    }
+    double seconds = (double)(loadgen_now_ns() - started) / 1e9;
+
+    uint64_t* latencies = (uint64_t*)malloc((total ? total : 1) * sizeof(uint64_t));
+    size_t at = 0;
+    for (int i = 0; i < options.clients; i++)
+    {
+        memcpy(latencies + at, clients[i].latencies, (size_t)clients[i].completed * sizeof(uint64_t));
+        at += (size_t)clients[i].completed;
+        free(clients[i].latencies);
+    }
+    qsort(latencies, total, sizeof(uint64_t), loadgen_compare_u64);
+
+    printf("Клиентов: %d, запросов: %zu за %.3f с (%.1f запросов/с)\n", options.clients, total, seconds,
+           seconds > 0 ? (double)total / seconds : 0.0);
+    printf("Ошибок: %d, неверных результатов: %d, посчитано в пачках: %llu\n", errors, mismatches,
+           (unsigned long long)batched);
+    if (total > 0)
+    {
+        printf("Задержка клиента, мкс: p50 %.1f  p90 %.1f  p99 %.1f  max %.1f\n",
+               latencies[(total - 1) * 50 / 100] / 1e3, latencies[(total - 1) * 90 / 100] / 1e3,
+               latencies[(total - 1) * 99 / 100] / 1e3, latencies[total - 1] / 1e3);
+    }
+
+    void* payload = NULL;
+    size_t payload_bytes = 0;
+    if (loadgen_control(options.socket_path, SERVER_REQUEST_STATS, &payload, &payload_bytes) &&
+        payload_bytes == sizeof(ServerStats))
+    {
+        ServerStats stats;
+        memcpy(&stats, payload, sizeof(stats));
+        printf("Сервер: запросов %llu, ответов %llu, вычислений %llu, заданий в пачках %llu\n",
+               (unsigned long long)stats.requests, (unsigned long long)stats.completed,
+               (unsigned long long)stats.batches, (unsigned long long)stats.batched);
+        printf("Очередь: сейчас %u, пик %u, ожиданий места %llu; соединений %u, рабочих потоков %u\n",
+               stats.queue_depth, stats.queue_peak, (unsigned long long)stats.full_waits, stats.connections,
+               stats.workers);
+        printf("Задержка сервера, мкс: p50 %.1f  p90 %.1f  p99 %.1f  max %.1f\n",
+               stats.latency_p50_ns / 1e3, stats.latency_p90_ns / 1e3, stats.latency_p99_ns / 1e3,
+               stats.latency_max_ns / 1e3);
+    }
+    free(payload);
+    if (histograms && loadgen_control(options.socket_path, SERVER_REQUEST_HISTOGRAMS, &payload, &payload_bytes))
+    {
+        fwrite(payload, 1, payload_bytes, stdout);
+        free(payload);
+    }
+    if (shutdown_server && loadgen_control(options.socket_path, SERVER_REQUEST_SHUTDOWN, &payload, &payload_bytes))
+    {
+        free(payload);
+    }
+    else if (shutdown_server)
+    {
+        fprintf(stderr, "Не удалось остановить сервер\n");
+    }
+
+    free(latencies);
+    free(clients);
+    free(threads);
+    return (errors || mismatches) ? ERROR_INVALID_INPUT : SUCCESS;
+}
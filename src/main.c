@@ -1,8 +1,73 @@
 #include "../include/common.h"
 #include "../include/tests.h"
+#include "../include/matrix_tune.h"
+#include "../include/matrix_server.h"
+#include "../include/matrix_tiled.h"
 
-int main()
+int main(int argc, char** argv)
 {
+    /* --serve [сокет]: режим сервера вместо меню */
+    if (argc > 1 && strcmp(argv[1], "--serve") == 0)
+    {
+        matrix_tune_load(NULL);
+        const char* socket_path = argc > 2 ? argv[2] : SERVER_DEFAULT_SOCKET;
+        printf("Сервер слушает %s\n", socket_path);
+        fflush(stdout);
+        int server_error = server_run(socket_path);
+        if (server_error != SERVER_SUCCESS)
+        {
+            printf("Ошибка сервера: %d\n", server_error);
+            return ERROR_FILE_OPERATION;
+        }
+        return SUCCESS;
+    }
+
+    /* --tiled-random файл n поле [плитка]: случайная матрица в файле плитками */
+    if (argc > 4 && strcmp(argv[1], "--tiled-random") == 0)
+    {
+        TiledMatrix* matrix;
+        int tile = argc > 5 ? atoi(argv[5]) : 0;
+        int tiled_error = tiled_matrix_random(argv[2], atoi(argv[3]), strtoull(argv[4], NULL, 10), tile,
+                                              (ULL)time(NULL), &matrix);
+        if (tiled_error != MATRIX_SUCCESS)
+        {
+            printf("Ошибка создания файла матрицы: %s\n", get_matrix_error_message(tiled_error));
+            return ERROR_FILE_OPERATION;
+        }
+        tiled_matrix_close(matrix);
+        return SUCCESS;
+    }
+
+    /* --tiled вход степень выход бюджет_МиБ: возведение в степень матрицы из файла вне памяти */
+    if (argc > 5 && strcmp(argv[1], "--tiled") == 0)
+    {
+        matrix_tune_load(NULL);
+        TiledMatrix* base = NULL;
+        TiledMatrix* result;
+        TiledReport report;
+        TiledOptions options = {(size_t)strtoull(argv[5], NULL, 10) << 20};
+        int tiled_error = tiled_matrix_open(argv[2], &base);
+        if (tiled_error == MATRIX_SUCCESS)
+        {
+            tiled_error = matrix_power_tiled(base, strtoull(argv[3], NULL, 10), &options, argv[4], &result, &report);
+        }
+        if (tiled_error != MATRIX_SUCCESS)
+        {
+            printf("Ошибка возведения в степень: %s\n", get_matrix_error_message(tiled_error));
+            if (tiled_error == MATRIX_ERROR_MEMORY_BUDGET)
+            {
+                size_t minimum = tiled_min_budget(base);
+                printf("Наименьший бюджет: %zu байт (%zu МиБ)\n", minimum, (minimum + (1u << 20) - 1) >> 20);
+            }
+            tiled_matrix_close(base);
+            return ERROR_FILE_OPERATION;
+        }
+        tiled_matrix_close(base);
+        tiled_matrix_close(result);
+        tiled_report_print(&report, stdout);
+        return SUCCESS;
+    }
+
     printf("БЫСТРОЕ ВОЗВЕДЕНИЕ КВАДРАТНОЙ МАТРИЦЫ В СТЕПЕНЬ\n");
     printf("================================================\n\n");
 
@@ -10,7 +75,15 @@ int main()
     printf("1. Ручное тестирование - ввод матрицы и параметров вручную\n");
     printf("2. Тестирование с известными данными - предопределенные тесты\n");
     printf("3. Генерация тестовых данных - создание CSV файла с результатами\n");
-    printf("4. Выход - завершение программы\n\n");
+    printf("4. Бенчмарк транспонирования - сравнение с пропускной способностью memcpy\n");
+    printf("5. Автонастройка - выбор ядер умножения для этой машины\n");
+    printf("6. Выход - завершение программы\n\n");
+
+    /* Профиль автонастройки, если он уже записан; иначе — правила по умолчанию */
+    if (matrix_tune_load(NULL) == TUNE_SUCCESS)
+    {
+        printf("Загружен профиль автонастройки\n\n");
+    }
 
     int choice;
     int ui_error;
@@ -21,7 +94,9 @@ int main()
         printf("1. Ручное тестирование\n");
         printf("2. Тестирование с известными данными\n");
         printf("3. Генерация тестовых данных\n");
-        printf("4. Выход\n");
+        printf("4. Бенчмарк транспонирования\n");
+        printf("5. Автонастройка\n");
+        printf("6. Выход\n");
         printf("Выберите опцию:");
 
         if (scanf("%d", &choice) != 1)
@@ -55,12 +130,26 @@ int main()
                 }
                 break;
             case 4:
+                ui_error = transpose_benchmark();
+                if (ui_error != UI_SUCCESS)
+                {
+                    printf("Ошибка бенчмарка: %d\n", ui_error);
+                }
+                break;
+            case 5:
+                ui_error = tune_multiply();
+                if (ui_error != UI_SUCCESS)
+                {
+                    printf("Ошибка автонастройки: %d\n", ui_error);
+                }
+                break;
+            case 6:
                 printf("Выход...\n");
                 break;
             default:
                 printf("Неверный выбор. Попробуйте снова.\n");
         }
-    } while (choice != 4);
+    } while (choice != 6);
 
     return SUCCESS;
 }
\ No newline at end of file
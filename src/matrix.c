@@ -1,49 +1,97 @@
 #include "../include/matrix.h"
 #include "../include/common.h"
+#include "../include/trace.h"
+#include "../include/matrix_kernels.h"
+#include "../include/gf2.h"
+#include "../include/matrix_rns.h"
+#include "../include/matrix_poly.h"
+#include "../include/modular.h"
+#include "../include/matrix_lu.h"
+#include "../include/matrix_view.h"
+#include "../include/matrix_numa.h"
+#include "../include/matrix_sched.h"
+#include "../include/matrix_verify.h"
 
-int matrix_create(int rows, int cols, ULL field_size, Matrix** result)
+int matrix_element_width(ULL field_size)
+{
+    if (field_size == 0 || field_size > (1ULL << 32)) return 8;
+    if (field_size > (1ULL << 16)) return 4;
+    if (field_size > (1ULL << 8)) return 2;
+    return 1;
+}
+
+static size_t matrix_block_size(int rows, int cols, size_t* pointers_offset, size_t* data_offset)
+{
+    const size_t alignment = 64;
+    size_t pointers = (sizeof(Matrix) + alignment - 1) & ~(alignment - 1);
+    size_t data = (pointers + (size_t)rows * sizeof(ULL*) + alignment - 1) & ~(alignment - 1);
+
+    if ((size_t)cols > (SIZE_MAX / 2 - data) / sizeof(ULL) / (size_t)rows)
+    {
+        return 0;
+    }
+
+    *pointers_offset = pointers;
+    *data_offset = data;
+    return (data + (size_t)rows * (size_t)cols * sizeof(ULL) + alignment - 1) & ~(alignment - 1);
+}
+
+int matrix_create_uninit(int rows, int cols, ULL field_size, Matrix** result)
 {
+    if (!result)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
     if (rows < 1 || cols < 1)
     {
         return MATRIX_ERROR_INVALID_SIZE;
     }
 
-    Matrix* matrix = (Matrix*)malloc(sizeof(Matrix));
-    if (!matrix)
+    size_t pointers_offset, data_offset;
+    size_t size = matrix_block_size(rows, cols, &pointers_offset, &data_offset);
+    if (size == 0)
+    {
+        return MATRIX_ERROR_INVALID_SIZE;
+    }
+
+    /* Большие матрицы без контекста выделения размещаются с учётом NUMA (matrix_numa.h):
+       строки матрицы вызывающего потока пишут рабочие потоки всех узлов — страницы чередуются */
+    MatrixAllocator* allocator = matrix_allocator_current();
+    int placement = matrix_numa_pinned() ? NUMA_PLACE_LOCAL : NUMA_PLACE_INTERLEAVE;
+    char* block = allocator ? (char*)matrix_allocator_acquire(allocator, size)
+                            : (char*)matrix_numa_alloc(size, placement, "matrix");
+    if (!block)
     {
         return MATRIX_ERROR_CREATION;
     }
 
+    Matrix* matrix = (Matrix*)block;
     matrix->rows = rows;
     matrix->cols = cols;
     matrix->field_size = field_size;
+    matrix->element_width = matrix_element_width(field_size);
+    matrix->allocator = allocator;
+    matrix->data = (ULL**)(block + pointers_offset);
 
-    matrix->data = (ULL**)malloc(rows * sizeof(ULL*));
-    if (!matrix->data)
-    {
-        free(matrix);
-        return MATRIX_ERROR_CREATION;
-    }
-
+    ULL* elements = (ULL*)(block + data_offset);
     for (int i = 0; i < rows; i++)
     {
-        matrix->data[i] = (ULL*)calloc(cols, sizeof(ULL));
-        if (!matrix->data[i])
-        {
-            for (int j = 0; j < i; j++)
-            {
-                free(matrix->data[j]);
-            }
-            free(matrix->data);
-            free(matrix);
-            return MATRIX_ERROR_CREATION;
-        }
+        matrix->data[i] = elements + (size_t)i * cols;
     }
 
     *result = matrix;
     return MATRIX_SUCCESS;
 }
 
+int matrix_create(int rows, int cols, ULL field_size, Matrix** result)
+{
+    int error = matrix_create_uninit(rows, cols, field_size, result);
+    if (error != MATRIX_SUCCESS) return error;
+
+    memset((*result)->data[0], 0, (size_t)rows * cols * sizeof(ULL));
+    return MATRIX_SUCCESS;
+}
+
 int matrix_free(Matrix* matrix)
 {
     if (!matrix)
@@ -51,18 +99,16 @@ int matrix_free(Matrix* matrix)
         return MATRIX_SUCCESS;
     }
 
-    if (matrix->data)
+    if (matrix->allocator)
     {
-        for (int i = 0; i < matrix->rows; i++)
-        {
-            if (matrix->data[i])
-            {
-                free(matrix->data[i]);
-            }
-        }
-        free(matrix->data);
+        size_t pointers_offset, data_offset;
+        size_t size = matrix_block_size(matrix->rows, matrix->cols, &pointers_offset, &data_offset);
+        matrix_allocator_release(matrix->allocator, matrix, size);
+    }
+    else
+    {
+        free(matrix);
     }
-    free(matrix);
     return MATRIX_SUCCESS;
 }
 
@@ -75,16 +121,10 @@ int matrix_copy(const Matrix* src, Matrix** result)
 
     int error;
     Matrix* dest;
-    error = matrix_create(src->rows, src->cols, src->field_size, &dest);
+    error = matrix_create_uninit(src->rows, src->cols, src->field_size, &dest);
     if (error != MATRIX_SUCCESS) return error;
 
-    for (int i = 0; i < src->rows; i++)
-    {
-        for (int j = 0; j < src->cols; j++)
-        {
-            dest->data[i][j] = src->data[i][j];
-        }
-    }
+    memcpy(dest->data[0], src->data[0], (size_t)src->rows * src->cols * sizeof(ULL));
 
     *result = dest;
     return MATRIX_SUCCESS;
@@ -111,56 +151,140 @@ ULL multiply_mod(ULL a, ULL b, ULL mod)
     return result;
 }
 
+/* Поэлементные операции выполняются над представлениями всей матрицы (matrix_view.c) */
+int matrix_sum_into(const Matrix* a, const Matrix* b, Matrix* result)
+{
+    MatrixView va, vb, vr;
+    int error = matrix_view_of(a, &va);
+    if (error == MATRIX_SUCCESS) error = matrix_view_of(b, &vb);
+    if (error == MATRIX_SUCCESS) error = matrix_view_of(result, &vr);
+    if (error == MATRIX_SUCCESS) error = matrix_view_sum(&va, &vb, &vr);
+    return error;
+}
+
+int matrix_subtract_into(const Matrix* a, const Matrix* b, Matrix* result)
+{
+    MatrixView va, vb, vr;
+    int error = matrix_view_of(a, &va);
+    if (error == MATRIX_SUCCESS) error = matrix_view_of(b, &vb);
+    if (error == MATRIX_SUCCESS) error = matrix_view_of(result, &vr);
+    if (error == MATRIX_SUCCESS) error = matrix_view_subtract(&va, &vb, &vr);
+    return error;
+}
+
+int matrix_scalar_multiply_into(const Matrix* a, ULL scalar, Matrix* result)
+{
+    MatrixView va, vr;
+    int error = matrix_view_of(a, &va);
+    if (error == MATRIX_SUCCESS) error = matrix_view_of(result, &vr);
+    if (error == MATRIX_SUCCESS) error = matrix_view_scalar_multiply(&va, scalar, &vr);
+    return error;
+}
+
+int matrix_axpby(ULL alpha, const Matrix* a, ULL beta, const Matrix* b, Matrix* result)
+{
+    MatrixView va, vb, vr;
+    int error = matrix_view_of(a, &va);
+    if (error == MATRIX_SUCCESS) error = matrix_view_of(b, &vb);
+    if (error == MATRIX_SUCCESS) error = matrix_view_of(result, &vr);
+    if (error == MATRIX_SUCCESS) error = matrix_view_axpby(alpha, &va, beta, &vb, &vr);
+    return error;
+}
+
 int matrix_sum(const Matrix* a, const Matrix* b, Matrix** result)
 {
     if (!a || !b || !result)
     {
         return MATRIX_ERROR_NULL_POINTER;
     }
-    if (a->rows < 1 || a->cols < 1 || b->rows < 1 || b->cols < 1)
+
+    Matrix* sum_matrix = NULL;
+    int error = matrix_create_uninit(a->rows, a->cols, a->field_size, &sum_matrix);
+    if (error == MATRIX_SUCCESS) error = matrix_sum_into(a, b, sum_matrix);
+    if (error != MATRIX_SUCCESS)
     {
-        return MATRIX_ERROR_INVALID_SIZE;
+        matrix_free(sum_matrix);
+        return error;
     }
-    if (a->rows != b->rows || a->cols != b->cols)
+
+    *result = sum_matrix;
+    return MATRIX_SUCCESS;
+}
+
+int matrix_subtract(const Matrix* a, const Matrix* b, Matrix** result)
+{
+    if (!a || !b || !result)
     {
-        return MATRIX_ERROR_DIMENSION;
+        return MATRIX_ERROR_NULL_POINTER;
     }
-    if (a->field_size != b->field_size)
+
+    Matrix* sub_matrix = NULL;
+    int error = matrix_create_uninit(a->rows, a->cols, a->field_size, &sub_matrix);
+    if (error == MATRIX_SUCCESS) error = matrix_subtract_into(a, b, sub_matrix);
+    if (error != MATRIX_SUCCESS)
     {
-        return MATRIX_ERROR_INVALID_FIELD;
+        matrix_free(sub_matrix);
+        return error;
     }
 
-    int error;
-    Matrix* sum_matrix;
-    error = matrix_create(a->rows, a->cols, a->field_size, &sum_matrix);
+    *result = sub_matrix;
+    return MATRIX_SUCCESS;
+}
+
+int matrix_scalar_multiply(const Matrix* a, ULL scalar, Matrix** result)
+{
+    if (!a || !result)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+
+    Matrix* scaled_matrix = NULL;
+    int error = matrix_create_uninit(a->rows, a->cols, a->field_size, &scaled_matrix);
+    if (error == MATRIX_SUCCESS) error = matrix_scalar_multiply_into(a, scalar, scaled_matrix);
+    if (error != MATRIX_SUCCESS)
+    {
+        matrix_free(scaled_matrix);
+        return error;
+    }
+
+    *result = scaled_matrix;
+    return MATRIX_SUCCESS;
+}
+
+int matrix_transpose(const Matrix* a, Matrix** result)
+{
+    if (!a || !result)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+    if (a->rows < 1 || a->cols < 1)
+    {
+        return MATRIX_ERROR_INVALID_SIZE;
+    }
+
+    MatrixView view;
+    int error = matrix_transpose_view(a, &view);
     if (error != MATRIX_SUCCESS) return error;
 
-    if (a->field_size == 0)
+    return matrix_materialize(&view, result);
+}
+
+int matrix_transpose_in_place(Matrix* a)
+{
+    if (!a)
     {
-        for (int i = 0; i < a->rows; i++)
-        {
-            for (int j = 0; j < a->cols; j++)
-            {
-                sum_matrix->data[i][j] = a->data[i][j] + b->data[i][j];
-            }
-        }
+        return MATRIX_ERROR_NULL_POINTER;
     }
-    else
+    if (a->rows != a->cols)
     {
-        for (int i = 0; i < a->rows; i++)
-        {
-            for (int j = 0; j < a->cols; j++)
-            {
-                sum_matrix->data[i][j] = (a->data[i][j] + b->data[i][j]) % a->field_size;
-            }
-        }
+        return MATRIX_ERROR_NOT_SQUARE;
     }
 
-    *result = sum_matrix;
+    transpose_square_in_place(a->data[0], a->cols, a->rows);
     return MATRIX_SUCCESS;
 }
 
-int matrix_subtract(const Matrix* a, const Matrix* b, Matrix** result)
+int matrix_multiply(const Matrix* a, const Matrix* b, Matrix** result)
 {
     if (!a || !b || !result)
     {
@@ -170,7 +294,7 @@ int matrix_subtract(const Matrix* a, const Matrix* b, Matrix** result)
     {
         return MATRIX_ERROR_INVALID_SIZE;
     }
-    if (a->rows != b->rows || a->cols != b->cols)
+    if (a->cols != b->rows)
     {
         return MATRIX_ERROR_DIMENSION;
     }
@@ -180,202 +304,497 @@ int matrix_subtract(const Matrix* a, const Matrix* b, Matrix** result)
     }
 
     int error;
-    Matrix* sub_matrix;
-    error = matrix_create(a->rows, a->cols, a->field_size, &sub_matrix);
+    Matrix* product;
+    error = matrix_create_uninit(a->rows, b->cols, a->field_size, &product);
     if (error != MATRIX_SUCCESS) return error;
 
-    if (a->field_size == 0)
-    {
-        for (int i = 0; i < a->rows; i++)
-        {
-            for (int j = 0; j < a->cols; j++)
-            {
-                sub_matrix->data[i][j] = a->data[i][j] - b->data[i][j];
-            }
-        }
-    }
-    else
+    PackedMatrix packed_a = {0}, packed_b = {0}, packed_product = {0};
+    error = packed_matrix_view(a, &packed_a);
+    if (error == MATRIX_SUCCESS) error = packed_matrix_view(b, &packed_b);
+    if (error == MATRIX_SUCCESS) error = packed_matrix_target(product, &packed_product);
+    if (error == MATRIX_SUCCESS) error = packed_matrix_multiply(&packed_a, &packed_b, &packed_product);
+    if (error == MATRIX_SUCCESS) error = packed_matrix_store(&packed_product, product);
+    packed_matrix_free(&packed_a);
+    packed_matrix_free(&packed_b);
+    packed_matrix_free(&packed_product);
+    if (error != MATRIX_SUCCESS)
     {
-        for (int i = 0; i < a->rows; i++)
-        {
-            for (int j = 0; j < a->cols; j++)
-            {
-                sub_matrix->data[i][j] =
-                    (a->data[i][j] - b->data[i][j] + a->field_size) % a->field_size;
-            }
-        }
+        matrix_free(product);
+        return error;
     }
 
-    *result = sub_matrix;
+    *result = product;
     return MATRIX_SUCCESS;
 }
 
-int matrix_scalar_multiply(const Matrix* a, ULL scalar, Matrix** result)
+
+int matrix_submatrix(const Matrix* a, int start_row, int end_row,
+                     int start_col, int end_col, Matrix** result)
 {
     if (!a || !result)
     {
         return MATRIX_ERROR_NULL_POINTER;
     }
-    if (a->rows < 1 || a->cols < 1)
-    {
-        return MATRIX_ERROR_INVALID_SIZE;
-    }
 
-    int error;
-    Matrix* scaled_matrix;
-    error = matrix_create(a->rows, a->cols, a->field_size, &scaled_matrix);
+    MatrixView view;
+    int error = matrix_submatrix_view(a, start_row, end_row, start_col, end_col, &view);
+    if (error != MATRIX_SUCCESS) return error;
+
+    return matrix_materialize(&view, result);
+}
+
+/* field_size == 2: возведение в битово-упакованном представлении (64 элемента в слове) */
+static int matrix_power_gf2(const Matrix* base, ULL exponent, Matrix** result)
+{
+    Gf2Matrix* packed;
+    int error = gf2_matrix_from_matrix(base, &packed);
+    if (error != MATRIX_SUCCESS) return error;
+
+    Gf2Matrix* packed_result;
+    error = gf2_matrix_power(packed, exponent, &packed_result);
+    gf2_matrix_free(packed);
     if (error != MATRIX_SUCCESS) return error;
 
-    if (a->field_size == 0)
+    error = gf2_matrix_to_matrix(packed_result, result);
+    gf2_matrix_free(packed_result);
+    return error;
+}
+
+#define POWER_CONCURRENT_MIN 64            /* меньшие произведения не окупают отдельные задачи */
+#define POWER_CONCURRENT_MAX 768           /* в больших одно произведение и так занимает все ядра */
+
+/*
+ * Накопление и возведение в квадрат одного шага бинарного метода справа налево независимы:
+ * оба читают только текущую степень. Если произведение среднего размера не занимает все
+ * рабочие потоки планировщика (matrix_sched.h), выгодно считать их одновременно.
+ */
+static int power_concurrent_preferred(int n)
+{
+    return n >= POWER_CONCURRENT_MIN && n <= POWER_CONCURRENT_MAX && sched_workers() > 0;
+}
+
+/* Накопление result × power, выполняемое задачей планировщика */
+typedef struct PowerAccumulate
+{
+    const PackedMatrix* result;
+    const PackedMatrix* power;
+    PackedMatrix* product;
+    MatrixVerifier* verifier;       /* контекст проверки потока, начавшего возведение */
+    int error;
+} PowerAccumulate;
+
+static void power_accumulate(void* arg)
+{
+    PowerAccumulate* step = (PowerAccumulate*)arg;
+    MatrixVerifier* previous = matrix_verifier_bind(step->verifier);
+    TRACE_BEGIN("accumulate");
+    step->error = packed_matrix_multiply(step->result, step->power, step->product);
+    TRACE_END();
+    matrix_verifier_bind(previous);
+}
+
+/*
+ * Бинарное возведение с одновременными накоплением и квадратом.
+ * Накопление уходит задачей в планировщик, а текущий поток тем временем возводит степень
+ * в квадрат. Степени лежат в кольце из трёх буферов: пока накопление читает один, два
+ * других принимают следующие квадраты, так что на серии нулевых битов накопление
+ * перекрывается ещё с двумя возведениями в квадрат. Ждать его приходится только перед
+ * следующим накоплением или перед записью в читаемый им буфер.
+ */
+static int matrix_power_binary_concurrent(const Matrix* base, const uint32_t* limbs, int bit_count,
+                                          Matrix** result)
+{
+    TRACE_BEGIN("setup");
+    int n = base->rows;
+    ULL p = base->field_size;
+    Matrix* result_matrix;
+    PackedMatrix accumulated[2] = {{0}}, powers[3] = {{0}};
+    int error = MATRIX_SUCCESS;
+    for (int i = 0; error == MATRIX_SUCCESS && i < 2; i++) error = packed_matrix_create(n, n, p, &accumulated[i]);
+    for (int i = 0; error == MATRIX_SUCCESS && i < 3; i++) error = packed_matrix_create(n, n, p, &powers[i]);
+    if (error == MATRIX_SUCCESS) error = packed_matrix_identity(&accumulated[0]);
+    if (error == MATRIX_SUCCESS) error = packed_matrix_load(base, &powers[0]);
+    TRACE_END();
+
+    int current = 0;                /* powers[current] = base^(2^bit) */
+    int acc = 0;                    /* accumulated[acc] — произведение уже учтённых степеней */
+    int reading = -1;               /* буфер степени, который читает незавершённое накопление */
+    SchedTask task;
+    PowerAccumulate step;
+    MatrixVerifier* verifier = matrix_verifier_current();
+
+    for (int bit = 0; error == MATRIX_SUCCESS && bit < bit_count; bit++)
     {
-        for (int i = 0; i < a->rows; i++)
+        if ((limbs[bit / 32] >> (bit % 32)) & 1)
         {
-            for (int j = 0; j < a->cols; j++)
+            if (reading >= 0)
             {
-                scaled_matrix->data[i][j] = a->data[i][j] * scalar;
+                sched_sync(&task);
+                reading = -1;
+                error = step.error;
+                acc ^= 1;
+                if (error != MATRIX_SUCCESS) break;
             }
+            step = (PowerAccumulate){&accumulated[acc], &powers[current], &accumulated[acc ^ 1],
+                                     verifier, MATRIX_SUCCESS};
+            sched_spawn(&task, power_accumulate, &step);
+            reading = current;
         }
-    }
-    else
-    {
-        for (int i = 0; i < a->rows; i++)
+
+        if (bit + 1 < bit_count)
         {
-            for (int j = 0; j < a->cols; j++)
+            int next = (current + 1) % 3;
+            if (next == reading)
             {
-                scaled_matrix->data[i][j] = multiply_mod(a->data[i][j], scalar, a->field_size);
+                sched_sync(&task);
+                reading = -1;
+                error = step.error;
+                acc ^= 1;
+                if (error != MATRIX_SUCCESS) break;
             }
+
+            TRACE_BEGIN("square");
+            error = packed_matrix_multiply(&powers[current], &powers[current], &powers[next]);
+            TRACE_END();
+            current = next;
         }
     }
+    if (reading >= 0)
+    {
+        sched_sync(&task);
+        if (error == MATRIX_SUCCESS) error = step.error;
+        acc ^= 1;
+    }
 
-    *result = scaled_matrix;
+    if (error == MATRIX_SUCCESS) error = matrix_create_uninit(n, n, p, &result_matrix);
+    if (error == MATRIX_SUCCESS)
+    {
+        error = packed_matrix_store(&accumulated[acc], result_matrix);
+        if (error != MATRIX_SUCCESS) matrix_free(result_matrix);
+    }
+
+    for (int i = 0; i < 2; i++) packed_matrix_free(&accumulated[i]);
+    for (int i = 0; i < 3; i++) packed_matrix_free(&powers[i]);
+    if (error != MATRIX_SUCCESS) return error;
+
+    *result = result_matrix;
     return MATRIX_SUCCESS;
 }
 
-int matrix_transpose(const Matrix* a, Matrix** result)
+/*
+ * Бинарное возведение в упакованном представлении ширины element_width.
+ * Показатель задан битами limbs (по 32 бита, младшие первыми), bit_count >= 1.
+ */
+static int matrix_power_binary(const Matrix* base, const uint32_t* limbs, int bit_count, Matrix** result)
 {
-    if (!a || !result)
+    if (power_concurrent_preferred(base->rows))
     {
-        return MATRIX_ERROR_NULL_POINTER;
+        return matrix_power_binary_concurrent(base, limbs, bit_count, result);
     }
-    if (a->rows < 1 || a->cols < 1)
+
+    TRACE_BEGIN("setup");
+    int n = base->rows;
+    Matrix* result_matrix;
+    PackedMatrix result_packed = {0}, power_packed = {0}, temp_packed = {0};
+    int error = packed_matrix_create(n, n, base->field_size, &result_packed);
+    if (error == MATRIX_SUCCESS) error = packed_matrix_identity(&result_packed);
+    if (error == MATRIX_SUCCESS) error = packed_matrix_create(n, n, base->field_size, &power_packed);
+    if (error == MATRIX_SUCCESS) error = packed_matrix_load(base, &power_packed);
+    if (error == MATRIX_SUCCESS) error = packed_matrix_create(n, n, base->field_size, &temp_packed);
+    TRACE_END();
+
+    // O(log(exp))
+    for (int bit = 0; error == MATRIX_SUCCESS && bit < bit_count; bit++)
     {
-        return MATRIX_ERROR_INVALID_SIZE;
+        if ((limbs[bit / 32] >> (bit % 32)) & 1)
+        {
+            // O(size^3)
+            TRACE_BEGIN("accumulate");
+            error = packed_matrix_multiply(&result_packed, &power_packed, &temp_packed);
+            TRACE_END();
+            if (error != MATRIX_SUCCESS) break;
+
+            PackedMatrix swap = result_packed;
+            result_packed = temp_packed;
+            temp_packed = swap;
+        }
+
+        if (bit + 1 < bit_count)
+        {
+            TRACE_BEGIN("square");
+            error = packed_matrix_multiply(&power_packed, &power_packed, &temp_packed);
+            TRACE_END();
+            if (error != MATRIX_SUCCESS) break;
+
+            PackedMatrix swap = power_packed;
+            power_packed = temp_packed;
+            temp_packed = swap;
+        }
     }
 
-    int error;
-    Matrix* transposed;
-    error = matrix_create(a->cols, a->rows, a->field_size, &transposed);
+    if (error == MATRIX_SUCCESS) error = matrix_create_uninit(n, n, base->field_size, &result_matrix);
+    if (error == MATRIX_SUCCESS)
+    {
+        error = packed_matrix_store(&result_packed, result_matrix);
+        if (error != MATRIX_SUCCESS) matrix_free(result_matrix);
+    }
+
+    packed_matrix_free(&result_packed);
+    packed_matrix_free(&power_packed);
+    packed_matrix_free(&temp_packed);
     if (error != MATRIX_SUCCESS) return error;
 
-    for (int i = 0; i < a->rows; i++)
+    *result = result_matrix;
+    return MATRIX_SUCCESS;
+}
+
+#define NAF_MAX_WINDOW 6                    /* наибольшая ширина окна wNAF */
+#define NAF_INVERSE_COST 8                  /* обращение матрицы в умножениях (оценка сверху) */
+
+static inline int exponent_bit(const uint32_t* limbs, int bit_count, int bit)
+{
+    return bit < bit_count ? (int)((limbs[bit / 32] >> (bit % 32)) & 1) : 0;
+}
+
+/*
+ * Записать показатель в виде wNAF ширины window: цифры нечётные, |d| < 2^(window-1),
+ * за каждой ненулевой цифрой следуют window - 1 нулей. digits — не меньше bit_count + 1.
+ * [RETURN] число цифр; в nonzero — число ненулевых, в negative — отрицательных
+ */
+static int naf_recode(const uint32_t* limbs, int bit_count, int window, signed char* digits,
+                      int* nonzero, int* negative)
+{
+    int count = 0, carry = 0;
+    *nonzero = 0;
+    *negative = 0;
+    for (int i = 0; i < bit_count || carry; )
     {
-        for (int j = 0; j < a->cols; j++)
+        int bit = exponent_bit(limbs, bit_count, i) + carry;
+        if ((bit & 1) == 0)
         {
-            transposed->data[j][i] = a->data[i][j];
+            digits[count++] = 0;
+            carry = bit >> 1;
+            i++;
+            continue;
         }
+
+        /* Окно из window битов плюс перенос, цифра — его вычет в (-2^(window-1), 2^(window-1)) */
+        int value = carry;
+        for (int k = 0; k < window; k++)
+        {
+            value += exponent_bit(limbs, bit_count, i + k) << k;
+        }
+        int digit = value & ((1 << window) - 1);
+        if (digit >= 1 << (window - 1)) digit -= 1 << window;
+        carry = (value - digit) >> window;
+
+        digits[count++] = (signed char)digit;
+        (*nonzero)++;
+        if (digit < 0) (*negative)++;
+        for (int k = 1; k < window; k++)
+        {
+            digits[count++] = 0;
+        }
+        i += window;
     }
+    while (count > 1 && digits[count - 1] == 0)
+    {
+        count--;
+    }
+    return count;
+}
 
-    *result = transposed;
-    return MATRIX_SUCCESS;
+/* Стоимость возведения по wNAF в умножениях матриц: возведения в квадрат, умножения, таблицы */
+static int naf_cost(int count, int nonzero, int negative, int window)
+{
+    int table = (window > 2) ? 1 << (window - 2) : 0;       /* A^2 и нечётные степени до 2^(w-1) - 1 */
+    int cost = (count - 1) + (nonzero - 1) + table;
+    if (negative > 0) cost += NAF_INVERSE_COST + table;
+    return cost;
 }
 
-int matrix_multiply(const Matrix* a, const Matrix* b, Matrix** result)
+/*
+ * Подобрать ширину окна wNAF для показателя.
+ * [IN] concurrent — 1, если бинарный метод считает накопление одновременно с квадратом
+ * [RETURN] ширина окна или 0, если бинарное возведение не дороже
+ */
+static int naf_choose_window(const uint32_t* limbs, int bit_count, int concurrent, signed char* digits)
 {
-    if (!a || !b || !result)
+    int popcount = 0;
+    for (int i = 0; i < (bit_count + 31) / 32; i++)
     {
-        return MATRIX_ERROR_NULL_POINTER;
+        popcount += __builtin_popcount(limbs[i]);
     }
-    if (a->rows < 1 || a->cols < 1 || b->rows < 1 || b->cols < 1)
+    /* При одновременных накоплении и квадрате по времени остаются только квадраты и последнее накопление */
+    int best_cost = concurrent ? bit_count : (bit_count - 1) + popcount;
+    int best_window = 0;
+
+    for (int window = 2; window <= NAF_MAX_WINDOW; window++)
     {
-        return MATRIX_ERROR_INVALID_SIZE;
+        int nonzero, negative;
+        int count = naf_recode(limbs, bit_count, window, digits, &nonzero, &negative);
+        int cost = naf_cost(count, nonzero, negative, window);
+        if (cost < best_cost)
+        {
+            best_cost = cost;
+            best_window = window;
+        }
     }
-    if (a->cols != b->rows)
+    return best_window;
+}
+
+/* Нечётные степени src^1, src^3, ..., src^(2 * count - 1) в table[0..count) */
+static int naf_table(const Matrix* src, PackedMatrix* table, int count, PackedMatrix* square)
+{
+    int error = packed_matrix_load(src, &table[0]);
+    if (error == MATRIX_SUCCESS && count > 1) error = packed_matrix_multiply(&table[0], &table[0], square);
+    for (int k = 1; error == MATRIX_SUCCESS && k < count; k++)
     {
-        return MATRIX_ERROR_DIMENSION;
+        error = packed_matrix_multiply(&table[k - 1], square, &table[k]);
     }
-    if (a->field_size != b->field_size)
+    return error;
+}
+
+/*
+ * Возведение слева направо по цифрам wNAF: отрицательные цифры умножают на степени A^-1.
+ * Длинные серии единичных битов стоят одно умножение и одно умножение на обратную.
+ */
+static int matrix_power_naf(const Matrix* base, const Matrix* inverse, const signed char* digits, int count,
+                            int window, Matrix** result)
+{
+    int n = base->rows;
+    ULL p = base->field_size;
+    int table_size = 1 << (window - 2);
+    int negative = 0;
+    for (int i = 0; i < count; i++)
     {
-        return MATRIX_ERROR_INVALID_FIELD;
+        if (digits[i] < 0) negative = 1;
     }
 
-    int error;
-    Matrix* product;
-    error = matrix_create(a->rows, b->cols, a->field_size, &product);
-    if (error != MATRIX_SUCCESS) return error;
+    /* [0, table_size) — степени A, [table_size, 2 * table_size) — степени A^-1, затем квадрат, итог, буфер */
+    int total = 2 * table_size + 3;
+    PackedMatrix* packed = (PackedMatrix*)calloc((size_t)total, sizeof(PackedMatrix));
+    if (!packed)
+    {
+        return MATRIX_ERROR_CREATION;
+    }
+    PackedMatrix* positive = packed;
+    PackedMatrix* negative_table = packed + table_size;
+    PackedMatrix* square = packed + 2 * table_size;
+    PackedMatrix* acc = square + 1;
+    PackedMatrix* temp = square + 2;
 
-    int i, j, k;
-    if (a->field_size == 0)
+    TRACE_BEGIN("naf_table");
+    int error = MATRIX_SUCCESS;
+    for (int i = 0; error == MATRIX_SUCCESS && i < total; i++)
     {
-        for (i = 0; i < a->rows; i++)
-        {
-            for (j = 0; j < b->cols; j++)
-            {
-                ULL sum = 0;
-                for (k = 0; k < a->cols; k++)
-                {
-                    sum += a->data[i][k] * b->data[k][j];
-                }
-                product->data[i][j] = sum;
-            }
-        }
+        if (i >= table_size && i < 2 * table_size && !negative) continue;
+        error = packed_matrix_create(n, n, p, &packed[i]);
     }
-    else
+    if (error == MATRIX_SUCCESS) error = naf_table(base, positive, table_size, square);
+    if (error == MATRIX_SUCCESS && negative) error = naf_table(inverse, negative_table, table_size, square);
+    TRACE_END();
+
+    int started = 0;
+    for (int i = count - 1; error == MATRIX_SUCCESS && i >= 0; i--)
     {
-        for (i = 0; i < a->rows; i++)
+        if (started)
         {
-            for (j = 0; j < b->cols; j++)
-            {
-                ULL sum = 0;
-                for (k = 0; k < a->cols; k++)
-                {
-                    sum = (sum + multiply_mod(a->data[i][k], b->data[k][j], a->field_size)) % a->field_size;
-                }
-                product->data[i][j] = sum;
-            }
+            TRACE_BEGIN("square");
+            error = packed_matrix_multiply(acc, acc, temp);
+            TRACE_END();
+            PackedMatrix swap = *acc;
+            *acc = *temp;
+            *temp = swap;
+        }
+
+        int digit = digits[i];
+        if (digit == 0 || error != MATRIX_SUCCESS) continue;
+
+        const PackedMatrix* entry = (digit > 0) ? &positive[(digit - 1) / 2] : &negative_table[(-digit - 1) / 2];
+        if (!started)
+        {
+            error = packed_matrix_copy(entry, acc);
+            started = 1;
+            continue;
         }
+
+        TRACE_BEGIN("accumulate");
+        error = packed_matrix_multiply(acc, entry, temp);
+        TRACE_END();
+        PackedMatrix swap = *acc;
+        *acc = *temp;
+        *temp = swap;
     }
 
-    *result = product;
+    Matrix* result_matrix;
+    if (error == MATRIX_SUCCESS) error = matrix_create_uninit(n, n, p, &result_matrix);
+    if (error == MATRIX_SUCCESS)
+    {
+        error = packed_matrix_store(acc, result_matrix);
+        if (error != MATRIX_SUCCESS) matrix_free(result_matrix);
+    }
+
+    for (int i = 0; i < total; i++)
+    {
+        packed_matrix_free(&packed[i]);
+    }
+    free(packed);
+    if (error != MATRIX_SUCCESS) return error;
+
+    *result = result_matrix;
     return MATRIX_SUCCESS;
 }
 
-
-int matrix_submatrix(const Matrix* a, int start_row, int end_row,
-                     int start_col, int end_col, Matrix** result)
+/*
+ * Возведение по битам limbs: над простым полем, если запись показателя в wNAF
+ * дешевле бинарной с учётом обращения, — по wNAF, иначе бинарным методом.
+ */
+static int matrix_power_packed(const Matrix* base, const uint32_t* limbs, int bit_count, Matrix** result)
 {
-    if (!a || !result)
+    if (!modular_is_prime(base->field_size))
     {
-        return MATRIX_ERROR_NULL_POINTER;
+        return matrix_power_binary(base, limbs, bit_count, result);
     }
-    if (start_row < 0 || end_row >= a->rows || start_col < 0 || end_col >= a->cols ||
-        start_row > end_row || start_col > end_col)
+
+    signed char* digits = (signed char*)malloc((size_t)bit_count + NAF_MAX_WINDOW + 1);
+    if (!digits)
     {
-        return MATRIX_ERROR_DIMENSION;
+        return MATRIX_ERROR_CREATION;
     }
 
-    int sub_rows = end_row - start_row + 1;
-    int sub_cols = end_col - start_col + 1;
+    int window = naf_choose_window(limbs, bit_count, power_concurrent_preferred(base->rows), digits);
+    int error = MATRIX_ERROR_SINGULAR;
+    if (window)
+    {
+        int nonzero, negative;
+        int count = naf_recode(limbs, bit_count, window, digits, &nonzero, &negative);
 
-    int error;
-    Matrix* submatrix;
-    error = matrix_create(sub_rows, sub_cols, a->field_size, &submatrix);
-    if (error != MATRIX_SUCCESS) return error;
+        Matrix* inverse = NULL;
+        error = negative ? matrix_inverse(base, &inverse) : MATRIX_SUCCESS;
+        if (error == MATRIX_SUCCESS) error = matrix_power_naf(base, inverse, digits, count, window, result);
+        matrix_free(inverse);
+    }
+    free(digits);
 
-    int i, j;
-    for (i = 0; i < sub_rows; i++)
+    /* Вырожденная матрица: обратной нет, остаётся бинарное возведение */
+    if (error == MATRIX_ERROR_SINGULAR)
     {
-        for (j = 0; j < sub_cols; j++)
-        {
-            submatrix->data[i][j] = a->data[start_row + i][start_col + j];
-        }
+        return matrix_power_binary(base, limbs, bit_count, result);
     }
+    return error;
+}
 
-    *result = submatrix;
-    return MATRIX_SUCCESS;
+/* Сопровождающая матрица рекурренты: метод Китамасы за O(n^2 log e) вместо O(n^3 log e) */
+static int matrix_companion_preferred(const Matrix* base)
+{
+    return base->field_size >= 2 && base->rows > 1 && matrix_companion_form(base, NULL) != COMPANION_NONE;
 }
 
 int matrix_power(const Matrix* base, ULL exponent, Matrix** result)
 {
+    TRACE_SCOPE("matrix_power");
+
     if (!base || !result)
     {
         return MATRIX_ERROR_NULL_POINTER;
@@ -387,7 +806,6 @@ int matrix_power(const Matrix* base, ULL exponent, Matrix** result)
 
     int error;
     Matrix* result_matrix;
-    Matrix* temp_power;
 
     if (exponent == 0)
     {
@@ -408,62 +826,317 @@ int matrix_power(const Matrix* base, ULL exponent, Matrix** result)
         return matrix_copy(base, result);
     }
 
-    error = matrix_create(base->rows, base->cols, base->field_size, &result_matrix);
-    if (error != MATRIX_SUCCESS) return error;
-    for (int i = 0; i < base->rows; i++)
+    if (matrix_companion_preferred(base))
     {
-        result_matrix->data[i][i] = 1;
+        return matrix_power_companion(base, exponent, result);
     }
 
-    error = matrix_copy(base, &temp_power);
-    if (error != MATRIX_SUCCESS)
+    if (base->field_size == 2)
     {
-        matrix_free(result_matrix);
-        return error;
+        return matrix_power_gf2(base, exponent, result);
     }
 
-    ULL exp = exponent;
+    uint32_t limbs[2] = {(uint32_t)exponent, (uint32_t)(exponent >> 32)};
+    return matrix_power_packed(base, limbs, 64 - __builtin_clzll(exponent), result);
+}
 
+/* Состояние пачки на одном бите показателей */
+typedef struct PowerBatch
+{
+    PackedMatrix* results;
+    PackedMatrix* powers;
+    PackedMatrix* temps;
+    const ULL* exponents;
+    int bit;
+    atomic_int error;
+} PowerBatch;
 
-    // O(log(exp))
-    while (exp > 0)
+static void power_batch_step(void* context, int begin, int end)
+{
+    PowerBatch* batch = (PowerBatch*)context;
+    for (int i = begin; i < end && atomic_load(&batch->error) == MATRIX_SUCCESS; i++)
     {
-        if (exp & 1)
+        ULL exponent = batch->exponents[i];
+        int error = MATRIX_SUCCESS;
+        if ((exponent >> batch->bit) & 1)
         {
-            Matrix* temp_result;
-            // O(size^3)
-            error = matrix_multiply(result_matrix, temp_power, &temp_result);
-            if (error != MATRIX_SUCCESS)
-            {
-                matrix_free(result_matrix);
-                matrix_free(temp_power);
-                return error;
-            }
-            matrix_free(result_matrix);
-            result_matrix = temp_result;
+            error = packed_matrix_multiply(&batch->results[i], &batch->powers[i], &batch->temps[i]);
+            PackedMatrix swap = batch->results[i];
+            batch->results[i] = batch->temps[i];
+            batch->temps[i] = swap;
+        }
+        if (error == MATRIX_SUCCESS && batch->bit < 63 && (exponent >> (batch->bit + 1)) != 0)
+        {
+            error = packed_matrix_multiply(&batch->powers[i], &batch->powers[i], &batch->temps[i]);
+            PackedMatrix swap = batch->powers[i];
+            batch->powers[i] = batch->temps[i];
+            batch->temps[i] = swap;
+        }
+        if (error != MATRIX_SUCCESS)
+        {
+            int expected = MATRIX_SUCCESS;
+            atomic_compare_exchange_strong(&batch->error, &expected, error);
+        }
+    }
+}
+
+int matrix_power_batch(const Matrix* const* bases, const ULL* exponents, int count, Matrix** results)
+{
+    TRACE_SCOPE("matrix_power_batch");
+
+    if (!bases || !exponents || !results)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+    if (count < 1)
+    {
+        return MATRIX_ERROR_INVALID_SIZE;
+    }
+    for (int i = 0; i < count; i++)
+    {
+        if (!bases[i])
+        {
+            return MATRIX_ERROR_NULL_POINTER;
+        }
+        if (bases[i]->rows != bases[i]->cols)
+        {
+            return MATRIX_ERROR_NOT_SQUARE;
         }
+        if (bases[i]->rows != bases[0]->rows)
+        {
+            return MATRIX_ERROR_DIMENSION;
+        }
+        if (bases[i]->field_size != bases[0]->field_size)
+        {
+            return MATRIX_ERROR_INVALID_FIELD;
+        }
+    }
+
+    int n = bases[0]->rows;
+    ULL p = bases[0]->field_size;
+    PackedMatrix* packed = (PackedMatrix*)calloc(3 * (size_t)count, sizeof(PackedMatrix));
+    Matrix** matrices = (Matrix**)calloc((size_t)count, sizeof(Matrix*));
+    int error = (packed && matrices) ? MATRIX_SUCCESS : MATRIX_ERROR_CREATION;
+
+    PowerBatch batch = {packed, packed + count, packed + 2 * (size_t)count, exponents, 0, MATRIX_SUCCESS};
+    ULL highest = 0;
+    for (int i = 0; error == MATRIX_SUCCESS && i < count; i++)
+    {
+        error = packed_matrix_create(n, n, p, &batch.results[i]);
+        if (error == MATRIX_SUCCESS) error = packed_matrix_identity(&batch.results[i]);
+        if (error == MATRIX_SUCCESS) error = packed_matrix_create(n, n, p, &batch.powers[i]);
+        if (error == MATRIX_SUCCESS) error = packed_matrix_load(bases[i], &batch.powers[i]);
+        if (error == MATRIX_SUCCESS) error = packed_matrix_create(n, n, p, &batch.temps[i]);
+        highest |= exponents[i];
+    }
+
+    /* Биты до старшего среди всех показателей; матрица с коротким показателем просто пропускает шаги */
+    int bit_count = highest ? 64 - __builtin_clzll(highest) : 0;
+    for (int bit = 0; error == MATRIX_SUCCESS && bit < bit_count; bit++)
+    {
+        batch.bit = bit;
+        sched_parallel_for(0, count, 1, power_batch_step, &batch);
+        error = atomic_load(&batch.error);
+    }
+
+    for (int i = 0; error == MATRIX_SUCCESS && i < count; i++)
+    {
+        error = matrix_create_uninit(n, n, p, &matrices[i]);
+        if (error == MATRIX_SUCCESS) error = packed_matrix_store(&batch.results[i], matrices[i]);
+    }
+
+    if (packed)
+    {
+        for (int i = 0; i < 3 * count; i++) packed_matrix_free(&packed[i]);
+        free(packed);
+    }
+    if (error != MATRIX_SUCCESS)
+    {
+        for (int i = 0; matrices && i < count; i++) matrix_free(matrices[i]);
+        free(matrices);
+        return error;
+    }
+
+    memcpy(results, matrices, (size_t)count * sizeof(Matrix*));
+    free(matrices);
+    return MATRIX_SUCCESS;
+}
+
+int matrix_power_signed(const Matrix* base, long long exponent, Matrix** result)
+{
+    if (!base || !result)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+    if (exponent >= 0)
+    {
+        return matrix_power(base, (ULL)exponent, result);
+    }
 
-        exp >>= 1;
-        if (exp > 0)
+    Matrix* inverse;
+    int error = matrix_inverse(base, &inverse);
+    if (error != MATRIX_SUCCESS) return error;
+
+    error = matrix_power(inverse, -(ULL)exponent, result);
+    matrix_free(inverse);
+    return error;
+}
+
+/*
+ * S_k = I + A + ... + A^(k-1), P_k = A^k. Удвоение: S_2k = S_k + P_k S_k, P_2k = P_k^2;
+ * шаг: S_(k+1) = S_k + P_k, P_(k+1) = P_k A. Деления нет, поэтому подходит любой модуль.
+ */
+int matrix_power_series(const Matrix* base, ULL exponent, Matrix** result)
+{
+    TRACE_SCOPE("power_series");
+
+    if (!base || !result)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+    if (base->rows != base->cols)
+    {
+        return MATRIX_ERROR_NOT_SQUARE;
+    }
+
+    int n = base->rows;
+    ULL p = base->field_size;
+    Matrix* result_matrix = NULL;
+    PackedMatrix a = {0}, sum = {0}, power = {0}, temp = {0};
+    int error = packed_matrix_create(n, n, p, &a);
+    if (error == MATRIX_SUCCESS) error = packed_matrix_load(base, &a);
+    if (error == MATRIX_SUCCESS) error = packed_matrix_create(n, n, p, &sum);
+    if (error == MATRIX_SUCCESS) error = packed_matrix_identity(&sum);
+    if (error == MATRIX_SUCCESS) error = packed_matrix_create(n, n, p, &power);
+    if (error == MATRIX_SUCCESS) error = packed_matrix_copy(&a, &power);
+    if (error == MATRIX_SUCCESS) error = packed_matrix_create(n, n, p, &temp);
+
+    /* k = 1 (S = I, P = A), далее по битам exponent от старшего; в конце k == exponent */
+    int bit = (exponent == 0) ? -1 : 62 - __builtin_clzll(exponent);
+    for (; error == MATRIX_SUCCESS && bit >= 0; bit--)
+    {
+        TRACE_BEGIN("double");
+        error = packed_matrix_multiply(&power, &sum, &temp);
+        if (error == MATRIX_SUCCESS) error = packed_matrix_add(&sum, &temp, &sum);
+        if (error == MATRIX_SUCCESS) error = packed_matrix_multiply(&power, &power, &temp);
+        TRACE_END();
+        if (error != MATRIX_SUCCESS) break;
+
+        PackedMatrix swap = power;
+        power = temp;
+        temp = swap;
+
+        if ((exponent >> bit) & 1)
         {
-            Matrix* temp_square;
-            error = matrix_multiply(temp_power, temp_power, &temp_square);
-            if (error != MATRIX_SUCCESS)
-            {
-                matrix_free(result_matrix);
-                matrix_free(temp_power);
-                return error;
-            }
-            matrix_free(temp_power);
-            temp_power = temp_square;
+            TRACE_BEGIN("step");
+            error = packed_matrix_add(&sum, &power, &sum);
+            if (error == MATRIX_SUCCESS) error = packed_matrix_multiply(&power, &a, &temp);
+            TRACE_END();
+            if (error != MATRIX_SUCCESS) break;
+
+            swap = power;
+            power = temp;
+            temp = swap;
         }
     }
 
-    matrix_free(temp_power);
+    /* S_(e+1) = S_e + A^e; при e == 0 это I */
+    if (error == MATRIX_SUCCESS && exponent > 0) error = packed_matrix_add(&sum, &power, &sum);
+    if (error == MATRIX_SUCCESS) error = matrix_create_uninit(n, n, p, &result_matrix);
+    if (error == MATRIX_SUCCESS) error = packed_matrix_store(&sum, result_matrix);
+
+    packed_matrix_free(&a);
+    packed_matrix_free(&sum);
+    packed_matrix_free(&power);
+    packed_matrix_free(&temp);
+    if (error != MATRIX_SUCCESS)
+    {
+        matrix_free(result_matrix);
+        return error;
+    }
+
     *result = result_matrix;
     return MATRIX_SUCCESS;
 }
 
+int matrix_power_ex(const Matrix* base, ULL exponent, const MatrixPowerOptions* options, Matrix** result)
+{
+    if (!base || !result)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+
+    if (options && options->reduce_exponent && exponent > 1 && modular_is_prime(base->field_size))
+    {
+        BigInt big_exponent;
+        bigint_init(&big_exponent);
+        int error = bigint_set_ull(&big_exponent, exponent);
+        if (error == MATRIX_SUCCESS) error = matrix_power_big(base, &big_exponent, options, result);
+        bigint_free(&big_exponent);
+        return error;
+    }
+    if (options && options->decompose_modulus && base->field_size > 2 && exponent > 1)
+    {
+        return matrix_power_components(base, exponent, result);
+    }
+    return matrix_power(base, exponent, result);
+}
+
+int matrix_power_big(const Matrix* base, const BigInt* exponent, const MatrixPowerOptions* options,
+                     Matrix** result)
+{
+    TRACE_SCOPE("matrix_power_big");
+
+    if (!base || !exponent || !result)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+    if (base->rows != base->cols)
+    {
+        return MATRIX_ERROR_NOT_SQUARE;
+    }
+
+    BigInt reduced;
+    bigint_init(&reduced);
+    int error = MATRIX_SUCCESS;
+
+    /* Над простым полем A^E = A^E', где E' — остаток E по периоду степеней A. Период
+       порядка p^n, поэтому более короткие показатели приведение не уменьшает */
+    int field_bits = 64 - __builtin_clzll(base->field_size | 1);
+    if (options && options->reduce_exponent && modular_is_prime(base->field_size) &&
+        bigint_bit_length(exponent) > base->rows * field_bits)
+    {
+        TRACE_BEGIN("reduce_exponent");
+        error = matrix_reduce_exponent(base, exponent, &reduced);
+        TRACE_END();
+        if (error == MATRIX_SUCCESS) exponent = &reduced;
+    }
+
+    ULL small_exponent;
+    if (error == MATRIX_SUCCESS && bigint_to_ull(exponent, &small_exponent))
+    {
+        MatrixPowerOptions plain = options ? *options : (MatrixPowerOptions){0};
+        plain.reduce_exponent = 0;
+        error = matrix_power_ex(base, small_exponent, &plain, result);
+    }
+    else if (error == MATRIX_SUCCESS && matrix_companion_preferred(base))
+    {
+        error = matrix_power_companion_big(base, exponent, result);
+    }
+    else if (error == MATRIX_SUCCESS && modular_is_prime(base->field_size) &&
+             matrix_cayley_hamilton_preferred_big(base->field_size, base->rows, exponent))
+    {
+        error = matrix_power_cayley_hamilton_big(base, exponent, result);
+    }
+    else if (error == MATRIX_SUCCESS)
+    {
+        error = matrix_power_packed(base, exponent->limbs, bigint_bit_length(exponent), result);
+    }
+
+    bigint_free(&reduced);
+    return error;
+}
+
 
 int matrix_print(const Matrix* matrix)
 {
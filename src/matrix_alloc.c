@@ -0,0 +1,208 @@
+#include "../include/matrix_alloc.h"
+
+#define ALLOC_ALIGNMENT 64
+#define ALLOC_DEFAULT_CHUNK ((size_t)64 << 20)
+#define ALLOC_CLASS_STEPS 4                          /* классов на каждую степень двойки */
+#define ALLOC_CLASS_COUNT (64 * ALLOC_CLASS_STEPS)
+
+typedef struct ArenaChunk
+{
+    struct ArenaChunk* next;
+    size_t size;
+} ArenaChunk;
+
+typedef struct FreeBlock
+{
+    struct FreeBlock* next;
+} FreeBlock;
+
+struct MatrixAllocator
+{
+    size_t chunk_size;
+    ArenaChunk* chunks;
+    char* bump;
+    char* bump_end;
+    FreeBlock* free_lists[ALLOC_CLASS_COUNT];
+    MatrixAllocatorStats stats;
+};
+
+static _Thread_local MatrixAllocator* current_allocator = NULL;
+
+static size_t align_up(size_t value, size_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+/*
+ * Класс размера: 2^b * (1 + k/4), k = 0..3 — потери на округление не больше 25%.
+ * Шаг не меньше ALLOC_ALIGNMENT, иначе блок, выделенный сдвигом bump, сбил бы выравнивание
+ * следующих: до 256 байт классов меньше четырёх на степень двойки.
+ */
+static int size_class(size_t size, size_t* class_size)
+{
+    if (size < ALLOC_ALIGNMENT) size = ALLOC_ALIGNMENT;
+
+    int b = 63 - __builtin_clzll((unsigned long long)size);
+    size_t base = (size_t)1 << b;
+    size_t step = base / ALLOC_CLASS_STEPS;
+    if (step < ALLOC_ALIGNMENT) step = ALLOC_ALIGNMENT;
+    size_t k = (size - base + step - 1) / step;
+    if (k * step == base)
+    {
+        /* Округлилось до следующей степени двойки: это её класс k = 0 */
+        b++;
+        base <<= 1;
+        k = 0;
+    }
+
+    *class_size = base + k * step;
+    return b * ALLOC_CLASS_STEPS + (int)k;
+}
+
+int matrix_allocator_create(size_t chunk_size, MatrixAllocator** result)
+{
+    if (!result)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+
+    MatrixAllocator* allocator = (MatrixAllocator*)calloc(1, sizeof(MatrixAllocator));
+    if (!allocator)
+    {
+        return MATRIX_ERROR_CREATION;
+    }
+    allocator->chunk_size = align_up(chunk_size ? chunk_size : ALLOC_DEFAULT_CHUNK, ALLOC_ALIGNMENT);
+
+    *result = allocator;
+    return MATRIX_SUCCESS;
+}
+
+int matrix_allocator_destroy(MatrixAllocator* allocator)
+{
+    if (!allocator)
+    {
+        return MATRIX_SUCCESS;
+    }
+    if (current_allocator == allocator)
+    {
+        current_allocator = NULL;
+    }
+
+    ArenaChunk* chunk = allocator->chunks;
+    while (chunk)
+    {
+        ArenaChunk* next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+    free(allocator);
+    return MATRIX_SUCCESS;
+}
+
+MatrixAllocator* matrix_allocator_bind(MatrixAllocator* allocator)
+{
+    MatrixAllocator* previous = current_allocator;
+    current_allocator = allocator;
+    return previous;
+}
+
+MatrixAllocator* matrix_allocator_current(void)
+{
+    return current_allocator;
+}
+
+static void* arena_new_chunk(MatrixAllocator* allocator, size_t payload)
+{
+    size_t header = align_up(sizeof(ArenaChunk), ALLOC_ALIGNMENT);
+    if (payload > SIZE_MAX - header)
+    {
+        return NULL;
+    }
+
+    ArenaChunk* chunk = (ArenaChunk*)aligned_alloc(ALLOC_ALIGNMENT, header + payload);
+    if (!chunk)
+    {
+        return NULL;
+    }
+    chunk->size = header + payload;
+    chunk->next = allocator->chunks;
+    allocator->chunks = chunk;
+    allocator->stats.arena_bytes += chunk->size;
+    return (char*)chunk + header;
+}
+
+void* matrix_allocator_acquire(MatrixAllocator* allocator, size_t size)
+{
+    if (!allocator || size == 0 || size > (SIZE_MAX >> 2))
+    {
+        return NULL;
+    }
+
+    size_t class_size;
+    int index = size_class(size, &class_size);
+
+    FreeBlock* block = allocator->free_lists[index];
+    if (block)
+    {
+        allocator->free_lists[index] = block->next;
+        allocator->stats.acquired++;
+        allocator->stats.reused++;
+        allocator->stats.live_bytes += class_size;
+        return block;
+    }
+
+    void* memory;
+    if (class_size > allocator->chunk_size / 4)
+    {
+        memory = arena_new_chunk(allocator, class_size);
+    }
+    else
+    {
+        if ((size_t)(allocator->bump_end - allocator->bump) < class_size)
+        {
+            char* start = (char*)arena_new_chunk(allocator, allocator->chunk_size);
+            if (!start)
+            {
+                return NULL;
+            }
+            allocator->bump = start;
+            allocator->bump_end = start + allocator->chunk_size;
+        }
+        memory = allocator->bump;
+        allocator->bump += class_size;
+    }
+
+    if (memory)
+    {
+        allocator->stats.acquired++;
+        allocator->stats.live_bytes += class_size;
+    }
+    return memory;
+}
+
+void matrix_allocator_release(MatrixAllocator* allocator, void* block, size_t size)
+{
+    if (!allocator || !block)
+    {
+        return;
+    }
+
+    size_t class_size;
+    int index = size_class(size, &class_size);
+
+    FreeBlock* free_block = (FreeBlock*)block;
+    free_block->next = allocator->free_lists[index];
+    allocator->free_lists[index] = free_block;
+    allocator->stats.live_bytes -= class_size;
+}
+
+int matrix_allocator_stats(const MatrixAllocator* allocator, MatrixAllocatorStats* stats)
+{
+    if (!allocator || !stats)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+
+    *stats = allocator->stats;
+    return MATRIX_SUCCESS;
+}
@@ -0,0 +1,185 @@
+#include "../include/matrix_fma.h"
+
+#include <math.h>
+
+#define FMA_BLOCK_COLS 256          /* столбцов c в блоке */
+#define FMA_BLOCK_INNER 128         /* наибольшая длина блока по k (по кэшу) */
+#define FMA_TILE_ROWS 4             /* строк c в регистровом блоке */
+
+/* Вектор из FMA_VEC_DOUBLES элементов: 256 бит при AVX, иначе 128 бит (SSE2) */
+#if defined(__AVX__)
+#define FMA_VEC_DOUBLES 4
+#else
+#define FMA_VEC_DOUBLES 2
+#endif
+#define FMA_TILE_COLS (2 * FMA_VEC_DOUBLES)   /* столбцов c в регистровом блоке */
+
+int fma_field_supported(ULL field_size)
+{
+    return field_size >= 2 && field_size < FMA_FIELD_LIMIT;
+}
+
+int fma_field_preferred(ULL field_size)
+{
+#if defined(__AVX__)
+    return field_size > (1ULL << 8) && field_size < FMA_PREFERRED_LIMIT;
+#else
+    (void)field_size;
+    return 0;
+#endif
+}
+
+int fma_max_inner_block(ULL field_size)
+{
+    /* аккумулятор < p, плюс k произведений по (p-1)^2, плюс запас p на приведение: < 2^53 */
+    ULL max_product = (field_size - 1) * (field_size - 1);
+    ULL budget = (1ULL << 53) - 2 * field_size;
+    ULL block = max_product ? budget / max_product : budget;
+    if (block < 1) block = 1;
+    return block > (ULL)INT32_MAX ? INT32_MAX : (int)block;
+}
+
+static inline double fma_reduce(double x, double p, double inverse)
+{
+    double r = x - floor(x * inverse) * p;
+    r += (r < 0.0) ? p : 0.0;
+    r -= (r >= p) ? p : 0.0;
+    return r;
+}
+
+typedef double fma_vec __attribute__((vector_size(FMA_VEC_DOUBLES * sizeof(double))));
+
+static inline fma_vec fma_load(const double* p)
+{
+    fma_vec v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline void fma_store(double* p, fma_vec v)
+{
+    memcpy(p, &v, sizeof(v));
+}
+
+/* Блок FMA_TILE_ROWS x FMA_TILE_COLS элементов c в регистрах (два вектора на строку) */
+static inline void fma_tile(const double* a, const double* b, double* c, int inner, int cols,
+                                int i0, int j0, int k0, int k1)
+{
+    double* c0 = c + (size_t)i0 * cols + j0;
+    double* c1 = c0 + cols;
+    double* c2 = c1 + cols;
+    double* c3 = c2 + cols;
+    fma_vec acc00 = fma_load(c0), acc01 = fma_load(c0 + FMA_VEC_DOUBLES);
+    fma_vec acc10 = fma_load(c1), acc11 = fma_load(c1 + FMA_VEC_DOUBLES);
+    fma_vec acc20 = fma_load(c2), acc21 = fma_load(c2 + FMA_VEC_DOUBLES);
+    fma_vec acc30 = fma_load(c3), acc31 = fma_load(c3 + FMA_VEC_DOUBLES);
+
+    const double* a0 = a + (size_t)i0 * inner;
+    const double* a1 = a0 + inner;
+    const double* a2 = a1 + inner;
+    const double* a3 = a2 + inner;
+    for (int k = k0; k < k1; k++)
+    {
+        const double* b_row = b + (size_t)k * cols + j0;
+        fma_vec b0 = fma_load(b_row), b1 = fma_load(b_row + FMA_VEC_DOUBLES);
+        acc00 += a0[k] * b0; acc01 += a0[k] * b1;
+        acc10 += a1[k] * b0; acc11 += a1[k] * b1;
+        acc20 += a2[k] * b0; acc21 += a2[k] * b1;
+        acc30 += a3[k] * b0; acc31 += a3[k] * b1;
+    }
+
+    fma_store(c0, acc00); fma_store(c0 + FMA_VEC_DOUBLES, acc01);
+    fma_store(c1, acc10); fma_store(c1 + FMA_VEC_DOUBLES, acc11);
+    fma_store(c2, acc20); fma_store(c2 + FMA_VEC_DOUBLES, acc21);
+    fma_store(c3, acc30); fma_store(c3 + FMA_VEC_DOUBLES, acc31);
+}
+
+/* Края, не кратные размеру блока: построчный цикл i-k-j */
+static void fma_edge(const double* a, const double* b, double* c, int inner, int cols,
+                     int i0, int i1, int j0, int j1, int k0, int k1)
+{
+    for (int i = i0; i < i1; i++)
+    {
+        const double* a_row = a + (size_t)i * inner;
+        double* c_row = c + (size_t)i * cols;
+        for (int k = k0; k < k1; k++)
+        {
+            const double x = a_row[k];
+            const double* b_row = b + (size_t)k * cols;
+            for (int j = j0; j < j1; j++)
+            {
+                c_row[j] += x * b_row[j];
+            }
+        }
+    }
+}
+
+void fma_multiply(const double* a, const double* b, double* c, int rows, int inner, int cols,
+                  ULL field_size)
+{
+    const double p = (double)field_size;
+    const double inverse = 1.0 / p;
+
+    int k_block = fma_max_inner_block(field_size);
+    if (k_block > FMA_BLOCK_INNER) k_block = FMA_BLOCK_INNER;
+
+    memset(c, 0, (size_t)rows * cols * sizeof(double));
+
+    for (int j0 = 0; j0 < cols; j0 += FMA_BLOCK_COLS)
+    {
+        int j1 = (cols - j0 < FMA_BLOCK_COLS) ? cols : j0 + FMA_BLOCK_COLS;
+        int j_tiles = j0 + (j1 - j0) / FMA_TILE_COLS * FMA_TILE_COLS;
+        int i_tiles = rows / FMA_TILE_ROWS * FMA_TILE_ROWS;
+
+        for (int k0 = 0; k0 < inner; k0 += k_block)
+        {
+            int k1 = (inner - k0 < k_block) ? inner : k0 + k_block;
+
+            for (int i = 0; i < i_tiles; i += FMA_TILE_ROWS)
+            {
+                for (int j = j0; j < j_tiles; j += FMA_TILE_COLS)
+                {
+                    fma_tile(a, b, c, inner, cols, i, j, k0, k1);
+                }
+            }
+            fma_edge(a, b, c, inner, cols, 0, i_tiles, j_tiles, j1, k0, k1);
+            fma_edge(a, b, c, inner, cols, i_tiles, rows, j0, j1, k0, k1);
+
+            /* Приведение между блоками по k: дальше аккумулятор снова < p */
+            for (int i = 0; i < rows; i++)
+            {
+                double* c_row = c + (size_t)i * cols;
+                for (int j = j0; j < j1; j++)
+                {
+                    c_row[j] = fma_reduce(c_row[j], p, inverse);
+                }
+            }
+        }
+    }
+}
+
+void fma_add(const double* a, const double* b, double* c, size_t count, ULL field_size)
+{
+    const double p = (double)field_size;
+    for (size_t i = 0; i < count; i++)
+    {
+        double sum = a[i] + b[i];
+        c[i] = (sum >= p) ? sum - p : sum;
+    }
+}
+
+void fma_from_ull(const ULL* src, double* dst, size_t count, ULL field_size)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        dst[i] = (double)(src[i] < field_size ? src[i] : src[i] % field_size);
+    }
+}
+
+void fma_to_ull(const double* src, ULL* dst, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        dst[i] = (ULL)src[i];
+    }
+}
@@ -0,0 +1,925 @@
+#include "../include/matrix_kernels.h"
+#include "../include/matrix_fma.h"
+#include "../include/matrix_rns.h"
+#include "../include/matrix_verify.h"
+#include "../include/matrix_tune.h"
+#include "../include/matrix_numa.h"
+#include "../include/matrix_sched.h"
+
+typedef unsigned __int128 U128;
+
+#define U128_MAX (~(U128)0)
+
+/*
+ * Ядра для одной ширины элемента T с аккумулятором ACC.
+ * Слагаемое произведения не больше (p-1)^2, поэтому до приведения по модулю
+ * в аккумуляторе можно сложить ACC_MAX / (p-1)^2 произведений.
+ * Умножение считает столбцы [col_begin, col_end) всех rows строк: a и c указывают на первую
+ * строку плитки, cols — длина строки b и c.
+ */
+#define DEFINE_WIDTH_KERNELS(SUFFIX, T, ACC, ACC_MAX)                                              \
+static void multiply_##SUFFIX(const T* a, const T* b, T* c, int rows, int inner, int cols,         \
+                              int col_begin, int col_end, int block, ULL p, ACC* acc)              \
+{                                                                                                  \
+    ACC max_product = (ACC)(p - 1) * (ACC)(p - 1);                                                 \
+    ACC limit = max_product ? (ACC)(ACC_MAX) / max_product : (ACC)(ACC_MAX);                       \
+    for (int j0 = col_begin; j0 < col_end; j0 += block)                                            \
+    {                                                                                              \
+        const int width = (col_end - j0 < block) ? col_end - j0 : block;                           \
+        for (int i = 0; i < rows; i++)                                                             \
+        {                                                                                          \
+            const T* a_row = a + (size_t)i * inner;                                                \
+            memset(acc, 0, (size_t)width * sizeof(ACC));                                           \
+            ACC count = 0;                                                                         \
+            for (int k = 0; k < inner; k++)                                                        \
+            {                                                                                      \
+                if (count >= limit)                                                                \
+                {                                                                                  \
+                    for (int j = 0; j < width; j++) acc[j] %= p;                                   \
+                    count = 1;                                                                     \
+                }                                                                                  \
+                const ACC x = a_row[k];                                                            \
+                const T* b_row = b + (size_t)k * cols + j0;                                        \
+                for (int j = 0; j < width; j++)                                                    \
+                {                                                                                  \
+                    acc[j] += x * (ACC)b_row[j];                                                   \
+                }                                                                                  \
+                count++;                                                                           \
+            }                                                                                      \
+            T* c_row = c + (size_t)i * cols + j0;                                                  \
+            for (int j = 0; j < width; j++)                                                        \
+            {                                                                                      \
+                c_row[j] = (T)(acc[j] % p);                                                        \
+            }                                                                                      \
+        }                                                                                          \
+    }                                                                                              \
+}                                                                                                  \
+                                                                                                   \
+static void add_##SUFFIX(const T* a, const T* b, T* c, size_t count, ULL p)                        \
+{                                                                                                  \
+    for (size_t i = 0; i < count; i++)                                                             \
+    {                                                                                              \
+        ACC sum = (ACC)a[i] + (ACC)b[i];                                                           \
+        c[i] = (T)(sum >= p ? sum - p : sum);                                                      \
+    }                                                                                              \
+}                                                                                                  \
+                                                                                                   \
+static void pack_##SUFFIX(const ULL* src, T* dst, size_t count, ULL p)                             \
+{                                                                                                  \
+    if (p == 0)                                                                                    \
+    {                                                                                              \
+        for (size_t i = 0; i < count; i++) dst[i] = (T)src[i];                                     \
+        return;                                                                                    \
+    }                                                                                              \
+    for (size_t i = 0; i < count; i++) dst[i] = (T)(src[i] < p ? src[i] : src[i] % p);            \
+}                                                                                                  \
+                                                                                                   \
+static void unpack_##SUFFIX(const T* src, ULL* dst, size_t count)                                  \
+{                                                                                                  \
+    for (size_t i = 0; i < count; i++) dst[i] = src[i];                                            \
+}
+
+DEFINE_WIDTH_KERNELS(u8, uint8_t, uint32_t, UINT32_MAX)
+DEFINE_WIDTH_KERNELS(u16, uint16_t, uint64_t, UINT64_MAX)
+DEFINE_WIDTH_KERNELS(u32, uint32_t, uint64_t, UINT64_MAX)
+DEFINE_WIDTH_KERNELS(u64, ULL, U128, U128_MAX)
+
+/* field_size == 0: арифметика по модулю 2^64 без приведения */
+static void multiply_wrap_u64(const ULL* a, const ULL* b, ULL* c, int rows, int inner, int cols,
+                              int col_begin, int col_end, int block)
+{
+    for (int j0 = col_begin; j0 < col_end; j0 += block)
+    {
+        const int width = (col_end - j0 < block) ? col_end - j0 : block;
+        for (int i = 0; i < rows; i++)
+        {
+            const ULL* a_row = a + (size_t)i * inner;
+            ULL* c_row = c + (size_t)i * cols + j0;
+            memset(c_row, 0, (size_t)width * sizeof(ULL));
+            for (int k = 0; k < inner; k++)
+            {
+                const ULL x = a_row[k];
+                const ULL* b_row = b + (size_t)k * cols + j0;
+                for (int j = 0; j < width; j++)
+                {
+                    c_row[j] += x * b_row[j];
+                }
+            }
+        }
+    }
+}
+
+static void add_wrap_u64(const ULL* a, const ULL* b, ULL* c, size_t count)
+{
+    for (size_t i = 0; i < count; i++) c[i] = a[i] + b[i];
+}
+
+static size_t packed_bytes(const PackedMatrix* m)
+{
+    return (size_t)m->rows * (size_t)m->cols * (size_t)m->width;
+}
+
+int packed_matrix_format(ULL field_size)
+{
+    return matrix_tune_format(field_size);
+}
+
+int packed_matrix_create(int rows, int cols, ULL field_size, PackedMatrix* result)
+{
+    if (!result)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+    if (rows < 1 || cols < 1)
+    {
+        return MATRIX_ERROR_INVALID_SIZE;
+    }
+
+    result->rows = rows;
+    result->cols = cols;
+    result->format = packed_matrix_format(field_size);
+    result->width = (result->format == PACKED_DOUBLE) ? (int)sizeof(double) : matrix_element_width(field_size);
+    result->field_size = field_size;
+    result->owns_data = 1;
+    result->allocator = matrix_allocator_current();
+
+    if ((size_t)cols > SIZE_MAX / 16 / (size_t)rows)
+    {
+        return MATRIX_ERROR_INVALID_SIZE;
+    }
+    /* Множитель, созданный вызывающим потоком, читают все рабочие потоки: страницы по узлам
+       чередуются; буфер закреплённого рабочего потока остаётся на его узле (matrix_numa.h) */
+    size_t bytes = (packed_bytes(result) + 63) & ~(size_t)63;
+    int placement = matrix_numa_pinned() ? NUMA_PLACE_LOCAL : NUMA_PLACE_INTERLEAVE;
+    result->data = result->allocator ? matrix_allocator_acquire(result->allocator, bytes)
+                                     : matrix_numa_alloc(bytes, placement, "packed");
+    if (!result->data)
+    {
+        return MATRIX_ERROR_CREATION;
+    }
+    return MATRIX_SUCCESS;
+}
+
+static void packed_matrix_alias(Matrix* src, PackedMatrix* result)
+{
+    result->data = src->data[0];
+    result->rows = src->rows;
+    result->cols = src->cols;
+    result->width = (int)sizeof(ULL);
+    result->format = PACKED_INTEGER;
+    result->field_size = src->field_size;
+    result->owns_data = 0;
+    result->allocator = NULL;
+}
+
+/* Упаковать count элементов src в dst, начиная с элемента offset */
+static void pack_span(const ULL* src, PackedMatrix* dst, size_t offset, size_t count)
+{
+    ULL p = dst->field_size;
+    if (dst->format == PACKED_DOUBLE)
+    {
+        fma_from_ull(src, (double*)dst->data + offset, count, p);
+        return;
+    }
+    switch (dst->width)
+    {
+        case 1: pack_u8(src, (uint8_t*)dst->data + offset, count, p); break;
+        case 2: pack_u16(src, (uint16_t*)dst->data + offset, count, p); break;
+        case 4: pack_u32(src, (uint32_t*)dst->data + offset, count, p); break;
+        default: pack_u64(src, (ULL*)dst->data + offset, count, p); break;
+    }
+}
+
+/* Распаковать count элементов src, начиная с элемента offset, в dst */
+static void unpack_span(const PackedMatrix* src, size_t offset, ULL* dst, size_t count)
+{
+    if (src->format == PACKED_DOUBLE)
+    {
+        fma_to_ull((const double*)src->data + offset, dst, count);
+        return;
+    }
+    switch (src->width)
+    {
+        case 1: unpack_u8((const uint8_t*)src->data + offset, dst, count); break;
+        case 2: unpack_u16((const uint16_t*)src->data + offset, dst, count); break;
+        case 4: unpack_u32((const uint32_t*)src->data + offset, dst, count); break;
+        default:
+            if ((const ULL*)src->data + offset != dst) unpack_u64((const ULL*)src->data + offset, dst, count);
+            break;
+    }
+}
+
+int packed_matrix_load(const Matrix* src, PackedMatrix* dst)
+{
+    if (!src || !dst)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+    if (src->rows != dst->rows || src->cols != dst->cols)
+    {
+        return MATRIX_ERROR_DIMENSION;
+    }
+
+    pack_span(src->data[0], dst, 0, (size_t)src->rows * src->cols);
+    return MATRIX_SUCCESS;
+}
+
+static int is_reduced(const Matrix* m)
+{
+    if (m->field_size == 0) return 1;
+
+    const ULL* data = m->data[0];
+    size_t count = (size_t)m->rows * m->cols;
+    ULL above = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        above |= (ULL)(data[i] >= m->field_size);
+    }
+    return above == 0;
+}
+
+int packed_matrix_view(const Matrix* src, PackedMatrix* result)
+{
+    if (!src || !result)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+
+    /* 8-байтовые элементы используются без копии, если они уже приведены по модулю */
+    if (packed_matrix_format(src->field_size) == PACKED_INTEGER &&
+        matrix_element_width(src->field_size) == (int)sizeof(ULL) && is_reduced(src))
+    {
+        packed_matrix_alias((Matrix*)src, result);
+        return MATRIX_SUCCESS;
+    }
+
+    int error = packed_matrix_create(src->rows, src->cols, src->field_size, result);
+    if (error != MATRIX_SUCCESS) return error;
+
+    error = packed_matrix_load(src, result);
+    if (error != MATRIX_SUCCESS)
+    {
+        packed_matrix_free(result);
+    }
+    return error;
+}
+
+int packed_matrix_target(Matrix* dst, PackedMatrix* result)
+{
+    if (!dst || !result)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+
+    if (packed_matrix_format(dst->field_size) == PACKED_INTEGER &&
+        matrix_element_width(dst->field_size) == (int)sizeof(ULL))
+    {
+        packed_matrix_alias(dst, result);
+        return MATRIX_SUCCESS;
+    }
+    return packed_matrix_create(dst->rows, dst->cols, dst->field_size, result);
+}
+
+int packed_matrix_store(const PackedMatrix* src, Matrix* dst)
+{
+    if (!src || !dst)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+    if (src->rows != dst->rows || src->cols != dst->cols)
+    {
+        return MATRIX_ERROR_DIMENSION;
+    }
+
+    unpack_span(src, 0, dst->data[0], (size_t)src->rows * src->cols);
+    return MATRIX_SUCCESS;
+}
+
+/* ---------- Транспонирование: рекурсивное деление и регистровые блоки 4x4 ---------- */
+
+#define TRANSPOSE_LEAF 32                   /* сторона блока, на котором рекурсия останавливается */
+#define TRANSPOSE_TILE 4                    /* сторона регистрового блока */
+
+typedef ULL transpose_vec __attribute__((vector_size(TRANSPOSE_TILE * sizeof(ULL))));
+
+#if defined(__clang__)
+#define TRANSPOSE_SHUFFLE(a, b, i0, i1, i2, i3) __builtin_shufflevector(a, b, i0, i1, i2, i3)
+#else
+#define TRANSPOSE_SHUFFLE(a, b, i0, i1, i2, i3) __builtin_shuffle(a, b, (transpose_vec){i0, i1, i2, i3})
+#endif
+
+static inline void tile_load(const ULL* src, ptrdiff_t stride, transpose_vec* r)
+{
+    for (int t = 0; t < TRANSPOSE_TILE; t++)
+    {
+        memcpy(&r[t], src + t * stride, sizeof(transpose_vec));
+    }
+}
+
+static inline void tile_store(ULL* dst, ptrdiff_t stride, const transpose_vec* r)
+{
+    for (int t = 0; t < TRANSPOSE_TILE; t++)
+    {
+        memcpy(dst + t * stride, &r[t], sizeof(transpose_vec));
+    }
+}
+
+/* Транспонировать блок 4x4 в регистрах: перемешать пары строк, затем их половины */
+static inline void tile_transpose(transpose_vec* r)
+{
+    transpose_vec t0 = TRANSPOSE_SHUFFLE(r[0], r[1], 0, 4, 2, 6);
+    transpose_vec t1 = TRANSPOSE_SHUFFLE(r[0], r[1], 1, 5, 3, 7);
+    transpose_vec t2 = TRANSPOSE_SHUFFLE(r[2], r[3], 0, 4, 2, 6);
+    transpose_vec t3 = TRANSPOSE_SHUFFLE(r[2], r[3], 1, 5, 3, 7);
+    r[0] = TRANSPOSE_SHUFFLE(t0, t2, 0, 1, 4, 5);
+    r[1] = TRANSPOSE_SHUFFLE(t1, t3, 0, 1, 4, 5);
+    r[2] = TRANSPOSE_SHUFFLE(t0, t2, 2, 3, 6, 7);
+    r[3] = TRANSPOSE_SHUFFLE(t1, t3, 2, 3, 6, 7);
+}
+
+/* Обменять блок 4x4 x с транспонированным блоком y */
+static inline void tile_swap(ULL* x, ULL* y, ptrdiff_t stride)
+{
+    transpose_vec rx[TRANSPOSE_TILE], ry[TRANSPOSE_TILE];
+    tile_load(x, stride, rx);
+    tile_load(y, stride, ry);
+    tile_transpose(rx);
+    tile_transpose(ry);
+    tile_store(x, stride, ry);
+    tile_store(y, stride, rx);
+}
+
+/* Половина стороны, кратная TRANSPOSE_TILE */
+static inline int transpose_split(int size)
+{
+    return (size / 2 + TRANSPOSE_TILE - 1) & ~(TRANSPOSE_TILE - 1);
+}
+
+static void transpose_leaf(const ULL* src, ptrdiff_t src_stride, ULL* dst, ptrdiff_t dst_stride, int rows, int cols)
+{
+    const int full_rows = rows & ~(TRANSPOSE_TILE - 1);
+    const int full_cols = cols & ~(TRANSPOSE_TILE - 1);
+    for (int i = 0; i < full_rows; i += TRANSPOSE_TILE)
+    {
+        for (int j = 0; j < full_cols; j += TRANSPOSE_TILE)
+        {
+            transpose_vec r[TRANSPOSE_TILE];
+            tile_load(src + i * src_stride + j, src_stride, r);
+            tile_transpose(r);
+            tile_store(dst + j * dst_stride + i, dst_stride, r);
+        }
+        for (int j = full_cols; j < cols; j++)
+        {
+            for (int t = 0; t < TRANSPOSE_TILE; t++)
+            {
+                dst[j * dst_stride + i + t] = src[(i + t) * src_stride + j];
+            }
+        }
+    }
+    for (int i = full_rows; i < rows; i++)
+    {
+        for (int j = 0; j < cols; j++)
+        {
+            dst[j * dst_stride + i] = src[i * src_stride + j];
+        }
+    }
+}
+
+void transpose_block(const ULL* src, ptrdiff_t src_stride, ULL* dst, ptrdiff_t dst_stride, int rows, int cols)
+{
+    if (rows <= TRANSPOSE_LEAF && cols <= TRANSPOSE_LEAF)
+    {
+        transpose_leaf(src, src_stride, dst, dst_stride, rows, cols);
+        return;
+    }
+
+    /* Делится большая сторона: на каждом уровне обе половины помещаются в кэш какого-то уровня */
+    if (rows >= cols)
+    {
+        int half = transpose_split(rows);
+        transpose_block(src, src_stride, dst, dst_stride, half, cols);
+        transpose_block(src + half * src_stride, src_stride, dst + half, dst_stride, rows - half, cols);
+    }
+    else
+    {
+        int half = transpose_split(cols);
+        transpose_block(src, src_stride, dst, dst_stride, rows, half);
+        transpose_block(src + half, src_stride, dst + half * dst_stride, dst_stride, rows, cols - half);
+    }
+}
+
+/* Обменять блок a (rows x cols) с транспонированным блоком b (cols x rows) одной матрицы */
+static void transpose_swap(ULL* a, ULL* b, ptrdiff_t stride, int rows, int cols)
+{
+    if (rows <= TRANSPOSE_LEAF && cols <= TRANSPOSE_LEAF)
+    {
+        const int full_rows = rows & ~(TRANSPOSE_TILE - 1);
+        const int full_cols = cols & ~(TRANSPOSE_TILE - 1);
+        for (int i = 0; i < full_rows; i += TRANSPOSE_TILE)
+        {
+            for (int j = 0; j < full_cols; j += TRANSPOSE_TILE)
+            {
+                tile_swap(a + i * stride + j, b + j * stride + i, stride);
+            }
+        }
+        for (int i = 0; i < rows; i++)
+        {
+            for (int j = (i < full_rows) ? full_cols : 0; j < cols; j++)
+            {
+                ULL t = a[i * stride + j];
+                a[i * stride + j] = b[j * stride + i];
+                b[j * stride + i] = t;
+            }
+        }
+        return;
+    }
+
+    if (rows >= cols)
+    {
+        int half = transpose_split(rows);
+        transpose_swap(a, b, stride, half, cols);
+        transpose_swap(a + half * stride, b + half, stride, rows - half, cols);
+    }
+    else
+    {
+        int half = transpose_split(cols);
+        transpose_swap(a, b, stride, rows, half);
+        transpose_swap(a + half, b + half * stride, stride, rows, cols - half);
+    }
+}
+
+void transpose_square_in_place(ULL* a, ptrdiff_t stride, int n)
+{
+    if (n <= TRANSPOSE_LEAF)
+    {
+        const int full = n & ~(TRANSPOSE_TILE - 1);
+        for (int i = 0; i < full; i += TRANSPOSE_TILE)
+        {
+            transpose_vec r[TRANSPOSE_TILE];
+            tile_load(a + i * stride + i, stride, r);
+            tile_transpose(r);
+            tile_store(a + i * stride + i, stride, r);
+            for (int j = i + TRANSPOSE_TILE; j < full; j += TRANSPOSE_TILE)
+            {
+                tile_swap(a + i * stride + j, a + j * stride + i, stride);
+            }
+        }
+        for (int i = 0; i < n; i++)
+        {
+            for (int j = (i + 1 > full) ? i + 1 : full; j < n; j++)
+            {
+                ULL t = a[i * stride + j];
+                a[i * stride + j] = a[j * stride + i];
+                a[j * stride + i] = t;
+            }
+        }
+        return;
+    }
+
+    /* Диагональные четверти — на месте, внедиагональные меняются местами */
+    int half = transpose_split(n);
+    transpose_square_in_place(a, stride, half);
+    transpose_square_in_place(a + half * stride + half, stride, n - half);
+    transpose_swap(a + half, a + half * stride, stride, half, n - half);
+}
+
+/* Строк транспонированного представления, собираемых за один проход по строкам хранения */
+#define VIEW_GATHER_ROWS 8
+
+int packed_matrix_load_view(const MatrixView* src, PackedMatrix* dst)
+{
+    if (!src || !dst)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+    if (src->rows != dst->rows || src->cols != dst->cols)
+    {
+        return MATRIX_ERROR_DIMENSION;
+    }
+
+    const int cols = src->cols;
+    if (!src->transposed)
+    {
+        for (int i = 0; i < src->rows; i++)
+        {
+            pack_span(src->base + (ptrdiff_t)i * src->row_stride, dst, (size_t)i * cols, cols);
+        }
+        return MATRIX_SUCCESS;
+    }
+
+    /* Строка представления — столбец хранения: VIEW_GATHER_ROWS соседних столбцов лежат в одной строке кэша */
+    ULL* rows = (ULL*)malloc((size_t)VIEW_GATHER_ROWS * cols * sizeof(ULL));
+    if (!rows)
+    {
+        return MATRIX_ERROR_CREATION;
+    }
+    for (int i0 = 0; i0 < src->rows; i0 += VIEW_GATHER_ROWS)
+    {
+        int count = (src->rows - i0 < VIEW_GATHER_ROWS) ? src->rows - i0 : VIEW_GATHER_ROWS;
+        transpose_block(src->base + i0, src->row_stride, rows, cols, cols, count);
+        for (int r = 0; r < count; r++)
+        {
+            pack_span(rows + (size_t)r * cols, dst, (size_t)(i0 + r) * cols, cols);
+        }
+    }
+    free(rows);
+    return MATRIX_SUCCESS;
+}
+
+int packed_matrix_store_view(const PackedMatrix* src, const MatrixView* dst)
+{
+    if (!src || !dst)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+    if (src->rows != dst->rows || src->cols != dst->cols)
+    {
+        return MATRIX_ERROR_DIMENSION;
+    }
+
+    const int cols = src->cols;
+    if (!dst->transposed)
+    {
+        for (int i = 0; i < src->rows; i++)
+        {
+            unpack_span(src, (size_t)i * cols, dst->base + (ptrdiff_t)i * dst->row_stride, cols);
+        }
+        return MATRIX_SUCCESS;
+    }
+
+    ULL* rows = (ULL*)malloc((size_t)VIEW_GATHER_ROWS * cols * sizeof(ULL));
+    if (!rows)
+    {
+        return MATRIX_ERROR_CREATION;
+    }
+    for (int i0 = 0; i0 < src->rows; i0 += VIEW_GATHER_ROWS)
+    {
+        int count = (src->rows - i0 < VIEW_GATHER_ROWS) ? src->rows - i0 : VIEW_GATHER_ROWS;
+        for (int r = 0; r < count; r++)
+        {
+            unpack_span(src, (size_t)(i0 + r) * cols, rows + (size_t)r * cols, cols);
+        }
+        transpose_block(rows, cols, dst->base + i0, dst->row_stride, count, cols);
+    }
+    free(rows);
+    return MATRIX_SUCCESS;
+}
+
+int packed_matrix_copy(const PackedMatrix* src, PackedMatrix* dst)
+{
+    if (!src || !dst)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+    if (src->rows != dst->rows || src->cols != dst->cols || src->width != dst->width ||
+        src->format != dst->format)
+    {
+        return MATRIX_ERROR_DIMENSION;
+    }
+
+    memcpy(dst->data, src->data, packed_bytes(src));
+    return MATRIX_SUCCESS;
+}
+
+int packed_matrix_identity(PackedMatrix* m)
+{
+    if (!m)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+    if (m->rows != m->cols)
+    {
+        return MATRIX_ERROR_NOT_SQUARE;
+    }
+
+    memset(m->data, 0, packed_bytes(m));
+    for (int i = 0; i < m->rows; i++)
+    {
+        size_t index = (size_t)i * m->cols + i;
+        if (m->format == PACKED_DOUBLE)
+        {
+            ((double*)m->data)[index] = 1.0;
+            continue;
+        }
+        switch (m->width)
+        {
+            case 1: ((uint8_t*)m->data)[index] = 1; break;
+            case 2: ((uint16_t*)m->data)[index] = 1; break;
+            case 4: ((uint32_t*)m->data)[index] = 1; break;
+            default: ((ULL*)m->data)[index] = 1; break;
+        }
+    }
+    return MATRIX_SUCCESS;
+}
+
+int packed_matrix_add_identity(PackedMatrix* m, ULL scalar)
+{
+    if (!m)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+    if (m->rows != m->cols)
+    {
+        return MATRIX_ERROR_NOT_SQUARE;
+    }
+
+    ULL p = m->field_size;
+    for (int i = 0; i < m->rows; i++)
+    {
+        size_t index = (size_t)i * m->cols + i;
+        ULL x;
+        if (m->format == PACKED_DOUBLE) x = (ULL)((double*)m->data)[index];
+        else if (m->width == 1) x = ((uint8_t*)m->data)[index];
+        else if (m->width == 2) x = ((uint16_t*)m->data)[index];
+        else if (m->width == 4) x = ((uint32_t*)m->data)[index];
+        else x = ((ULL*)m->data)[index];
+
+        ULL sum = x + scalar;
+        if (p != 0 && (sum < x || sum >= p)) sum -= p;
+
+        if (m->format == PACKED_DOUBLE) ((double*)m->data)[index] = (double)sum;
+        else if (m->width == 1) ((uint8_t*)m->data)[index] = (uint8_t)sum;
+        else if (m->width == 2) ((uint16_t*)m->data)[index] = (uint16_t)sum;
+        else if (m->width == 4) ((uint32_t*)m->data)[index] = (uint32_t)sum;
+        else ((ULL*)m->data)[index] = sum;
+    }
+    return MATRIX_SUCCESS;
+}
+
+/*
+ * Произведение делится на прямоугольные плитки c: пополам по строкам, а когда строк остаётся
+ * мало, — по столбцам, пока в плитке больше MULTIPLY_TASK_WORK умножений. Полосы строк
+ * сохраняют порядок обхода ядер. Одна половина уходит в очередь планировщика (matrix_sched.h),
+ * другая считается сразу; неровные края при любых n выравниваются кражей.
+ */
+#define MULTIPLY_TASK_WORK (1 << 18)        /* умножений-сложений в неделимой плитке */
+#define MULTIPLY_MIN_ROWS 8                 /* строк в плитке не меньше */
+#define MULTIPLY_MIN_COLS 64                /* столбцов в плитке не меньше; граница кратна 16 */
+
+typedef struct MultiplyTile
+{
+    const PackedMatrix* a;
+    const PackedMatrix* b;
+    PackedMatrix* c;
+    int row_begin, row_end;
+    int col_begin, col_end;
+    int block;                              /* ширина полосы столбцов (MULTIPLY_BLOCKED) */
+    atomic_int* error;                      /* первая ошибка среди плиток */
+} MultiplyTile;
+
+static void multiply_tile_leaf(const MultiplyTile* tile)
+{
+    const PackedMatrix* a = tile->a;
+    const PackedMatrix* b = tile->b;
+    PackedMatrix* c = tile->c;
+    const int rows = tile->row_end - tile->row_begin;
+    const int inner = a->cols;
+    const int cols = b->cols;
+    const size_t a_offset = (size_t)tile->row_begin * inner;
+    const size_t c_offset = (size_t)tile->row_begin * cols;
+    ULL p = a->field_size;
+
+    if (a->format == PACKED_DOUBLE)
+    {
+        fma_multiply((const double*)a->data + a_offset, (const double*)b->data, (double*)c->data + c_offset,
+                     rows, inner, cols, p);
+        return;
+    }
+    if (p == 0)
+    {
+        multiply_wrap_u64((const ULL*)a->data + a_offset, (const ULL*)b->data, (ULL*)c->data + c_offset,
+                          rows, inner, cols, tile->col_begin, tile->col_end, tile->block);
+        return;
+    }
+
+    const int width = (tile->col_end - tile->col_begin < tile->block) ? tile->col_end - tile->col_begin : tile->block;
+    void* acc = aligned_alloc(64, ((size_t)width * sizeof(U128) + 63) & ~(size_t)63);
+    if (!acc)
+    {
+        int expected = MATRIX_SUCCESS;
+        atomic_compare_exchange_strong(tile->error, &expected, MATRIX_ERROR_CREATION);
+        return;
+    }
+
+    switch (a->width)
+    {
+        case 1:
+            multiply_u8((const uint8_t*)a->data + a_offset, (const uint8_t*)b->data, (uint8_t*)c->data + c_offset,
+                        rows, inner, cols, tile->col_begin, tile->col_end, tile->block, p, (uint32_t*)acc);
+            break;
+        case 2:
+            multiply_u16((const uint16_t*)a->data + a_offset, (const uint16_t*)b->data,
+                         (uint16_t*)c->data + c_offset,
+                         rows, inner, cols, tile->col_begin, tile->col_end, tile->block, p, (uint64_t*)acc);
+            break;
+        case 4:
+            multiply_u32((const uint32_t*)a->data + a_offset, (const uint32_t*)b->data,
+                         (uint32_t*)c->data + c_offset,
+                         rows, inner, cols, tile->col_begin, tile->col_end, tile->block, p, (uint64_t*)acc);
+            break;
+        default:
+            multiply_u64((const ULL*)a->data + a_offset, (const ULL*)b->data, (ULL*)c->data + c_offset,
+                         rows, inner, cols, tile->col_begin, tile->col_end, tile->block, p, (U128*)acc);
+            break;
+    }
+    free(acc);
+}
+
+static void multiply_tile_run(void* arg)
+{
+    MultiplyTile* tile = (MultiplyTile*)arg;
+    const int rows = tile->row_end - tile->row_begin;
+    const int cols = tile->col_end - tile->col_begin;
+
+    /* Ядро double обрабатывает строки целиком: его плитки делятся только по строкам */
+    const int split_rows = rows >= 2 * MULTIPLY_MIN_ROWS;
+    const int split_cols = tile->a->format != PACKED_DOUBLE && cols >= 2 * MULTIPLY_MIN_COLS;
+    const double work = (double)rows * (tile->a->format == PACKED_DOUBLE ? tile->b->cols : cols) * tile->a->cols;
+    if (work <= MULTIPLY_TASK_WORK || (!split_rows && !split_cols))
+    {
+        multiply_tile_leaf(tile);
+        return;
+    }
+
+    MultiplyTile upper = *tile;
+    MultiplyTile lower = *tile;
+    if (!split_rows)
+    {
+        int middle = tile->col_begin + ((cols / 2) & ~15);
+        lower.col_end = middle;
+        upper.col_begin = middle;
+    }
+    else
+    {
+        int middle = tile->row_begin + rows / 2;
+        lower.row_end = middle;
+        upper.row_begin = middle;
+    }
+
+    SchedTask task;
+    sched_spawn(&task, multiply_tile_run, &upper);
+    multiply_tile_run(&lower);
+    sched_sync(&task);
+}
+
+/* Выбор ядра умножения по формату, ширине элемента, модулю и профилю настройки (matrix_tune.h) */
+static int packed_multiply_dispatch(const PackedMatrix* a, const PackedMatrix* b, PackedMatrix* c, int allow_rns)
+{
+    ULL p = a->field_size;
+    int block = b->cols;
+    if (a->format != PACKED_DOUBLE)
+    {
+        TuneChoice choice = matrix_tune_choice(p, a->rows, a->cols, b->cols);
+        if (choice.variant == MULTIPLY_BLOCKED && choice.block > 0) block = choice.block;
+
+        /* Большие модули: точное произведение по нескольким малым простым и CRT */
+        if (allow_rns && p != 0 && a->width == (int)sizeof(ULL) && choice.variant == MULTIPLY_RNS)
+        {
+            return rns_multiply((const ULL*)a->data, (const ULL*)b->data, (ULL*)c->data,
+                                a->rows, a->cols, b->cols, p);
+        }
+    }
+    if (block < 1) block = 1;
+
+    atomic_int error = MATRIX_SUCCESS;
+    MultiplyTile tile = {a, b, c, 0, a->rows, 0, b->cols, block, &error};
+    if (sched_workers() > 0) multiply_tile_run(&tile);
+    else multiply_tile_leaf(&tile);
+    return atomic_load(&error);
+}
+
+static int packed_multiply_checked(const PackedMatrix* a, const PackedMatrix* b, PackedMatrix* c, int allow_rns)
+{
+    if (!a || !b || !c)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+    if (a->cols != b->rows || c->rows != a->rows || c->cols != b->cols)
+    {
+        return MATRIX_ERROR_DIMENSION;
+    }
+    if (a->field_size != b->field_size || a->width != b->width || a->width != c->width ||
+        a->format != b->format || a->format != c->format)
+    {
+        return MATRIX_ERROR_INVALID_FIELD;
+    }
+
+    /*
+     * Проверка Фрейвалдса, если к потоку привязан контекст (matrix_verify.h).
+     * На время умножения контекст отвязывается: вложенные произведения (каналы RNS)
+     * не проверяются, проверяется только итоговое.
+     */
+    MatrixVerifier* verifier = matrix_verifier_bind(NULL);
+    int error = packed_multiply_dispatch(a, b, c, allow_rns);
+    matrix_verifier_bind(verifier);
+
+    if (error == MATRIX_SUCCESS && verifier) error = matrix_verify_packed(verifier, a, b, c);
+    return error;
+}
+
+int packed_matrix_multiply(const PackedMatrix* a, const PackedMatrix* b, PackedMatrix* c)
+{
+    return packed_multiply_checked(a, b, c, 1);
+}
+
+int packed_matrix_multiply_inplace(const PackedMatrix* a, const PackedMatrix* b, PackedMatrix* c)
+{
+    return packed_multiply_checked(a, b, c, 0);
+}
+
+/* Сложение делится на куски по ADD_TASK_ELEMENTS элементов, куски считаются задачами планировщика */
+#define ADD_TASK_ELEMENTS (1 << 16)
+
+typedef struct PackedAddRange
+{
+    const PackedMatrix* a;
+    const PackedMatrix* b;
+    PackedMatrix* c;
+    size_t count;                           /* всего элементов */
+} PackedAddRange;
+
+static void packed_add_chunks(void* context, int begin, int end)
+{
+    const PackedAddRange* range = (const PackedAddRange*)context;
+    const PackedMatrix* a = range->a;
+    const PackedMatrix* b = range->b;
+    PackedMatrix* c = range->c;
+    size_t offset = (size_t)begin * ADD_TASK_ELEMENTS;
+    size_t last = (size_t)end * ADD_TASK_ELEMENTS;
+    size_t count = (last < range->count ? last : range->count) - offset;
+    ULL p = a->field_size;
+
+    if (a->format == PACKED_DOUBLE)
+    {
+        fma_add((const double*)a->data + offset, (const double*)b->data + offset, (double*)c->data + offset,
+                count, p);
+        return;
+    }
+    switch (a->width)
+    {
+        case 1:
+            add_u8((const uint8_t*)a->data + offset, (const uint8_t*)b->data + offset,
+                   (uint8_t*)c->data + offset, count, p);
+            break;
+        case 2:
+            add_u16((const uint16_t*)a->data + offset, (const uint16_t*)b->data + offset,
+                    (uint16_t*)c->data + offset, count, p);
+            break;
+        case 4:
+            add_u32((const uint32_t*)a->data + offset, (const uint32_t*)b->data + offset,
+                    (uint32_t*)c->data + offset, count, p);
+            break;
+        default:
+            if (p == 0)
+            {
+                add_wrap_u64((const ULL*)a->data + offset, (const ULL*)b->data + offset,
+                             (ULL*)c->data + offset, count);
+            }
+            else
+            {
+                add_u64((const ULL*)a->data + offset, (const ULL*)b->data + offset,
+                        (ULL*)c->data + offset, count, p);
+            }
+            break;
+    }
+}
+
+int packed_matrix_add(const PackedMatrix* a, const PackedMatrix* b, PackedMatrix* c)
+{
+    if (!a || !b || !c)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+    if (a->rows != b->rows || a->cols != b->cols || a->rows != c->rows || a->cols != c->cols)
+    {
+        return MATRIX_ERROR_DIMENSION;
+    }
+    if (a->field_size != b->field_size || a->width != b->width || a->width != c->width ||
+        a->format != b->format || a->format != c->format)
+    {
+        return MATRIX_ERROR_INVALID_FIELD;
+    }
+
+    PackedAddRange range = {a, b, c, (size_t)a->rows * a->cols};
+    int chunks = (int)((range.count + ADD_TASK_ELEMENTS - 1) / ADD_TASK_ELEMENTS);
+    sched_parallel_for(0, chunks, 1, packed_add_chunks, &range);
+    return MATRIX_SUCCESS;
+}
+
+void packed_matrix_free(PackedMatrix* m)
+{
+    if (!m || !m->owns_data || !m->data)
+    {
+        return;
+    }
+
+    if (m->allocator)
+    {
+        matrix_allocator_release(m->allocator, m->data, (packed_bytes(m) + 63) & ~(size_t)63);
+    }
+    else
+    {
+        free(m->data);
+    }
+    m->data = NULL;
+}
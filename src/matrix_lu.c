@@ -0,0 +1,363 @@
+#include "../include/matrix_lu.h"
+#include "../include/modular.h"
+#include "../include/trace.h"
+
+typedef unsigned __int128 U128;
+
+#define SHOUP_LIMIT (1ULL << 63)            /* метод Шоупа требует модуль < 2^63 */
+
+static inline ULL fixed_shoup(ULL w, ULL p)
+{
+    return p < SHOUP_LIMIT ? modular_shoup(w, p) : 0;
+}
+
+static inline ULL mul_fixed(ULL x, ULL w, ULL w_shoup, ULL p)
+{
+    return p < SHOUP_LIMIT ? modular_mul_shoup(x, w, w_shoup, p) : modular_mul(x, w, p);
+}
+
+/*
+ * row[from..to) -= Σ multipliers[t] * source[t][from..to), t = 0 ... count-1.
+ * Суммы копятся с отложенным приведением: в 64-битных аккумуляторах при p < 2^32,
+ * иначе в 128-битных. acc — рабочий буфер не меньше чем на to - from элементов U128.
+ */
+static void row_update(ULL* row, const ULL* source, size_t stride, const ULL* multipliers, int count,
+                       int from, int to, ULL p, U128* acc)
+{
+    if (count <= 0 || from >= to) return;
+
+    const int length = to - from;
+    row += from;
+    source += from;
+
+    if (p <= UINT32_MAX)
+    {
+        ULL* acc64 = (ULL*)acc;
+        ULL max_product = (p - 1) * (p - 1);
+        ULL limit = max_product ? (UINT64_MAX - p) / max_product : UINT64_MAX;
+        ULL used = 0;
+
+        memcpy(acc64, row, (size_t)length * sizeof(ULL));
+        for (int t = 0; t < count; t++)
+        {
+            if (multipliers[t] == 0) continue;
+            if (used == limit)
+            {
+                for (int j = 0; j < length; j++)
+                {
+                    acc64[j] %= p;
+                }
+                used = 0;
+            }
+
+            const ULL c = p - multipliers[t];
+            const ULL* src = source + (size_t)t * stride;
+            for (int j = 0; j < length; j++)
+            {
+                acc64[j] += c * src[j];
+            }
+            used++;
+        }
+        for (int j = 0; j < length; j++)
+        {
+            row[j] = acc64[j] % p;
+        }
+        return;
+    }
+
+    U128 max_product = (U128)(p - 1) * (p - 1);
+    U128 limit = (~(U128)0 - p) / max_product;
+    U128 used = 0;
+
+    for (int j = 0; j < length; j++)
+    {
+        acc[j] = row[j];
+    }
+    for (int t = 0; t < count; t++)
+    {
+        if (multipliers[t] == 0) continue;
+        if (used == limit)
+        {
+            for (int j = 0; j < length; j++)
+            {
+                acc[j] %= p;
+            }
+            used = 0;
+        }
+
+        const ULL c = p - multipliers[t];
+        const ULL* src = source + (size_t)t * stride;
+        for (int j = 0; j < length; j++)
+        {
+            acc[j] += (U128)c * src[j];
+        }
+        used++;
+    }
+    for (int j = 0; j < length; j++)
+    {
+        row[j] = (ULL)(acc[j] % p);
+    }
+}
+
+/*
+ * Блочное LU-разложение n x n матрицы lu (по строкам) на месте.
+ * perm[i] — исходный номер строки, стоящей на месте i; sign — чётность перестановки.
+ * [RETURN] 1, если матрица невырождена, иначе 0 (разложение прерывается)
+ */
+static int lu_factor(ULL* lu, int n, ULL p, int* perm, int* sign, U128* acc)
+{
+    for (int i = 0; i < n; i++)
+    {
+        perm[i] = i;
+    }
+    *sign = 1;
+
+    for (int k0 = 0; k0 < n; k0 += LU_BLOCK)
+    {
+        int k1 = (n - k0 < LU_BLOCK) ? n : k0 + LU_BLOCK;
+
+        /* Панель: исключение только в столбцах k0..k1-1 */
+        TRACE_BEGIN("lu_panel");
+        for (int j = k0; j < k1; j++)
+        {
+            int pivot = j;
+            while (pivot < n && lu[(size_t)pivot * n + j] == 0)
+            {
+                pivot++;
+            }
+            if (pivot == n)
+            {
+                TRACE_END();
+                return 0;
+            }
+
+            if (pivot != j)
+            {
+                ULL* a = lu + (size_t)pivot * n;
+                ULL* b = lu + (size_t)j * n;
+                for (int c = 0; c < n; c++)
+                {
+                    ULL t = a[c];
+                    a[c] = b[c];
+                    b[c] = t;
+                }
+                int t = perm[pivot];
+                perm[pivot] = perm[j];
+                perm[j] = t;
+                *sign = -*sign;
+            }
+
+            const ULL* pivot_row = lu + (size_t)j * n;
+            ULL inverse = modular_inverse(pivot_row[j], p);
+            ULL inverse_shoup = fixed_shoup(inverse, p);
+            for (int i = j + 1; i < n; i++)
+            {
+                ULL* row = lu + (size_t)i * n;
+                if (row[j] == 0) continue;
+
+                ULL l = mul_fixed(row[j], inverse, inverse_shoup, p);
+                ULL l_shoup = fixed_shoup(l, p);
+                row[j] = l;
+                for (int c = j + 1; c < k1; c++)
+                {
+                    ULL v = mul_fixed(pivot_row[c], l, l_shoup, p);
+                    row[c] = (row[c] >= v) ? row[c] - v : row[c] + (p - v);
+                }
+            }
+        }
+        TRACE_END();
+
+        if (k1 == n) break;
+
+        /* U12 = L11^-1 A12, затем остаток A22 -= L21 U12 одним проходом ранга k1 - k0 */
+        TRACE_BEGIN("lu_update");
+        for (int i = k0 + 1; i < k1; i++)
+        {
+            ULL* row = lu + (size_t)i * n;
+            row_update(row, lu + (size_t)k0 * n, n, row + k0, i - k0, k1, n, p, acc);
+        }
+        for (int i = k1; i < n; i++)
+        {
+            ULL* row = lu + (size_t)i * n;
+            row_update(row, lu + (size_t)k0 * n, n, row + k0, k1 - k0, k1, n, p, acc);
+        }
+        TRACE_END();
+    }
+    return 1;
+}
+
+/* Скопировать a в непрерывный буфер n x n */
+static ULL* lu_load(const Matrix* a)
+{
+    int n = a->rows;
+    ULL* lu = (ULL*)malloc((size_t)n * n * sizeof(ULL));
+    if (!lu) return NULL;
+
+    for (int i = 0; i < n; i++)
+    {
+        for (int j = 0; j < n; j++)
+        {
+            ULL v = a->data[i][j];
+            lu[(size_t)i * n + j] = (v < a->field_size) ? v : v % a->field_size;
+        }
+    }
+    return lu;
+}
+
+static int lu_check(const Matrix* a)
+{
+    if (a->rows != a->cols)
+    {
+        return MATRIX_ERROR_NOT_SQUARE;
+    }
+    if (!modular_is_prime(a->field_size))
+    {
+        return MATRIX_ERROR_INVALID_FIELD;
+    }
+    return MATRIX_SUCCESS;
+}
+
+int matrix_determinant(const Matrix* a, ULL* result)
+{
+    TRACE_SCOPE("determinant");
+
+    if (!a || !result)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+    int error = lu_check(a);
+    if (error != MATRIX_SUCCESS) return error;
+
+    int n = a->rows;
+    ULL p = a->field_size;
+    ULL* lu = lu_load(a);
+    int* perm = (int*)malloc((size_t)n * sizeof(int));
+    U128* acc = (U128*)malloc((size_t)n * sizeof(U128));
+    if (!lu || !perm || !acc)
+    {
+        free(lu);
+        free(perm);
+        free(acc);
+        return MATRIX_ERROR_CREATION;
+    }
+
+    int sign;
+    ULL det = 0;
+    if (lu_factor(lu, n, p, perm, &sign, acc))
+    {
+        det = 1 % p;
+        for (int i = 0; i < n; i++)
+        {
+            det = modular_mul(det, lu[(size_t)i * n + i], p);
+        }
+        if (sign < 0 && det != 0) det = p - det;
+    }
+
+    free(lu);
+    free(perm);
+    free(acc);
+    *result = det;
+    return MATRIX_SUCCESS;
+}
+
+/*
+ * Блочная подстановка для всех n правых частей x (n x n, по строкам).
+ * upper == 0: L x = b сверху вниз (L унитреугольная);
+ * upper == 1: U x = b снизу вверх с делением на диагональ U.
+ * Строки x уже решённых блоков вычитаются поблочно, пока блок в кэше.
+ */
+static void lu_solve(const ULL* lu, ULL* x, int n, ULL p, int upper, U128* acc)
+{
+    for (int step = 0; step < n; step += LU_BLOCK)
+    {
+        int b0 = upper ? ((n - step - LU_BLOCK > 0) ? n - step - LU_BLOCK : 0) : step;
+        int b1 = upper ? n - step : ((step + LU_BLOCK < n) ? step + LU_BLOCK : n);
+
+        /* Вклад уже решённых блоков */
+        int t_begin = upper ? b1 : 0;
+        int t_end = upper ? n : b0;
+        for (int t0 = t_begin; t0 < t_end; t0 += LU_BLOCK)
+        {
+            int t1 = (t_end - t0 < LU_BLOCK) ? t_end : t0 + LU_BLOCK;
+            for (int i = b0; i < b1; i++)
+            {
+                row_update(x + (size_t)i * n, x + (size_t)t0 * n, n, lu + (size_t)i * n + t0,
+                           t1 - t0, 0, n, p, acc);
+            }
+        }
+
+        /* Подстановка внутри блока */
+        if (!upper)
+        {
+            for (int i = b0 + 1; i < b1; i++)
+            {
+                row_update(x + (size_t)i * n, x + (size_t)b0 * n, n, lu + (size_t)i * n + b0,
+                           i - b0, 0, n, p, acc);
+            }
+            continue;
+        }
+        for (int i = b1 - 1; i >= b0; i--)
+        {
+            ULL* row = x + (size_t)i * n;
+            row_update(row, x + (size_t)(i + 1) * n, n, lu + (size_t)i * n + i + 1, b1 - i - 1, 0, n, p, acc);
+
+            ULL inverse = modular_inverse(lu[(size_t)i * n + i], p);
+            ULL inverse_shoup = fixed_shoup(inverse, p);
+            for (int j = 0; j < n; j++)
+            {
+                row[j] = mul_fixed(row[j], inverse, inverse_shoup, p);
+            }
+        }
+    }
+}
+
+int matrix_inverse(const Matrix* a, Matrix** result)
+{
+    TRACE_SCOPE("inverse");
+
+    if (!a || !result)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+    int error = lu_check(a);
+    if (error != MATRIX_SUCCESS) return error;
+
+    int n = a->rows;
+    ULL p = a->field_size;
+    ULL* lu = lu_load(a);
+    int* perm = (int*)malloc((size_t)n * sizeof(int));
+    U128* acc = (U128*)malloc((size_t)n * sizeof(U128));
+    Matrix* inverse = NULL;
+    if (!lu || !perm || !acc)
+    {
+        error = MATRIX_ERROR_CREATION;
+    }
+
+    int sign;
+    if (error == MATRIX_SUCCESS && !lu_factor(lu, n, p, perm, &sign, acc))
+    {
+        error = MATRIX_ERROR_SINGULAR;
+    }
+    if (error == MATRIX_SUCCESS) error = matrix_create(n, n, p, &inverse);
+    if (error == MATRIX_SUCCESS)
+    {
+        /* A^-1 = U^-1 L^-1 P: правая часть — переставленная единичная матрица */
+        ULL* x = inverse->data[0];
+        for (int i = 0; i < n; i++)
+        {
+            x[(size_t)i * n + perm[i]] = 1;
+        }
+        TRACE_BEGIN("lu_solve");
+        lu_solve(lu, x, n, p, 0, acc);
+        lu_solve(lu, x, n, p, 1, acc);
+        TRACE_END();
+    }
+
+    free(lu);
+    free(perm);
+    free(acc);
+    if (error != MATRIX_SUCCESS) return error;
+
+    *result = inverse;
+    return MATRIX_SUCCESS;
+}
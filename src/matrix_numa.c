@@ -0,0 +1,265 @@
+#include "../include/matrix_numa.h"
+
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+/* Политики памяти ядра Linux (linux/mempolicy.h), чтобы не зависеть от numaif.h */
+#define NUMA_MPOL_INTERLEAVE 3
+
+#define NUMA_MASK_WORDS (NUMA_MAX_CPUS / 64)
+
+typedef struct NumaNodeSet
+{
+    int count;                              /* число узлов */
+    int ids[NUMA_MAX_NODES];                /* номера узлов (могут идти с пропусками) */
+    unsigned long cpus[NUMA_MAX_NODES][NUMA_MASK_WORDS];  /* доступные ядра каждого узла */
+} NumaNodeSet;
+
+int matrix_numa_state = -1;
+
+static NumaTopology numa_topology;
+static NumaNodeSet numa_nodes;
+static _Thread_local int numa_pinned_cpu = -1;
+
+static void numa_report(const char* format, ...)
+{
+    if (matrix_numa_state != 2) return;
+
+    va_list args;
+    va_start(args, format);
+    fprintf(stderr, "numa: ");
+    vfprintf(stderr, format, args);
+    fprintf(stderr, "\n");
+    va_end(args);
+}
+
+/* ---------- Топология ---------- */
+
+/* Разобрать список вида "0-3,8,10-11" из файла sysfs; mark[i] = 1 для каждого номера */
+static int numa_read_list(const char* path, unsigned char* mark, int limit)
+{
+    FILE* file = fopen(path, "r");
+    if (!file) return 0;
+
+    char text[4096];
+    size_t length = fread(text, 1, sizeof(text) - 1, file);
+    fclose(file);
+    text[length] = '\0';
+
+    int count = 0;
+    char* cursor = text;
+    while (*cursor)
+    {
+        char* end;
+        long first = strtol(cursor, &end, 10);
+        if (end == cursor) break;
+        long last = first;
+        cursor = end;
+        if (*cursor == '-')
+        {
+            last = strtol(cursor + 1, &end, 10);
+            cursor = end;
+        }
+        for (long i = first; i <= last && i < limit; i++)
+        {
+            if (i >= 0 && !mark[i])
+            {
+                mark[i] = 1;
+                count++;
+            }
+        }
+        if (*cursor == ',') cursor++;
+        else break;
+    }
+    return count;
+}
+
+static void numa_read_topology(void)
+{
+    /* Ядра, на которых процессу разрешено работать (taskset, cgroups) */
+    unsigned long allowed[NUMA_MASK_WORDS];
+    memset(allowed, 0, sizeof(allowed));
+    if (syscall(SYS_sched_getaffinity, 0, sizeof(allowed), allowed) <= 0)
+    {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        for (long cpu = 0; cpu < online && cpu < NUMA_MAX_CPUS; cpu++)
+        {
+            allowed[cpu / 64] |= 1UL << (cpu % 64);
+        }
+    }
+
+    unsigned char nodes[NUMA_MAX_NODES] = {0};
+    if (numa_read_list("/sys/devices/system/node/online", nodes, NUMA_MAX_NODES) == 0)
+    {
+        nodes[0] = 1;
+    }
+
+    numa_nodes.count = 0;
+    for (int node = 0; node < NUMA_MAX_NODES; node++)
+    {
+        if (!nodes[node]) continue;
+
+        int index = numa_nodes.count;
+        char path[128];
+        unsigned char cpus[NUMA_MAX_CPUS] = {0};
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+        if (numa_read_list(path, cpus, NUMA_MAX_CPUS) == 0)
+        {
+            /* Нет sysfs: один узел со всеми доступными ядрами */
+            memset(cpus, 1, sizeof(cpus));
+        }
+
+        int any = 0;
+        memset(numa_nodes.cpus[index], 0, sizeof(numa_nodes.cpus[index]));
+        for (int cpu = 0; cpu < NUMA_MAX_CPUS; cpu++)
+        {
+            if (cpus[cpu] && (allowed[cpu / 64] >> (cpu % 64) & 1))
+            {
+                numa_nodes.cpus[index][cpu / 64] |= 1UL << (cpu % 64);
+                any = 1;
+            }
+        }
+        if (!any) continue;                 /* узел без доступных ядер (например, только память) */
+
+        numa_nodes.ids[index] = node;
+        numa_nodes.count++;
+    }
+    if (numa_nodes.count == 0)
+    {
+        numa_nodes.count = 1;
+        numa_nodes.ids[0] = 0;
+        memcpy(numa_nodes.cpus[0], allowed, sizeof(allowed));
+    }
+
+    /* Порядок закрепления: по одному ядру с каждого узла по кругу */
+    int next[NUMA_MAX_NODES] = {0};
+    numa_topology.nodes = numa_nodes.count;
+    numa_topology.cpus = 0;
+    for (int added = 1; added; )
+    {
+        added = 0;
+        for (int index = 0; index < numa_nodes.count; index++)
+        {
+            int cpu = next[index];
+            while (cpu < NUMA_MAX_CPUS && !(numa_nodes.cpus[index][cpu / 64] >> (cpu % 64) & 1)) cpu++;
+            next[index] = cpu + 1;
+            if (cpu >= NUMA_MAX_CPUS) continue;
+
+            numa_topology.cpu_ids[numa_topology.cpus] = cpu;
+            numa_topology.cpu_nodes[numa_topology.cpus] = numa_nodes.ids[index];
+            numa_topology.cpus++;
+            added = 1;
+        }
+    }
+}
+
+int matrix_numa_init(void)
+{
+    static atomic_int initialized = 0;
+    int expected = 0;
+    if (!atomic_compare_exchange_strong(&initialized, &expected, 1))
+    {
+        while (atomic_load(&initialized) != 2);
+        return matrix_numa_state > 0;
+    }
+
+    const char* mode = getenv("MATRIX_NUMA");
+    int state = 0;
+    if (mode && (strcmp(mode, "on") == 0 || strcmp(mode, "1") == 0)) state = 1;
+    if (mode && strcmp(mode, "report") == 0) state = 2;
+
+    if (state > 0)
+    {
+        numa_read_topology();
+    }
+    matrix_numa_state = state;
+
+    if (state > 0)
+    {
+        numa_report("%d node(s), %d cpu(s) available", numa_topology.nodes, numa_topology.cpus);
+        for (int index = 0; index < numa_nodes.count; index++)
+        {
+            int count = 0;
+            for (int w = 0; w < NUMA_MASK_WORDS; w++) count += __builtin_popcountl(numa_nodes.cpus[index][w]);
+            numa_report("node %d: %d cpu(s)", numa_nodes.ids[index], count);
+        }
+    }
+    atomic_store(&initialized, 2);
+    return state > 0;
+}
+
+const NumaTopology* matrix_numa_topology(void)
+{
+    return matrix_numa_enabled() ? &numa_topology : NULL;
+}
+
+/* ---------- Память ---------- */
+
+void* matrix_numa_alloc(size_t bytes, int placement, const char* what)
+{
+    if (!matrix_numa_enabled() || bytes < NUMA_MIN_BYTES)
+    {
+        return aligned_alloc(64, (bytes + 63) & ~(size_t)63);
+    }
+
+    size_t size = (bytes + NUMA_HUGE_PAGE - 1) & ~(size_t)(NUMA_HUGE_PAGE - 1);
+    void* data = aligned_alloc(NUMA_HUGE_PAGE, size);
+    if (!data) return NULL;
+
+    /* Политику нужно задать до первой записи: страницы ещё не выделены */
+    const char* policy = "local (first touch)";
+    if (placement == NUMA_PLACE_INTERLEAVE && numa_nodes.count > 1)
+    {
+        unsigned long mask[NUMA_MAX_NODES / 64 + 1] = {0};
+        for (int index = 0; index < numa_nodes.count; index++)
+        {
+            mask[numa_nodes.ids[index] / 64] |= 1UL << (numa_nodes.ids[index] % 64);
+        }
+        long status = syscall(SYS_mbind, data, size, NUMA_MPOL_INTERLEAVE, mask,
+                              (unsigned long)(sizeof(mask) * 8), 0);
+        policy = (status == 0) ? "interleave" : "interleave failed, local";
+    }
+    else if (placement == NUMA_PLACE_INTERLEAVE)
+    {
+        policy = "interleave skipped (1 node)";
+    }
+
+    const char* huge = "unavailable";
+#ifdef MADV_HUGEPAGE
+    huge = (madvise(data, size, MADV_HUGEPAGE) == 0) ? "on" : "refused";
+#endif
+
+    numa_report("%s %zu bytes: %s, huge pages %s", what, bytes, policy, huge);
+    return data;
+}
+
+/* ---------- Потоки ---------- */
+
+int matrix_numa_pin_worker(int worker)
+{
+    if (!matrix_numa_enabled() || numa_topology.cpus == 0 || worker < 0)
+    {
+        return -1;
+    }
+
+    int slot = worker % numa_topology.cpus;
+    int cpu = numa_topology.cpu_ids[slot];
+    unsigned long mask[NUMA_MASK_WORDS] = {0};
+    mask[cpu / 64] |= 1UL << (cpu % 64);
+    if (syscall(SYS_sched_setaffinity, 0, sizeof(mask), mask) != 0)
+    {
+        numa_report("worker %d: pinning to cpu %d failed", worker, cpu);
+        return -1;
+    }
+
+    numa_pinned_cpu = cpu;
+    numa_report("worker %d -> cpu %d (node %d)", worker, cpu, numa_topology.cpu_nodes[slot]);
+    return cpu;
+}
+
+int matrix_numa_pinned(void)
+{
+    return numa_pinned_cpu >= 0;
+}
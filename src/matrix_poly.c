@@ -0,0 +1,1036 @@
+#include "../include/matrix_poly.h"
+#include "../include/matrix_kernels.h"
+#include "../include/modular.h"
+#include "../include/trace.h"
+
+typedef unsigned __int128 U128;
+
+#define SHOUP_LIMIT (1ULL << 63)            /* метод Шоупа требует модуль < 2^63 */
+#define CAYLEY_HAMILTON_OVERHEAD 8          /* стоимость многочленной части в умножениях матриц */
+
+static inline ULL add_mod(ULL a, ULL b, ULL p)
+{
+    ULL sum = a + b;
+    return (sum < a || sum >= p) ? sum - p : sum;
+}
+
+static inline ULL sub_mod(ULL a, ULL b, ULL p)
+{
+    return (a >= b) ? a - b : a + (p - b);
+}
+
+/* Умножение на фиксированный множитель w: метод Шоупа при p < 2^63, иначе 128-битное деление */
+static inline ULL fixed_shoup(ULL w, ULL p)
+{
+    return p < SHOUP_LIMIT ? modular_shoup(w, p) : 0;
+}
+
+static inline ULL mul_fixed(ULL x, ULL w, ULL w_shoup, ULL p)
+{
+    return p < SHOUP_LIMIT ? modular_mul_shoup(x, w, w_shoup, p) : modular_mul(x, w, p);
+}
+
+/* Сколько произведений (p-1)^2 помещается в 128-битный аккумулятор */
+static inline ULL accumulate_limit(ULL p)
+{
+    U128 limit = ~(U128)0 / ((U128)(p - 1) * (p - 1));
+    return limit > UINT64_MAX ? UINT64_MAX : (ULL)limit;
+}
+
+/* Длина блока схемы Патерсона — Стокмейера: ceil(sqrt(degree + 1)) */
+static int poly_eval_step(int degree)
+{
+    int step = 1;
+    while ((long long)step * step < (long long)degree + 1)
+    {
+        step++;
+    }
+    return step;
+}
+
+/* Привести h (n x n, по строкам) к верхней форме Хессенберга преобразованиями подобия */
+static void hessenberg_reduce(ULL* h, int n, ULL p)
+{
+    for (int j = 0; j + 2 < n; j++)
+    {
+        int pivot = j + 1;
+        while (pivot < n && h[(size_t)pivot * n + j] == 0)
+        {
+            pivot++;
+        }
+        if (pivot == n) continue;
+
+        /* Перестановка строк и столбцов pivot <-> j + 1 */
+        if (pivot != j + 1)
+        {
+            for (int c = 0; c < n; c++)
+            {
+                ULL t = h[(size_t)pivot * n + c];
+                h[(size_t)pivot * n + c] = h[(size_t)(j + 1) * n + c];
+                h[(size_t)(j + 1) * n + c] = t;
+            }
+            for (int r = 0; r < n; r++)
+            {
+                ULL t = h[(size_t)r * n + pivot];
+                h[(size_t)r * n + pivot] = h[(size_t)r * n + j + 1];
+                h[(size_t)r * n + j + 1] = t;
+            }
+        }
+
+        ULL inverse = modular_inverse(h[(size_t)(j + 1) * n + j], p);
+        ULL inverse_shoup = fixed_shoup(inverse, p);
+        const ULL* pivot_row = h + (size_t)(j + 1) * n;
+        for (int r = j + 2; r < n; r++)
+        {
+            ULL* row = h + (size_t)r * n;
+            ULL u = mul_fixed(row[j], inverse, inverse_shoup, p);
+            if (u == 0) continue;
+            ULL u_shoup = fixed_shoup(u, p);
+
+            /* Строка r -= u * строка j+1, затем столбец j+1 += u * столбец r */
+            for (int c = j; c < n; c++)
+            {
+                row[c] = sub_mod(row[c], mul_fixed(pivot_row[c], u, u_shoup, p), p);
+            }
+            for (int k = 0; k < n; k++)
+            {
+                ULL* line = h + (size_t)k * n;
+                line[j + 1] = add_mod(line[j + 1], mul_fixed(line[r], u, u_shoup, p), p);
+            }
+        }
+    }
+}
+
+int matrix_charpoly(const Matrix* a, ULL* coeffs)
+{
+    TRACE_SCOPE("charpoly");
+
+    if (!a || !coeffs)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+    if (a->rows != a->cols)
+    {
+        return MATRIX_ERROR_NOT_SQUARE;
+    }
+    if (a->field_size < 2)
+    {
+        return MATRIX_ERROR_INVALID_FIELD;
+    }
+
+    int n = a->rows;
+    ULL p = a->field_size;
+    ULL* h = (ULL*)malloc((size_t)n * n * sizeof(ULL));
+    ULL* polys = (ULL*)calloc((size_t)(n + 1) * (n + 1), sizeof(ULL));
+    if (!h || !polys)
+    {
+        free(h);
+        free(polys);
+        return MATRIX_ERROR_CREATION;
+    }
+
+    for (size_t i = 0; i < (size_t)n * n; i++)
+    {
+        h[i] = a->data[0][i] % p;
+    }
+    hessenberg_reduce(h, n, p);
+
+    /*
+     * polys[k] — характеристический многочлен ведущего блока k x k:
+     * p_k = (x - h[k-1][k-1]) p_{k-1} - sum_i h[k-1-i][k-1] * h[k-1][k-2] ... h[k-i][k-i-1] * p_{k-1-i}
+     */
+    const size_t stride = (size_t)n + 1;
+    polys[0] = 1 % p;
+    for (int k = 1; k <= n; k++)
+    {
+        ULL* current = polys + (size_t)k * stride;
+        const ULL* previous = polys + (size_t)(k - 1) * stride;
+        ULL diagonal = h[(size_t)(k - 1) * n + k - 1];
+        ULL diagonal_shoup = fixed_shoup(diagonal, p);
+
+        for (int i = 0; i <= k; i++)
+        {
+            ULL shifted = (i > 0) ? previous[i - 1] : 0;
+            ULL scaled = (i < k) ? mul_fixed(previous[i], diagonal, diagonal_shoup, p) : 0;
+            current[i] = sub_mod(shifted, scaled, p);
+        }
+
+        ULL product = 1 % p;
+        for (int i = 1; i < k; i++)
+        {
+            product = modular_mul(product, h[(size_t)(k - i) * n + (k - i - 1)], p);
+            if (product == 0) break;
+
+            ULL coefficient = modular_mul(product, h[(size_t)(k - i - 1) * n + (k - 1)], p);
+            if (coefficient == 0) continue;
+            ULL coefficient_shoup = fixed_shoup(coefficient, p);
+
+            const ULL* lower = polys + (size_t)(k - i - 1) * stride;
+            for (int j = 0; j <= k - i - 1; j++)
+            {
+                current[j] = sub_mod(current[j], mul_fixed(lower[j], coefficient, coefficient_shoup, p), p);
+            }
+        }
+    }
+
+    memcpy(coeffs, polys + (size_t)n * stride, stride * sizeof(ULL));
+    free(h);
+    free(polys);
+    return MATRIX_SUCCESS;
+}
+
+int matrix_poly_eval_multiplies(int degree)
+{
+    if (degree < 2) return 0;
+
+    int step = poly_eval_step(degree);
+    int chunks = degree / step + 1;
+    /* A^2 ... A^(step-1), затем A^step и chunks - 1 шагов Горнера, если блоков больше одного */
+    return (step - 2) + ((chunks > 1) ? chunks : 0);
+}
+
+/* acc += c[0] I + c[1] A + ... + c[count-1] A^(count-1); powers[j] = A^j */
+static int poly_eval_add_block(Matrix* acc, const Matrix* const* powers, const ULL* c, int count, ULL p)
+{
+    int error = MATRIX_SUCCESS;
+    for (int j = 1; j < count && error == MATRIX_SUCCESS; j++)
+    {
+        ULL coefficient = p ? c[j] % p : c[j];
+        if (coefficient != 0) error = matrix_axpby(1, acc, coefficient, powers[j], acc);
+    }
+
+    ULL constant = p ? c[0] % p : c[0];
+    for (int i = 0; i < acc->rows && error == MATRIX_SUCCESS; i++)
+    {
+        acc->data[i][i] = p ? add_mod(acc->data[i][i], constant, p) : acc->data[i][i] + constant;
+    }
+    return error;
+}
+
+int matrix_poly_eval(const Matrix* a, const ULL* coeffs, int degree, Matrix** result)
+{
+    TRACE_SCOPE("poly_eval");
+
+    if (!a || !coeffs || !result)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+    if (a->rows != a->cols)
+    {
+        return MATRIX_ERROR_NOT_SQUARE;
+    }
+    if (degree < 0)
+    {
+        return MATRIX_ERROR_INVALID_SIZE;
+    }
+
+    int n = a->rows;
+    ULL p = a->field_size;
+    while (degree > 0 && (p ? coeffs[degree] % p : coeffs[degree]) == 0)
+    {
+        degree--;
+    }
+
+    /*
+     * Патерсон — Стокмейер: p(x) = Σ_k B_k(x) (x^s)^k, deg B_k < s. Степени A^1 ... A^s
+     * считаются один раз, блоки B_k(A) — линейные комбинации (matrix_axpby), а внешний
+     * многочлен от A^s — схемой Горнера.
+     */
+    int step = poly_eval_step(degree);
+    int chunks = degree / step + 1;
+    int top = (chunks > 1) ? step : step - 1;
+    const Matrix** powers = (const Matrix**)calloc((size_t)step + 1, sizeof(Matrix*));
+    Matrix* acc = NULL;
+    if (!powers)
+    {
+        return MATRIX_ERROR_CREATION;
+    }
+
+    powers[1] = a;
+    int error = MATRIX_SUCCESS;
+    TRACE_BEGIN("poly_eval_powers");
+    for (int j = 2; j <= top && error == MATRIX_SUCCESS; j++)
+    {
+        error = matrix_multiply(powers[j - 1], a, (Matrix**)&powers[j]);
+    }
+    TRACE_END();
+
+    if (error == MATRIX_SUCCESS) error = matrix_create(n, n, p, &acc);
+    if (error == MATRIX_SUCCESS)
+    {
+        int k = chunks - 1;
+        error = poly_eval_add_block(acc, powers, coeffs + (size_t)k * step, degree - k * step + 1, p);
+    }
+    for (int k = chunks - 2; k >= 0 && error == MATRIX_SUCCESS; k--)
+    {
+        Matrix* next = NULL;
+        error = matrix_multiply(acc, powers[step], &next);
+        if (error != MATRIX_SUCCESS) break;
+
+        matrix_free(acc);
+        acc = next;
+        error = poly_eval_add_block(acc, powers, coeffs + (size_t)k * step, step, p);
+    }
+
+    for (int j = 2; j <= top; j++)
+    {
+        matrix_free((Matrix*)powers[j]);
+    }
+    free(powers);
+    if (error != MATRIX_SUCCESS)
+    {
+        matrix_free(acc);
+        return error;
+    }
+    *result = acc;
+    return MATRIX_SUCCESS;
+}
+
+int matrix_cayley_hamilton_preferred(ULL field_size, int n, ULL exponent)
+{
+    /* Для узких элементов и ядра double умножение матриц настолько дешевле скалярной
+       арифметики характеристического многочлена, что он не окупается */
+    if (exponent < 2 || matrix_element_width(field_size) < 4 ||
+        packed_matrix_format(field_size) != PACKED_INTEGER)
+    {
+        return 0;
+    }
+
+    /* matrix_power: умножение на каждый единичный бит и возведение в квадрат на каждый следующий */
+    int binary = 63 - __builtin_clzll(exponent) + __builtin_popcountll(exponent);
+    return matrix_poly_eval_multiplies(n - 1) + CAYLEY_HAMILTON_OVERHEAD < binary;
+}
+
+int matrix_cayley_hamilton_preferred_big(ULL field_size, int n, const BigInt* exponent)
+{
+    ULL small_exponent;
+    if (bigint_to_ull(exponent, &small_exponent))
+    {
+        return matrix_cayley_hamilton_preferred(field_size, n, small_exponent);
+    }
+    if (matrix_element_width(field_size) < 4 || packed_matrix_format(field_size) != PACKED_INTEGER)
+    {
+        return 0;
+    }
+
+    int binary = bigint_bit_length(exponent) - 1;
+    for (int i = 0; i < exponent->size; i++)
+    {
+        binary += __builtin_popcount(exponent->limbs[i]);
+    }
+    return matrix_poly_eval_multiplies(n - 1) + CAYLEY_HAMILTON_OVERHEAD < binary;
+}
+
+/*
+ * Таблица остатков x^(n+j) mod χ(x), j = 0 ... n-1, для унитарного χ степени n.
+ * Хранится по столбцам: table[i * n + j] — коэффициент при x^i у x^(n+j).
+ */
+static void poly_reduction_table(const ULL* charpoly, int n, ULL p, ULL* table, ULL* row)
+{
+    /* x^n = -(χ_0 + χ_1 x + ... + χ_{n-1} x^{n-1}) */
+    for (int i = 0; i < n; i++)
+    {
+        row[i] = sub_mod(0, charpoly[i], p);
+    }
+    for (int j = 0; j < n; j++)
+    {
+        for (int i = 0; i < n; i++)
+        {
+            table[(size_t)i * n + j] = row[i];
+        }
+
+        /* x^(n+j+1) = x * x^(n+j): сдвиг и замена старшего члена через x^n */
+        ULL top = row[n - 1];
+        for (int i = n - 1; i > 0; i--)
+        {
+            row[i] = add_mod(row[i - 1], modular_mul(top, sub_mod(0, charpoly[i], p), p), p);
+        }
+        row[0] = modular_mul(top, sub_mod(0, charpoly[0], p), p);
+    }
+}
+
+/*
+ * out = (r * r * x^shift) mod χ, степени r меньше n, shift — 0 или 1.
+ * Свёртка и приведение накапливаются в 128-битных суммах с отложенным делением.
+ */
+static void poly_square_mod(const ULL* r, int n, int shift, const ULL* table, ULL p, ULL* product, ULL* out)
+{
+    const ULL limit = accumulate_limit(p);
+
+    /* квадрат: пары r_i r_(k-i) и r_(k-i) r_i равны, поэтому считается половина суммы */
+    for (int k = 0; k <= 2 * n - 2; k++)
+    {
+        int low = (k - n + 1 > 0) ? k - n + 1 : 0;
+        U128 acc = 0;
+        ULL count = 0;
+        for (int i = low; i < k - i; i++)
+        {
+            if (count >= limit)
+            {
+                acc %= p;
+                count = 1;
+            }
+            acc += (U128)r[i] * r[k - i];
+            count++;
+        }
+        U128 total = 2 * (acc % p);
+        if (k % 2 == 0) total += (U128)r[k / 2] * r[k / 2];
+        product[k + shift] = (ULL)(total % p);
+    }
+    if (shift) product[0] = 0;
+
+    int top = 2 * n - 2 + shift;
+    for (int i = 0; i < n; i++)
+    {
+        const ULL* column = table + (size_t)i * n;
+        U128 acc = product[i];
+        ULL count = 1;
+        for (int d = n; d <= top; d++)
+        {
+            if (count >= limit)
+            {
+                acc %= p;
+                count = 1;
+            }
+            acc += (U128)product[d] * column[d - n];
+            count++;
+        }
+        out[i] = (ULL)(acc % p);
+    }
+}
+
+/*
+ * remainder = x^e mod χ(x) для унитарного χ степени n (charpoly[0..n]); показатель задан
+ * битами limbs (по 32 бита, младшие первыми). remainder — не меньше 2n элементов.
+ */
+static int poly_power_mod(const ULL* charpoly, int n, ULL p, const uint32_t* limbs, int bit_count, ULL* remainder)
+{
+    ULL* table = (ULL*)malloc((size_t)n * n * sizeof(ULL));
+    ULL* product = (ULL*)calloc(2 * (size_t)n, sizeof(ULL));
+    if (!table || !product)
+    {
+        free(table);
+        free(product);
+        return MATRIX_ERROR_CREATION;
+    }
+
+    poly_reduction_table(charpoly, n, p, table, remainder);
+
+    /* бинарное возведение от старшего бита */
+    memset(remainder, 0, 2 * (size_t)n * sizeof(ULL));
+    remainder[0] = 1 % p;
+    for (int bit = bit_count - 1; bit >= 0; bit--)
+    {
+        poly_square_mod(remainder, n, (int)((limbs[bit / 32] >> (bit % 32)) & 1), table, p, product, remainder);
+    }
+
+    free(table);
+    free(product);
+    return MATRIX_SUCCESS;
+}
+
+/* A^e = (x^e mod χ)(A) */
+static int cayley_hamilton_power(const Matrix* base, const uint32_t* limbs, int bit_count, Matrix** result)
+{
+    TRACE_SCOPE("cayley_hamilton");
+
+    int n = base->rows;
+    ULL p = base->field_size;
+    ULL* charpoly = (ULL*)malloc((size_t)(n + 1) * sizeof(ULL));
+    ULL* remainder = (ULL*)calloc(2 * (size_t)n, sizeof(ULL));
+    if (!charpoly || !remainder)
+    {
+        free(charpoly);
+        free(remainder);
+        return MATRIX_ERROR_CREATION;
+    }
+
+    int error = matrix_charpoly(base, charpoly);
+    if (error == MATRIX_SUCCESS) error = poly_power_mod(charpoly, n, p, limbs, bit_count, remainder);
+    if (error == MATRIX_SUCCESS) error = matrix_poly_eval(base, remainder, n - 1, result);
+
+    free(charpoly);
+    free(remainder);
+    return error;
+}
+
+static int cayley_hamilton_check(const Matrix* base, Matrix** result)
+{
+    if (!base || !result)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+    if (base->rows != base->cols)
+    {
+        return MATRIX_ERROR_NOT_SQUARE;
+    }
+    if (base->field_size < 2)
+    {
+        return MATRIX_ERROR_INVALID_FIELD;
+    }
+    return MATRIX_SUCCESS;
+}
+
+int matrix_power_cayley_hamilton(const Matrix* base, ULL exponent, Matrix** result)
+{
+    int error = cayley_hamilton_check(base, result);
+    if (error != MATRIX_SUCCESS) return error;
+
+    uint32_t limbs[2] = {(uint32_t)exponent, (uint32_t)(exponent >> 32)};
+    return cayley_hamilton_power(base, limbs, 64 - __builtin_clzll(exponent | 1), result);
+}
+
+int matrix_power_cayley_hamilton_big(const Matrix* base, const BigInt* exponent, Matrix** result)
+{
+    int error = cayley_hamilton_check(base, result);
+    if (error != MATRIX_SUCCESS) return error;
+    if (!exponent)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+
+    uint32_t zero = 0;
+    int bit_count = bigint_bit_length(exponent);
+    return cayley_hamilton_power(base, bit_count ? exponent->limbs : &zero, bit_count ? bit_count : 1, result);
+}
+
+/* ---------- Сопровождающие матрицы линейных рекуррент (метод Китамасы) ---------- */
+
+/*
+ * Каждый вид сводится к верхнему T: коэффициенты в строке 0, T[i][i-1] = 1.
+ * Элемент T[i][j] хранится в a[*row][*col]: нижний вид — J T J (J — обращение порядка
+ * индексов), левый — T^T, правый — J T^T J. Степени сводятся так же: C^e[...] = T^e[i][j].
+ */
+static inline void companion_index(int form, int n, int i, int j, int* row, int* col)
+{
+    switch (form)
+    {
+        case COMPANION_BOTTOM_ROW:
+            *row = n - 1 - i;
+            *col = n - 1 - j;
+            break;
+        case COMPANION_LEFT_COLUMN:
+            *row = j;
+            *col = i;
+            break;
+        case COMPANION_RIGHT_COLUMN:
+            *row = n - 1 - j;
+            *col = n - 1 - i;
+            break;
+        default:
+            *row = i;
+            *col = j;
+            break;
+    }
+}
+
+static int companion_matches(const Matrix* a, int form)
+{
+    int n = a->rows;
+    ULL p = a->field_size;
+    for (int i = 1; i < n; i++)
+    {
+        for (int j = 0; j < n; j++)
+        {
+            int row, col;
+            companion_index(form, n, i, j, &row, &col);
+            ULL value = p ? a->data[row][col] % p : a->data[row][col];
+            if (value != (ULL)(j == i - 1))
+            {
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+int matrix_companion_form(const Matrix* a, ULL* recurrence)
+{
+    if (!a || a->rows != a->cols)
+    {
+        return COMPANION_NONE;
+    }
+
+    int n = a->rows;
+    ULL p = a->field_size;
+    for (int form = COMPANION_TOP_ROW; form <= COMPANION_RIGHT_COLUMN; form++)
+    {
+        if (!companion_matches(a, form)) continue;
+
+        for (int k = 0; recurrence && k < n; k++)
+        {
+            int row, col;
+            companion_index(form, n, 0, k, &row, &col);
+            recurrence[k] = p ? a->data[row][col] % p : a->data[row][col];
+        }
+        return form;
+    }
+    return COMPANION_NONE;
+}
+
+/*
+ * Строка i матрицы T^e равна строке 0 матрицы T^(e-i), а T^m[0][j] — коэффициенту при
+ * x^(n-1-j) остатка x^(m+n-1) mod χ(x). Поэтому находится r = x^e mod χ (строка n - 1),
+ * и каждая следующая строка вверх получается умножением r на x по модулю χ за O(n).
+ */
+static int companion_power(const Matrix* base, int form, const uint32_t* limbs, int bit_count, Matrix** result)
+{
+    TRACE_SCOPE("companion_power");
+
+    int n = base->rows;
+    ULL p = base->field_size;
+    ULL* recurrence = (ULL*)malloc((size_t)n * sizeof(ULL));
+    ULL* charpoly = (ULL*)malloc((size_t)(n + 1) * sizeof(ULL));
+    ULL* remainder = (ULL*)calloc(2 * (size_t)n, sizeof(ULL));
+    Matrix* power = NULL;
+    if (!recurrence || !charpoly || !remainder)
+    {
+        free(recurrence);
+        free(charpoly);
+        free(remainder);
+        return MATRIX_ERROR_CREATION;
+    }
+
+    /* x_(k+1) = a_1 x_k + ... + a_n x_(k-n+1): χ(x) = x^n - a_1 x^(n-1) - ... - a_n */
+    matrix_companion_form(base, recurrence);
+    for (int i = 0; i < n; i++)
+    {
+        charpoly[i] = sub_mod(0, recurrence[n - 1 - i], p);
+    }
+    charpoly[n] = 1;
+
+    int error = poly_power_mod(charpoly, n, p, limbs, bit_count, remainder);
+    if (error == MATRIX_SUCCESS) error = matrix_create_uninit(n, n, p, &power);
+    for (int i = n - 1; i >= 0 && error == MATRIX_SUCCESS; i--)
+    {
+        for (int j = 0; j < n; j++)
+        {
+            int row, col;
+            companion_index(form, n, i, j, &row, &col);
+            power->data[row][col] = remainder[n - 1 - j];
+        }
+        if (i == 0) break;
+
+        /* r = x r mod χ: x^n = a_n + a_(n-1) x + ... + a_1 x^(n-1) */
+        ULL top = remainder[n - 1];
+        ULL top_shoup = fixed_shoup(top, p);
+        for (int k = n - 1; k > 0; k--)
+        {
+            remainder[k] = add_mod(remainder[k - 1], mul_fixed(recurrence[n - 1 - k], top, top_shoup, p), p);
+        }
+        remainder[0] = mul_fixed(recurrence[n - 1], top, top_shoup, p);
+    }
+
+    free(recurrence);
+    free(charpoly);
+    free(remainder);
+    if (error != MATRIX_SUCCESS)
+    {
+        matrix_free(power);
+        return error;
+    }
+    *result = power;
+    return MATRIX_SUCCESS;
+}
+
+static int companion_check(const Matrix* base, Matrix** result, int* form)
+{
+    if (!base || !result)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+    if (base->rows != base->cols)
+    {
+        return MATRIX_ERROR_NOT_SQUARE;
+    }
+    if (base->field_size < 2)
+    {
+        return MATRIX_ERROR_INVALID_FIELD;
+    }
+    *form = matrix_companion_form(base, NULL);
+    return (*form == COMPANION_NONE) ? MATRIX_ERROR_INVALID_NUMBER : MATRIX_SUCCESS;
+}
+
+int matrix_power_companion(const Matrix* base, ULL exponent, Matrix** result)
+{
+    int form;
+    int error = companion_check(base, result, &form);
+    if (error != MATRIX_SUCCESS) return error;
+
+    uint32_t limbs[2] = {(uint32_t)exponent, (uint32_t)(exponent >> 32)};
+    return companion_power(base, form, limbs, 64 - __builtin_clzll(exponent | 1), result);
+}
+
+int matrix_power_companion_big(const Matrix* base, const BigInt* exponent, Matrix** result)
+{
+    int form;
+    int error = companion_check(base, result, &form);
+    if (error != MATRIX_SUCCESS) return error;
+    if (!exponent)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+
+    uint32_t zero = 0;
+    int bit_count = bigint_bit_length(exponent);
+    return companion_power(base, form, bit_count ? exponent->limbs : &zero, bit_count ? bit_count : 1, result);
+}
+
+/* ---------- Разложение характеристического многочлена и порядок матрицы ---------- */
+
+/* Многочлен над GF(p) в буфере фиксированной ёмкости; у нулевого degree == -1 */
+typedef struct Poly
+{
+    ULL* c;                         /* коэффициенты c[0..degree] */
+    int degree;                     /* степень */
+} Poly;
+
+static void poly_trim(Poly* a)
+{
+    while (a->degree >= 0 && a->c[a->degree] == 0)
+    {
+        a->degree--;
+    }
+}
+
+static void poly_assign(Poly* dst, const Poly* src)
+{
+    if (dst != src && src->degree >= 0)
+    {
+        memmove(dst->c, src->c, (size_t)(src->degree + 1) * sizeof(ULL));
+    }
+    dst->degree = src->degree;
+}
+
+static void poly_make_monic(Poly* a, ULL p)
+{
+    if (a->degree < 0 || a->c[a->degree] == 1) return;
+
+    ULL inverse = modular_inverse(a->c[a->degree], p);
+    ULL inverse_shoup = fixed_shoup(inverse, p);
+    for (int i = 0; i <= a->degree; i++)
+    {
+        a->c[i] = mul_fixed(a->c[i], inverse, inverse_shoup, p);
+    }
+}
+
+/* a := a mod b; при quotient != NULL туда записывается частное */
+static void poly_divide(Poly* a, const Poly* b, Poly* quotient, ULL p)
+{
+    ULL inverse = modular_inverse(b->c[b->degree], p);
+    ULL inverse_shoup = fixed_shoup(inverse, p);
+
+    if (quotient)
+    {
+        quotient->degree = a->degree - b->degree;
+        if (quotient->degree < 0) quotient->degree = -1;
+    }
+    for (int d = a->degree; d >= b->degree; d--)
+    {
+        ULL factor = mul_fixed(a->c[d], inverse, inverse_shoup, p);
+        if (quotient) quotient->c[d - b->degree] = factor;
+        if (factor == 0) continue;
+
+        ULL factor_shoup = fixed_shoup(factor, p);
+        for (int i = 0; i <= b->degree; i++)
+        {
+            a->c[d - b->degree + i] = sub_mod(a->c[d - b->degree + i], mul_fixed(b->c[i], factor, factor_shoup, p), p);
+        }
+    }
+    if (a->degree >= b->degree) a->degree = b->degree - 1;
+    poly_trim(a);
+}
+
+/* result := унитарный НОД(a, b); x, y — рабочие буферы */
+static void poly_gcd(const Poly* a, const Poly* b, Poly* result, Poly* x, Poly* y, ULL p)
+{
+    poly_assign(x, a);
+    poly_assign(y, b);
+    while (y->degree >= 0)
+    {
+        poly_divide(x, y, NULL, p);
+        Poly t = *x;
+        *x = *y;
+        *y = t;
+    }
+    poly_make_monic(x, p);
+    poly_assign(result, x);
+}
+
+/* result := a * b mod m (m унитарный); product — рабочий буфер ёмкости 2 * deg m */
+static void poly_mulmod(const Poly* a, const Poly* b, const Poly* m, Poly* result, Poly* product, ULL p)
+{
+    const ULL limit = accumulate_limit(p);
+
+    if (a->degree < 0 || b->degree < 0)
+    {
+        result->degree = -1;
+        return;
+    }
+    product->degree = a->degree + b->degree;
+    for (int k = 0; k <= product->degree; k++)
+    {
+        int low = (k - b->degree > 0) ? k - b->degree : 0;
+        int high = (k < a->degree) ? k : a->degree;
+        U128 acc = 0;
+        ULL count = 0;
+        for (int i = low; i <= high; i++)
+        {
+            if (count >= limit)
+            {
+                acc %= p;
+                count = 1;
+            }
+            acc += (U128)a->c[i] * b->c[k - i];
+            count++;
+        }
+        product->c[k] = (ULL)(acc % p);
+    }
+    poly_trim(product);
+    poly_divide(product, m, NULL, p);
+    poly_assign(result, product);
+}
+
+/* h := h^exponent mod m */
+static void poly_powmod(Poly* h, ULL exponent, const Poly* m, Poly* base, Poly* product, ULL p)
+{
+    poly_assign(base, h);
+    h->c[0] = 1;
+    h->degree = 0;
+    for (int bit = 63 - __builtin_clzll(exponent | 1); bit >= 0; bit--)
+    {
+        poly_mulmod(h, h, m, h, product, p);
+        if ((exponent >> bit) & 1) poly_mulmod(h, base, m, h, product, p);
+    }
+}
+
+/* Рабочие буферы анализа многочлена степени не выше n */
+typedef struct PolyWorkspace
+{
+    ULL* storage;
+    Poly f, derivative, c, w, y, x, g;                  /* разложение на свободные от квадратов */
+    Poly h, shifted, factor, quotient, base, product;   /* разложение по степеням */
+    Poly gx, gy;                                        /* рабочие буферы НОД */
+    unsigned char* degrees;         /* degrees[d] = 1 — есть неприводимый множитель степени d */
+    int max_multiplicity;           /* наибольшая кратность множителя */
+} PolyWorkspace;
+
+/* Степени неприводимых множителей свободного от квадратов g (distinct-degree factorization) */
+static void poly_distinct_degrees(PolyWorkspace* ws, Poly* g, ULL p)
+{
+    Poly* h = &ws->h;
+    h->c[0] = 0;
+    h->c[1] = 1;
+    h->degree = 1;
+    if (g->degree >= 1) poly_divide(h, g, NULL, p);
+
+    for (int d = 1; 2 * d <= g->degree; d++)
+    {
+        /* h = x^(p^d) mod g; НОД(g, h - x) — произведение множителей степени d */
+        poly_powmod(h, p, g, &ws->base, &ws->product, p);
+
+        Poly* x = &ws->shifted;
+        poly_assign(x, h);
+        while (x->degree < 1)
+        {
+            x->c[++x->degree] = 0;
+        }
+        x->c[1] = sub_mod(x->c[1], 1, p);
+        poly_trim(x);
+
+        poly_gcd(g, x, &ws->factor, &ws->gx, &ws->gy, p);
+        if (ws->factor.degree > 0)
+        {
+            ws->degrees[d] = 1;
+            poly_divide(g, &ws->factor, &ws->quotient, p);
+            poly_assign(g, &ws->quotient);
+            poly_divide(h, g, NULL, p);
+        }
+    }
+    if (g->degree > 0)
+    {
+        ws->degrees[g->degree] = 1;
+    }
+}
+
+/* Разложение f на свободные от квадратов множители (алгоритм Юна для GF(p)) */
+static void poly_squarefree_degrees(PolyWorkspace* ws, ULL p)
+{
+    Poly* f = &ws->f;
+    ULL scale = 1;
+
+    while (f->degree > 0)
+    {
+        /* c = НОД(f, f'), w = f / c */
+        Poly* derivative = &ws->derivative;
+        derivative->degree = f->degree - 1;
+        for (int i = 1; i <= f->degree; i++)
+        {
+            derivative->c[i - 1] = modular_mul((ULL)i % p, f->c[i], p);
+        }
+        poly_trim(derivative);
+
+        if (derivative->degree >= 0) poly_gcd(f, derivative, &ws->c, &ws->gx, &ws->gy, p);
+        else poly_assign(&ws->c, f);
+
+        poly_assign(&ws->w, f);
+        poly_divide(&ws->w, &ws->c, &ws->y, p);
+        poly_assign(&ws->w, &ws->y);
+
+        for (ULL i = 1; ws->w.degree > 0; i++)
+        {
+            poly_gcd(&ws->w, &ws->c, &ws->y, &ws->gx, &ws->gy, p);
+
+            /* g = w / y — произведение множителей кратности i * scale */
+            poly_assign(&ws->x, &ws->w);
+            poly_divide(&ws->x, &ws->y, &ws->g, p);
+            if (ws->g.degree > 0)
+            {
+                ULL multiplicity = i * scale;
+                if (multiplicity > (ULL)ws->max_multiplicity) ws->max_multiplicity = (int)multiplicity;
+                poly_distinct_degrees(ws, &ws->g, p);
+            }
+
+            poly_assign(&ws->w, &ws->y);
+            poly_divide(&ws->c, &ws->y, &ws->x, p);
+            poly_assign(&ws->c, &ws->x);
+        }
+
+        /* Остаток c — многочлен от x^p: извлечь корень степени p и продолжить */
+        if (ws->c.degree <= 0) break;
+        f->degree = ws->c.degree / (int)p;
+        for (int i = 0; i <= f->degree; i++)
+        {
+            f->c[i] = ws->c.c[(size_t)i * p];
+        }
+        scale *= p;
+    }
+}
+
+int matrix_order_bound(const Matrix* a, BigInt* period, int* preperiod)
+{
+    TRACE_SCOPE("order_bound");
+
+    if (!a || !period || !preperiod)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+    if (a->rows != a->cols)
+    {
+        return MATRIX_ERROR_NOT_SQUARE;
+    }
+    if (!modular_is_prime(a->field_size))
+    {
+        return MATRIX_ERROR_INVALID_FIELD;
+    }
+
+    int n = a->rows;
+    ULL p = a->field_size;
+    const int buffers = 15;
+    const size_t capacity = 2 * (size_t)n + 2;
+
+    PolyWorkspace ws;
+    ws.storage = (ULL*)calloc(buffers * capacity, sizeof(ULL));
+    ws.degrees = (unsigned char*)calloc((size_t)n + 1, 1);
+    if (!ws.storage || !ws.degrees)
+    {
+        free(ws.storage);
+        free(ws.degrees);
+        return MATRIX_ERROR_CREATION;
+    }
+    Poly* polys[] = {&ws.f, &ws.derivative, &ws.c, &ws.w, &ws.y, &ws.x, &ws.g, &ws.h,
+                     &ws.shifted, &ws.factor, &ws.quotient, &ws.base, &ws.product, &ws.gx, &ws.gy};
+    for (int i = 0; i < buffers; i++)
+    {
+        polys[i]->c = ws.storage + (size_t)i * capacity;
+        polys[i]->degree = -1;
+    }
+    ws.max_multiplicity = 1;
+
+    int error = matrix_charpoly(a, ws.f.c);
+    if (error == MATRIX_SUCCESS)
+    {
+        /* χ = x^m * f: m — кратность нулевого собственного значения */
+        int m = 0;
+        while (m < n && ws.f.c[m] == 0)
+        {
+            m++;
+        }
+        memmove(ws.f.c, ws.f.c + m, (size_t)(n - m + 1) * sizeof(ULL));
+        ws.f.degree = n - m;
+        *preperiod = m;
+
+        poly_squarefree_degrees(&ws, p);
+    }
+
+    /* period = lcm(p^d - 1) * p^t */
+    BigInt prime, power, term, divisor;
+    bigint_init(&prime);
+    bigint_init(&power);
+    bigint_init(&term);
+    bigint_init(&divisor);
+    if (error == MATRIX_SUCCESS) error = bigint_set_ull(&prime, p);
+    if (error == MATRIX_SUCCESS) error = bigint_set_ull(period, 1);
+    if (error == MATRIX_SUCCESS) error = bigint_set_ull(&power, 1);
+    for (int d = 1; d <= n && error == MATRIX_SUCCESS; d++)
+    {
+        error = bigint_mul(&power, &prime, &power);
+        if (error != MATRIX_SUCCESS || !ws.degrees[d]) continue;
+
+        BigInt one;
+        bigint_init(&one);
+        error = bigint_set_ull(&one, 1);
+        if (error == MATRIX_SUCCESS) error = bigint_sub(&power, &one, &term);
+        bigint_free(&one);
+
+        if (error == MATRIX_SUCCESS) error = bigint_gcd(period, &term, &divisor);
+        if (error == MATRIX_SUCCESS) error = bigint_divmod(&term, &divisor, &term, NULL);
+        if (error == MATRIX_SUCCESS) error = bigint_mul(period, &term, period);
+    }
+    for (ULL reach = 1; error == MATRIX_SUCCESS && reach < (ULL)ws.max_multiplicity; reach *= p)
+    {
+        error = bigint_mul(period, &prime, period);
+    }
+
+    bigint_free(&prime);
+    bigint_free(&power);
+    bigint_free(&term);
+    bigint_free(&divisor);
+    free(ws.storage);
+    free(ws.degrees);
+    return error;
+}
+
+int matrix_reduce_exponent(const Matrix* a, const BigInt* exponent, BigInt* reduced)
+{
+    if (!a || !exponent || !reduced)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+
+    BigInt period, offset;
+    bigint_init(&period);
+    bigint_init(&offset);
+
+    int preperiod = 0;
+    int error = matrix_order_bound(a, &period, &preperiod);
+    if (error == MATRIX_SUCCESS) error = bigint_set_ull(&offset, (ULL)preperiod);
+    if (error == MATRIX_SUCCESS)
+    {
+        if (bigint_compare(exponent, &offset) < 0)
+        {
+            error = bigint_copy(reduced, exponent);
+        }
+        else
+        {
+            /* preperiod + (exponent - preperiod) mod period */
+            error = bigint_sub(exponent, &offset, reduced);
+            if (error == MATRIX_SUCCESS) error = bigint_divmod(reduced, &period, NULL, reduced);
+            if (error == MATRIX_SUCCESS) error = bigint_add(reduced, &offset, reduced);
+        }
+    }
+
+    bigint_free(&period);
+    bigint_free(&offset);
+    return error;
+}
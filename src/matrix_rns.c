@@ -0,0 +1,604 @@
+#include "../include/matrix_rns.h"
+#include "../include/matrix_kernels.h"
+#include "../include/matrix_fma.h"
+#include "../include/matrix_poly.h"
+#include "../include/modular.h"
+#include "../include/trace.h"
+#include "../include/matrix_verify.h"
+#include "../include/matrix_sched.h"
+
+#include <math.h>
+#include <stdatomic.h>
+
+typedef unsigned __int128 U128;
+
+#define RNS_FMA_BOUND (1ULL << 23)          /* (p-1)^2 < 2^46: блок по k в ядре double не короче 128 */
+#define RNS_INTEGER_BOUND (1ULL << 28)      /* (p-1)^2 < 2^56: 256 произведений до приведения */
+#define RNS_MIN_LARGE_FIELD (1ULL << 32)    /* ниже этого модуля хватает 64-битных ядер */
+#define RNS_SERIAL_FIELD (1ULL << 62)       /* выше — приведение через 128 бит почти на каждом шаге */
+#define RNS_MIN_MULTIPLY_SIZE 96            /* меньшие матрицы не окупают перевод в каналы */
+#define RNS_WRAP_POWER_OF_TWO (1ULL << 28)  /* выше 32-битное ядро приводит слишком часто */
+
+ULL rns_channel_bound(void)
+{
+    return packed_matrix_format(RNS_FMA_BOUND - 1) == PACKED_DOUBLE ? RNS_FMA_BOUND : RNS_INTEGER_BOUND;
+}
+
+/* x mod primes[index] без деления: частное оценивается через floor(2^64 / p) */
+static inline ULL rns_reduce(const RnsBasis* basis, int index, ULL x)
+{
+    ULL p = basis->primes[index];
+    ULL q = (ULL)(((U128)x * basis->barrett[index]) >> 64);
+    ULL r = x - q * p;
+    while (r >= p)
+    {
+        r -= p;
+    }
+    return r;
+}
+
+int rns_basis_create(double bits, RnsBasis* basis)
+{
+    if (!basis)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+
+    /* Модули не меньше bound / 2, поэтому каналов не больше bits / (log2(bound) - 1) + 1 */
+    ULL bound = rns_channel_bound();
+    double per_channel = log2((double)bound) - 1.0;
+    if (bits / per_channel + 1.0 > RNS_MAX_CHANNELS)
+    {
+        return MATRIX_ERROR_OVERFLOW;
+    }
+    int capacity = (int)(bits / per_channel) + 2;
+    if (capacity > RNS_MAX_CHANNELS) capacity = RNS_MAX_CHANNELS;
+
+    basis->count = 0;
+    basis->primes = (ULL*)malloc((size_t)capacity * sizeof(ULL));
+    basis->barrett = (ULL*)malloc((size_t)capacity * sizeof(ULL));
+    basis->inverses = NULL;
+    if (!basis->primes || !basis->barrett)
+    {
+        rns_basis_free(basis);
+        return MATRIX_ERROR_CREATION;
+    }
+
+    double total = 0.0;
+    ULL candidate = bound;
+    while (total <= bits && basis->count < capacity)
+    {
+        candidate = modular_prev_prime(candidate);
+        basis->primes[basis->count] = candidate;
+        basis->barrett[basis->count] = UINT64_MAX / candidate;
+        basis->count++;
+        total += log2((double)candidate);
+    }
+    if (total <= bits)
+    {
+        rns_basis_free(basis);
+        return MATRIX_ERROR_OVERFLOW;
+    }
+
+    basis->inverses = (ULL*)malloc((size_t)basis->count * basis->count * sizeof(ULL));
+    if (!basis->inverses)
+    {
+        rns_basis_free(basis);
+        return MATRIX_ERROR_CREATION;
+    }
+    for (int i = 0; i < basis->count; i++)
+    {
+        for (int j = 0; j < i; j++)
+        {
+            basis->inverses[(size_t)i * basis->count + j] =
+                modular_inverse(basis->primes[j] % basis->primes[i], basis->primes[i]);
+        }
+    }
+    return MATRIX_SUCCESS;
+}
+
+void rns_basis_free(RnsBasis* basis)
+{
+    if (!basis)
+    {
+        return;
+    }
+
+    free(basis->primes);
+    free(basis->barrett);
+    free(basis->inverses);
+    basis->primes = NULL;
+    basis->barrett = NULL;
+    basis->inverses = NULL;
+    basis->count = 0;
+}
+
+/*
+ * Цифры смешанной системы счисления по остаткам residues:
+ * X = digits[0] + digits[1]*p0 + digits[2]*p0*p1 + ...
+ */
+static void rns_garner(const RnsBasis* basis, const ULL* residues, ULL* digits)
+{
+    for (int i = 0; i < basis->count; i++)
+    {
+        ULL p = basis->primes[i];
+        const ULL* inverses = basis->inverses + (size_t)i * basis->count;
+        ULL x = residues[i];
+        for (int j = 0; j < i; j++)
+        {
+            /* digits[j] < primes[j] < 2 * p: одного вычитания достаточно */
+            ULL d = digits[j] >= p ? digits[j] - p : digits[j];
+            x = x >= d ? x - d : x + p - d;
+            x = rns_reduce(basis, i, x * inverses[j]);
+        }
+        digits[i] = x;
+    }
+}
+
+/* ---------- Параллельный запуск каналов ---------- */
+
+static int rns_cpu_count(void)
+{
+    static atomic_int cached = 0;
+    int count = atomic_load(&cached);
+    if (count == 0)
+    {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        count = (cpus > 1) ? (int)cpus : 1;
+        atomic_store(&cached, count);
+    }
+    return count;
+}
+
+typedef struct RnsTasks
+{
+    void (*run)(void* task);        /* обработчик одного канала */
+    char* tasks;                    /* массив описаний каналов */
+    size_t task_size;               /* размер одного описания */
+    MatrixVerifier* verifier;       /* контекст проверки вызывающего потока (matrix_verify.h) */
+} RnsTasks;
+
+static void rns_run_range(void* context, int begin, int end)
+{
+    RnsTasks* tasks = (RnsTasks*)context;
+    MatrixVerifier* previous = matrix_verifier_bind(tasks->verifier);
+    for (int index = begin; index < end; index++)
+    {
+        tasks->run(tasks->tasks + (size_t)index * tasks->task_size);
+    }
+    matrix_verifier_bind(previous);
+}
+
+/* Выполнить count задач как задачи планировщика (matrix_sched.h): по одному каналу на задачу */
+static void rns_run_parallel(void (*run)(void*), void* items, size_t item_size, int count)
+{
+    RnsTasks tasks = {run, (char*)items, item_size, matrix_verifier_current()};
+    sched_parallel_for(0, count, 1, rns_run_range, &tasks);
+}
+
+/* ---------- Умножение по большому модулю ---------- */
+
+typedef struct RnsMultiplyChannel
+{
+    const RnsBasis* basis;
+    int index;                      /* номер канала */
+    const ULL* a;
+    const ULL* b;
+    int rows, inner, cols;
+    PackedMatrix product;           /* a × b по модулю primes[index] */
+    int error;
+} RnsMultiplyChannel;
+
+/* Записать остатки src по модулю канала в упакованную матрицу (double или uint32_t) */
+static void rns_load_residues(const RnsBasis* basis, int index, const ULL* src, PackedMatrix* dst)
+{
+    size_t count = (size_t)dst->rows * dst->cols;
+    if (dst->format == PACKED_DOUBLE)
+    {
+        double* data = (double*)dst->data;
+        for (size_t i = 0; i < count; i++) data[i] = (double)rns_reduce(basis, index, src[i]);
+    }
+    else
+    {
+        uint32_t* data = (uint32_t*)dst->data;
+        for (size_t i = 0; i < count; i++) data[i] = (uint32_t)rns_reduce(basis, index, src[i]);
+    }
+}
+
+static inline ULL rns_residue_at(const PackedMatrix* m, size_t i)
+{
+    return (m->format == PACKED_DOUBLE) ? (ULL)((const double*)m->data)[i]
+                                        : (ULL)((const uint32_t*)m->data)[i];
+}
+
+static void rns_multiply_channel(void* arg)
+{
+    RnsMultiplyChannel* channel = (RnsMultiplyChannel*)arg;
+    ULL p = channel->basis->primes[channel->index];
+    PackedMatrix pa = {0}, pb = {0};
+
+    TRACE_BEGIN("rns_channel");
+    int error = packed_matrix_create(channel->rows, channel->inner, p, &pa);
+    if (error == MATRIX_SUCCESS) error = packed_matrix_create(channel->inner, channel->cols, p, &pb);
+    if (error == MATRIX_SUCCESS) error = packed_matrix_create(channel->rows, channel->cols, p, &channel->product);
+    if (error == MATRIX_SUCCESS)
+    {
+        rns_load_residues(channel->basis, channel->index, channel->a, &pa);
+        rns_load_residues(channel->basis, channel->index, channel->b, &pb);
+        error = packed_matrix_multiply(&pa, &pb, &channel->product);
+    }
+    TRACE_END();
+
+    packed_matrix_free(&pa);
+    packed_matrix_free(&pb);
+    channel->error = error;
+}
+
+int rns_multiply_preferred(ULL field_size, int rows, int inner, int cols)
+{
+    if (rows < RNS_MIN_MULTIPLY_SIZE || inner < RNS_MIN_MULTIPLY_SIZE || cols < RNS_MIN_MULTIPLY_SIZE)
+    {
+        return 0;
+    }
+
+    /* На одном ядре каналы выигрывают только у частого 128-битного приведения;
+       при нескольких ядрах каналы считаются параллельно */
+    return field_size > RNS_SERIAL_FIELD || (field_size >= RNS_MIN_LARGE_FIELD && rns_cpu_count() > 1);
+}
+
+int rns_multiply(const ULL* a, const ULL* b, ULL* c, int rows, int inner, int cols, ULL field_size)
+{
+    if (!a || !b || !c)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+    if (field_size < 2)
+    {
+        return MATRIX_ERROR_INVALID_FIELD;
+    }
+
+    /* Точное произведение меньше inner * (field_size - 1)^2 */
+    double bits = 2.0 * log2((double)(field_size - 1)) + log2((double)inner) + 1.0;
+    RnsBasis basis;
+    int error = rns_basis_create(bits, &basis);
+    if (error != MATRIX_SUCCESS) return error;
+
+    RnsMultiplyChannel* channels = (RnsMultiplyChannel*)calloc((size_t)basis.count, sizeof(RnsMultiplyChannel));
+    if (!channels)
+    {
+        rns_basis_free(&basis);
+        return MATRIX_ERROR_CREATION;
+    }
+    for (int i = 0; i < basis.count; i++)
+    {
+        channels[i] = (RnsMultiplyChannel){&basis, i, a, b, rows, inner, cols, {0}, MATRIX_SUCCESS};
+    }
+
+    rns_run_parallel(rns_multiply_channel, channels, sizeof(RnsMultiplyChannel), basis.count);
+    for (int i = 0; i < basis.count && error == MATRIX_SUCCESS; i++)
+    {
+        error = channels[i].error;
+    }
+
+    ULL* residues = (ULL*)malloc(2 * (size_t)basis.count * sizeof(ULL));
+    if (error == MATRIX_SUCCESS && !residues) error = MATRIX_ERROR_CREATION;
+
+    if (error == MATRIX_SUCCESS)
+    {
+        TRACE_SCOPE("crt");
+        ULL* digits = residues + basis.count;
+        size_t count = (size_t)rows * cols;
+        for (size_t e = 0; e < count; e++)
+        {
+            for (int i = 0; i < basis.count; i++)
+            {
+                residues[i] = rns_residue_at(&channels[i].product, e);
+            }
+            rns_garner(&basis, residues, digits);
+
+            /* Схема Горнера по цифрам смешанной системы; модули каналов меньше 2^28,
+               поэтому приводить по field_size нужно, только когда value >= 2^99 */
+            U128 value = digits[basis.count - 1];
+            for (int i = basis.count - 2; i >= 0; i--)
+            {
+                if (value >> 99) value %= field_size;
+                value = value * basis.primes[i] + digits[i];
+            }
+            c[e] = (ULL)(value % field_size);
+        }
+    }
+
+    free(residues);
+    for (int i = 0; i < basis.count; i++)
+    {
+        packed_matrix_free(&channels[i].product);
+    }
+    free(channels);
+    rns_basis_free(&basis);
+    return error;
+}
+
+/* ---------- Точное возведение в степень ---------- */
+
+typedef struct RnsPowerChannel
+{
+    const RnsBasis* basis;
+    int index;
+    const Matrix* base;
+    ULL exponent;
+    Matrix* power;                  /* base^exponent по модулю primes[index] */
+    int error;
+} RnsPowerChannel;
+
+static void rns_power_channel(void* arg)
+{
+    RnsPowerChannel* channel = (RnsPowerChannel*)arg;
+    const Matrix* base = channel->base;
+    Matrix* residues = NULL;
+
+    TRACE_BEGIN("rns_channel");
+    int error = matrix_create_uninit(base->rows, base->cols, channel->basis->primes[channel->index], &residues);
+    if (error == MATRIX_SUCCESS)
+    {
+        const ULL* src = base->data[0];
+        ULL* dst = residues->data[0];
+        for (size_t i = 0; i < (size_t)base->rows * base->cols; i++)
+        {
+            dst[i] = rns_reduce(channel->basis, channel->index, src[i]);
+        }
+        error = matrix_power(residues, channel->exponent, &channel->power);
+    }
+    TRACE_END();
+
+    matrix_free(residues);
+    channel->error = error;
+}
+
+int matrix_power_exact(const Matrix* base, ULL exponent, BigMatrix** result)
+{
+    if (!base || !result)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+    if (base->rows != base->cols)
+    {
+        return MATRIX_ERROR_NOT_SQUARE;
+    }
+
+    int n = base->rows;
+    size_t count = (size_t)n * n;
+    ULL max_element = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        if (base->data[0][i] > max_element) max_element = base->data[0][i];
+    }
+
+    BigMatrix* matrix;
+    int error = big_matrix_create(n, n, &matrix);
+    if (error != MATRIX_SUCCESS) return error;
+
+    /* Тривиальные случаи: единичная матрица и нулевой результат */
+    if (exponent == 0 || max_element == 0)
+    {
+        for (size_t i = 0; i < count && error == MATRIX_SUCCESS; i++)
+        {
+            int diagonal = (i % (size_t)(n + 1)) == 0;
+            error = bigint_set_ull(&matrix->data[i], (exponent == 0) ? (ULL)diagonal : 0);
+        }
+        if (error != MATRIX_SUCCESS)
+        {
+            big_matrix_free(matrix);
+            return error;
+        }
+        *result = matrix;
+        return MATRIX_SUCCESS;
+    }
+
+    /* Элементы A^e не больше n^(e-1) * max^e; один бит запаса на округление */
+    double bits = (double)exponent * log2((double)max_element) +
+                  (double)(exponent - 1) * log2((double)n) + 1.0;
+    RnsBasis basis = {0};
+    error = rns_basis_create(bits, &basis);
+
+    RnsPowerChannel* channels = NULL;
+    if (error == MATRIX_SUCCESS)
+    {
+        channels = (RnsPowerChannel*)calloc((size_t)basis.count, sizeof(RnsPowerChannel));
+        if (!channels) error = MATRIX_ERROR_CREATION;
+    }
+    if (error == MATRIX_SUCCESS)
+    {
+        for (int i = 0; i < basis.count; i++)
+        {
+            channels[i] = (RnsPowerChannel){&basis, i, base, exponent, NULL, MATRIX_SUCCESS};
+        }
+        rns_run_parallel(rns_power_channel, channels, sizeof(RnsPowerChannel), basis.count);
+        for (int i = 0; i < basis.count && error == MATRIX_SUCCESS; i++)
+        {
+            error = channels[i].error;
+        }
+    }
+
+    ULL* residues = NULL;
+    if (error == MATRIX_SUCCESS)
+    {
+        residues = (ULL*)malloc(2 * (size_t)basis.count * sizeof(ULL));
+        if (!residues) error = MATRIX_ERROR_CREATION;
+    }
+
+    if (error == MATRIX_SUCCESS)
+    {
+        TRACE_SCOPE("crt");
+        ULL* digits = residues + basis.count;
+        for (size_t e = 0; e < count && error == MATRIX_SUCCESS; e++)
+        {
+            for (int i = 0; i < basis.count; i++)
+            {
+                residues[i] = channels[i].power->data[0][e];
+            }
+            rns_garner(&basis, residues, digits);
+
+            BigInt* value = &matrix->data[e];
+            error = bigint_set_ull(value, digits[basis.count - 1]);
+            for (int i = basis.count - 2; i >= 0 && error == MATRIX_SUCCESS; i--)
+            {
+                error = bigint_mul_add_small(value, (uint32_t)basis.primes[i], (uint32_t)digits[i]);
+            }
+        }
+    }
+
+    free(residues);
+    if (channels)
+    {
+        for (int i = 0; i < basis.count; i++)
+        {
+            matrix_free(channels[i].power);
+        }
+        free(channels);
+    }
+    rns_basis_free(&basis);
+
+    if (error != MATRIX_SUCCESS)
+    {
+        big_matrix_free(matrix);
+        return error;
+    }
+    *result = matrix;
+    return MATRIX_SUCCESS;
+}
+
+/* ---------- Возведение по компонентам составного модуля ---------- */
+
+typedef struct RnsComponent
+{
+    const Matrix* base;
+    ULL exponent;
+    ULL modulus;                    /* p^k */
+    int prime;                      /* 1 — k == 1 */
+    int power_of_two;               /* 1 — модуль 2^k > RNS_WRAP_POWER_OF_TWO */
+    Matrix* power;                  /* base^exponent по модулю modulus */
+    int error;
+} RnsComponent;
+
+static void rns_power_component(void* arg)
+{
+    RnsComponent* component = (RnsComponent*)arg;
+    const Matrix* base = component->base;
+    Matrix* residues = NULL;
+
+    /* По модулю 2^k считается без приведения (по модулю 2^64), младшие k бит отбираются в конце */
+    ULL field_size = component->power_of_two ? 0 : component->modulus;
+
+    TRACE_BEGIN("component");
+    int error = matrix_create_uninit(base->rows, base->cols, field_size, &residues);
+    if (error == MATRIX_SUCCESS)
+    {
+        const ULL* src = base->data[0];
+        ULL* dst = residues->data[0];
+        for (size_t i = 0; i < (size_t)base->rows * base->cols; i++)
+        {
+            dst[i] = src[i] % component->modulus;
+        }
+
+        if (component->prime && matrix_cayley_hamilton_preferred(component->modulus, base->rows, component->exponent))
+        {
+            error = matrix_power_cayley_hamilton(residues, component->exponent, &component->power);
+        }
+        else
+        {
+            error = matrix_power(residues, component->exponent, &component->power);
+        }
+    }
+    if (error == MATRIX_SUCCESS && component->power_of_two)
+    {
+        Matrix* power = component->power;
+        for (size_t i = 0; i < (size_t)power->rows * power->cols; i++)
+        {
+            power->data[0][i] &= component->modulus - 1;
+        }
+        power->field_size = component->modulus;
+    }
+    TRACE_END();
+
+    matrix_free(residues);
+    component->error = error;
+}
+
+int matrix_power_components(const Matrix* base, ULL exponent, Matrix** result)
+{
+    if (!base || !result)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+    if (base->rows != base->cols)
+    {
+        return MATRIX_ERROR_NOT_SQUARE;
+    }
+    if (base->field_size < 2)
+    {
+        return MATRIX_ERROR_INVALID_FIELD;
+    }
+
+    ModularFactorization factors;
+    int error = modular_factor(base->field_size, &factors);
+    if (error != MATRIX_SUCCESS) return error;
+
+    RnsComponent components[MODULAR_MAX_FACTORS];
+    for (int i = 0; i < factors.count; i++)
+    {
+        components[i] = (RnsComponent){base, exponent, factors.powers[i], factors.exponents[i] == 1,
+                                       factors.primes[i] == 2 && factors.powers[i] > RNS_WRAP_POWER_OF_TWO,
+                                       NULL, MATRIX_SUCCESS};
+    }
+    rns_run_parallel(rns_power_component, components, sizeof(RnsComponent), factors.count);
+    for (int i = 0; i < factors.count && error == MATRIX_SUCCESS; i++)
+    {
+        error = components[i].error;
+    }
+
+    Matrix* matrix = NULL;
+    if (error == MATRIX_SUCCESS) error = matrix_create_uninit(base->rows, base->cols, base->field_size, &matrix);
+    if (error == MATRIX_SUCCESS)
+    {
+        TRACE_SCOPE("crt");
+
+        /* inverses[i] = (m_0 * ... * m_{i-1})^(-1) mod m_i */
+        ULL inverses[MODULAR_MAX_FACTORS];
+        ULL prefix = 1;
+        for (int i = 0; i < factors.count; i++)
+        {
+            inverses[i] = (i > 0) ? modular_inverse(prefix % factors.powers[i], factors.powers[i]) : 1;
+            prefix *= factors.powers[i];
+        }
+
+        /* x = r_0 + m_0 * (t_1 + m_1 * (t_2 + ...)): произведение всех m_i равно field_size */
+        size_t count = (size_t)base->rows * base->cols;
+        for (size_t e = 0; e < count; e++)
+        {
+            ULL value = components[0].power->data[0][e];
+            ULL modulus = factors.powers[0];
+            for (int i = 1; i < factors.count; i++)
+            {
+                ULL m = factors.powers[i];
+                ULL r = components[i].power->data[0][e];
+                ULL v = value % m;
+                ULL t = modular_mul(r >= v ? r - v : r + (m - v), inverses[i], m);
+                value += t * modulus;
+                modulus *= m;
+            }
+            matrix->data[0][e] = value;
+        }
+    }
+
+    for (int i = 0; i < factors.count; i++)
+    {
+        matrix_free(components[i].power);
+    }
+    if (error != MATRIX_SUCCESS)
+    {
+        matrix_free(matrix);
+        return error;
+    }
+    *result = matrix;
+    return MATRIX_SUCCESS;
+}
@@ -0,0 +1,471 @@
+#include "../include/matrix_sched.h"
+#include "../include/matrix_alloc.h"
+#include "../include/matrix_verify.h"
+#include "../include/matrix_numa.h"
+#include "../include/trace.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+#define SCHED_SPIN_ROUNDS 64                /* попыток найти задачу с паузой, прежде чем уступать процессор */
+#define SCHED_YIELD_ROUNDS 64               /* затем попыток с sched_yield, прежде чем уснуть */
+#define SCHED_SLEEP_NS 10000000L            /* наибольший сон простаивающего потока (страховка от гонок) */
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SCHED_PAUSE() __builtin_ia32_pause()
+#else
+#define SCHED_PAUSE() ((void)0)
+#endif
+
+/*
+ * Двусторонняя очередь Чейза–Лева фиксированной ёмкости
+ * (порядок доступа к памяти по Lê, Pop, Cohen, Zappa Nardelli, PPoPP 2013).
+ * bottom меняет только владелец, top сдвигают воры и владелец при споре за последнюю задачу.
+ */
+typedef struct SchedQueue
+{
+    _Alignas(64) atomic_long top;
+    _Alignas(64) atomic_long bottom;
+    _Alignas(64) atomic_int owned;          /* очередь занята потоком */
+    _Atomic(SchedTask*) slots[SCHED_QUEUE_CAPACITY];
+    _Atomic(const void*) groups[SCHED_QUEUE_CAPACITY];   /* группа задачи slots[i]: вор не трогает чужую задачу до захвата */
+} SchedQueue;
+
+static _Atomic(SchedQueue*) sched_queues[SCHED_MAX_QUEUES];
+static atomic_int sched_queue_count = 0;
+
+static int sched_worker_count = 0;
+static int sched_forked = 0;                /* дочерний процесс после fork: пула в нём нет */
+static pthread_once_t sched_once = PTHREAD_ONCE_INIT;
+static pthread_key_t sched_queue_key;
+
+static pthread_mutex_t sched_sleep_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t sched_sleep_cond = PTHREAD_COND_INITIALIZER;
+static atomic_int sched_sleepers = 0;
+static atomic_long sched_pending = 0;       /* задач в очередях */
+
+static atomic_size_t sched_spawned = 0;
+static atomic_size_t sched_inlined = 0;
+static atomic_size_t sched_stolen = 0;
+static atomic_size_t sched_sleeps = 0;
+
+static _Thread_local SchedQueue* sched_local_queue = NULL;
+static _Thread_local const void* sched_current_group = NULL;
+static _Thread_local unsigned sched_random = 0;
+
+/* ---------- Очередь ---------- */
+
+static int sched_push(SchedQueue* queue, SchedTask* task)
+{
+    long bottom = atomic_load_explicit(&queue->bottom, memory_order_relaxed);
+    long top = atomic_load_explicit(&queue->top, memory_order_acquire);
+    if (bottom - top >= SCHED_QUEUE_CAPACITY)
+    {
+        return 0;
+    }
+    atomic_store_explicit(&queue->slots[bottom % SCHED_QUEUE_CAPACITY], task, memory_order_relaxed);
+    atomic_store_explicit(&queue->groups[bottom % SCHED_QUEUE_CAPACITY], task->group, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&queue->bottom, bottom + 1, memory_order_relaxed);
+    return 1;
+}
+
+/* Забрать последнюю положенную задачу (только владелец) */
+static SchedTask* sched_take(SchedQueue* queue)
+{
+    long bottom = atomic_load_explicit(&queue->bottom, memory_order_relaxed) - 1;
+    atomic_store_explicit(&queue->bottom, bottom, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    long top = atomic_load_explicit(&queue->top, memory_order_relaxed);
+
+    SchedTask* task = NULL;
+    if (top <= bottom)
+    {
+        task = atomic_load_explicit(&queue->slots[bottom % SCHED_QUEUE_CAPACITY], memory_order_relaxed);
+        if (top == bottom)
+        {
+            /* Последняя задача: её может одновременно красть другой поток */
+            if (!atomic_compare_exchange_strong_explicit(&queue->top, &top, top + 1,
+                                                         memory_order_seq_cst, memory_order_relaxed))
+            {
+                task = NULL;
+            }
+            atomic_store_explicit(&queue->bottom, bottom + 1, memory_order_relaxed);
+        }
+    }
+    else
+    {
+        atomic_store_explicit(&queue->bottom, bottom + 1, memory_order_relaxed);
+    }
+    return task;
+}
+
+/* Подходит ли задача группы task_group ожидающему задачу группы group (NULL — любая) */
+static inline int sched_eligible(const void* task_group, const void* group)
+{
+    return !group || task_group == group;
+}
+
+/* Подходит ли группе group последняя положенная задача своей очереди (только владелец) */
+static int sched_last_eligible(SchedQueue* queue, const void* group)
+{
+    long bottom = atomic_load_explicit(&queue->bottom, memory_order_relaxed);
+    long top = atomic_load_explicit(&queue->top, memory_order_acquire);
+    return top < bottom &&
+           sched_eligible(atomic_load_explicit(&queue->groups[(bottom - 1) % SCHED_QUEUE_CAPACITY],
+                                               memory_order_relaxed), group);
+}
+
+/*
+ * Украсть самую старую задачу (любой поток), если она подходит группе group.
+ * Группа читается из очереди до захвата: если слот успели перезаписать, захват не удастся.
+ */
+static SchedTask* sched_steal(SchedQueue* queue, const void* group)
+{
+    long top = atomic_load_explicit(&queue->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    long bottom = atomic_load_explicit(&queue->bottom, memory_order_acquire);
+    if (top >= bottom)
+    {
+        return NULL;
+    }
+
+    SchedTask* task = atomic_load_explicit(&queue->slots[top % SCHED_QUEUE_CAPACITY], memory_order_relaxed);
+    if (!sched_eligible(atomic_load_explicit(&queue->groups[top % SCHED_QUEUE_CAPACITY], memory_order_relaxed),
+                        group))
+    {
+        return NULL;
+    }
+    if (!atomic_compare_exchange_strong_explicit(&queue->top, &top, top + 1,
+                                                 memory_order_seq_cst, memory_order_relaxed))
+    {
+        return NULL;
+    }
+    return task;
+}
+
+/* ---------- Выполнение ---------- */
+
+static void sched_execute(SchedTask* task)
+{
+    atomic_fetch_sub(&sched_pending, 1);
+
+    /* Контексты вызывающего потока задаче не передаются (см. matrix_sched.h) */
+    MatrixAllocator* allocator = matrix_allocator_bind(NULL);
+    MatrixVerifier* verifier = matrix_verifier_bind(NULL);
+    const void* group = sched_group_enter(task->group);
+    task->run(task->arg);
+    sched_group_enter(group);
+    matrix_verifier_bind(verifier);
+    matrix_allocator_bind(allocator);
+
+    atomic_store_explicit(&task->done, 1, memory_order_release);
+}
+
+/* Найти задачу группы group (NULL — любую): сначала в своей очереди, затем в чужих, начиная со случайной */
+static SchedTask* sched_find(const void* group)
+{
+    SchedQueue* own = sched_local_queue;
+    if (own)
+    {
+        /* Свою последнюю задачу чужой группы не трогаем: под ней лежат только более старые */
+        SchedTask* task = (!group || sched_last_eligible(own, group)) ? sched_take(own) : NULL;
+        if (task) return task;
+    }
+
+    int count = atomic_load_explicit(&sched_queue_count, memory_order_acquire);
+    if (count == 0) return NULL;
+
+    if (sched_random == 0) sched_random = (unsigned)(uintptr_t)&own | 1u;
+    sched_random ^= sched_random << 13;
+    sched_random ^= sched_random >> 17;
+    sched_random ^= sched_random << 5;
+    int start = (int)(sched_random % (unsigned)count);
+    for (int i = 0; i < count; i++)
+    {
+        SchedQueue* queue = atomic_load_explicit(&sched_queues[(start + i) % count], memory_order_acquire);
+        if (!queue || queue == own) continue;
+
+        SchedTask* task = sched_steal(queue, group);
+        if (task)
+        {
+            atomic_fetch_add_explicit(&sched_stolen, 1, memory_order_relaxed);
+            return task;
+        }
+    }
+    return NULL;
+}
+
+/* Короткое ожидание: пауза, затем уступка процессора */
+static void sched_backoff(int round)
+{
+    if (round < SCHED_SPIN_ROUNDS)
+    {
+        for (int i = 0; i < (1 << (round < 6 ? round : 6)); i++) SCHED_PAUSE();
+    }
+    else
+    {
+        sched_yield();
+    }
+}
+
+/* Уснуть, пока в очередях нет задач (или не истёк SCHED_SLEEP_NS) */
+static void sched_sleep(void)
+{
+    pthread_mutex_lock(&sched_sleep_lock);
+    atomic_fetch_add(&sched_sleepers, 1);
+    if (atomic_load(&sched_pending) <= 0)
+    {
+        struct timespec until;
+        clock_gettime(CLOCK_REALTIME, &until);
+        until.tv_nsec += SCHED_SLEEP_NS;
+        if (until.tv_nsec >= 1000000000L)
+        {
+            until.tv_sec++;
+            until.tv_nsec -= 1000000000L;
+        }
+        atomic_fetch_add_explicit(&sched_sleeps, 1, memory_order_relaxed);
+        pthread_cond_timedwait(&sched_sleep_cond, &sched_sleep_lock, &until);
+    }
+    atomic_fetch_sub(&sched_sleepers, 1);
+    pthread_mutex_unlock(&sched_sleep_lock);
+}
+
+/* ---------- Очереди потоков ---------- */
+
+/* Взять свободную очередь или создать новую; NULL, если очереди кончились */
+static SchedQueue* sched_queue_acquire(void)
+{
+    int count = atomic_load_explicit(&sched_queue_count, memory_order_acquire);
+    for (int i = 0; i < count; i++)
+    {
+        SchedQueue* queue = atomic_load_explicit(&sched_queues[i], memory_order_acquire);
+        int expected = 0;
+        if (queue && atomic_compare_exchange_strong(&queue->owned, &expected, 1))
+        {
+            return queue;
+        }
+    }
+
+    SchedQueue* queue = (SchedQueue*)aligned_alloc(64, sizeof(SchedQueue));
+    if (!queue) return NULL;
+    memset(queue, 0, sizeof(SchedQueue));
+    atomic_store(&queue->owned, 1);
+
+    int index = atomic_fetch_add(&sched_queue_count, 1);
+    if (index >= SCHED_MAX_QUEUES)
+    {
+        atomic_fetch_sub(&sched_queue_count, 1);
+        free(queue);
+        return NULL;
+    }
+    /* Воры читают индексы до sched_queue_count: до публикации там NULL */
+    atomic_store_explicit(&sched_queues[index], queue, memory_order_release);
+    return queue;
+}
+
+/* Поток завершился: его очередь пуста (все задачи синхронизированы) и достаётся следующему */
+static void sched_queue_release(void* arg)
+{
+    SchedQueue* queue = (SchedQueue*)arg;
+    atomic_store(&queue->owned, 0);
+}
+
+static SchedQueue* sched_current_queue(void)
+{
+    if (!sched_local_queue)
+    {
+        sched_local_queue = sched_queue_acquire();
+        if (sched_local_queue) pthread_setspecific(sched_queue_key, sched_local_queue);
+    }
+    return sched_local_queue;
+}
+
+/* ---------- Пул ---------- */
+
+static void* sched_worker(void* arg)
+{
+    int index = (int)(intptr_t)arg;
+    sched_random = 2463534242u + (unsigned)index * 2654435761u;
+    trace_thread_name("sched-worker");
+
+    /* Поток 0 — вызывающий (главный), рабочие потоки закрепляются начиная с ядра 1 */
+    if (matrix_numa_enabled()) matrix_numa_pin_worker(index + 1);
+    sched_current_queue();
+
+    for (int round = 0; ; round++)
+    {
+        SchedTask* task = sched_find(NULL);
+        if (task)
+        {
+            sched_execute(task);
+            round = -1;
+        }
+        else if (round < SCHED_SPIN_ROUNDS + SCHED_YIELD_ROUNDS)
+        {
+            sched_backoff(round);
+        }
+        else
+        {
+            sched_sleep();
+            round = SCHED_SPIN_ROUNDS - 1;
+        }
+    }
+    return NULL;
+}
+
+static void sched_start(void)
+{
+    pthread_key_create(&sched_queue_key, sched_queue_release);
+    sched_random = 88172645u;
+
+    long count;
+    const char* text = getenv(SCHED_ENV);
+    if (text && *text)
+    {
+        count = strtol(text, NULL, 10);
+    }
+    else
+    {
+        count = sysconf(_SC_NPROCESSORS_ONLN) - 1;
+    }
+    if (count < 0) count = 0;
+    if (count > SCHED_MAX_WORKERS) count = SCHED_MAX_WORKERS;
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+
+    int started = 0;
+    for (long i = 0; i < count; i++)
+    {
+        pthread_t thread;
+        if (pthread_create(&thread, &attr, sched_worker, (void*)(intptr_t)i) != 0) break;
+        started++;
+    }
+    pthread_attr_destroy(&attr);
+    sched_worker_count = started;
+}
+
+int sched_workers(void)
+{
+    if (sched_forked) return 0;
+    pthread_once(&sched_once, sched_start);
+    return sched_worker_count;
+}
+
+void sched_fork_child(void)
+{
+    sched_forked = 1;
+}
+
+/* ---------- fork/join ---------- */
+
+void sched_spawn(SchedTask* task, void (*run)(void*), void* arg)
+{
+    task->run = run;
+    task->arg = arg;
+    task->group = sched_current_group;
+    atomic_store_explicit(&task->done, 0, memory_order_relaxed);
+
+    SchedQueue* queue = (sched_workers() > 0) ? sched_current_queue() : NULL;
+    if (!queue || !sched_push(queue, task))
+    {
+        atomic_fetch_add_explicit(&sched_inlined, 1, memory_order_relaxed);
+        run(arg);
+        atomic_store_explicit(&task->done, 1, memory_order_release);
+        return;
+    }
+
+    atomic_fetch_add_explicit(&sched_spawned, 1, memory_order_relaxed);
+    atomic_fetch_add(&sched_pending, 1);
+    if (atomic_load(&sched_sleepers) > 0)
+    {
+        pthread_mutex_lock(&sched_sleep_lock);
+        pthread_cond_signal(&sched_sleep_cond);
+        pthread_mutex_unlock(&sched_sleep_lock);
+    }
+}
+
+void sched_sync(SchedTask* task)
+{
+    /* Пока задача не готова, поток не простаивает: выполняет свои задачи или крадёт чужие,
+       но только из группы ожидаемой задачи */
+    for (int round = 0; !atomic_load_explicit(&task->done, memory_order_acquire); round++)
+    {
+        SchedTask* other = sched_find(task->group);
+        if (other)
+        {
+            sched_execute(other);
+            round = -1;
+        }
+        else
+        {
+            sched_backoff(round);
+        }
+    }
+}
+
+const void* sched_group_enter(const void* group)
+{
+    const void* previous = sched_current_group;
+    sched_current_group = group;
+    return previous;
+}
+
+typedef struct SchedRange
+{
+    void (*body)(void* context, int begin, int end);
+    void* context;
+    int begin, end, grain;
+} SchedRange;
+
+static void sched_range_run(void* arg)
+{
+    SchedRange* range = (SchedRange*)arg;
+    if (range->end - range->begin <= range->grain || sched_worker_count == 0)
+    {
+        range->body(range->context, range->begin, range->end);
+        return;
+    }
+
+    /* Верхняя половина — в очередь (её украдут целиком), нижняя — в этом же потоке */
+    int middle = range->begin + (range->end - range->begin) / 2;
+    SchedRange upper = *range;
+    SchedRange lower = *range;
+    upper.begin = middle;
+    lower.end = middle;
+
+    SchedTask task;
+    sched_spawn(&task, sched_range_run, &upper);
+    sched_range_run(&lower);
+    sched_sync(&task);
+}
+
+void sched_parallel_for(int begin, int end, int grain, void (*body)(void* context, int begin, int end),
+                        void* context)
+{
+    if (end <= begin)
+    {
+        return;
+    }
+
+    SchedRange range = {body, context, begin, end, grain < 1 ? 1 : grain};
+    sched_workers();
+    sched_range_run(&range);
+}
+
+void sched_stats(SchedStats* stats)
+{
+    if (!stats)
+    {
+        return;
+    }
+
+    stats->workers = sched_workers();
+    stats->spawned = atomic_load(&sched_spawned);
+    stats->inlined = atomic_load(&sched_inlined);
+    stats->stolen = atomic_load(&sched_stolen);
+    stats->sleeps = atomic_load(&sched_sleeps);
+}
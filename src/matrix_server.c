@@ -0,0 +1,726 @@
+#include "../include/matrix_server.h"
+#include "../include/matrix.h"
+#include "../include/trace.h"
+#include "../include/latency_hist.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#define SERVER_MAX_WORKERS 64
+#define SERVER_ACCEPT_POLL_MS 100           /* как часто цикл приёма проверяет остановку */
+
+typedef struct Server Server;
+
+/* Соединение: его держат поток чтения и каждое задание из него */
+typedef struct ServerConnection
+{
+    int fd;
+    atomic_int refs;
+    pthread_mutex_t write_lock;             /* ответы разных рабочих потоков не перемешиваются */
+    Server* server;
+    struct ServerConnection* next;
+} ServerConnection;
+
+typedef struct ServerJob
+{
+    ServerConnection* connection;
+    uint64_t id;
+    Matrix* base;
+    ULL exponent;
+    int64_t received_ns;
+} ServerJob;
+
+struct Server
+{
+    int listen_fd;
+    atomic_int stopping;
+
+    /* Очередь заданий, список соединений и счётчики очереди — под lock */
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+    pthread_cond_t readers_done;
+    ServerJob* queue[SERVER_QUEUE_CAPACITY];
+    int queue_head;
+    int queue_count;
+    int closed;
+    ServerConnection* connections;
+    int readers;
+    uint64_t requests;
+    uint64_t full_waits;
+    uint32_t queue_peak;
+    uint32_t connection_count;
+
+    /* Счётчики выполнения и окно задержек — под stats_lock */
+    pthread_mutex_t stats_lock;
+    uint64_t completed;
+    uint64_t batches;
+    uint64_t batched;
+    uint64_t latencies[SERVER_LATENCY_WINDOW];
+    size_t latency_count;
+
+    pthread_t workers[SERVER_MAX_WORKERS];
+    int worker_count;
+    atomic_int next_worker;
+    LatencyRecorder* histograms[SERVER_MAX_WORKERS];   /* по набору на рабочий поток, сливаются по запросу */
+};
+
+static int64_t server_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/* ---------- Ввод-вывод ---------- */
+
+static int server_read_full(int fd, void* buffer, size_t bytes)
+{
+    char* at = (char*)buffer;
+    while (bytes > 0)
+    {
+        ssize_t got = recv(fd, at, bytes, 0);
+        if (got < 0 && errno == EINTR) continue;
+        if (got <= 0) return 0;
+        at += got;
+        bytes -= (size_t)got;
+    }
+    return 1;
+}
+
+static int server_write_full(int fd, const void* buffer, size_t bytes)
+{
+    const char* at = (const char*)buffer;
+    while (bytes > 0)
+    {
+        ssize_t sent = send(fd, at, bytes, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent <= 0) return 0;
+        at += sent;
+        bytes -= (size_t)sent;
+    }
+    return 1;
+}
+
+/* Развернуть count элементов по width байт в ULL, приводя их по модулю поля */
+static void server_unpack(const void* src, int width, ULL field_size, ULL* dst, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        ULL value;
+        switch (width)
+        {
+            case 1: value = ((const uint8_t*)src)[i]; break;
+            case 2: value = ((const uint16_t*)src)[i]; break;
+            case 4: value = ((const uint32_t*)src)[i]; break;
+            default: value = ((const uint64_t*)src)[i]; break;
+        }
+        dst[i] = field_size ? value % field_size : value;
+    }
+}
+
+static void server_pack(const ULL* src, int width, void* dst, size_t count)
+{
+    switch (width)
+    {
+        case 1:
+            for (size_t i = 0; i < count; i++) ((uint8_t*)dst)[i] = (uint8_t)src[i];
+            break;
+        case 2:
+            for (size_t i = 0; i < count; i++) ((uint16_t*)dst)[i] = (uint16_t)src[i];
+            break;
+        case 4:
+            for (size_t i = 0; i < count; i++) ((uint32_t*)dst)[i] = (uint32_t)src[i];
+            break;
+        default:
+            memcpy(dst, src, count * sizeof(ULL));
+            break;
+    }
+}
+
+/*
+ * Отправить кадр ответа: заголовок и payload_bytes байт данных. Данные — либо готовый
+ * буфер payload, либо элементы matrix, упакованные по header->width байт.
+ */
+static int server_respond(ServerConnection* connection, const ServerResponseHeader* header,
+                          const void* payload, size_t payload_bytes, const Matrix* matrix)
+{
+    size_t frame = sizeof(uint32_t) + sizeof(*header) + payload_bytes;
+    char* buffer = (char*)malloc(frame);
+    if (!buffer) return 0;
+
+    uint32_t length = (uint32_t)(frame - sizeof(uint32_t));
+    memcpy(buffer, &length, sizeof(length));
+    memcpy(buffer + sizeof(length), header, sizeof(*header));
+    char* data = buffer + sizeof(length) + sizeof(*header);
+    if (matrix)
+    {
+        server_pack(matrix->data[0], (int)header->width, data, (size_t)matrix->rows * matrix->cols);
+    }
+    else if (payload_bytes > 0)
+    {
+        memcpy(data, payload, payload_bytes);
+    }
+
+    pthread_mutex_lock(&connection->write_lock);
+    int sent = server_write_full(connection->fd, buffer, frame);
+    pthread_mutex_unlock(&connection->write_lock);
+    free(buffer);
+    return sent;
+}
+
+static void server_respond_error(ServerConnection* connection, uint64_t id, int status)
+{
+    ServerResponseHeader header = {id, status, 0, 0, 0, 0, 0};
+    server_respond(connection, &header, NULL, 0, NULL);
+}
+
+static void server_connection_release(ServerConnection* connection)
+{
+    if (atomic_fetch_sub(&connection->refs, 1) == 1)
+    {
+        close(connection->fd);
+        pthread_mutex_destroy(&connection->write_lock);
+        free(connection);
+    }
+}
+
+/* ---------- Статистика ---------- */
+
+static int server_compare_u64(const void* a, const void* b)
+{
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+static void server_record(Server* server, int64_t latency_ns)
+{
+    pthread_mutex_lock(&server->stats_lock);
+    server->completed++;
+    server->latencies[server->latency_count % SERVER_LATENCY_WINDOW] = (uint64_t)latency_ns;
+    server->latency_count++;
+    pthread_mutex_unlock(&server->stats_lock);
+}
+
+static void server_collect_stats(Server* server, ServerStats* stats)
+{
+    memset(stats, 0, sizeof(*stats));
+    uint64_t* window = (uint64_t*)malloc(SERVER_LATENCY_WINDOW * sizeof(uint64_t));
+
+    pthread_mutex_lock(&server->stats_lock);
+    stats->completed = server->completed;
+    stats->batches = server->batches;
+    stats->batched = server->batched;
+    size_t count = server->latency_count < SERVER_LATENCY_WINDOW ? server->latency_count : SERVER_LATENCY_WINDOW;
+    if (window) memcpy(window, server->latencies, count * sizeof(uint64_t));
+    pthread_mutex_unlock(&server->stats_lock);
+
+    pthread_mutex_lock(&server->lock);
+    stats->requests = server->requests;
+    stats->full_waits = server->full_waits;
+    stats->queue_depth = (uint32_t)server->queue_count;
+    stats->queue_peak = server->queue_peak;
+    stats->connections = server->connection_count;
+    pthread_mutex_unlock(&server->lock);
+    stats->workers = (uint32_t)server->worker_count;
+
+    /* Процентили считаются при запросе, запись задержки — только одно присваивание */
+    if (window && count > 0)
+    {
+        qsort(window, count, sizeof(uint64_t), server_compare_u64);
+        stats->latency_p50_ns = window[(count - 1) * 50 / 100];
+        stats->latency_p90_ns = window[(count - 1) * 90 / 100];
+        stats->latency_p99_ns = window[(count - 1) * 99 / 100];
+        stats->latency_max_ns = window[count - 1];
+    }
+    free(window);
+}
+
+/* Таблица процентилей по ключам: наборы рабочих потоков сливаются в один. [RETURN] текст (malloc) или NULL */
+static char* server_collect_histograms(Server* server, size_t* bytes)
+{
+    LatencyRecorder* merged = NULL;
+    if (latency_recorder_create(&merged) != MATRIX_SUCCESS)
+    {
+        return NULL;
+    }
+    for (int i = 0; i < server->worker_count; i++)
+    {
+        latency_recorder_merge(merged, server->histograms[i]);
+    }
+
+    char* text = NULL;
+    FILE* out = open_memstream(&text, bytes);
+    if (out)
+    {
+        latency_recorder_print(merged, out);
+        fclose(out);
+    }
+    latency_recorder_destroy(merged);
+    return text;
+}
+
+/* ---------- Очередь заданий ---------- */
+
+/* Положить задание, дождавшись места. [RETURN] 0, если очередь уже закрыта */
+static int server_enqueue(Server* server, ServerJob* job)
+{
+    pthread_mutex_lock(&server->lock);
+    if (server->queue_count == SERVER_QUEUE_CAPACITY)
+    {
+        server->full_waits++;
+    }
+    while (server->queue_count == SERVER_QUEUE_CAPACITY && !server->closed)
+    {
+        pthread_cond_wait(&server->not_full, &server->lock);
+    }
+    if (server->closed)
+    {
+        pthread_mutex_unlock(&server->lock);
+        return 0;
+    }
+
+    server->queue[(server->queue_head + server->queue_count) % SERVER_QUEUE_CAPACITY] = job;
+    server->queue_count++;
+    server->requests++;
+    if ((uint32_t)server->queue_count > server->queue_peak)
+    {
+        server->queue_peak = (uint32_t)server->queue_count;
+    }
+    pthread_cond_signal(&server->not_empty);
+    pthread_mutex_unlock(&server->lock);
+    return 1;
+}
+
+static int server_same_batch(const ServerJob* a, const ServerJob* b)
+{
+    return a->base->rows == b->base->rows && a->base->field_size == b->base->field_size;
+}
+
+/*
+ * Взять задание из головы очереди и, если матрица мала, все ожидающие задания того же
+ * размера и поля (до SERVER_BATCH_MAX); остальные сохраняют свой порядок.
+ * [RETURN] число взятых заданий; 0 — очередь закрыта и пуста
+ */
+static int server_dequeue(Server* server, ServerJob** jobs)
+{
+    pthread_mutex_lock(&server->lock);
+    while (server->queue_count == 0 && !server->closed)
+    {
+        pthread_cond_wait(&server->not_empty, &server->lock);
+    }
+    if (server->queue_count == 0)
+    {
+        pthread_mutex_unlock(&server->lock);
+        return 0;
+    }
+
+    int count = 0;
+    jobs[count++] = server->queue[server->queue_head];
+    server->queue_head = (server->queue_head + 1) % SERVER_QUEUE_CAPACITY;
+    server->queue_count--;
+
+    if (jobs[0]->base->rows <= SERVER_BATCH_MAX_SIZE)
+    {
+        int kept = 0;
+        for (int i = 0; i < server->queue_count; i++)
+        {
+            ServerJob* job = server->queue[(server->queue_head + i) % SERVER_QUEUE_CAPACITY];
+            if (count < SERVER_BATCH_MAX && server_same_batch(jobs[0], job))
+            {
+                jobs[count++] = job;
+            }
+            else
+            {
+                server->queue[(server->queue_head + kept++) % SERVER_QUEUE_CAPACITY] = job;
+            }
+        }
+        server->queue_count = kept;
+    }
+
+    pthread_cond_broadcast(&server->not_full);
+    pthread_mutex_unlock(&server->lock);
+    return count;
+}
+
+/* ---------- Рабочие потоки ---------- */
+
+static void server_finish(Server* server, LatencyRecorder* histograms, ServerJob* job, int error,
+                          const Matrix* result, int batch, int64_t started_ns, int64_t compute_ns)
+{
+    int width = matrix_element_width(job->base->field_size);
+    ServerResponseHeader header = {job->id, error, (uint32_t)job->base->rows,
+                                   (uint64_t)(started_ns - job->received_ns), (uint64_t)compute_ns,
+                                   (uint32_t)batch, (uint32_t)width};
+    size_t bytes = error == MATRIX_SUCCESS ? (size_t)job->base->rows * job->base->cols * (size_t)width : 0;
+    server_respond(job->connection, &header, NULL, bytes, error == MATRIX_SUCCESS ? result : NULL);
+    int64_t latency = server_now_ns() - job->received_ns;
+    server_record(server, latency);
+    latency_record(histograms, job->base->rows, job->exponent, job->base->field_size, (ULL)latency);
+
+    server_connection_release(job->connection);
+    matrix_free(job->base);
+    free(job);
+}
+
+static void* server_worker(void* arg)
+{
+    Server* server = (Server*)arg;
+    trace_thread_name("server-worker");
+    LatencyRecorder* histograms = server->histograms[atomic_fetch_add(&server->next_worker, 1)];
+
+    ServerJob* jobs[SERVER_BATCH_MAX];
+    const Matrix* bases[SERVER_BATCH_MAX];
+    ULL exponents[SERVER_BATCH_MAX];
+    Matrix* results[SERVER_BATCH_MAX];
+
+    int count;
+    while ((count = server_dequeue(server, jobs)) > 0)
+    {
+        TRACE_SCOPE("server_batch");
+
+        int64_t started = server_now_ns();
+        int errors[SERVER_BATCH_MAX];
+        memset(results, 0, sizeof(results));
+
+        int error = MATRIX_ERROR_CREATION;
+        if (count > 1)
+        {
+            for (int i = 0; i < count; i++)
+            {
+                bases[i] = jobs[i]->base;
+                exponents[i] = jobs[i]->exponent;
+            }
+            error = matrix_power_batch(bases, exponents, count, results);
+        }
+        for (int i = 0; i < count; i++)
+        {
+            /* Одиночное задание или пачка не удалась — каждое считается отдельно */
+            errors[i] = error == MATRIX_SUCCESS ? MATRIX_SUCCESS
+                                                : matrix_power(jobs[i]->base, jobs[i]->exponent, &results[i]);
+        }
+        int64_t compute = server_now_ns() - started;
+
+        pthread_mutex_lock(&server->stats_lock);
+        server->batches++;
+        if (count > 1) server->batched += (uint64_t)count;
+        pthread_mutex_unlock(&server->stats_lock);
+
+        for (int i = 0; i < count; i++)
+        {
+            server_finish(server, histograms, jobs[i], errors[i], results[i], count, started, compute);
+            matrix_free(results[i]);
+        }
+    }
+    return NULL;
+}
+
+/* ---------- Соединения ---------- */
+
+/* Прочитать тело запроса POWER и поставить задание. [RETURN] 0 — соединение нужно закрыть */
+static int server_read_power(ServerConnection* connection, const ServerRequestHeader* header, size_t payload)
+{
+    if (header->size == 0 || header->size > SERVER_MAX_SIZE)
+    {
+        server_respond_error(connection, header->id, -SERVER_ERROR_TOO_LARGE);
+        return 0;
+    }
+    int n = (int)header->size;
+    size_t count = (size_t)n * n;
+    if (header->width != (uint32_t)matrix_element_width(header->field_size) || payload != count * header->width)
+    {
+        server_respond_error(connection, header->id, -SERVER_ERROR_PROTOCOL);
+        return 0;
+    }
+
+    void* buffer = malloc(payload);
+    Matrix* base = NULL;
+    ServerJob* job = (ServerJob*)malloc(sizeof(ServerJob));
+    int error = (buffer && job) ? matrix_create_uninit(n, n, header->field_size, &base) : MATRIX_ERROR_CREATION;
+    if (error != MATRIX_SUCCESS)
+    {
+        /* Тело не прочитано, дальше в потоке не найти границу кадра */
+        server_respond_error(connection, header->id, error);
+    }
+    else if (server_read_full(connection->fd, buffer, payload))
+    {
+        server_unpack(buffer, (int)header->width, header->field_size, base->data[0], count);
+    }
+    else
+    {
+        error = MATRIX_ERROR_CREATION;
+    }
+    free(buffer);
+
+    if (error != MATRIX_SUCCESS)
+    {
+        matrix_free(base);
+        free(job);
+        return 0;
+    }
+
+    job->connection = connection;
+    job->id = header->id;
+    job->base = base;
+    job->exponent = header->exponent;
+    job->received_ns = server_now_ns();
+
+    atomic_fetch_add(&connection->refs, 1);
+    if (!server_enqueue(connection->server, job))
+    {
+        server_connection_release(connection);
+        matrix_free(base);
+        free(job);
+        return 0;
+    }
+    return 1;
+}
+
+static void* server_reader(void* arg)
+{
+    ServerConnection* connection = (ServerConnection*)arg;
+    Server* server = connection->server;
+    trace_thread_name("server-reader");
+
+    int alive = 1;
+    while (alive)
+    {
+        uint32_t length;
+        ServerRequestHeader header;
+        if (!server_read_full(connection->fd, &length, sizeof(length))) break;
+        if (length < sizeof(header) || !server_read_full(connection->fd, &header, sizeof(header)))
+        {
+            server_respond_error(connection, 0, -SERVER_ERROR_PROTOCOL);
+            break;
+        }
+        size_t payload = length - sizeof(header);
+
+        switch (header.type)
+        {
+            case SERVER_REQUEST_POWER:
+                alive = server_read_power(connection, &header, payload);
+                break;
+            case SERVER_REQUEST_STATS:
+            {
+                ServerStats stats;
+                server_collect_stats(server, &stats);
+                ServerResponseHeader response = {header.id, SERVER_SUCCESS, 0, 0, 0, 0, 0};
+                alive = payload == 0 && server_respond(connection, &response, &stats, sizeof(stats), NULL);
+                break;
+            }
+            case SERVER_REQUEST_HISTOGRAMS:
+            {
+                size_t bytes = 0;
+                char* text = payload == 0 ? server_collect_histograms(server, &bytes) : NULL;
+                ServerResponseHeader response = {header.id, text ? SERVER_SUCCESS : -SERVER_ERROR_PROTOCOL,
+                                                 0, 0, 0, 0, 0};
+                alive = text && server_respond(connection, &response, text, bytes, NULL);
+                free(text);
+                break;
+            }
+            case SERVER_REQUEST_SHUTDOWN:
+                atomic_store(&server->stopping, 1);
+                server_respond_error(connection, header.id, SERVER_SUCCESS);
+                alive = 0;
+                break;
+            default:
+                server_respond_error(connection, header.id, -SERVER_ERROR_PROTOCOL);
+                alive = 0;
+                break;
+        }
+    }
+
+    pthread_mutex_lock(&server->lock);
+    for (ServerConnection** link = &server->connections; *link; link = &(*link)->next)
+    {
+        if (*link == connection)
+        {
+            *link = connection->next;
+            break;
+        }
+    }
+    server->connection_count--;
+    server->readers--;
+    pthread_cond_signal(&server->readers_done);
+    pthread_mutex_unlock(&server->lock);
+
+    /* Задания этого соединения ещё могут отвечать в сокет: он закроется с последней ссылкой */
+    shutdown(connection->fd, SHUT_RD);
+    server_connection_release(connection);
+    return NULL;
+}
+
+static int server_accept(Server* server, int fd)
+{
+    ServerConnection* connection = (ServerConnection*)malloc(sizeof(ServerConnection));
+    if (!connection)
+    {
+        close(fd);
+        return 0;
+    }
+    connection->fd = fd;
+    atomic_init(&connection->refs, 1);
+    pthread_mutex_init(&connection->write_lock, NULL);
+    connection->server = server;
+
+    pthread_mutex_lock(&server->lock);
+    connection->next = server->connections;
+    server->connections = connection;
+    server->connection_count++;
+    server->readers++;
+    pthread_mutex_unlock(&server->lock);
+
+    pthread_t thread;
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    int created = pthread_create(&thread, &attr, server_reader, connection) == 0;
+    pthread_attr_destroy(&attr);
+    if (!created)
+    {
+        pthread_mutex_lock(&server->lock);
+        server->connections = connection->next;
+        server->connection_count--;
+        server->readers--;
+        pthread_mutex_unlock(&server->lock);
+        server_connection_release(connection);
+    }
+    return created;
+}
+
+/* ---------- Запуск ---------- */
+
+static int server_worker_count(void)
+{
+    long count;
+    const char* text = getenv(SERVER_WORKERS_ENV);
+    if (text && *text)
+    {
+        count = strtol(text, NULL, 10);
+    }
+    else
+    {
+        count = sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    if (count < 1) count = 1;
+    if (count > SERVER_MAX_WORKERS) count = SERVER_MAX_WORKERS;
+    return (int)count;
+}
+
+static int server_listen(const char* path, int* result)
+{
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(address.sun_path))
+    {
+        return SERVER_ERROR_SOCKET;
+    }
+    strcpy(address.sun_path, path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+    {
+        return SERVER_ERROR_SOCKET;
+    }
+    unlink(path);
+    if (bind(fd, (struct sockaddr*)&address, sizeof(address)) != 0 || listen(fd, SOMAXCONN) != 0)
+    {
+        close(fd);
+        return SERVER_ERROR_SOCKET;
+    }
+    *result = fd;
+    return SERVER_SUCCESS;
+}
+
+int server_run(const char* socket_path)
+{
+    const char* path = socket_path ? socket_path : SERVER_DEFAULT_SOCKET;
+
+    Server* server = (Server*)calloc(1, sizeof(Server));
+    if (!server)
+    {
+        return SERVER_ERROR_THREAD;
+    }
+    int error = server_listen(path, &server->listen_fd);
+    if (error != SERVER_SUCCESS)
+    {
+        free(server);
+        return error;
+    }
+
+    pthread_mutex_init(&server->lock, NULL);
+    pthread_mutex_init(&server->stats_lock, NULL);
+    pthread_cond_init(&server->not_empty, NULL);
+    pthread_cond_init(&server->not_full, NULL);
+    pthread_cond_init(&server->readers_done, NULL);
+
+    int wanted = server_worker_count();
+    for (int i = 0; i < wanted; i++)
+    {
+        if (latency_recorder_create(&server->histograms[i]) != MATRIX_SUCCESS)
+        {
+            wanted = i;
+            break;
+        }
+    }
+    while (server->worker_count < wanted &&
+           pthread_create(&server->workers[server->worker_count], NULL, server_worker, server) == 0)
+    {
+        server->worker_count++;
+    }
+    if (server->worker_count == 0)
+    {
+        error = SERVER_ERROR_THREAD;
+        atomic_store(&server->stopping, 1);
+    }
+
+    while (!atomic_load(&server->stopping))
+    {
+        struct pollfd wait_for = {server->listen_fd, POLLIN, 0};
+        if (poll(&wait_for, 1, SERVER_ACCEPT_POLL_MS) <= 0) continue;
+
+        int fd = accept(server->listen_fd, NULL, NULL);
+        if (fd >= 0) server_accept(server, fd);
+    }
+
+    /* Остановка: новых соединений нет, потоки чтения будятся закрытием сокетов на чтение,
+     * рабочие потоки дорабатывают очередь */
+    close(server->listen_fd);
+    unlink(path);
+
+    pthread_mutex_lock(&server->lock);
+    for (ServerConnection* connection = server->connections; connection; connection = connection->next)
+    {
+        shutdown(connection->fd, SHUT_RD);
+    }
+    while (server->readers > 0)
+    {
+        pthread_cond_wait(&server->readers_done, &server->lock);
+    }
+    server->closed = 1;
+    pthread_cond_broadcast(&server->not_empty);
+    pthread_mutex_unlock(&server->lock);
+
+    for (int i = 0; i < server->worker_count; i++)
+    {
+        pthread_join(server->workers[i], NULL);
+    }
+
+    pthread_mutex_destroy(&server->lock);
+    pthread_mutex_destroy(&server->stats_lock);
+    pthread_cond_destroy(&server->not_empty);
+    pthread_cond_destroy(&server->not_full);
+    pthread_cond_destroy(&server->readers_done);
+    for (int i = 0; i < SERVER_MAX_WORKERS; i++)
+    {
+        latency_recorder_destroy(server->histograms[i]);
+    }
+    free(server);
+    return error;
+}
@@ -0,0 +1,496 @@
+#include "../include/matrix_shard.h"
+#include "../include/matrix_kernels.h"
+#include "../include/matrix_sched.h"
+#include "../include/matrix_verify.h"
+#include "../include/trace.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+
+#define SHARD_FUTEX_WAIT 0                  /* без FUTEX_PRIVATE_FLAG: слово лежит в общей памяти */
+#define SHARD_FUTEX_WAKE 1
+#define SHARD_SPIN_ROUNDS 2000              /* проверок поколения барьера до сна на futex */
+#define SHARD_WAIT_SLICE_NS 50000000L       /* сон на futex между проверками живости участников */
+#define SHARD_PAGE 4096
+
+/* ---------- Транспорт: одна машина ---------- */
+
+/* Заголовок области: барьер для всех участников */
+typedef struct ShmHeader
+{
+    _Alignas(64) atomic_uint arrived;
+    _Alignas(64) atomic_uint generation;    /* слово futex */
+    atomic_int aborted;                     /* участник завершился аварийно */
+    unsigned parties;
+} ShmHeader;
+
+typedef struct ShmState
+{
+    ShmHeader* header;
+    size_t mapped;
+    pid_t coordinator;
+    pid_t pids[SHARD_MAX_WORKERS + 1];      /* 0 — не запущен или уже дождались */
+} ShmState;
+
+static int64_t shard_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static size_t shm_header_bytes(void)
+{
+    return (sizeof(ShmHeader) + SHARD_PAGE - 1) & ~(size_t)(SHARD_PAGE - 1);
+}
+
+static int shm_create(size_t bytes, int workers, void** state_out, void** memory)
+{
+    static atomic_int counter = 0;
+
+    ShmState* state = (ShmState*)calloc(1, sizeof(ShmState));
+    if (!state)
+    {
+        return MATRIX_ERROR_CREATION;
+    }
+
+    char name[64];
+    snprintf(name, sizeof(name), "/matrix_power-%d-%d", (int)getpid(), atomic_fetch_add(&counter, 1));
+    int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0)
+    {
+        free(state);
+        return MATRIX_ERROR_CREATION;
+    }
+
+    /* Имя нужно только на время создания: процессы получают отображение через fork */
+    state->mapped = shm_header_bytes() + bytes;
+    void* mapping = MAP_FAILED;
+    if (ftruncate(fd, (off_t)state->mapped) == 0)
+    {
+        mapping = mmap(NULL, state->mapped, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    shm_unlink(name);
+    if (mapping == MAP_FAILED)
+    {
+        free(state);
+        return MATRIX_ERROR_CREATION;
+    }
+
+    state->header = (ShmHeader*)mapping;
+    state->header->parties = (unsigned)workers + 1;
+    state->coordinator = getpid();
+    *state_out = state;
+    *memory = (char*)mapping + shm_header_bytes();
+    return MATRIX_SUCCESS;
+}
+
+static int shm_launch(void* state_ptr, int rank, int (*run)(void* context, void* memory, int rank), void* context)
+{
+    ShmState* state = (ShmState*)state_ptr;
+    fflush(NULL);
+
+    pid_t pid = fork();
+    if (pid < 0)
+    {
+        return MATRIX_ERROR_CREATION;
+    }
+    if (pid == 0)
+    {
+        sched_fork_child();
+        int code = run(context, (char*)state->header + shm_header_bytes(), rank);
+        _exit(code);
+    }
+    state->pids[rank] = pid;
+    return MATRIX_SUCCESS;
+}
+
+/* Координатор: не завершился ли какой-то процесс раньше времени */
+static void shm_check_workers(ShmState* state)
+{
+    for (unsigned rank = 1; rank < state->header->parties; rank++)
+    {
+        if (state->pids[rank] > 0 && waitpid(state->pids[rank], NULL, WNOHANG) == state->pids[rank])
+        {
+            state->pids[rank] = 0;
+            atomic_store(&state->header->aborted, 1);
+        }
+    }
+}
+
+static void shm_futex(atomic_uint* word, int op, unsigned value, const struct timespec* timeout)
+{
+    syscall(SYS_futex, (unsigned*)word, op, value, timeout, NULL, 0);
+}
+
+static int shm_barrier(void* state_ptr, int rank)
+{
+    ShmState* state = (ShmState*)state_ptr;
+    ShmHeader* header = state->header;
+
+    unsigned generation = atomic_load(&header->generation);
+    if (atomic_fetch_add(&header->arrived, 1) + 1 == header->parties)
+    {
+        atomic_store(&header->arrived, 0);
+        atomic_fetch_add(&header->generation, 1);
+        shm_futex(&header->generation, SHARD_FUTEX_WAKE, INT_MAX, NULL);
+        return atomic_load(&header->aborted) ? -1 : 0;
+    }
+
+    for (int round = 0; atomic_load(&header->generation) == generation; round++)
+    {
+        if (atomic_load(&header->aborted)) break;
+        if (round < SHARD_SPIN_ROUNDS) continue;
+
+        struct timespec slice = {0, SHARD_WAIT_SLICE_NS};
+        shm_futex(&header->generation, SHARD_FUTEX_WAIT, generation, &slice);
+        if (rank == 0)
+        {
+            shm_check_workers(state);
+        }
+        else if (getppid() != state->coordinator)
+        {
+            atomic_store(&header->aborted, 1);
+        }
+    }
+
+    if (atomic_load(&header->aborted))
+    {
+        shm_futex(&header->generation, SHARD_FUTEX_WAKE, INT_MAX, NULL);
+        return -1;
+    }
+    return 0;
+}
+
+static int shm_publish(void* state, int rank, size_t offset, size_t bytes)
+{
+    /* Область общая: записанное видно всем после барьера */
+    (void)state;
+    (void)rank;
+    (void)offset;
+    (void)bytes;
+    return MATRIX_SUCCESS;
+}
+
+static void shm_destroy(void* state_ptr)
+{
+    ShmState* state = (ShmState*)state_ptr;
+    if (!state) return;
+
+    /* Процессы, которые ещё ждут на барьере (не все были запущены), выходят с ошибкой */
+    atomic_store(&state->header->aborted, 1);
+    shm_futex(&state->header->generation, SHARD_FUTEX_WAKE, INT_MAX, NULL);
+    for (unsigned rank = 1; rank <= SHARD_MAX_WORKERS; rank++)
+    {
+        if (state->pids[rank] > 0) waitpid(state->pids[rank], NULL, 0);
+    }
+    munmap(state->header, state->mapped);
+    free(state);
+}
+
+const ShardTransport shard_transport_shm =
+{
+    "shm", shm_create, shm_launch, shm_barrier, shm_publish, shm_destroy
+};
+
+/* ---------- Координатор и рабочие процессы ---------- */
+
+enum SHARD_COMMAND
+{
+    SHARD_MULTIPLY = 1,
+    SHARD_EXIT
+};
+
+/* Счётчики участника: каждый пишет только свою строку кэша */
+typedef struct ShardRankState
+{
+    _Alignas(64) pid_t pid;
+    int rows;
+    int multiplies;
+    int error;
+    ULL compute_ns;
+    ULL wait_ns;
+    MatrixVerifierStats verified;           /* проверки полос этим процессом */
+} ShardRankState;
+
+/* Начало общей области: параметры, команда и счётчики; за ней три упакованные матрицы */
+typedef struct ShardControl
+{
+    int n;
+    int workers;
+    ULL field_size;
+    int width;
+    int format;
+    size_t matrix_bytes;
+    size_t offsets[3];
+
+    int command;                            /* SHARD_COMMAND, пишет координатор до первого барьера */
+    int a, b, c;                            /* c = a × b по номерам буферов */
+
+    ShardRankState ranks[SHARD_MAX_WORKERS + 1];
+} ShardControl;
+
+/* Аргумент рабочих процессов (у каждого своя копия после fork) */
+typedef struct ShardContext
+{
+    const ShardTransport* transport;
+    void* state;
+} ShardContext;
+
+static void shard_packed(const ShardControl* control, void* memory, int index, int row_begin, int row_end,
+                         PackedMatrix* result)
+{
+    size_t row_bytes = (size_t)control->n * (size_t)control->width;
+    result->data = (char*)memory + control->offsets[index] + (size_t)row_begin * row_bytes;
+    result->rows = row_end - row_begin;
+    result->cols = control->n;
+    result->width = control->width;
+    result->format = control->format;
+    result->field_size = control->field_size;
+    result->owns_data = 0;
+    result->allocator = NULL;
+}
+
+static int shard_worker(void* context_ptr, void* memory, int rank)
+{
+    ShardContext* context = (ShardContext*)context_ptr;
+    ShardControl* control = (ShardControl*)memory;
+    ShardRankState* self = &control->ranks[rank];
+    trace_thread_name("shard-worker");
+
+    int row_begin = (int)((long long)control->n * (rank - 1) / control->workers);
+    int row_end = (int)((long long)control->n * rank / control->workers);
+    self->pid = getpid();
+    self->rows = row_end - row_begin;
+
+    /* Копия контекста проверки досталась от координатора вместе с его счётчиками */
+    MatrixVerifier* verifier = matrix_verifier_current();
+    MatrixVerifierStats inherited = {0, 0, 0}, current;
+    if (verifier) matrix_verifier_stats(verifier, &inherited);
+
+    for (;;)
+    {
+        int64_t t0 = shard_now_ns();
+        if (context->transport->barrier(context->state, rank) != 0) return 1;
+        int64_t t1 = shard_now_ns();
+        self->wait_ns += (ULL)(t1 - t0);
+
+        if (control->command == SHARD_EXIT) return 0;
+
+        if (row_end > row_begin && self->error == MATRIX_SUCCESS)
+        {
+            PackedMatrix a, b, c;
+            shard_packed(control, memory, control->a, row_begin, row_end, &a);
+            shard_packed(control, memory, control->b, 0, control->n, &b);
+            shard_packed(control, memory, control->c, row_begin, row_end, &c);
+            self->error = packed_matrix_multiply(&a, &b, &c);
+            if (self->error == MATRIX_SUCCESS)
+            {
+                context->transport->publish(context->state, rank,
+                                            control->offsets[control->c] + (size_t)row_begin * control->n * control->width,
+                                            (size_t)self->rows * control->n * control->width);
+            }
+            self->multiplies++;
+            if (verifier && matrix_verifier_stats(verifier, &current) == MATRIX_SUCCESS)
+            {
+                self->verified.checks = current.checks - inherited.checks;
+                self->verified.rounds = current.rounds - inherited.rounds;
+                self->verified.failures = current.failures - inherited.failures;
+            }
+        }
+        int64_t t2 = shard_now_ns();
+        self->compute_ns += (ULL)(t2 - t1);
+
+        if (context->transport->barrier(context->state, rank) != 0) return 1;
+        self->wait_ns += (ULL)(shard_now_ns() - t2);
+    }
+}
+
+/* Одно умножение всеми процессами: c = a × b. [RETURN] код первой ошибки полосы */
+static int shard_multiply(ShardContext* context, ShardControl* control, int a, int b, int c)
+{
+    TRACE_SCOPE("shard_multiply");
+
+    control->command = SHARD_MULTIPLY;
+    control->a = a;
+    control->b = b;
+    control->c = c;
+    if (context->transport->barrier(context->state, 0) != 0 || context->transport->barrier(context->state, 0) != 0)
+    {
+        return MATRIX_ERROR_CREATION;
+    }
+    for (int rank = 1; rank <= control->workers; rank++)
+    {
+        if (control->ranks[rank].error != MATRIX_SUCCESS) return control->ranks[rank].error;
+    }
+    return MATRIX_SUCCESS;
+}
+
+int matrix_power_sharded(const Matrix* base, ULL exponent, const ShardOptions* options, Matrix** result,
+                         ShardReport* report)
+{
+    TRACE_SCOPE("matrix_power_sharded");
+
+    if (!base || !options || !result)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+    if (base->rows != base->cols)
+    {
+        return MATRIX_ERROR_NOT_SQUARE;
+    }
+    if (options->workers < 1 || options->workers > SHARD_MAX_WORKERS)
+    {
+        return MATRIX_ERROR_INVALID_SIZE;
+    }
+    if (report)
+    {
+        memset(report, 0, sizeof(*report));
+    }
+    if (exponent <= 1)
+    {
+        return matrix_power(base, exponent, result);
+    }
+
+    int n = base->rows;
+    int workers = options->workers < n ? options->workers : n;
+    ULL p = base->field_size;
+    const ShardTransport* transport = options->transport ? options->transport : &shard_transport_shm;
+
+    /* Ширина и формат — как у packed_matrix_create: полосы перемножаются теми же ядрами */
+    int format = packed_matrix_format(p);
+    int width = (format == PACKED_DOUBLE) ? (int)sizeof(double) : matrix_element_width(p);
+    size_t matrix_bytes = ((size_t)n * n * (size_t)width + SHARD_PAGE - 1) & ~(size_t)(SHARD_PAGE - 1);
+    size_t control_bytes = (sizeof(ShardControl) + SHARD_PAGE - 1) & ~(size_t)(SHARD_PAGE - 1);
+
+    ShardContext context = {transport, NULL};
+    void* memory = NULL;
+    int error = transport->create(control_bytes + 3 * matrix_bytes, workers, &context.state, &memory);
+    if (error != MATRIX_SUCCESS)
+    {
+        return error;
+    }
+
+    ShardControl* control = (ShardControl*)memory;
+    memset(control, 0, sizeof(*control));
+    control->n = n;
+    control->workers = workers;
+    control->field_size = p;
+    control->width = width;
+    control->format = format;
+    control->matrix_bytes = matrix_bytes;
+    for (int i = 0; i < 3; i++)
+    {
+        control->offsets[i] = control_bytes + (size_t)i * matrix_bytes;
+    }
+
+    /* Буферы: результат, текущая степень, приёмник — роли меняются после каждого умножения */
+    int accumulated = 0, power = 1, spare = 2;
+    PackedMatrix packed;
+    shard_packed(control, memory, power, 0, n, &packed);
+    error = packed_matrix_load(base, &packed);
+
+    int64_t started = shard_now_ns();
+    int launched = 0;
+    for (; error == MATRIX_SUCCESS && launched < workers; launched++)
+    {
+        error = transport->launch(context.state, launched + 1, shard_worker, &context);
+    }
+
+    int have_result = 0;
+    int multiplies = 0;
+    for (ULL rest = exponent; error == MATRIX_SUCCESS && rest; rest >>= 1)
+    {
+        if (rest & 1)
+        {
+            if (!have_result)
+            {
+                memcpy((char*)memory + control->offsets[accumulated], (char*)memory + control->offsets[power],
+                       matrix_bytes);
+                have_result = 1;
+            }
+            else
+            {
+                error = shard_multiply(&context, control, accumulated, power, spare);
+                int swap = accumulated; accumulated = spare; spare = swap;
+                multiplies++;
+            }
+        }
+        if (error == MATRIX_SUCCESS && rest > 1)
+        {
+            error = shard_multiply(&context, control, power, power, spare);
+            int swap = power; power = spare; spare = swap;
+            multiplies++;
+        }
+    }
+
+    /* Если запустились не все, барьер не пройти: уже запущенных остановит destroy */
+    if (launched == workers)
+    {
+        control->command = SHARD_EXIT;
+        transport->barrier(context.state, 0);
+    }
+
+    Matrix* result_matrix = NULL;
+    if (error == MATRIX_SUCCESS) error = matrix_create_uninit(n, n, p, &result_matrix);
+    if (error == MATRIX_SUCCESS)
+    {
+        shard_packed(control, memory, accumulated, 0, n, &packed);
+        error = packed_matrix_store(&packed, result_matrix);
+    }
+
+    MatrixVerifier* verifier = matrix_verifier_current();
+    for (int rank = 1; verifier && rank <= workers; rank++)
+    {
+        matrix_verifier_add(verifier, &control->ranks[rank].verified);
+    }
+
+    if (report)
+    {
+        report->workers = workers;
+        report->multiplies = multiplies;
+        report->total_ns = (ULL)(shard_now_ns() - started);
+        for (int rank = 1; rank <= workers; rank++)
+        {
+            const ShardRankState* state = &control->ranks[rank];
+            ShardWorkerReport* line = &report->ranks[rank - 1];
+            line->pid = state->pid;
+            line->rows = state->rows;
+            line->multiplies = state->multiplies;
+            line->compute_ns = state->compute_ns;
+            line->wait_ns = state->wait_ns;
+        }
+    }
+    transport->destroy(context.state);
+
+    if (error != MATRIX_SUCCESS)
+    {
+        matrix_free(result_matrix);
+        return error;
+    }
+    *result = result_matrix;
+    return MATRIX_SUCCESS;
+}
+
+void shard_report_print(const ShardReport* report, FILE* out)
+{
+    if (!report || !out) return;
+
+    fprintf(out, "Процессов: %d, умножений: %d, всего %.3f мс\n", report->workers, report->multiplies,
+            (double)report->total_ns / 1e6);
+    fprintf(out, "%s\n", "     pid    строк    полос     счёт, мс    ожид., мс  счёт %");
+    for (int i = 0; i < report->workers; i++)
+    {
+        const ShardWorkerReport* line = &report->ranks[i];
+        ULL busy = line->compute_ns + line->wait_ns;
+        fprintf(out, "%8d %8d %8d %12.3f %12.3f %6.1f%%\n", (int)line->pid, line->rows, line->multiplies,
+                (double)line->compute_ns / 1e6, (double)line->wait_ns / 1e6,
+                busy ? 100.0 * (double)line->compute_ns / (double)busy : 0.0);
+    }
+}
@@ -0,0 +1,968 @@
+#include "../include/matrix_tiled.h"
+#include "../include/matrix_kernels.h"
+#include "../include/trace.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sys/stat.h>
+
+#define TILED_TEMP_FILES 3                  /* результат, текущая степень и приёмник умножения */
+
+static int64_t tiled_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/* ---------- Файл ---------- */
+
+static off_t tiled_offset(const TiledMatrix* matrix, int row, int col)
+{
+    return (off_t)TILED_DATA_OFFSET + ((off_t)row * matrix->tiles + col) * (off_t)matrix->tile_bytes;
+}
+
+/* pread/pwrite целиком: с повтором после EINTR и неполной операции */
+static int tiled_transfer(int fd, int write, void* buffer, size_t bytes, off_t offset)
+{
+    char* cursor = (char*)buffer;
+    while (bytes > 0)
+    {
+        ssize_t done = write ? pwrite(fd, cursor, bytes, offset) : pread(fd, cursor, bytes, offset);
+        if (done < 0 && errno == EINTR) continue;
+        if (done <= 0) return MATRIX_ERROR_FILE;
+        cursor += done;
+        bytes -= (size_t)done;
+        offset += done;
+    }
+    return MATRIX_SUCCESS;
+}
+
+static TiledMatrix* tiled_alloc(const char* path, int fd, int size, int tile, ULL field_size)
+{
+    TiledMatrix* matrix = (TiledMatrix*)calloc(1, sizeof(TiledMatrix));
+    size_t length = strlen(path) + 1;
+    char* copy = (char*)malloc(length);
+    if (!matrix || !copy)
+    {
+        free(matrix);
+        free(copy);
+        return NULL;
+    }
+    memcpy(copy, path, length);
+
+    matrix->fd = fd;
+    matrix->path = copy;
+    matrix->size = size;
+    matrix->tile = tile;
+    matrix->tiles = (size + tile - 1) / tile;
+    matrix->width = matrix_element_width(field_size);
+    matrix->field_size = field_size;
+    matrix->tile_bytes = (size_t)tile * (size_t)tile * (size_t)matrix->width;
+    return matrix;
+}
+
+int tiled_matrix_create(const char* path, int size, ULL field_size, int tile, TiledMatrix** result)
+{
+    if (!path || !result)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+    if (size <= 0 || tile < 0)
+    {
+        return MATRIX_ERROR_INVALID_SIZE;
+    }
+    if (tile == 0) tile = TILED_DEFAULT_TILE;
+    if (tile > size) tile = size;
+
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        return MATRIX_ERROR_FILE;
+    }
+    TiledMatrix* matrix = tiled_alloc(path, fd, size, tile, field_size);
+    if (!matrix)
+    {
+        close(fd);
+        return MATRIX_ERROR_CREATION;
+    }
+
+    TiledFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, TILED_MAGIC, sizeof(header.magic));
+    header.field_size = field_size;
+    header.size = (uint32_t)size;
+    header.tile = (uint32_t)tile;
+    header.width = (uint32_t)matrix->width;
+
+    int error = tiled_transfer(fd, 1, &header, sizeof(header), 0);
+    if (error == MATRIX_SUCCESS && ftruncate(fd, tiled_offset(matrix, matrix->tiles, 0)) != 0)
+    {
+        error = MATRIX_ERROR_FILE;
+    }
+    if (error != MATRIX_SUCCESS)
+    {
+        tiled_matrix_close(matrix);
+        unlink(path);
+        return error;
+    }
+
+    *result = matrix;
+    return MATRIX_SUCCESS;
+}
+
+int tiled_matrix_open(const char* path, TiledMatrix** result)
+{
+    if (!path || !result)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        return MATRIX_ERROR_FILE;
+    }
+
+    TiledFileHeader header;
+    int error = tiled_transfer(fd, 0, &header, sizeof(header), 0);
+    if (error == MATRIX_SUCCESS &&
+        (memcmp(header.magic, TILED_MAGIC, sizeof(header.magic)) != 0 || header.size == 0 ||
+         header.size > INT32_MAX || header.tile == 0 || header.tile > header.size ||
+         header.width != (uint32_t)matrix_element_width(header.field_size)))
+    {
+        error = MATRIX_ERROR_INVALID_NUMBER;
+    }
+
+    TiledMatrix* matrix = NULL;
+    if (error == MATRIX_SUCCESS)
+    {
+        matrix = tiled_alloc(path, fd, (int)header.size, (int)header.tile, header.field_size);
+        if (!matrix) error = MATRIX_ERROR_CREATION;
+    }
+
+    /* Файл короче заявленного — обрезан */
+    struct stat info;
+    if (error == MATRIX_SUCCESS && (fstat(fd, &info) != 0 || info.st_size < tiled_offset(matrix, matrix->tiles, 0)))
+    {
+        error = MATRIX_ERROR_INVALID_NUMBER;
+    }
+
+    if (error != MATRIX_SUCCESS)
+    {
+        if (matrix) tiled_matrix_close(matrix);
+        else close(fd);
+        return error;
+    }
+
+    *result = matrix;
+    return MATRIX_SUCCESS;
+}
+
+void tiled_matrix_close(TiledMatrix* matrix)
+{
+    if (!matrix)
+    {
+        return;
+    }
+    close(matrix->fd);
+    free(matrix->path);
+    free(matrix);
+}
+
+int tiled_matrix_read_tile(const TiledMatrix* matrix, int row, int col, void* buffer)
+{
+    if (!matrix || !buffer)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+    if (row < 0 || col < 0 || row >= matrix->tiles || col >= matrix->tiles)
+    {
+        return MATRIX_ERROR_DIMENSION;
+    }
+    return tiled_transfer(matrix->fd, 0, buffer, matrix->tile_bytes, tiled_offset(matrix, row, col));
+}
+
+int tiled_matrix_write_tile(TiledMatrix* matrix, int row, int col, const void* buffer)
+{
+    if (!matrix || !buffer)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+    if (row < 0 || col < 0 || row >= matrix->tiles || col >= matrix->tiles)
+    {
+        return MATRIX_ERROR_DIMENSION;
+    }
+    return tiled_transfer(matrix->fd, 1, (void*)buffer, matrix->tile_bytes, tiled_offset(matrix, row, col));
+}
+
+/* Элемент плитки ширины width */
+static ULL tile_get(const void* tile, int width, size_t index)
+{
+    switch (width)
+    {
+        case 1: return ((const uint8_t*)tile)[index];
+        case 2: return ((const uint16_t*)tile)[index];
+        case 4: return ((const uint32_t*)tile)[index];
+        default: return ((const ULL*)tile)[index];
+    }
+}
+
+static void tile_set(void* tile, int width, size_t index, ULL value)
+{
+    switch (width)
+    {
+        case 1: ((uint8_t*)tile)[index] = (uint8_t)value; break;
+        case 2: ((uint16_t*)tile)[index] = (uint16_t)value; break;
+        case 4: ((uint32_t*)tile)[index] = (uint32_t)value; break;
+        default: ((ULL*)tile)[index] = value; break;
+    }
+}
+
+/* Число строк (столбцов) плитки index, попадающих в матрицу */
+static int tile_extent(const TiledMatrix* matrix, int index)
+{
+    int rest = matrix->size - index * matrix->tile;
+    return rest < matrix->tile ? rest : matrix->tile;
+}
+
+int tiled_matrix_from_matrix(const Matrix* src, const char* path, int tile, TiledMatrix** result)
+{
+    if (!src || !path || !result)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+    if (src->rows != src->cols)
+    {
+        return MATRIX_ERROR_NOT_SQUARE;
+    }
+
+    TiledMatrix* matrix;
+    int error = tiled_matrix_create(path, src->rows, src->field_size, tile, &matrix);
+    if (error != MATRIX_SUCCESS)
+    {
+        return error;
+    }
+    void* buffer = calloc(1, matrix->tile_bytes);
+    if (!buffer) error = MATRIX_ERROR_CREATION;
+
+    for (int ti = 0; ti < matrix->tiles && error == MATRIX_SUCCESS; ti++)
+    {
+        for (int tj = 0; tj < matrix->tiles && error == MATRIX_SUCCESS; tj++)
+        {
+            int rows = tile_extent(matrix, ti);
+            int cols = tile_extent(matrix, tj);
+            if (rows < matrix->tile || cols < matrix->tile) memset(buffer, 0, matrix->tile_bytes);  /* дополнение */
+            for (int i = 0; i < rows; i++)
+            {
+                const ULL* row = src->data[ti * matrix->tile + i] + tj * matrix->tile;
+                for (int j = 0; j < cols; j++)
+                {
+                    tile_set(buffer, matrix->width, (size_t)i * matrix->tile + j, row[j]);
+                }
+            }
+            error = tiled_matrix_write_tile(matrix, ti, tj, buffer);
+        }
+    }
+
+    free(buffer);
+    if (error != MATRIX_SUCCESS)
+    {
+        unlink(path);
+        tiled_matrix_close(matrix);
+        return error;
+    }
+    *result = matrix;
+    return MATRIX_SUCCESS;
+}
+
+int tiled_matrix_to_matrix(const TiledMatrix* src, Matrix** result)
+{
+    if (!src || !result)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+
+    Matrix* matrix;
+    int error = matrix_create(src->size, src->size, src->field_size, &matrix);
+    if (error != MATRIX_SUCCESS)
+    {
+        return error;
+    }
+    void* buffer = malloc(src->tile_bytes);
+    if (!buffer) error = MATRIX_ERROR_CREATION;
+
+    for (int ti = 0; ti < src->tiles && error == MATRIX_SUCCESS; ti++)
+    {
+        for (int tj = 0; tj < src->tiles && error == MATRIX_SUCCESS; tj++)
+        {
+            error = tiled_matrix_read_tile(src, ti, tj, buffer);
+            int rows = tile_extent(src, ti);
+            int cols = tile_extent(src, tj);
+            for (int i = 0; i < rows && error == MATRIX_SUCCESS; i++)
+            {
+                ULL* row = matrix->data[ti * src->tile + i] + tj * src->tile;
+                for (int j = 0; j < cols; j++)
+                {
+                    row[j] = tile_get(buffer, src->width, (size_t)i * src->tile + j);
+                }
+            }
+        }
+    }
+
+    free(buffer);
+    if (error != MATRIX_SUCCESS)
+    {
+        matrix_free(matrix);
+        return error;
+    }
+    *result = matrix;
+    return MATRIX_SUCCESS;
+}
+
+/* splitmix64 */
+static ULL tiled_random_next(ULL* state)
+{
+    ULL z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+int tiled_matrix_random(const char* path, int size, ULL field_size, int tile, ULL seed, TiledMatrix** result)
+{
+    TiledMatrix* matrix;
+    int error = tiled_matrix_create(path, size, field_size, tile, &matrix);
+    if (error != MATRIX_SUCCESS)
+    {
+        return error;
+    }
+    void* buffer = calloc(1, matrix->tile_bytes);
+    if (!buffer) error = MATRIX_ERROR_CREATION;
+
+    ULL state = seed;
+    for (int ti = 0; ti < matrix->tiles && error == MATRIX_SUCCESS; ti++)
+    {
+        for (int tj = 0; tj < matrix->tiles && error == MATRIX_SUCCESS; tj++)
+        {
+            int rows = tile_extent(matrix, ti);
+            int cols = tile_extent(matrix, tj);
+            if (rows < matrix->tile || cols < matrix->tile) memset(buffer, 0, matrix->tile_bytes);  /* дополнение */
+            for (int i = 0; i < rows; i++)
+            {
+                for (int j = 0; j < cols; j++)
+                {
+                    ULL value = tiled_random_next(&state);
+                    tile_set(buffer, matrix->width, (size_t)i * matrix->tile + j,
+                             field_size ? value % field_size : value);
+                }
+            }
+            error = tiled_matrix_write_tile(matrix, ti, tj, buffer);
+        }
+    }
+
+    free(buffer);
+    if (error != MATRIX_SUCCESS)
+    {
+        unlink(path);
+        tiled_matrix_close(matrix);
+        return error;
+    }
+    *result = matrix;
+    return MATRIX_SUCCESS;
+}
+
+/* ---------- Поток ввода-вывода ---------- */
+
+/* Заявка: прочитать или записать одну плитку */
+typedef struct TiledIoRequest
+{
+    int fd;
+    int write;
+    off_t offset;
+    void* buffer;
+    size_t bytes;
+} TiledIoRequest;
+
+/*
+ * Кольцо заявок. Заявки выполняются по порядку, поэтому номер заявки одновременно означает
+ * «выполнены все заявки до неё»: ожидание номера — одно сравнение с done.
+ */
+typedef struct TiledIo
+{
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t submitted;               /* новая заявка или остановка */
+    pthread_cond_t completed;               /* заявка выполнена (освободилось место) */
+    TiledIoRequest ring[TILED_IO_DEPTH];
+    ULL head;                               /* выдано заявок */
+    ULL done;                               /* выполнено заявок */
+    int stop;
+    int error;                              /* первая ошибка; после неё заявки не выполняются */
+} TiledIo;
+
+static void* tiled_io_thread(void* argument)
+{
+    TiledIo* io = (TiledIo*)argument;
+    trace_thread_name("tiled-io");
+
+    pthread_mutex_lock(&io->lock);
+    for (;;)
+    {
+        while (io->done == io->head && !io->stop)
+        {
+            pthread_cond_wait(&io->submitted, &io->lock);
+        }
+        if (io->done == io->head)
+        {
+            break;
+        }
+        TiledIoRequest request = io->ring[io->done % TILED_IO_DEPTH];
+        int failed = io->error;
+        pthread_mutex_unlock(&io->lock);
+
+        int error = failed ? failed
+                           : tiled_transfer(request.fd, request.write, request.buffer, request.bytes, request.offset);
+
+        pthread_mutex_lock(&io->lock);
+        if (error != MATRIX_SUCCESS && io->error == MATRIX_SUCCESS) io->error = error;
+        io->done++;
+        pthread_cond_broadcast(&io->completed);
+    }
+    pthread_mutex_unlock(&io->lock);
+    return NULL;
+}
+
+static int tiled_io_start(TiledIo* io)
+{
+    memset(io, 0, sizeof(*io));
+    pthread_mutex_init(&io->lock, NULL);
+    pthread_cond_init(&io->submitted, NULL);
+    pthread_cond_init(&io->completed, NULL);
+    if (pthread_create(&io->thread, NULL, tiled_io_thread, io) != 0)
+    {
+        pthread_mutex_destroy(&io->lock);
+        pthread_cond_destroy(&io->submitted);
+        pthread_cond_destroy(&io->completed);
+        return MATRIX_ERROR_CREATION;
+    }
+    return MATRIX_SUCCESS;
+}
+
+/* Выполнить оставшиеся заявки и остановить поток */
+static void tiled_io_stop(TiledIo* io)
+{
+    pthread_mutex_lock(&io->lock);
+    io->stop = 1;
+    pthread_cond_signal(&io->submitted);
+    pthread_mutex_unlock(&io->lock);
+    pthread_join(io->thread, NULL);
+    pthread_mutex_destroy(&io->lock);
+    pthread_cond_destroy(&io->submitted);
+    pthread_cond_destroy(&io->completed);
+}
+
+/* Поставить заявку (ждёт, если кольцо полно). [RETURN] номер заявки для tiled_io_wait */
+static ULL tiled_io_submit(TiledIo* io, int fd, int write, off_t offset, void* buffer, size_t bytes)
+{
+    pthread_mutex_lock(&io->lock);
+    while (io->head - io->done >= TILED_IO_DEPTH)
+    {
+        pthread_cond_wait(&io->completed, &io->lock);
+    }
+    TiledIoRequest* request = &io->ring[io->head % TILED_IO_DEPTH];
+    request->fd = fd;
+    request->write = write;
+    request->offset = offset;
+    request->buffer = buffer;
+    request->bytes = bytes;
+    ULL ticket = ++io->head;
+    pthread_cond_signal(&io->submitted);
+    pthread_mutex_unlock(&io->lock);
+    return ticket;
+}
+
+/* Дождаться выполнения заявок до номера ticket включительно. [RETURN] MATRIX_SUCCESS или первая ошибка */
+static int tiled_io_wait(TiledIo* io, ULL ticket)
+{
+    pthread_mutex_lock(&io->lock);
+    while (io->done < ticket)
+    {
+        pthread_cond_wait(&io->completed, &io->lock);
+    }
+    int error = io->error;
+    pthread_mutex_unlock(&io->lock);
+    return error;
+}
+
+/* ---------- Блочное умножение ---------- */
+
+/* Столбец плиток A (row, k) или строка плиток B (k, row) в памяти */
+typedef struct TiledPanel
+{
+    char* tiles;                            /* count плиток с шагом slot_bytes */
+    const TiledMatrix* source;              /* NULL — содержимое неизвестно */
+    int first;                              /* первая строка плиток (A) или столбец (B) */
+    int count;
+    int k;
+} TiledPanel;
+
+typedef struct TiledEngine
+{
+    TiledIo io;
+    char* arena;                            /* все буферы плиток */
+    size_t slot_bytes;                      /* tile_bytes, выровненный на TILED_ALIGN */
+    int rows;                               /* r: плиток в блоке C по вертикали */
+    int cols;                               /* c */
+    char* accumulators;                     /* r * c плиток блока C */
+    char* product;                          /* произведение двух плиток */
+    TiledPanel a[2];                        /* текущий столбец A и предвыборка */
+    TiledPanel b[2];
+    ULL* write_tickets;                     /* последняя запись каждого аккумулятора */
+    TiledReport* report;
+} TiledEngine;
+
+/* Один шаг умножения: блок C и индекс k */
+typedef struct TiledStep
+{
+    int row0;
+    int rows;
+    int col0;
+    int cols;
+    int k;
+    int first;                              /* первый шаг блока: аккумуляторы перезаписываются */
+    int last;                               /* последний: блок пишется в файл */
+} TiledStep;
+
+/* Плитка в памяти: tile_bytes, выровненные на TILED_ALIGN */
+static size_t tiled_slot_bytes(const TiledMatrix* matrix)
+{
+    return (matrix->tile_bytes + TILED_ALIGN - 1) & ~(size_t)(TILED_ALIGN - 1);
+}
+
+size_t tiled_min_budget(const TiledMatrix* matrix)
+{
+    return matrix ? TILED_MIN_SLOTS * tiled_slot_bytes(matrix) : 0;
+}
+
+/*
+ * Наибольшие r и c, при которых r * c + 2 * (r + c) + 1 плиток помещаются в slots:
+ * сначала квадратный блок, затем остаток бюджета — на ширину.
+ */
+static int tiled_plan(size_t slots, int tiles, int* rows, int* cols)
+{
+    size_t r = 0;
+    while (r < (size_t)tiles && (r + 1) * (r + 1) + 4 * (r + 1) + 1 <= slots) r++;   /* r = 1: TILED_MIN_SLOTS */
+    if (r == 0)
+    {
+        return MATRIX_ERROR_MEMORY_BUDGET;
+    }
+    size_t c = r;
+    while (c < (size_t)tiles && r * (c + 1) + 2 * (r + c + 1) + 1 <= slots) c++;
+
+    *rows = (int)r;
+    *cols = (int)c;
+    return MATRIX_SUCCESS;
+}
+
+/*
+ * Шаг index: блоки обходятся по строкам блоков змейкой, k в каждом следующем блоке идёт
+ * в обратную сторону. На стыке соседних блоков совпадает столбец A (блоки в одной строке)
+ * или строка B (блоки в одном столбце), и он не читается повторно.
+ */
+static void tiled_step(const TiledEngine* engine, int tiles, long long index, TiledStep* step)
+{
+    int blocks_cols = (tiles + engine->cols - 1) / engine->cols;
+    long long block = index / tiles;
+    int position = (int)(index % tiles);
+    int block_row = (int)(block / blocks_cols);
+    int block_col = (int)(block % blocks_cols);
+    if (block_row & 1) block_col = blocks_cols - 1 - block_col;
+
+    step->row0 = block_row * engine->rows;
+    step->rows = tiles - step->row0 < engine->rows ? tiles - step->row0 : engine->rows;
+    step->col0 = block_col * engine->cols;
+    step->cols = tiles - step->col0 < engine->cols ? tiles - step->col0 : engine->cols;
+    step->k = (block & 1) ? tiles - 1 - position : position;
+    step->first = position == 0;
+    step->last = position == tiles - 1;
+}
+
+/*
+ * Получить буфер для столбца A (column == 0) или строки B шага: уже содержащий их
+ * или свободный (не busy), с постановкой заявок на чтение.
+ * [RETURN] индекс буфера в panels
+ */
+static int tiled_panel_acquire(TiledEngine* engine, TiledPanel* panels, int busy, const TiledMatrix* source,
+                               int first, int count, int k, int column, ULL* ticket)
+{
+    for (int index = 0; index < 2; index++)
+    {
+        TiledPanel* panel = &panels[index];
+        if (panel->source == source && panel->first == first && panel->count == count && panel->k == k)
+        {
+            engine->report->tiles_reused += (ULL)count;
+            return index;
+        }
+    }
+
+    int index = (busy == 0) ? 1 : 0;
+    TiledPanel* panel = &panels[index];
+    panel->source = source;
+    panel->first = first;
+    panel->count = count;
+    panel->k = k;
+    for (int t = 0; t < count; t++)
+    {
+        off_t offset = column ? tiled_offset(source, first + t, k) : tiled_offset(source, k, first + t);
+        *ticket = tiled_io_submit(&engine->io, source->fd, 0, offset, panel->tiles + (size_t)t * engine->slot_bytes,
+                                  source->tile_bytes);
+    }
+    engine->report->tiles_read += (ULL)count;
+    engine->report->bytes_read += (ULL)count * source->tile_bytes;
+    return index;
+}
+
+static void tiled_packed(const TiledMatrix* matrix, void* data, PackedMatrix* result)
+{
+    result->data = data;
+    result->rows = matrix->tile;
+    result->cols = matrix->tile;
+    result->width = matrix->width;
+    result->format = PACKED_INTEGER;
+    result->field_size = matrix->field_size;
+    result->owns_data = 0;
+    result->allocator = NULL;
+}
+
+static int tiled_wait_timed(TiledEngine* engine, ULL ticket)
+{
+    if (ticket == 0)
+    {
+        return MATRIX_SUCCESS;
+    }
+    int64_t start = tiled_now_ns();
+    int error = tiled_io_wait(&engine->io, ticket);
+    engine->report->io_wait_ns += (ULL)(tiled_now_ns() - start);
+    return error;
+}
+
+/* c = a × b; плитки следующего шага читаются во время вычисления текущего */
+static int tiled_multiply(TiledEngine* engine, const TiledMatrix* a, const TiledMatrix* b, TiledMatrix* c)
+{
+    TRACE_SCOPE("tiled_multiply");
+    int tiles = a->tiles;
+    int blocks = ((tiles + engine->rows - 1) / engine->rows) * ((tiles + engine->cols - 1) / engine->cols);
+    long long steps = (long long)blocks * tiles;
+
+    /* Файлы-приёмники переиспользуются: прежнее содержимое буферов недействительно */
+    for (int index = 0; index < 2; index++)
+    {
+        engine->a[index].source = NULL;
+        engine->b[index].source = NULL;
+    }
+
+    TiledStep step;
+    ULL ticket = 0;
+    tiled_step(engine, tiles, 0, &step);
+    TiledStep next = step;
+    int slot_a = tiled_panel_acquire(engine, engine->a, -1, a, step.row0, step.rows, step.k, 1, &ticket);
+    int slot_b = tiled_panel_acquire(engine, engine->b, -1, b, step.col0, step.cols, step.k, 0, &ticket);
+
+    int error = MATRIX_SUCCESS;
+    for (long long index = 0; index < steps && error == MATRIX_SUCCESS; index++)
+    {
+        error = tiled_wait_timed(engine, ticket);
+        if (error != MATRIX_SUCCESS)
+        {
+            break;
+        }
+
+        /* Предвыборка следующего шага в буферы, не занятые текущим */
+        int next_a = -1;
+        int next_b = -1;
+        ticket = 0;
+        if (index + 1 < steps)
+        {
+            tiled_step(engine, tiles, index + 1, &next);
+            next_a = tiled_panel_acquire(engine, engine->a, slot_a, a, next.row0, next.rows, next.k, 1, &ticket);
+            next_b = tiled_panel_acquire(engine, engine->b, slot_b, b, next.col0, next.cols, next.k, 0, &ticket);
+        }
+
+        for (int i = 0; i < step.rows && error == MATRIX_SUCCESS; i++)
+        {
+            for (int j = 0; j < step.cols && error == MATRIX_SUCCESS; j++)
+            {
+                size_t slot = (size_t)i * engine->cols + j;
+                PackedMatrix left;
+                PackedMatrix right;
+                PackedMatrix accumulator;
+                PackedMatrix product;
+                tiled_packed(a, engine->a[slot_a].tiles + (size_t)i * engine->slot_bytes, &left);
+                tiled_packed(b, engine->b[slot_b].tiles + (size_t)j * engine->slot_bytes, &right);
+                tiled_packed(c, engine->accumulators + slot * engine->slot_bytes, &accumulator);
+                tiled_packed(c, engine->product, &product);
+
+                /* Первое произведение блока пишется прямо в аккумулятор, как только тот записан в файл */
+                if (step.first) error = tiled_wait_timed(engine, engine->write_tickets[slot]);
+
+                int64_t start = tiled_now_ns();
+                if (error == MATRIX_SUCCESS && step.first)
+                {
+                    error = packed_matrix_multiply_inplace(&left, &right, &accumulator);
+                }
+                else if (error == MATRIX_SUCCESS)
+                {
+                    error = packed_matrix_multiply_inplace(&left, &right, &product);
+                    if (error == MATRIX_SUCCESS) error = packed_matrix_add(&accumulator, &product, &accumulator);
+                }
+                engine->report->compute_ns += (ULL)(tiled_now_ns() - start);
+            }
+        }
+
+        /* Готовый блок пишется плитка за плиткой */
+        if (error == MATRIX_SUCCESS && step.last)
+        {
+            for (int i = 0; i < step.rows; i++)
+            {
+                for (int j = 0; j < step.cols; j++)
+                {
+                    size_t slot = (size_t)i * engine->cols + j;
+                    engine->write_tickets[slot] =
+                        tiled_io_submit(&engine->io, c->fd, 1, tiled_offset(c, step.row0 + i, step.col0 + j),
+                                        engine->accumulators + slot * engine->slot_bytes, c->tile_bytes);
+                }
+            }
+            engine->report->tiles_written += (ULL)step.rows * step.cols;
+            engine->report->bytes_written += (ULL)step.rows * step.cols * c->tile_bytes;
+        }
+
+        step = next;
+        slot_a = next_a;
+        slot_b = next_b;
+    }
+
+    /* Буферы свободны, только когда выполнены все поставленные заявки */
+    pthread_mutex_lock(&engine->io.lock);
+    ULL last = engine->io.head;
+    pthread_mutex_unlock(&engine->io.lock);
+    int io_error = tiled_wait_timed(engine, last);
+    return error != MATRIX_SUCCESS ? error : io_error;
+}
+
+/* Записать в пустой (нулевой) файл единичную матрицу; buffer — одна плитка */
+static int tiled_write_identity(TiledMatrix* matrix, void* buffer)
+{
+    ULL one = matrix->field_size ? 1 % matrix->field_size : 1;
+    int error = MATRIX_SUCCESS;
+    for (int t = 0; t < matrix->tiles && error == MATRIX_SUCCESS; t++)
+    {
+        memset(buffer, 0, matrix->tile_bytes);
+        int extent = tile_extent(matrix, t);
+        for (int i = 0; i < extent; i++)
+        {
+            tile_set(buffer, matrix->width, (size_t)i * matrix->tile + i, one);
+        }
+        error = tiled_matrix_write_tile(matrix, t, t, buffer);
+    }
+    return error;
+}
+
+static int tiled_copy(const TiledMatrix* src, TiledMatrix* dst, void* buffer)
+{
+    int error = MATRIX_SUCCESS;
+    for (int ti = 0; ti < src->tiles && error == MATRIX_SUCCESS; ti++)
+    {
+        for (int tj = 0; tj < src->tiles && error == MATRIX_SUCCESS; tj++)
+        {
+            error = tiled_matrix_read_tile(src, ti, tj, buffer);
+            if (error == MATRIX_SUCCESS) error = tiled_matrix_write_tile(dst, ti, tj, buffer);
+        }
+    }
+    return error;
+}
+
+/* Временный файл, не занятый ни результатом, ни текущей степенью; создаётся при первом использовании */
+static int tiled_temp(const TiledMatrix* base, TiledMatrix** temps, char paths[][PATH_MAX + 8],
+                      const TiledMatrix* busy_a, const TiledMatrix* busy_b, TiledMatrix** result)
+{
+    for (int index = 0; index < TILED_TEMP_FILES; index++)
+    {
+        if (temps[index] && (temps[index] == busy_a || temps[index] == busy_b)) continue;
+        if (!temps[index])
+        {
+            int error = tiled_matrix_create(paths[index], base->size, base->field_size, base->tile, &temps[index]);
+            if (error != MATRIX_SUCCESS) return error;
+        }
+        *result = temps[index];
+        return MATRIX_SUCCESS;
+    }
+    return MATRIX_ERROR_CREATION;
+}
+
+int matrix_power_tiled(const TiledMatrix* base, ULL exponent, const TiledOptions* options,
+                       const char* result_path, TiledMatrix** result, TiledReport* report)
+{
+    if (!base || !options || !result_path || !result)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+    if (strcmp(result_path, base->path) == 0 || strlen(result_path) >= PATH_MAX)
+    {
+        return MATRIX_ERROR_FILE;
+    }
+    TRACE_SCOPE("matrix_power_tiled");
+
+    TiledReport local;
+    TiledReport* stats = report ? report : &local;
+    memset(stats, 0, sizeof(*stats));
+    int64_t start = tiled_now_ns();
+
+    TiledEngine engine;
+    memset(&engine, 0, sizeof(engine));
+    engine.report = stats;
+    engine.slot_bytes = tiled_slot_bytes(base);
+    int error = tiled_plan(options->memory_budget / engine.slot_bytes, base->tiles, &engine.rows, &engine.cols);
+
+    /* Все буферы плиток — один блок в пределах бюджета */
+    size_t accumulators = (size_t)engine.rows * engine.cols;
+    size_t slots = accumulators + 2 * ((size_t)engine.rows + engine.cols) + 1;
+    if (error == MATRIX_SUCCESS)
+    {
+        stats->block_rows = engine.rows;
+        stats->block_cols = engine.cols;
+        stats->memory_used = slots * engine.slot_bytes;
+        engine.arena = (char*)aligned_alloc(TILED_ALIGN, stats->memory_used);
+        engine.write_tickets = (ULL*)calloc(accumulators, sizeof(ULL));
+        if (!engine.arena || !engine.write_tickets) error = MATRIX_ERROR_CREATION;
+    }
+    if (error == MATRIX_SUCCESS)
+    {
+        char* cursor = engine.arena;
+        engine.accumulators = cursor;
+        cursor += accumulators * engine.slot_bytes;
+        for (int index = 0; index < 2; index++)
+        {
+            engine.a[index].tiles = cursor;
+            cursor += (size_t)engine.rows * engine.slot_bytes;
+            engine.b[index].tiles = cursor;
+            cursor += (size_t)engine.cols * engine.slot_bytes;
+        }
+        engine.product = cursor;
+        error = tiled_io_start(&engine.io);
+    }
+    if (error != MATRIX_SUCCESS)
+    {
+        free(engine.arena);
+        free(engine.write_tickets);
+        return error;
+    }
+
+    TiledMatrix* temps[TILED_TEMP_FILES] = {NULL};
+    char paths[TILED_TEMP_FILES][PATH_MAX + 8];
+    for (int index = 0; index < TILED_TEMP_FILES; index++)
+    {
+        snprintf(paths[index], sizeof(paths[index]), "%s.tmp%d", result_path, index);
+    }
+
+    /* Бинарный метод справа налево; acc и power ссылаются на base или временные файлы */
+    const TiledMatrix* power = base;
+    const TiledMatrix* acc = NULL;
+    ULL e = exponent;
+    while (e > 0 && error == MATRIX_SUCCESS)
+    {
+        TiledMatrix* target = NULL;
+        if (e & 1)
+        {
+            if (!acc)
+            {
+                acc = power;
+            }
+            else
+            {
+                error = tiled_temp(base, temps, paths, acc, power, &target);
+                if (error == MATRIX_SUCCESS) error = tiled_multiply(&engine, acc, power, target);
+                acc = target;
+                stats->multiplies++;
+            }
+        }
+        e >>= 1;
+        if (e > 0 && error == MATRIX_SUCCESS)
+        {
+            error = tiled_temp(base, temps, paths, acc, power, &target);
+            if (error == MATRIX_SUCCESS) error = tiled_multiply(&engine, power, power, target);
+            power = target;
+            stats->multiplies++;
+        }
+    }
+    tiled_io_stop(&engine.io);
+
+    /* Результат во временном файле переименовывается; степени 0 и 1 пишутся заново */
+    TiledMatrix* output = NULL;
+    for (int index = 0; index < TILED_TEMP_FILES && error == MATRIX_SUCCESS; index++)
+    {
+        if (temps[index] && temps[index] == acc)
+        {
+            if (rename(paths[index], result_path) != 0)
+            {
+                error = MATRIX_ERROR_FILE;
+                break;
+            }
+            output = temps[index];
+            temps[index] = NULL;
+            memcpy(output->path, result_path, strlen(result_path) + 1);     /* короче пути временного файла */
+        }
+    }
+    if (error == MATRIX_SUCCESS && !output)
+    {
+        error = tiled_matrix_create(result_path, base->size, base->field_size, base->tile, &output);
+        if (error == MATRIX_SUCCESS)
+        {
+            error = acc ? tiled_copy(base, output, engine.accumulators)
+                        : tiled_write_identity(output, engine.accumulators);
+            stats->tiles_written += acc ? (ULL)base->tiles * base->tiles : (ULL)base->tiles;
+            if (error != MATRIX_SUCCESS)
+            {
+                tiled_matrix_close(output);
+                unlink(result_path);
+                output = NULL;
+            }
+        }
+    }
+
+    for (int index = 0; index < TILED_TEMP_FILES; index++)
+    {
+        if (!temps[index]) continue;
+        tiled_matrix_close(temps[index]);
+        unlink(paths[index]);
+    }
+    free(engine.arena);
+    free(engine.write_tickets);
+    stats->total_ns = (ULL)(tiled_now_ns() - start);
+
+    if (error != MATRIX_SUCCESS)
+    {
+        return error;
+    }
+    *result = output;
+    return MATRIX_SUCCESS;
+}
+
+void tiled_report_print(const TiledReport* report, FILE* out)
+{
+    if (!report || !out)
+    {
+        return;
+    }
+    const double mib = 1024.0 * 1024.0;
+    fprintf(out, "Блок C: %d x %d плиток, буферы плиток: %.1f МиБ, умножений: %d\n",
+            report->block_rows, report->block_cols, (double)report->memory_used / mib, report->multiplies);
+    fprintf(out, "Плиток прочитано: %llu (не перечитано на стыках блоков: %llu), записано: %llu\n",
+            report->tiles_read, report->tiles_reused, report->tiles_written);
+    fprintf(out, "Прочитано %.1f МиБ, записано %.1f МиБ\n",
+            (double)report->bytes_read / mib, (double)report->bytes_written / mib);
+    fprintf(out, "Вычисление %.3f мс, ожидание ввода-вывода %.3f мс, всего %.3f мс\n",
+            report->compute_ns / 1e6, report->io_wait_ns / 1e6, report->total_ns / 1e6);
+}
@@ -0,0 +1,400 @@
+#include "../include/matrix_tune.h"
+#include "../include/matrix_kernels.h"
+#include "../include/matrix_fma.h"
+#include "../include/matrix_rns.h"
+#include "../include/matrix_verify.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define TUNE_MAGIC "MPTUNE"
+#define TUNE_SAMPLE_ROWS 64                 /* строк a в замере: время на строку от числа строк не зависит */
+#define TUNE_BATCH_NS 10000000LL            /* замер не короче 10 мс */
+#define TUNE_LONG_NS 100000000LL            /* одиночное умножение дольше 100 мс не повторяется */
+#define TUNE_BATCHES 3
+
+/* Характерный модуль класса поля и характерный размер класса размера */
+static const ULL tune_fields[TUNE_FIELD_CLASSES] = {
+    0, 251, 65521, 8388593, 4294967291ULL, 2305843009213693951ULL, 18446744073709551557ULL
+};
+static const int tune_sizes[TUNE_SIZE_CLASSES] = {16, 48, 128, 256, 512};
+static const int tune_size_bounds[TUNE_SIZE_CLASSES - 1] = {32, 96, 192, 384};
+static const int tune_blocks[] = {32, 64, 128, 256};
+
+/* Текущий профиль: отображение файла (tune_mapping) или черновик во время настройки */
+static const TuneProfile* tune_profile = NULL;
+static void* tune_mapping = NULL;
+
+int tune_field_class(ULL field_size)
+{
+    if (field_size == 0) return 0;
+    if (field_size <= (1ULL << 8)) return 1;
+    if (field_size <= (1ULL << 16)) return 2;
+    if (field_size < FMA_FIELD_LIMIT) return 3;
+    if (field_size <= (1ULL << 32)) return 4;
+    if (field_size <= (1ULL << 62)) return 5;
+    return 6;
+}
+
+int tune_size_class(int rows, int inner, int cols)
+{
+    int n = rows;
+    if (inner < n) n = inner;
+    if (cols < n) n = cols;
+
+    int size_class = 0;
+    while (size_class < TUNE_SIZE_CLASSES - 1 && n >= tune_size_bounds[size_class])
+    {
+        size_class++;
+    }
+    return size_class;
+}
+
+int matrix_tune_format(ULL field_size)
+{
+    const TuneProfile* profile = tune_profile;
+    if (!profile)
+    {
+        return fma_field_preferred(field_size) ? PACKED_DOUBLE : PACKED_INTEGER;
+    }
+    return (profile->formats[tune_field_class(field_size)] == PACKED_DOUBLE && fma_field_supported(field_size))
+               ? PACKED_DOUBLE : PACKED_INTEGER;
+}
+
+TuneChoice matrix_tune_choice(ULL field_size, int rows, int inner, int cols)
+{
+    const TuneProfile* profile = tune_profile;
+    if (profile)
+    {
+        return profile->choices[tune_field_class(field_size)][tune_size_class(rows, inner, cols)];
+    }
+
+    TuneChoice choice = {MULTIPLY_ROWS, 0, 0};
+    if (rns_multiply_preferred(field_size, rows, inner, cols)) choice.variant = MULTIPLY_RNS;
+    return choice;
+}
+
+/* ---------- Файл профиля ---------- */
+
+static const char* tune_path(const char* path)
+{
+    if (path) return path;
+
+    const char* env = getenv(MATRIX_TUNE_ENV);
+    return (env && env[0]) ? env : MATRIX_TUNE_FILE;
+}
+
+static int tune_profile_valid(const TuneProfile* profile)
+{
+    if (memcmp(profile->magic, TUNE_MAGIC, sizeof(TUNE_MAGIC)) != 0 ||
+        profile->version != TUNE_PROFILE_VERSION || profile->size != sizeof(TuneProfile))
+    {
+        return 0;
+    }
+
+    for (int f = 0; f < TUNE_FIELD_CLASSES; f++)
+    {
+        if (profile->formats[f] > PACKED_DOUBLE) return 0;
+        for (int s = 0; s < TUNE_SIZE_CLASSES; s++)
+        {
+            TuneChoice choice = profile->choices[f][s];
+            if (choice.variant > MULTIPLY_RNS) return 0;
+            if (choice.variant == MULTIPLY_BLOCKED && choice.block == 0) return 0;
+        }
+    }
+    return 1;
+}
+
+int matrix_tune_load(const char* path)
+{
+    int fd = open(tune_path(path), O_RDONLY);
+    if (fd < 0)
+    {
+        return TUNE_ERROR_FILE_READ;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        close(fd);
+        return TUNE_ERROR_FILE_READ;
+    }
+    if (st.st_size != (off_t)sizeof(TuneProfile))
+    {
+        close(fd);
+        return TUNE_ERROR_FORMAT;
+    }
+
+    void* mapping = mmap(NULL, sizeof(TuneProfile), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        return TUNE_ERROR_FILE_READ;
+    }
+    if (!tune_profile_valid((const TuneProfile*)mapping))
+    {
+        munmap(mapping, sizeof(TuneProfile));
+        return TUNE_ERROR_FORMAT;
+    }
+
+    matrix_tune_unload();
+    tune_mapping = mapping;
+    tune_profile = (const TuneProfile*)mapping;
+    return TUNE_SUCCESS;
+}
+
+void matrix_tune_unload(void)
+{
+    if (tune_mapping)
+    {
+        munmap(tune_mapping, sizeof(TuneProfile));
+    }
+    tune_mapping = NULL;
+    tune_profile = NULL;
+}
+
+int matrix_tune_active(void)
+{
+    return tune_profile != NULL;
+}
+
+/* Записать профиль во временный файл и переименовать, чтобы читатели не видели половину */
+static int tune_write(const TuneProfile* profile, const char* path)
+{
+    char temp[4096];
+    if (snprintf(temp, sizeof(temp), "%s.tmp", path) >= (int)sizeof(temp))
+    {
+        return TUNE_ERROR_FILE_WRITE;
+    }
+
+    FILE* file = fopen(temp, "wb");
+    if (!file)
+    {
+        return TUNE_ERROR_FILE_WRITE;
+    }
+    size_t written = fwrite(profile, sizeof(TuneProfile), 1, file);
+    if (fclose(file) != 0 || written != 1 || rename(temp, path) != 0)
+    {
+        remove(temp);
+        return TUNE_ERROR_FILE_WRITE;
+    }
+    return TUNE_SUCCESS;
+}
+
+/* ---------- Замеры ---------- */
+
+static int64_t tune_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static int tune_random_packed(int rows, int cols, ULL p, ULL seed, PackedMatrix* result)
+{
+    Matrix* source = NULL;
+    int error = matrix_create_uninit(rows, cols, p, &source);
+    if (error != MATRIX_SUCCESS) return error;
+
+    ULL state = seed;
+    for (int i = 0; i < rows; i++)
+    {
+        for (int j = 0; j < cols; j++)
+        {
+            /* splitmix64 */
+            ULL x = (state += 0x9E3779B97F4A7C15ULL);
+            x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+            x ^= x >> 31;
+            source->data[i][j] = p ? x % p : x;
+        }
+    }
+
+    error = packed_matrix_create(rows, cols, p, result);
+    if (error == MATRIX_SUCCESS) error = packed_matrix_load(source, result);
+    matrix_free(source);
+    return error;
+}
+
+/*
+ * Время одного умножения (64 строки или n) x n на n x n в наносекундах, когда для класса
+ * поля f черновик draft предписывает формат format и вариант choice при любом размере.
+ * [RETURN] TUNE_SUCCESS или TUNE_ERROR_MEASURE
+ */
+static int tune_measure(TuneProfile* draft, int f, int format, TuneChoice choice, int n, double* result)
+{
+    draft->formats[f] = (uint8_t)format;
+    for (int s = 0; s < TUNE_SIZE_CLASSES; s++)
+    {
+        draft->choices[f][s] = choice;
+    }
+
+    ULL p = tune_fields[f];
+    int rows = (n < TUNE_SAMPLE_ROWS) ? n : TUNE_SAMPLE_ROWS;
+    PackedMatrix a = {0}, b = {0}, c = {0};
+    int error = tune_random_packed(rows, n, p, 1, &a);
+    if (error == MATRIX_SUCCESS) error = tune_random_packed(n, n, p, 2, &b);
+    if (error == MATRIX_SUCCESS) error = packed_matrix_create(rows, n, p, &c);
+
+    double best = 0.0;
+    int repeats = 1;
+    for (int batch = 0; batch < TUNE_BATCHES && error == MATRIX_SUCCESS; )
+    {
+        int64_t start = tune_now_ns();
+        for (int r = 0; r < repeats && error == MATRIX_SUCCESS; r++)
+        {
+            error = packed_matrix_multiply(&a, &b, &c);
+        }
+        int64_t elapsed = tune_now_ns() - start;
+
+        /* Короткие замеры удлиняются; первый короткий служит прогревом */
+        if (elapsed < TUNE_BATCH_NS && repeats < (1 << 20))
+        {
+            repeats *= 2;
+            continue;
+        }
+
+        double per_multiply = (double)elapsed / repeats;
+        if (batch == 0 || per_multiply < best) best = per_multiply;
+        batch++;
+        if (repeats == 1 && elapsed > TUNE_LONG_NS) break;
+    }
+
+    packed_matrix_free(&a);
+    packed_matrix_free(&b);
+    packed_matrix_free(&c);
+    if (error != MATRIX_SUCCESS) return TUNE_ERROR_MEASURE;
+
+    *result = best;
+    return TUNE_SUCCESS;
+}
+
+static void tune_choice_name(int format, TuneChoice choice, char* buffer, size_t size)
+{
+    if (format == PACKED_DOUBLE) snprintf(buffer, size, "fma");
+    else if (choice.variant == MULTIPLY_BLOCKED) snprintf(buffer, size, "blk%d", choice.block);
+    else if (choice.variant == MULTIPLY_RNS) snprintf(buffer, size, "rns");
+    else snprintf(buffer, size, "rows");
+}
+
+/*
+ * Настроить класс поля f: лучший целочисленный вариант для каждого класса размера,
+ * затем формат double против целых по сумме времён на всех размерах.
+ */
+static int tune_field(TuneProfile* draft, int f, FILE* log)
+{
+    ULL p = tune_fields[f];
+    TuneChoice best[TUNE_SIZE_CLASSES];
+    double best_time[TUNE_SIZE_CLASSES];
+    double rows_time[TUNE_SIZE_CLASSES];
+    double fma_time[TUNE_SIZE_CLASSES];
+    double integer_total = 0.0, fma_total = 0.0;
+    int try_fma = fma_field_supported(p);
+    int try_rns = matrix_element_width(p) == (int)sizeof(ULL) && p != 0;
+
+    for (int s = 0; s < TUNE_SIZE_CLASSES; s++)
+    {
+        int n = tune_sizes[s];
+        TuneChoice candidates[2 + sizeof(tune_blocks) / sizeof(tune_blocks[0])];
+        int count = 0;
+        candidates[count++] = (TuneChoice){MULTIPLY_ROWS, 0, 0};
+        for (size_t k = 0; k < sizeof(tune_blocks) / sizeof(tune_blocks[0]); k++)
+        {
+            if (tune_blocks[k] < n) candidates[count++] = (TuneChoice){MULTIPLY_BLOCKED, 0, (uint16_t)tune_blocks[k]};
+        }
+        if (try_rns) candidates[count++] = (TuneChoice){MULTIPLY_RNS, 0, 0};
+
+        for (int k = 0; k < count; k++)
+        {
+            double time;
+            int error = tune_measure(draft, f, PACKED_INTEGER, candidates[k], n, &time);
+            if (error != TUNE_SUCCESS) return error;
+
+            if (k == 0) rows_time[s] = time;
+            if (k == 0 || time < best_time[s])
+            {
+                best[s] = candidates[k];
+                best_time[s] = time;
+            }
+        }
+        integer_total += best_time[s];
+
+        if (try_fma)
+        {
+            int error = tune_measure(draft, f, PACKED_DOUBLE, best[s], n, &fma_time[s]);
+            if (error != TUNE_SUCCESS) return error;
+            fma_total += fma_time[s];
+        }
+    }
+
+    int format = (try_fma && fma_total < integer_total) ? PACKED_DOUBLE : PACKED_INTEGER;
+    draft->formats[f] = (uint8_t)format;
+    for (int s = 0; s < TUNE_SIZE_CLASSES; s++)
+    {
+        draft->choices[f][s] = best[s];
+    }
+
+    if (log)
+    {
+        fprintf(log, "%22llu", p);
+        for (int s = 0; s < TUNE_SIZE_CLASSES; s++)
+        {
+            char name[16];
+            tune_choice_name(format, best[s], name, sizeof(name));
+            double time = (format == PACKED_DOUBLE) ? fma_time[s] : best_time[s];
+            fprintf(log, " %7s x%-4.2f", name, rows_time[s] / time);
+        }
+        fprintf(log, "\n");
+        fflush(log);
+    }
+    return TUNE_SUCCESS;
+}
+
+int matrix_tune_run(const char* path, FILE* log)
+{
+    /* Черновик начинается с правил по умолчанию: поля настраиваются по возрастанию,
+       и каналы RNS больших полей уже считаются по выбранному для малых полей ядру */
+    TuneProfile draft;
+    memset(&draft, 0, sizeof(draft));
+    memcpy(draft.magic, TUNE_MAGIC, sizeof(TUNE_MAGIC));
+    draft.version = TUNE_PROFILE_VERSION;
+    draft.size = sizeof(TuneProfile);
+    for (int f = 0; f < TUNE_FIELD_CLASSES; f++)
+    {
+        draft.formats[f] = (uint8_t)(fma_field_preferred(tune_fields[f]) ? PACKED_DOUBLE : PACKED_INTEGER);
+        for (int s = 0; s < TUNE_SIZE_CLASSES; s++)
+        {
+            int n = tune_sizes[s];
+            draft.choices[f][s].variant = rns_multiply_preferred(tune_fields[f], n, n, n) ? MULTIPLY_RNS : MULTIPLY_ROWS;
+        }
+    }
+
+    if (log)
+    {
+        fprintf(log, "%22s", "field_size");
+        for (int s = 0; s < TUNE_SIZE_CLASSES; s++)
+        {
+            fprintf(log, " %7d %-5s", tune_sizes[s], "");
+        }
+        fprintf(log, "\n");
+    }
+
+    const TuneProfile* previous = tune_profile;
+    MatrixVerifier* verifier = matrix_verifier_bind(NULL);
+    tune_profile = &draft;
+
+    int error = TUNE_SUCCESS;
+    for (int f = 0; f < TUNE_FIELD_CLASSES && error == TUNE_SUCCESS; f++)
+    {
+        error = tune_field(&draft, f, log);
+    }
+
+    tune_profile = previous;
+    matrix_verifier_bind(verifier);
+
+    path = tune_path(path);
+    if (error == TUNE_SUCCESS) error = tune_write(&draft, path);
+    if (error == TUNE_SUCCESS) error = matrix_tune_load(path);
+    return error;
+}
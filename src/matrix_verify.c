@@ -0,0 +1,297 @@
+#include "../include/matrix_verify.h"
+#include "../include/matrix_kernels.h"
+#include "../include/gf2.h"
+
+#include <stdatomic.h>
+
+typedef unsigned __int128 U128;
+
+struct MatrixVerifier
+{
+    int rounds;
+    ULL seed;
+    atomic_size_t checks;
+    atomic_size_t rounds_done;
+    atomic_size_t failures;
+};
+
+static _Thread_local MatrixVerifier* current_verifier = NULL;
+
+/* Генератор splitmix64: значение зависит только от аргумента, поэтому потокобезопасен */
+static inline ULL verify_mix(ULL x)
+{
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+int matrix_verifier_create(int rounds, ULL seed, MatrixVerifier** result)
+{
+    if (!result)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+    if (rounds < 1)
+    {
+        return MATRIX_ERROR_INVALID_NUMBER;
+    }
+
+    MatrixVerifier* verifier = (MatrixVerifier*)calloc(1, sizeof(MatrixVerifier));
+    if (!verifier)
+    {
+        return MATRIX_ERROR_CREATION;
+    }
+    verifier->rounds = rounds;
+    verifier->seed = seed;
+    atomic_init(&verifier->checks, 0);
+    atomic_init(&verifier->rounds_done, 0);
+    atomic_init(&verifier->failures, 0);
+
+    *result = verifier;
+    return MATRIX_SUCCESS;
+}
+
+int matrix_verifier_destroy(MatrixVerifier* verifier)
+{
+    if (current_verifier == verifier)
+    {
+        current_verifier = NULL;
+    }
+    free(verifier);
+    return MATRIX_SUCCESS;
+}
+
+MatrixVerifier* matrix_verifier_bind(MatrixVerifier* verifier)
+{
+    MatrixVerifier* previous = current_verifier;
+    current_verifier = verifier;
+    return previous;
+}
+
+MatrixVerifier* matrix_verifier_current(void)
+{
+    return current_verifier;
+}
+
+int matrix_verifier_stats(const MatrixVerifier* verifier, MatrixVerifierStats* stats)
+{
+    if (!verifier || !stats)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+
+    stats->checks = atomic_load(&verifier->checks);
+    stats->rounds = atomic_load(&verifier->rounds_done);
+    stats->failures = atomic_load(&verifier->failures);
+    return MATRIX_SUCCESS;
+}
+
+int matrix_verifier_add(MatrixVerifier* verifier, const MatrixVerifierStats* stats)
+{
+    if (!verifier || !stats)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+
+    atomic_fetch_add(&verifier->checks, stats->checks);
+    atomic_fetch_add(&verifier->rounds_done, stats->rounds);
+    atomic_fetch_add(&verifier->failures, stats->failures);
+    return MATRIX_SUCCESS;
+}
+
+/* Начальное значение генератора для очередной проверки */
+static ULL verify_begin(MatrixVerifier* verifier)
+{
+    size_t index = atomic_fetch_add(&verifier->checks, 1);
+    return verify_mix(verifier->seed ^ verify_mix((ULL)index));
+}
+
+static int verify_finish(MatrixVerifier* verifier, int rounds, int passed)
+{
+    atomic_fetch_add(&verifier->rounds_done, (size_t)rounds);
+    if (passed) return MATRIX_SUCCESS;
+
+    atomic_fetch_add(&verifier->failures, 1);
+    return MATRIX_ERROR_VERIFICATION;
+}
+
+/* ---------- Упакованные матрицы ---------- */
+
+/* Строка row упакованной матрицы в элементах ULL */
+static void packed_row(const struct PackedMatrix* m, int row, ULL* out)
+{
+    size_t offset = (size_t)row * m->cols;
+    if (m->format == PACKED_DOUBLE)
+    {
+        const double* src = (const double*)m->data + offset;
+        for (int j = 0; j < m->cols; j++) out[j] = (ULL)src[j];
+        return;
+    }
+
+    switch (m->width)
+    {
+        case 1:
+        {
+            const uint8_t* src = (const uint8_t*)m->data + offset;
+            for (int j = 0; j < m->cols; j++) out[j] = src[j];
+            break;
+        }
+        case 2:
+        {
+            const uint16_t* src = (const uint16_t*)m->data + offset;
+            for (int j = 0; j < m->cols; j++) out[j] = src[j];
+            break;
+        }
+        case 4:
+        {
+            const uint32_t* src = (const uint32_t*)m->data + offset;
+            for (int j = 0; j < m->cols; j++) out[j] = src[j];
+            break;
+        }
+        default:
+            memcpy(out, (const ULL*)m->data + offset, (size_t)m->cols * sizeof(ULL));
+            break;
+    }
+}
+
+/* Σ row[k] v[k] по модулю p (p == 0 — по модулю 2^64) с отложенным приведением */
+static ULL verify_dot(const ULL* row, const ULL* v, int count, ULL p)
+{
+    if (p == 0)
+    {
+        ULL sum = 0;
+        for (int k = 0; k < count; k++) sum += row[k] * v[k];
+        return sum;
+    }
+
+    U128 max_product = (U128)(p - 1) * (p - 1);
+    U128 limit = max_product ? (~(U128)0 - p) / max_product : ~(U128)0;
+    U128 acc = 0, used = 0;
+    for (int k = 0; k < count; k++)
+    {
+        if (used == limit)
+        {
+            acc %= p;
+            used = 0;
+        }
+        acc += (U128)(row[k] % p) * (v[k] % p);
+        used++;
+    }
+    return (ULL)(acc % p);
+}
+
+int matrix_verify_packed(MatrixVerifier* verifier, const struct PackedMatrix* a, const struct PackedMatrix* b,
+                         const struct PackedMatrix* c)
+{
+    if (!verifier || !a || !b || !c)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+
+    ULL p = a->field_size;
+    int width = a->cols;
+    if (b->cols > width) width = b->cols;
+    if (c->cols > width) width = c->cols;
+    ULL* r = (ULL*)malloc((size_t)b->cols * sizeof(ULL));
+    ULL* y = (ULL*)malloc((size_t)b->rows * sizeof(ULL));
+    ULL* row = (ULL*)malloc((size_t)width * sizeof(ULL));
+    if (!r || !y || !row)
+    {
+        free(r);
+        free(y);
+        free(row);
+        return MATRIX_ERROR_CREATION;
+    }
+
+    /* A(Br) == Cr для rounds случайных векторов r */
+    ULL seed = verify_begin(verifier);
+    int passed = 1;
+    for (int round = 0; round < verifier->rounds && passed; round++)
+    {
+        for (int k = 0; k < b->cols; k++)
+        {
+            ULL value = verify_mix(seed + (ULL)round * b->cols + k);
+            r[k] = p ? value % p : value;
+        }
+        for (int i = 0; i < b->rows; i++)
+        {
+            packed_row(b, i, row);
+            y[i] = verify_dot(row, r, b->cols, p);
+        }
+        for (int i = 0; i < a->rows && passed; i++)
+        {
+            packed_row(a, i, row);
+            ULL expected = verify_dot(row, y, a->cols, p);
+            packed_row(c, i, row);
+            passed = (verify_dot(row, r, c->cols, p) == expected);
+        }
+    }
+
+    free(r);
+    free(y);
+    free(row);
+    return verify_finish(verifier, verifier->rounds, passed);
+}
+
+/* ---------- GF(2) ---------- */
+
+/* Биты (M v)_i = чётность popcount(строка i & v) */
+static void gf2_apply(const struct Gf2Matrix* m, const ULL* v, ULL* out)
+{
+    memset(out, 0, (size_t)((m->rows + 63) / 64) * sizeof(ULL));
+    for (int i = 0; i < m->rows; i++)
+    {
+        const ULL* words = m->words + (size_t)i * m->words_per_row;
+        int parity = 0;
+        for (int w = 0; w < m->words_per_row; w++)
+        {
+            parity ^= __builtin_parityll(words[w] & v[w]);
+        }
+        out[i / 64] |= (ULL)parity << (i % 64);
+    }
+}
+
+int matrix_verify_gf2(MatrixVerifier* verifier, const struct Gf2Matrix* a, const struct Gf2Matrix* b,
+                      const struct Gf2Matrix* c)
+{
+    if (!verifier || !a || !b || !c)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+
+    ULL* r = (ULL*)malloc((size_t)b->words_per_row * sizeof(ULL));
+    ULL* y = (ULL*)malloc((size_t)((b->rows + 63) / 64) * sizeof(ULL));
+    ULL* z = (ULL*)malloc((size_t)((a->rows + 63) / 64) * sizeof(ULL));
+    ULL* w = (ULL*)malloc((size_t)((c->rows + 63) / 64) * sizeof(ULL));
+    if (!r || !y || !z || !w)
+    {
+        free(r);
+        free(y);
+        free(z);
+        free(w);
+        return MATRIX_ERROR_CREATION;
+    }
+
+    ULL seed = verify_begin(verifier);
+    int passed = 1;
+    for (int round = 0; round < verifier->rounds && passed; round++)
+    {
+        for (int k = 0; k < b->words_per_row; k++)
+        {
+            r[k] = verify_mix(seed + (ULL)round * b->words_per_row + k);
+        }
+        if (b->cols % 64) r[b->words_per_row - 1] &= (1ULL << (b->cols % 64)) - 1;
+
+        gf2_apply(b, r, y);
+        gf2_apply(a, y, z);
+        gf2_apply(c, r, w);
+        passed = (memcmp(z, w, (size_t)((a->rows + 63) / 64) * sizeof(ULL)) == 0);
+    }
+
+    free(r);
+    free(y);
+    free(z);
+    free(w);
+    return verify_finish(verifier, verifier->rounds, passed);
+}
@@ -0,0 +1,554 @@
+#include "../include/matrix_view.h"
+#include "../include/matrix_kernels.h"
+#include "../include/modular.h"
+#include "../include/trace.h"
+#include "../include/matrix_sched.h"
+
+#define VIEW_TILE 64                             /* сторона плитки для операндов разной ориентации */
+#define ELEMENTWISE_SHOUP32_LIMIT (1ULL << 32)   /* до этого модуля метод Шоупа в 64-битных словах */
+#define ELEMENTWISE_TASK_ELEMENTS (1 << 16)      /* элементов в полосе строк одной задачи */
+
+int matrix_view_of(const Matrix* matrix, MatrixView* result)
+{
+    if (!matrix || !result)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+
+    result->base = matrix->data[0];
+    result->rows = matrix->rows;
+    result->cols = matrix->cols;
+    result->row_stride = matrix->cols;
+    result->transposed = 0;
+    result->field_size = matrix->field_size;
+    return MATRIX_SUCCESS;
+}
+
+int matrix_view_submatrix(const MatrixView* view, int start_row, int end_row,
+                          int start_col, int end_col, MatrixView* result)
+{
+    if (!view || !result)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+    if (start_row < 0 || end_row >= view->rows || start_col < 0 || end_col >= view->cols ||
+        start_row > end_row || start_col > end_col)
+    {
+        return MATRIX_ERROR_DIMENSION;
+    }
+
+    MatrixView sub = *view;
+    sub.base = matrix_view_at(view, start_row, start_col);
+    sub.rows = end_row - start_row + 1;
+    sub.cols = end_col - start_col + 1;
+    *result = sub;
+    return MATRIX_SUCCESS;
+}
+
+int matrix_submatrix_view(const Matrix* a, int start_row, int end_row,
+                          int start_col, int end_col, MatrixView* result)
+{
+    MatrixView whole;
+    int error = matrix_view_of(a, &whole);
+    if (error != MATRIX_SUCCESS) return error;
+
+    return matrix_view_submatrix(&whole, start_row, end_row, start_col, end_col, result);
+}
+
+int matrix_view_transpose(const MatrixView* view, MatrixView* result)
+{
+    if (!view || !result)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+
+    MatrixView transposed = *view;
+    transposed.rows = view->cols;
+    transposed.cols = view->rows;
+    transposed.transposed = !view->transposed;
+    *result = transposed;
+    return MATRIX_SUCCESS;
+}
+
+int matrix_transpose_view(const Matrix* a, MatrixView* result)
+{
+    MatrixView whole;
+    int error = matrix_view_of(a, &whole);
+    if (error != MATRIX_SUCCESS) return error;
+
+    return matrix_view_transpose(&whole, result);
+}
+
+/* ---------- Поэлементные ядра: приведение условным вычитанием вместо деления ---------- */
+
+/*
+ * Множитель w с предвычислением Шоупа. При p <= 2^32 частное оценивается через
+ * floor(w * 2^32 / p) в 64-битной арифметике (векторизуется), иначе через modular_shoup.
+ */
+typedef struct ScalarFactor
+{
+    ULL w;
+    ULL shoup;
+} ScalarFactor;
+
+static ScalarFactor scalar_factor(ULL w, ULL p)
+{
+    ScalarFactor factor = {0, 0};
+    if (p == 0)
+    {
+        factor.w = w;
+        return factor;
+    }
+
+    factor.w = w % p;
+    if (p <= ELEMENTWISE_SHOUP32_LIMIT) factor.shoup = (factor.w << 32) / p;
+    else if (p < (1ULL << 63)) factor.shoup = modular_shoup(factor.w, p);
+    return factor;
+}
+
+static inline ULL scale32(ULL x, ScalarFactor f, ULL p)
+{
+    ULL q = (x * f.shoup) >> 32;
+    ULL r = x * f.w - q * p;
+    return (r >= p) ? r - p : r;
+}
+
+static inline ULL scale64(ULL x, ScalarFactor f, ULL p)
+{
+    return (p < (1ULL << 63)) ? modular_mul_shoup(x, f.w, f.shoup, p) : modular_mul(x, f.w, p);
+}
+
+/* Сумма элементов из [0, p): при p <= 2^63 она меньше 2^64 и хватает одного сравнения */
+static inline ULL add_reduce(ULL x, ULL y, ULL p)
+{
+    ULL sum = x + y;
+    if (p <= (1ULL << 63)) return (sum >= p) ? sum - p : sum;
+    return (sum < x || sum >= p) ? sum - p : sum;
+}
+
+enum ELEMENTWISE_KIND
+{
+    ELEMENTWISE_ADD = 0,
+    ELEMENTWISE_SUBTRACT,
+    ELEMENTWISE_SCALE,
+    ELEMENTWISE_AXPBY
+};
+
+/* Поэлементная операция c = op(a, b) с предвычисленными множителями */
+typedef struct ElementwiseOp
+{
+    int kind;                       /* ELEMENTWISE_KIND */
+    ScalarFactor alpha;             /* множитель a (SCALE, AXPBY) */
+    ScalarFactor beta;              /* множитель b (AXPBY) */
+    ULL p;                          /* модуль (0 — по модулю 2^64) */
+} ElementwiseOp;
+
+/*
+ * count элементов с шагами as, bs, cs. Функция встраивается в elementwise_span, и при
+ * единичных шагах компилятор векторизует цикл.
+ */
+static inline void span_kernel(const ElementwiseOp* op, const ULL* a, ptrdiff_t as, const ULL* b, ptrdiff_t bs,
+                               ULL* c, ptrdiff_t cs, int count)
+{
+    const ULL p = op->p;
+    switch (op->kind)
+    {
+        case ELEMENTWISE_ADD:
+            if (p == 0)
+            {
+                for (int j = 0; j < count; j++) c[j * cs] = a[j * as] + b[j * bs];
+            }
+            else
+            {
+                for (int j = 0; j < count; j++) c[j * cs] = add_reduce(a[j * as], b[j * bs], p);
+            }
+            break;
+
+        case ELEMENTWISE_SUBTRACT:
+            /* при p == 0 — вычитание по модулю 2^64 */
+            for (int j = 0; j < count; j++)
+            {
+                ULL x = a[j * as], y = b[j * bs];
+                c[j * cs] = (x >= y) ? x - y : x - y + p;
+            }
+            break;
+
+        case ELEMENTWISE_SCALE:
+            if (p == 0)
+            {
+                for (int j = 0; j < count; j++) c[j * cs] = a[j * as] * op->alpha.w;
+            }
+            else if (p <= ELEMENTWISE_SHOUP32_LIMIT)
+            {
+                for (int j = 0; j < count; j++) c[j * cs] = scale32(a[j * as], op->alpha, p);
+            }
+            else
+            {
+                for (int j = 0; j < count; j++) c[j * cs] = scale64(a[j * as], op->alpha, p);
+            }
+            break;
+
+        default:
+            if (p == 0)
+            {
+                for (int j = 0; j < count; j++) c[j * cs] = op->alpha.w * a[j * as] + op->beta.w * b[j * bs];
+            }
+            else if (p <= ELEMENTWISE_SHOUP32_LIMIT)
+            {
+                for (int j = 0; j < count; j++)
+                {
+                    c[j * cs] = add_reduce(scale32(a[j * as], op->alpha, p), scale32(b[j * bs], op->beta, p), p);
+                }
+            }
+            else
+            {
+                for (int j = 0; j < count; j++)
+                {
+                    c[j * cs] = add_reduce(scale64(a[j * as], op->alpha, p), scale64(b[j * bs], op->beta, p), p);
+                }
+            }
+            break;
+    }
+}
+
+/* Все ли count элементов с шагом step меньше p (проход без ветвлений, векторизуется) */
+static inline int span_reduced(const ULL* x, ptrdiff_t step, int count, ULL p)
+{
+    ULL above = 0;
+    for (int j = 0; j < count; j++) above |= (ULL)(x[j * step] >= p);
+    return above == 0;
+}
+
+/*
+ * Ядра рассчитаны на элементы из [0, p), а Matrix может хранить и неприведённые.
+ * Такой отрезок сначала приводится по кускам во временные буферы на стеке.
+ */
+static void elementwise_span_unreduced(const ElementwiseOp* op, const ULL* a, ptrdiff_t as, const ULL* b,
+                                       ptrdiff_t bs, ULL* c, ptrdiff_t cs, int count)
+{
+    ULL ra[VIEW_TILE], rb[VIEW_TILE];
+    for (int j0 = 0; j0 < count; j0 += VIEW_TILE)
+    {
+        int length = (count - j0 < VIEW_TILE) ? count - j0 : VIEW_TILE;
+        for (int j = 0; j < length; j++)
+        {
+            ra[j] = a[(j0 + j) * as] % op->p;
+            rb[j] = b[(j0 + j) * bs] % op->p;
+        }
+        span_kernel(op, ra, 1, rb, 1, c + j0 * cs, cs, length);
+    }
+}
+
+static void elementwise_span(const ElementwiseOp* op, const ULL* a, ptrdiff_t as, const ULL* b, ptrdiff_t bs,
+                             ULL* c, ptrdiff_t cs, int count)
+{
+    if (op->p != 0 && !(span_reduced(a, as, count, op->p) && span_reduced(b, bs, count, op->p)))
+    {
+        elementwise_span_unreduced(op, a, as, b, bs, c, cs, count);
+    }
+    else if (as == 1 && bs == 1 && cs == 1)
+    {
+        span_kernel(op, a, 1, b, 1, c, 1, count);
+    }
+    else
+    {
+        span_kernel(op, a, as, b, bs, c, cs, count);
+    }
+}
+
+/* Шаг между соседними элементами строки представления */
+static inline ptrdiff_t view_col_stride(const MatrixView* view)
+{
+    return view->transposed ? view->row_stride : 1;
+}
+
+typedef struct ElementwiseRows
+{
+    const ElementwiseOp* op;
+    MatrixView va, vb, vc;
+    ptrdiff_t as, bs, cs;                   /* шаги вдоль строки каждого операнда */
+} ElementwiseRows;
+
+/* Строки [begin, end) операндов одной ориентации: непрерывные отрезки */
+static void elementwise_rows(void* context, int begin, int end)
+{
+    const ElementwiseRows* rows = (const ElementwiseRows*)context;
+    for (int i = begin; i < end; i++)
+    {
+        elementwise_span(rows->op, matrix_view_at(&rows->va, i, 0), 1, matrix_view_at(&rows->vb, i, 0), 1,
+                         matrix_view_at(&rows->vc, i, 0), 1, rows->va.cols);
+    }
+}
+
+/* Разная ориентация: строки плиток [begin, end), плитки VIEW_TILE x VIEW_TILE, внутри — отрезки строк */
+static void elementwise_tile_rows(void* context, int begin, int end)
+{
+    const ElementwiseRows* rows = (const ElementwiseRows*)context;
+    const MatrixView* va = &rows->va;
+    for (int i0 = begin * VIEW_TILE; i0 < end * VIEW_TILE && i0 < va->rows; i0 += VIEW_TILE)
+    {
+        int i1 = (va->rows - i0 < VIEW_TILE) ? va->rows : i0 + VIEW_TILE;
+        for (int j0 = 0; j0 < va->cols; j0 += VIEW_TILE)
+        {
+            int length = (va->cols - j0 < VIEW_TILE) ? va->cols - j0 : VIEW_TILE;
+            for (int i = i0; i < i1; i++)
+            {
+                elementwise_span(rows->op, matrix_view_at(va, i, j0), rows->as, matrix_view_at(&rows->vb, i, j0),
+                                 rows->bs, matrix_view_at(&rows->vc, i, j0), rows->cs, length);
+            }
+        }
+    }
+}
+
+/* Наименьший и наибольший адрес хранения, которого касается представление */
+static void view_span(const MatrixView* view, const ULL** low, const ULL** high)
+{
+    *low = view->base;
+    *high = matrix_view_at(view, view->rows - 1, view->cols - 1);
+}
+
+/*
+ * Хранение operand перекрывается с result, но элемент (i, j) лежит по другому адресу
+ * (другая ориентация, шаг или сдвиг). Совпадающее представление — не конфликт:
+ * каждый элемент читается перед записью по тому же адресу.
+ */
+static int view_conflicts(const MatrixView* operand, const MatrixView* result)
+{
+    if (operand->base == result->base && operand->row_stride == result->row_stride &&
+        operand->transposed == result->transposed)
+    {
+        return 0;
+    }
+    const ULL *operand_low, *operand_high, *result_low, *result_high;
+    view_span(operand, &operand_low, &operand_high);
+    view_span(result, &result_low, &result_high);
+    return operand_low <= result_high && result_low <= operand_high;
+}
+
+/*
+ * Применить op ко всем элементам; b == NULL для операций с одним операндом.
+ * Если все операнды транспонированы, операция выполняется над исходными
+ * (поэлементные операции перестановочны с транспонированием).
+ */
+static int elementwise_apply(const ElementwiseOp* op, const MatrixView* a, const MatrixView* b,
+                             const MatrixView* result)
+{
+    if (!a || !result)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+    if (a->rows < 1 || a->cols < 1)
+    {
+        return MATRIX_ERROR_INVALID_SIZE;
+    }
+    if ((b && (a->rows != b->rows || a->cols != b->cols)) ||
+        a->rows != result->rows || a->cols != result->cols)
+    {
+        return MATRIX_ERROR_DIMENSION;
+    }
+    if ((b && a->field_size != b->field_size) || a->field_size != result->field_size)
+    {
+        return MATRIX_ERROR_INVALID_FIELD;
+    }
+
+    /* Операнд, перекрывающийся с result иначе, чем поэлементно, читается из копии:
+       полосы пишут result параллельно и затёрли бы ещё не прочитанные элементы */
+    Matrix* copy_a = NULL;
+    Matrix* copy_b = NULL;
+    MatrixView view_a = {0};
+    MatrixView view_b = {0};
+    int error = MATRIX_SUCCESS;
+    if (view_conflicts(a, result))
+    {
+        error = matrix_materialize(a, &copy_a);
+        if (error == MATRIX_SUCCESS) matrix_view_of(copy_a, &view_a);
+    }
+    if (error == MATRIX_SUCCESS && b && view_conflicts(b, result))
+    {
+        if (copy_a && b->base == a->base && b->row_stride == a->row_stride && b->transposed == a->transposed)
+        {
+            view_b = view_a;
+        }
+        else
+        {
+            error = matrix_materialize(b, &copy_b);
+            if (error == MATRIX_SUCCESS) matrix_view_of(copy_b, &view_b);
+        }
+        if (error == MATRIX_SUCCESS) b = &view_b;
+    }
+    if (copy_a) a = &view_a;
+    if (error != MATRIX_SUCCESS)
+    {
+        matrix_free(copy_a);
+        return error;
+    }
+
+    MatrixView va = *a, vb = b ? *b : *a, vc = *result;
+    if (va.transposed && vb.transposed && vc.transposed)
+    {
+        matrix_view_transpose(&va, &va);
+        matrix_view_transpose(&vb, &vb);
+        matrix_view_transpose(&vc, &vc);
+    }
+
+    /* Полосы строк считаются задачами планировщика (matrix_sched.h); малые матрицы — одной полосой */
+    ElementwiseRows rows = {op, va, vb, vc, view_col_stride(&va), view_col_stride(&vb), view_col_stride(&vc)};
+    int band = ELEMENTWISE_TASK_ELEMENTS / va.cols;
+    if (!va.transposed && !vb.transposed && !vc.transposed)
+    {
+        sched_parallel_for(0, va.rows, band, elementwise_rows, &rows);
+    }
+    else
+    {
+        int tiles = (va.rows + VIEW_TILE - 1) / VIEW_TILE;
+        sched_parallel_for(0, tiles, band / VIEW_TILE, elementwise_tile_rows, &rows);
+    }
+    matrix_free(copy_a);
+    matrix_free(copy_b);
+    return MATRIX_SUCCESS;
+}
+
+int matrix_view_sum(const MatrixView* a, const MatrixView* b, const MatrixView* result)
+{
+    if (!a || !b)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+
+    ElementwiseOp op = {ELEMENTWISE_ADD, {0, 0}, {0, 0}, a->field_size};
+    return elementwise_apply(&op, a, b, result);
+}
+
+int matrix_view_subtract(const MatrixView* a, const MatrixView* b, const MatrixView* result)
+{
+    if (!a || !b)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+
+    ElementwiseOp op = {ELEMENTWISE_SUBTRACT, {0, 0}, {0, 0}, a->field_size};
+    return elementwise_apply(&op, a, b, result);
+}
+
+int matrix_view_scalar_multiply(const MatrixView* a, ULL scalar, const MatrixView* result)
+{
+    if (!a)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+
+    ElementwiseOp op = {ELEMENTWISE_SCALE, scalar_factor(scalar, a->field_size), {0, 0}, a->field_size};
+    return elementwise_apply(&op, a, NULL, result);
+}
+
+int matrix_view_axpby(ULL alpha, const MatrixView* a, ULL beta, const MatrixView* b, const MatrixView* result)
+{
+    if (!a || !b)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+
+    ElementwiseOp op = {ELEMENTWISE_AXPBY, scalar_factor(alpha, a->field_size),
+                        scalar_factor(beta, a->field_size), a->field_size};
+    return elementwise_apply(&op, a, b, result);
+}
+
+int matrix_view_copy(const MatrixView* src, const MatrixView* dst)
+{
+    if (!src || !dst)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+    if (src->rows != dst->rows || src->cols != dst->cols)
+    {
+        return MATRIX_ERROR_DIMENSION;
+    }
+
+    MatrixView s = *src, d = *dst;
+    if (s.transposed && d.transposed)
+    {
+        matrix_view_transpose(&s, &s);
+        matrix_view_transpose(&d, &d);
+    }
+
+    if (!s.transposed && !d.transposed)
+    {
+        for (int i = 0; i < s.rows; i++)
+        {
+            memmove(matrix_view_at(&d, i, 0), matrix_view_at(&s, i, 0), (size_t)s.cols * sizeof(ULL));
+        }
+        return MATRIX_SUCCESS;
+    }
+
+    /* Ориентации различаются: хранение dst — транспонированное хранение src */
+    if (s.base == d.base && s.row_stride == d.row_stride && s.rows == s.cols)
+    {
+        transpose_square_in_place(s.base, s.row_stride, s.rows);
+    }
+    else if (!s.transposed)
+    {
+        transpose_block(s.base, s.row_stride, d.base, d.row_stride, s.rows, s.cols);
+    }
+    else
+    {
+        transpose_block(s.base, s.row_stride, d.base, d.row_stride, s.cols, s.rows);
+    }
+    return MATRIX_SUCCESS;
+}
+
+int matrix_materialize(const MatrixView* view, Matrix** result)
+{
+    if (!view || !result)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+
+    Matrix* matrix;
+    int error = matrix_create_uninit(view->rows, view->cols, view->field_size, &matrix);
+    if (error != MATRIX_SUCCESS) return error;
+
+    MatrixView target;
+    matrix_view_of(matrix, &target);
+    error = matrix_view_copy(view, &target);
+    if (error != MATRIX_SUCCESS)
+    {
+        matrix_free(matrix);
+        return error;
+    }
+
+    *result = matrix;
+    return MATRIX_SUCCESS;
+}
+
+int matrix_view_multiply(const MatrixView* a, const MatrixView* b, const MatrixView* c)
+{
+    TRACE_SCOPE("view_multiply");
+
+    if (!a || !b || !c)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+    if (a->cols != b->rows || c->rows != a->rows || c->cols != b->cols)
+    {
+        return MATRIX_ERROR_DIMENSION;
+    }
+    if (a->field_size != b->field_size || a->field_size != c->field_size)
+    {
+        return MATRIX_ERROR_INVALID_FIELD;
+    }
+
+    ULL p = a->field_size;
+    PackedMatrix pa = {0}, pb = {0}, pc = {0};
+    int error = packed_matrix_create(a->rows, a->cols, p, &pa);
+    if (error == MATRIX_SUCCESS) error = packed_matrix_create(b->rows, b->cols, p, &pb);
+    if (error == MATRIX_SUCCESS) error = packed_matrix_create(c->rows, c->cols, p, &pc);
+    if (error == MATRIX_SUCCESS) error = packed_matrix_load_view(a, &pa);
+    if (error == MATRIX_SUCCESS) error = packed_matrix_load_view(b, &pb);
+    if (error == MATRIX_SUCCESS) error = packed_matrix_multiply(&pa, &pb, &pc);
+    if (error == MATRIX_SUCCESS) error = packed_matrix_store_view(&pc, c);
+
+    packed_matrix_free(&pa);
+    packed_matrix_free(&pb);
+    packed_matrix_free(&pc);
+    return error;
+}
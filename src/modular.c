@@ -0,0 +1,276 @@
+#include "../include/modular.h"
+
+#include <pthread.h>
+
+ULL modular_mul(ULL a, ULL b, ULL mod)
+{
+    return (ULL)(((unsigned __int128)a * b) % mod);
+}
+
+ULL modular_pow(ULL base, ULL exponent, ULL mod)
+{
+    ULL result = 1 % mod;
+    base %= mod;
+    while (exponent > 0)
+    {
+        if (exponent & 1)
+        {
+            result = modular_mul(result, base, mod);
+        }
+        base = modular_mul(base, base, mod);
+        exponent >>= 1;
+    }
+    return result;
+}
+
+ULL modular_inverse(ULL a, ULL mod)
+{
+    long long old_r = (long long)(a % mod), r = (long long)mod;
+    __int128 old_s = 1, s = 0;
+
+    if (mod > (ULL)INT64_MAX)
+    {
+        /* Для модулей больше 2^63 — через 128-битные остатки */
+        __int128 r0 = (__int128)(a % mod), r1 = (__int128)mod;
+        __int128 s0 = 1, s1 = 0;
+        while (r1 != 0)
+        {
+            __int128 q = r0 / r1, t;
+            t = r0 - q * r1; r0 = r1; r1 = t;
+            t = s0 - q * s1; s0 = s1; s1 = t;
+        }
+        if (r0 != 1) return 0;
+        if (s0 < 0) s0 += (__int128)mod;
+        return (ULL)s0;
+    }
+
+    while (r != 0)
+    {
+        long long q = old_r / r, t;
+        t = old_r - q * r; old_r = r; r = t;
+        __int128 ts = old_s - (__int128)q * s; old_s = s; s = ts;
+    }
+    if (old_r != 1) return 0;
+    if (old_s < 0) old_s += (__int128)mod;
+    return (ULL)old_s;
+}
+
+int modular_is_prime(ULL n)
+{
+    static const ULL small_primes[] = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37};
+    const int count = (int)(sizeof(small_primes) / sizeof(small_primes[0]));
+
+    if (n < 2) return 0;
+    for (int i = 0; i < count; i++)
+    {
+        if (n % small_primes[i] == 0) return n == small_primes[i];
+    }
+
+    ULL d = n - 1;
+    int s = 0;
+    while ((d & 1) == 0)
+    {
+        d >>= 1;
+        s++;
+    }
+
+    /* Первые 12 простых оснований достаточны для всех n < 3.3 * 10^24 */
+    for (int i = 0; i < count; i++)
+    {
+        ULL x = modular_pow(small_primes[i], d, n);
+        if (x == 1 || x == n - 1) continue;
+
+        int composite = 1;
+        for (int r = 1; r < s; r++)
+        {
+            x = modular_mul(x, x, n);
+            if (x == n - 1)
+            {
+                composite = 0;
+                break;
+            }
+        }
+        if (composite) return 0;
+    }
+    return 1;
+}
+
+ULL modular_prev_prime(ULL bound)
+{
+    if (bound <= 2) return 0;
+    for (ULL candidate = bound - 1; candidate >= 2; candidate--)
+    {
+        if (modular_is_prime(candidate)) return candidate;
+    }
+    return 0;
+}
+
+/* ---------- Разложение на множители ---------- */
+
+#define MODULAR_TRIAL_LIMIT 1024            /* пробное деление до этой границы */
+#define MODULAR_CACHE_SIZE 64               /* число кэшируемых разложений */
+
+static ULL modular_gcd(ULL a, ULL b)
+{
+    while (b != 0)
+    {
+        ULL t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+/* Нетривиальный делитель нечётного составного n (ро-метод Полларда, вариант Брента) */
+static ULL modular_pollard_rho(ULL n)
+{
+    const ULL batch = 128;
+    for (ULL c = 1;; c++)
+    {
+        ULL y = 2, x = 2, saved = 2, q = 1, g = 1;
+        for (ULL r = 1; g == 1; r <<= 1)
+        {
+            x = y;
+            for (ULL i = 0; i < r; i++)
+            {
+                y = (ULL)(((unsigned __int128)y * y + c) % n);
+            }
+            for (ULL k = 0; k < r && g == 1; k += batch)
+            {
+                saved = y;
+                for (ULL i = 0; i < batch && i < r - k; i++)
+                {
+                    y = (ULL)(((unsigned __int128)y * y + c) % n);
+                    q = modular_mul(q, x > y ? x - y : y - x, n);
+                }
+                g = modular_gcd(q, n);
+            }
+        }
+
+        /* Пакет перескочил делитель — повторить последние шаги по одному */
+        if (g == n)
+        {
+            do
+            {
+                saved = (ULL)(((unsigned __int128)saved * saved + c) % n);
+                g = modular_gcd(x > saved ? x - saved : saved - x, n);
+            } while (g == 1);
+        }
+        if (g != n)
+        {
+            return g;
+        }
+    }
+}
+
+static void modular_add_factor(ModularFactorization* result, ULL prime, int exponent)
+{
+    for (int i = 0; i < result->count; i++)
+    {
+        if (result->primes[i] == prime)
+        {
+            result->exponents[i] += exponent;
+            return;
+        }
+    }
+    result->primes[result->count] = prime;
+    result->exponents[result->count] = exponent;
+    result->count++;
+}
+
+static void modular_factor_rho(ULL n, ModularFactorization* result)
+{
+    if (n == 1)
+    {
+        return;
+    }
+    if (modular_is_prime(n))
+    {
+        modular_add_factor(result, n, 1);
+        return;
+    }
+
+    ULL d = modular_pollard_rho(n);
+    modular_factor_rho(d, result);
+    modular_factor_rho(n / d, result);
+}
+
+static void modular_factor_uncached(ULL n, ModularFactorization* result)
+{
+    result->count = 0;
+    if (n == 0)
+    {
+        return;
+    }
+
+    for (ULL p = 2; p < MODULAR_TRIAL_LIMIT && p * p <= n; p += (p == 2) ? 1 : 2)
+    {
+        int exponent = 0;
+        while (n % p == 0)
+        {
+            n /= p;
+            exponent++;
+        }
+        if (exponent > 0) modular_add_factor(result, p, exponent);
+    }
+    modular_factor_rho(n, result);
+
+    /* Сортировка по возрастанию простых и вычисление степеней */
+    for (int i = 1; i < result->count; i++)
+    {
+        for (int j = i; j > 0 && result->primes[j - 1] > result->primes[j]; j--)
+        {
+            ULL prime = result->primes[j];
+            int exponent = result->exponents[j];
+            result->primes[j] = result->primes[j - 1];
+            result->exponents[j] = result->exponents[j - 1];
+            result->primes[j - 1] = prime;
+            result->exponents[j - 1] = exponent;
+        }
+    }
+    for (int i = 0; i < result->count; i++)
+    {
+        ULL power = 1;
+        for (int e = 0; e < result->exponents[i]; e++) power *= result->primes[i];
+        result->powers[i] = power;
+    }
+}
+
+static struct
+{
+    pthread_mutex_t lock;
+    ULL moduli[MODULAR_CACHE_SIZE];
+    ModularFactorization factorizations[MODULAR_CACHE_SIZE];
+    int used;                               /* заполненных записей */
+    int next;                               /* запись для следующей вставки (по кругу) */
+} modular_cache = {PTHREAD_MUTEX_INITIALIZER, {0}, {{0}}, 0, 0};
+
+int modular_factor(ULL n, ModularFactorization* result)
+{
+    if (!result)
+    {
+        return MATRIX_ERROR_NULL_POINTER;
+    }
+
+    pthread_mutex_lock(&modular_cache.lock);
+    for (int i = 0; i < modular_cache.used; i++)
+    {
+        if (modular_cache.moduli[i] == n)
+        {
+            *result = modular_cache.factorizations[i];
+            pthread_mutex_unlock(&modular_cache.lock);
+            return MATRIX_SUCCESS;
+        }
+    }
+    pthread_mutex_unlock(&modular_cache.lock);
+
+    modular_factor_uncached(n, result);
+
+    pthread_mutex_lock(&modular_cache.lock);
+    modular_cache.moduli[modular_cache.next] = n;
+    modular_cache.factorizations[modular_cache.next] = *result;
+    modular_cache.next = (modular_cache.next + 1) % MODULAR_CACHE_SIZE;
+    if (modular_cache.used < MODULAR_CACHE_SIZE) modular_cache.used++;
+    pthread_mutex_unlock(&modular_cache.lock);
+    return MATRIX_SUCCESS;
+}
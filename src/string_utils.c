@@ -1,7 +1,10 @@
 #include "../include/string_utils.h"
+#include "../include/trace.h"
 
 int string_to_matrix(const char* str, ULL field_size, Matrix** result)
 {
+    TRACE_SCOPE("parse");
+
     if (!str)
     {
         return STRING_ERROR_NULL_POINTER;
@@ -103,6 +106,8 @@ int string_to_matrix(const char* str, ULL field_size, Matrix** result)
 
 int matrix_to_string(const Matrix* matrix, char** result)
 {
+    TRACE_SCOPE("serialize");
+
     if (!matrix || !result)
     {
         return STRING_ERROR_NULL_POINTER;
@@ -217,3 +222,182 @@ int matrix_to_string(const Matrix* matrix, char** result)
     *result = str_result;
     return STRING_SUCCESS;
 }
+
+int string_to_gf2_matrix(const char* str, Gf2Matrix** result)
+{
+    TRACE_SCOPE("parse");
+
+    if (!str || !result)
+    {
+        return STRING_ERROR_NULL_POINTER;
+    }
+    size_t length = strlen(str);
+    if (length < 3)
+    {
+        return STRING_ERROR_INVALID_FORMAT;
+    }
+
+    int rows = 1;
+    int cols = 1;
+    for (size_t i = 1; i + 1 < length; i++)
+    {
+        if (str[i] == ';')
+        {
+            rows++;
+        }
+        else if (str[i] == ',' && rows == 1)
+        {
+            cols++;
+        }
+    }
+
+    if (gf2_matrix_create(rows, cols, result) != MATRIX_SUCCESS)
+    {
+        return STRING_ERROR_CONVERSION;
+    }
+
+    const char* p = strchr(str, '(');
+    if (!p)
+    {
+        gf2_matrix_free(*result);
+        *result = NULL;
+        return STRING_ERROR_INVALID_FORMAT;
+    }
+
+    int row = 0, col = 0;
+    int digits = 0;
+    char last = '0';
+    for (p++; *p && *p != ')'; p++)
+    {
+        if (*p == ',' || *p == ';')
+        {
+            if (digits > 0 && row < rows && col < cols && ((last - '0') & 1))
+            {
+                (*result)->words[(size_t)row * (*result)->words_per_row + (col >> 6)] |= 1ULL << (col & 63);
+            }
+            if (digits > 0) col++;
+            digits = 0;
+            if (*p == ';')
+            {
+                row++;
+                col = 0;
+            }
+        }
+        else if (*p != ' ')
+        {
+            if (*p < '0' || *p > '9' || digits >= 31)
+            {
+                gf2_matrix_free(*result);
+                *result = NULL;
+                return (digits >= 31) ? STRING_ERROR_BUFFER_OVERFLOW : STRING_ERROR_CONVERSION;
+            }
+            last = *p;
+            digits++;
+        }
+    }
+
+    if (digits > 0 && row < rows && col < cols && ((last - '0') & 1))
+    {
+        (*result)->words[(size_t)row * (*result)->words_per_row + (col >> 6)] |= 1ULL << (col & 63);
+    }
+
+    return STRING_SUCCESS;
+}
+
+int gf2_matrix_to_string(const Gf2Matrix* matrix, char** result)
+{
+    TRACE_SCOPE("serialize");
+
+    if (!matrix || !result)
+    {
+        return STRING_ERROR_NULL_POINTER;
+    }
+
+    /* Каждый элемент — одна цифра и один разделитель (последний заменяется на ')') */
+    size_t total_chars = 2 * (size_t)matrix->rows * matrix->cols + 2;
+    char* str_result = (char*)malloc(total_chars);
+    if (!str_result)
+    {
+        return STRING_ERROR_CONVERSION;
+    }
+
+    size_t pos = 0;
+    str_result[pos++] = '(';
+    for (int i = 0; i < matrix->rows; i++)
+    {
+        for (int j = 0; j < matrix->cols; j++)
+        {
+            str_result[pos++] = (char)('0' + gf2_matrix_get(matrix, i, j));
+            str_result[pos++] = (j < matrix->cols - 1) ? ',' : ';';
+        }
+    }
+    str_result[pos - 1] = ')';
+    str_result[pos] = '\0';
+
+    *result = str_result;
+    return STRING_SUCCESS;
+}
+
+int big_matrix_to_string(const BigMatrix* matrix, char** result)
+{
+    TRACE_SCOPE("serialize");
+
+    if (!matrix || !result)
+    {
+        return STRING_ERROR_NULL_POINTER;
+    }
+
+    size_t count = (size_t)matrix->rows * matrix->cols;
+    size_t total_chars = 2;
+    for (size_t i = 0; i < count; i++)
+    {
+        total_chars += bigint_decimal_length(&matrix->data[i]) + 1;
+    }
+
+    char* str_result = (char*)malloc(total_chars);
+    if (!str_result)
+    {
+        return STRING_ERROR_CONVERSION;
+    }
+
+    size_t pos = 0;
+    str_result[pos++] = '(';
+    for (int i = 0; i < matrix->rows; i++)
+    {
+        for (int j = 0; j < matrix->cols; j++)
+        {
+            size_t written = bigint_write_decimal(&matrix->data[(size_t)i * matrix->cols + j], str_result + pos);
+            if (written == 0)
+            {
+                free(str_result);
+                return STRING_ERROR_CONVERSION;
+            }
+            pos += written;
+            str_result[pos++] = (j < matrix->cols - 1) ? ',' : ';';
+        }
+    }
+    str_result[pos - 1] = ')';
+    str_result[pos] = '\0';
+
+    *result = str_result;
+    return STRING_SUCCESS;
+}
+
+int string_to_bigint(const char* str, BigInt* value)
+{
+    if (!str || !value)
+    {
+        return STRING_ERROR_NULL_POINTER;
+    }
+
+    int error = bigint_from_decimal(value, str);
+    if (error == MATRIX_ERROR_INVALID_NUMBER)
+    {
+        return STRING_ERROR_CONVERSION;
+    }
+    if (error != MATRIX_SUCCESS)
+    {
+        return STRING_ERROR_BUFFER_OVERFLOW;
+    }
+    return STRING_SUCCESS;
+}
@@ -0,0 +1,253 @@
+#include "../include/test_writer.h"
+#include "../include/trace.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <time.h>
+
+#define TEST_WRITER_SLEEP_NS 10000000L      /* наибольший сон потока записи при пустой очереди */
+
+struct TestWriter
+{
+    FILE* csv;
+    FILE* short_out;
+    FILE* dump;                             /* NULL — без дампов */
+    void* dump_buffer;                      /* упакованные элементы одной матрицы */
+    size_t dump_capacity;
+
+    TestRecord records[TEST_WRITER_QUEUE];
+    _Alignas(64) atomic_size_t head;        /* следующая запись для потока записи */
+    _Alignas(64) atomic_size_t tail;        /* следующее свободное место для генератора */
+    atomic_int closed;
+    atomic_int sleeping;
+    int failed;                             /* была ошибка записи */
+
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+};
+
+/* Записать элементы матрицы size x size по width байт на элемент */
+static int writer_dump_matrix(TestWriter* writer, const ULL* data, int size, int width)
+{
+    size_t count = (size_t)size * size;
+    size_t bytes = count * (size_t)width;
+    if (bytes > writer->dump_capacity)
+    {
+        void* buffer = realloc(writer->dump_buffer, bytes);
+        if (!buffer) return 0;
+        writer->dump_buffer = buffer;
+        writer->dump_capacity = bytes;
+    }
+
+    switch (width)
+    {
+        case 1:
+            for (size_t i = 0; i < count; i++) ((uint8_t*)writer->dump_buffer)[i] = (uint8_t)data[i];
+            break;
+        case 2:
+            for (size_t i = 0; i < count; i++) ((uint16_t*)writer->dump_buffer)[i] = (uint16_t)data[i];
+            break;
+        case 4:
+            for (size_t i = 0; i < count; i++) ((uint32_t*)writer->dump_buffer)[i] = (uint32_t)data[i];
+            break;
+        default:
+            memcpy(writer->dump_buffer, data, bytes);
+            break;
+    }
+    return fwrite(writer->dump_buffer, 1, bytes, writer->dump) == bytes;
+}
+
+static void writer_output(TestWriter* writer, TestRecord* record)
+{
+    TRACE_SCOPE("write_output");
+
+    printf("%6d %6d %12llu %12llu %12llu\n", record->index, record->size, record->exponent,
+           record->field_size, record->time_ns);
+
+    int written = fprintf(writer->short_out, "%d %llu %llu %llu\n", record->size, record->exponent,
+                          record->field_size, record->time_ns) > 0;
+
+    written &= fprintf(writer->csv, "%d,%llu,%llu,%llu\n",
+                       record->size, record->exponent, record->field_size,
+                       record->time_ns) > 0;
+
+    if (writer->dump && record->matrix)
+    {
+        int width = matrix_element_width(record->field_size);
+        TestDumpHeader header = {(uint32_t)record->index, (uint32_t)record->size, record->exponent,
+                                 record->field_size, record->time_ns, record->error, (uint32_t)width};
+        written &= fwrite(&header, sizeof(header), 1, writer->dump) == 1;
+        written &= writer_dump_matrix(writer, record->matrix, record->size, width);
+        if (record->error == MATRIX_SUCCESS && record->power)
+        {
+            written &= writer_dump_matrix(writer, record->power, record->size, width);
+        }
+    }
+    if (!written) writer->failed = 1;
+
+    free(record->matrix);
+    free(record->power);
+}
+
+/* Уснуть, пока очередь пуста и не закрыта (или не истёк TEST_WRITER_SLEEP_NS) */
+static void writer_sleep(TestWriter* writer)
+{
+    pthread_mutex_lock(&writer->lock);
+    atomic_store(&writer->sleeping, 1);
+    if (atomic_load(&writer->head) == atomic_load(&writer->tail) && !atomic_load(&writer->closed))
+    {
+        struct timespec until;
+        clock_gettime(CLOCK_REALTIME, &until);
+        until.tv_nsec += TEST_WRITER_SLEEP_NS;
+        if (until.tv_nsec >= 1000000000L)
+        {
+            until.tv_sec++;
+            until.tv_nsec -= 1000000000L;
+        }
+        pthread_cond_timedwait(&writer->wake, &writer->lock, &until);
+    }
+    atomic_store(&writer->sleeping, 0);
+    pthread_mutex_unlock(&writer->lock);
+}
+
+static void* writer_thread(void* arg)
+{
+    TestWriter* writer = (TestWriter*)arg;
+    trace_thread_name("test-writer");
+
+    for (;;)
+    {
+        size_t head = atomic_load_explicit(&writer->head, memory_order_relaxed);
+        size_t tail = atomic_load_explicit(&writer->tail, memory_order_acquire);
+        if (head == tail)
+        {
+            if (atomic_load(&writer->closed) && head == atomic_load(&writer->tail)) break;
+
+            /* Очередь разобрана: строки уже видны на экране, файлы копятся в буферах */
+            fflush(stdout);
+            writer_sleep(writer);
+            continue;
+        }
+
+        for (; head != tail; head++)
+        {
+            writer_output(writer, &writer->records[head % TEST_WRITER_QUEUE]);
+            atomic_store_explicit(&writer->head, head + 1, memory_order_release);
+        }
+    }
+    fflush(stdout);
+    return NULL;
+}
+
+int test_writer_open(const char* csv_path, const char* short_path, const char* dump_path, TestWriter** result)
+{
+    if (!csv_path || !short_path || !result)
+    {
+        return TEST_ERROR_INVALID_PARAMS;
+    }
+
+    TestWriter* writer = (TestWriter*)aligned_alloc(64, (sizeof(TestWriter) + 63) & ~(size_t)63);
+    if (!writer)
+    {
+        return TEST_ERROR_FILE_WRITE;
+    }
+    memset(writer, 0, sizeof(TestWriter));
+
+    writer->csv = fopen(csv_path, "w");
+    writer->short_out = fopen(short_path, "w");
+    writer->dump = dump_path ? fopen(dump_path, "wb") : NULL;
+    if (!writer->csv || !writer->short_out || (dump_path && !writer->dump))
+    {
+        if (writer->csv) fclose(writer->csv);
+        if (writer->short_out) fclose(writer->short_out);
+        if (writer->dump) fclose(writer->dump);
+        free(writer);
+        return TEST_ERROR_FILE_WRITE;
+    }
+
+    setvbuf(writer->csv, NULL, _IOFBF, TEST_WRITER_BUFFER);
+    setvbuf(writer->short_out, NULL, _IOFBF, TEST_WRITER_BUFFER);
+    if (writer->dump)
+    {
+        setvbuf(writer->dump, NULL, _IOFBF, TEST_WRITER_BUFFER);
+        char magic[8] = TEST_DUMP_MAGIC;
+        fwrite(magic, sizeof(magic), 1, writer->dump);
+    }
+
+    fprintf(writer->csv, "matrix_size,exponent,field_size,computation_time_ns\n");
+    fprintf(writer->short_out, "matrix_size exponent field_size computation_time_ns\n");
+
+    pthread_mutex_init(&writer->lock, NULL);
+    pthread_cond_init(&writer->wake, NULL);
+    if (pthread_create(&writer->thread, NULL, writer_thread, writer) != 0)
+    {
+        pthread_mutex_destroy(&writer->lock);
+        pthread_cond_destroy(&writer->wake);
+        fclose(writer->csv);
+        fclose(writer->short_out);
+        if (writer->dump) fclose(writer->dump);
+        free(writer);
+        return TEST_ERROR_FILE_WRITE;
+    }
+
+    *result = writer;
+    return TEST_SUCCESS;
+}
+
+int test_writer_dumps(const TestWriter* writer)
+{
+    return writer && writer->dump;
+}
+
+int test_writer_push(TestWriter* writer, const TestRecord* record)
+{
+    if (!writer || !record)
+    {
+        return TEST_ERROR_INVALID_PARAMS;
+    }
+
+    size_t tail = atomic_load_explicit(&writer->tail, memory_order_relaxed);
+    while (tail - atomic_load_explicit(&writer->head, memory_order_acquire) >= TEST_WRITER_QUEUE)
+    {
+        /* Очередь полна: поток записи отстаёт, ждём вне замеров времени */
+        sched_yield();
+    }
+
+    writer->records[tail % TEST_WRITER_QUEUE] = *record;
+    atomic_store(&writer->tail, tail + 1);
+
+    if (atomic_load(&writer->sleeping))
+    {
+        pthread_mutex_lock(&writer->lock);
+        pthread_cond_signal(&writer->wake);
+        pthread_mutex_unlock(&writer->lock);
+    }
+    return TEST_SUCCESS;
+}
+
+int test_writer_close(TestWriter* writer)
+{
+    if (!writer)
+    {
+        return TEST_SUCCESS;
+    }
+
+    atomic_store(&writer->closed, 1);
+    pthread_mutex_lock(&writer->lock);
+    pthread_cond_signal(&writer->wake);
+    pthread_mutex_unlock(&writer->lock);
+    pthread_join(writer->thread, NULL);
+
+    int failed = writer->failed;
+    if (fclose(writer->csv) != 0) failed = 1;
+    if (fclose(writer->short_out) != 0) failed = 1;
+    if (writer->dump && fclose(writer->dump) != 0) failed = 1;
+
+    pthread_mutex_destroy(&writer->lock);
+    pthread_cond_destroy(&writer->wake);
+    free(writer->dump_buffer);
+    free(writer);
+    return failed ? TEST_ERROR_FILE_WRITE : TEST_SUCCESS;
+}
@@ -1,7 +1,24 @@
 #include "../include/tests.h"
+#include "../include/trace.h"
+#include "../include/matrix_rns.h"
+#include "../include/matrix_lu.h"
+#include "../include/matrix_view.h"
+#include "../include/matrix_verify.h"
+#include "../include/matrix_tune.h"
+#include "../include/matrix_sched.h"
+#include "../include/test_writer.h"
+#include "../include/latency_hist.h"
+#include "../include/matrix_shard.h"
+#include "../include/matrix_tiled.h"
+#include "../include/matrix_poly.h"
+#include "../include/gf2.h"
+#include "../include/matrix_alloc.h"
 
 #define POSIX_C_SOURCE 199309L
 #define K 19 // [2^K;(2^K)-1)
+#define GENERATOR_JOBS_ENV "MATRIX_JOBS"    /* число тестов генератора, считаемых одновременно */
+#define GENERATOR_MAX_JOBS 64
+#define GENERATOR_LATENCY_FILE "output-latency.txt"   /* таблица процентилей по ключам */
 
 static inline uint64_t rand64(void)
 {
@@ -47,7 +64,7 @@ int generate_random_matrix(int size, ULL field_size, Matrix** result)
     if (size <= 0)
         return MATRIX_ERROR_INVALID_SIZE;
 
-    int err = matrix_create(size, size, field_size, result);
+    int err = matrix_create_uninit(size, size, field_size, result);
     if (err != MATRIX_SUCCESS)
         return err;
 
@@ -80,6 +97,90 @@ int generate_random_matrix(int size, ULL field_size, Matrix** result)
     return MATRIX_SUCCESS;
 }
 
+/* Один тест генератора: матрица готовится заранее, возведение идёт задачей планировщика */
+typedef struct GeneratorJob
+{
+    int size;
+    ULL exponent;
+    ULL field_size;
+    Matrix* matrix;
+    Matrix* power;
+    MatrixAllocator* allocator;     /* арена места в пачке: временные матрицы возведения */
+    int error;                      /* код matrix_power */
+    ULL dt_ns;
+    LatencyRecorder* latency;       /* общие гистограммы всех тестов (запись без блокировок) */
+} GeneratorJob;
+
+static void generator_run_jobs(void* context, int begin, int end)
+{
+    GeneratorJob* jobs = (GeneratorJob*)context;
+    for (int j = begin; j < end; j++)
+    {
+        GeneratorJob* job = &jobs[j];
+        if (!job->matrix) continue;
+
+        /* Арена привязывается к потоку, который взял тест: одна арена — один тест в каждый момент.
+           Своя группа задач: ожидая свои задачи, поток не возьмёт чужой тест, и в замер
+           попадает только работа этого теста (matrix_sched.h) */
+        MatrixAllocator* previous = matrix_allocator_bind(job->allocator);
+        const void* group = sched_group_enter(job);
+
+        int64_t t0 = 0, t1 = 0;
+        if (get_time_ns(&t0) != 0) t0 = 0;
+        job->error = matrix_power(job->matrix, job->exponent, &job->power);
+        if (get_time_ns(&t1) != 0) t1 = t0;
+        job->dt_ns = t1 - t0;
+        if (job->error == MATRIX_SUCCESS)
+        {
+            latency_record(job->latency, job->size, job->exponent, job->field_size, job->dt_ns);
+        }
+
+        sched_group_enter(group);
+        matrix_allocator_bind(previous);
+    }
+}
+
+/* Копия элементов матрицы для дампа (освобождает поток записи) или NULL */
+static ULL* generator_dump_copy(const Matrix* matrix)
+{
+    if (!matrix) return NULL;
+
+    size_t bytes = (size_t)matrix->rows * matrix->cols * sizeof(ULL);
+    ULL* copy = (ULL*)malloc(bytes);
+    if (copy) memcpy(copy, matrix->data[0], bytes);
+    return copy;
+}
+
+/* Число одновременно считаемых тестов из GENERATOR_JOBS_ENV (по умолчанию 1 — по очереди) */
+static int generator_job_count(void)
+{
+    const char* text = getenv(GENERATOR_JOBS_ENV);
+    long jobs = text ? strtol(text, NULL, 10) : 1;
+    if (jobs < 1) jobs = 1;
+    if (jobs > GENERATOR_MAX_JOBS) jobs = GENERATOR_MAX_JOBS;
+    return (int)jobs;
+}
+
+/* Число раундов проверки произведений из MATRIX_VERIFY_ENV (0 — без проверки) */
+static int verify_round_count(void)
+{
+    const char* text = getenv(MATRIX_VERIFY_ENV);
+    long rounds = text ? strtol(text, NULL, 10) : 0;
+    if (rounds < 0) rounds = 0;
+    if (rounds > MATRIX_VERIFY_MAX_ROUNDS) rounds = MATRIX_VERIFY_MAX_ROUNDS;
+    return (int)rounds;
+}
+
+/* Число процессов из SHARD_ENV для ручного ввода (0 — считать в этом процессе) */
+static int shard_process_count(void)
+{
+    const char* text = getenv(SHARD_ENV);
+    long workers = text ? strtol(text, NULL, 10) : 0;
+    if (workers < 0) workers = 0;
+    if (workers > SHARD_MAX_WORKERS) workers = SHARD_MAX_WORKERS;
+    return (int)workers;
+}
+
 int generate_test_cases(const char* filename, int min_size, int max_size, int num_tests,
                        ULL min_exponent, ULL max_exponent, ULL field_size)
 {
@@ -88,77 +189,110 @@ int generate_test_cases(const char* filename, int min_size, int max_size, int nu
     if (num_tests <= 0) return TEST_ERROR_INVALID_PARAMS;
     if (min_exponent > max_exponent) return TEST_ERROR_INVALID_PARAMS;
 
-    FILE* csv = fopen(filename, "w");
-    if (!csv) return TEST_ERROR_FILE_WRITE;
-
-    FILE* short_out = fopen("output-short.txt", "w");
-    if (!short_out) { fclose(csv); return TEST_ERROR_FILE_WRITE; }
-
-    fprintf(csv, "matrix_size,exponent,field_size,computation_time_ns\n");
-    fprintf(short_out, "matrix_size exponent field_size computation_time_ns\n");
+    /* Вывод идёт в отдельном потоке (test_writer.h): замеры не ждут ввода-вывода */
+    TestWriter* writer = NULL;
+    int writer_error = test_writer_open(filename, "output-short.txt", getenv(TEST_DUMP_ENV), &writer);
+    if (writer_error != TEST_SUCCESS) return writer_error;
+    int dumps = test_writer_dumps(writer);
+
+    /* Тесты идут пачками по job_count; у каждого места в пачке своя арена: без фрагментации кучи */
+    int job_count = generator_job_count();
+    GeneratorJob jobs[GENERATOR_MAX_JOBS];
+    LatencyRecorder* latency = NULL;
+    if (latency_recorder_create(&latency) != MATRIX_SUCCESS)
+        latency = NULL;
+    for (int j = 0; j < job_count; j++)
+    {
+        if (matrix_allocator_create(0, &jobs[j].allocator) != MATRIX_SUCCESS)
+            jobs[j].allocator = NULL;
+        jobs[j].latency = latency;
+    }
 
     srand((unsigned)time(NULL));
     static int count_tests = 1;
     int successful_tests = 0;
 
-    for (int test_idx = 0; test_idx < num_tests; test_idx++)
+    for (int first = 0; first < num_tests; first += job_count)
     {
-        int size = min_size + (rand32() % (max_size - min_size + 1));
-        ULL exponent = min_exponent;
-        if (min_exponent != max_exponent)
+        int batch = (num_tests - first < job_count) ? num_tests - first : job_count;
+
+        /* Параметры и матрицы — по очереди в этом потоке, чтобы последовательность rand() не зависела от пачки */
+        for (int j = 0; j < batch; j++)
         {
-            exponent = min_exponent + (rand64() % (max_exponent - min_exponent + 1));
+            GeneratorJob* job = &jobs[j];
+            job->size = min_size + (rand32() % (max_size - min_size + 1));
+            job->exponent = min_exponent;
+            if (min_exponent != max_exponent)
+            {
+                job->exponent = min_exponent + (rand64() % (max_exponent - min_exponent + 1));
+            }
+            job->field_size = field_size;
+            job->matrix = NULL;
+            job->power = NULL;
+            job->error = MATRIX_SUCCESS;
+            job->dt_ns = 0;
+
+            MatrixAllocator* previous = matrix_allocator_bind(job->allocator);
+            TRACE_BEGIN("generate_matrix");
+            int create_err = generate_random_matrix(job->size, field_size, &job->matrix);
+            TRACE_END();
+            matrix_allocator_bind(previous);
+            if (create_err != MATRIX_SUCCESS)
+            {
+                printf("\nFailed to create matrix: %s\n", get_matrix_error_message(create_err));
+                job->matrix = NULL;
+            }
         }
 
-        Matrix* M = NULL;
-        int create_err = generate_random_matrix(size, field_size, &M);
-        if (create_err != MATRIX_SUCCESS)
+        /* Тесты пачки — задачи планировщика; их умножения порождают вложенные задачи */
+        sched_parallel_for(0, batch, 1, generator_run_jobs, jobs);
+
+        for (int j = 0; j < batch; j++)
         {
-            printf("\nFailed to create matrix: %s\n", get_matrix_error_message(create_err));
-            continue;
+            GeneratorJob* job = &jobs[j];
+            if (!job->matrix) continue;
+
+            TestRecord record = {count_tests, job->size, job->exponent, field_size, job->dt_ns, job->error,
+                                 dumps ? generator_dump_copy(job->matrix) : NULL,
+                                 dumps ? generator_dump_copy(job->power) : NULL};
+            test_writer_push(writer, &record);
+
+            if (job->power) matrix_free(job->power);
+            matrix_free(job->matrix);
+            count_tests++;
+            successful_tests++;
         }
+    }
 
-        char* matrix_str = NULL;
-        if (matrix_to_string(M, &matrix_str) != STRING_SUCCESS)
-            matrix_str = strdup("SERIALIZE_ERROR");
+    for (int j = 0; j < job_count; j++)
+    {
+        matrix_allocator_destroy(jobs[j].allocator);
+    }
 
-        int64_t t0 = 0, t1 = 0;
-        if (get_time_ns(&t0) != 0) t0 = 0;
-        Matrix* R = NULL;
-        int pow_err = matrix_power(M, exponent, &R);
-        if (get_time_ns(&t1) != 0) t1 = t0;
-        ULL dt_ns = t1 - t0;
+    writer_error = test_writer_close(writer);
 
-        char* result_str = NULL;
-        if (pow_err == MATRIX_SUCCESS)
+    /* Процентили по ключам (класс n, биты показателя, класс поля) — в файл, общая строка — на экран */
+    if (latency)
+    {
+        FILE* latency_out = fopen(GENERATOR_LATENCY_FILE, "w");
+        if (latency_out)
         {
-            if (matrix_to_string(R, &result_str) != STRING_SUCCESS)
-                result_str = strdup("SERIALIZE_ERROR");
+            latency_recorder_print(latency, latency_out);
+            fclose(latency_out);
         }
-        else
+
+        LatencyHistogram* total = (LatencyHistogram*)malloc(sizeof(LatencyHistogram));
+        if (total && latency_recorder_total(latency, total) == MATRIX_SUCCESS && atomic_load(&total->total) > 0)
         {
-            const char* msg = get_matrix_error_message(pow_err);
-            result_str = strdup(msg ? msg : "POWER_ERROR");
+            printf("Latency, ns: p50 %llu  p90 %llu  p99 %llu  p99.9 %llu  max %llu (by key: %s)\n",
+                   latency_histogram_percentile(total, 50), latency_histogram_percentile(total, 90),
+                   latency_histogram_percentile(total, 99), latency_histogram_percentile(total, 99.9),
+                   latency_histogram_percentile(total, 100), GENERATOR_LATENCY_FILE);
         }
-
-        printf("%6d %6d %12llu %12llu %12lld\n", count_tests, size, exponent, field_size, dt_ns);
-
-        fprintf(short_out, "%d %llu %llu %llu\n", size, exponent, field_size, dt_ns);
-
-        fprintf(csv, "%d,%llu,%llu,%lld\n",
-                size, exponent, field_size,
-                dt_ns);
-
-        free(matrix_str);
-        free(result_str);
-        if (R) matrix_free(R);
-        matrix_free(M);
-        count_tests++;
-        successful_tests++;
+        free(total);
+        latency_recorder_destroy(latency);
     }
-
-    fclose(csv);
-    fclose(short_out);
+    if (writer_error != TEST_SUCCESS) return writer_error;
 
     if (successful_tests == 0)
         return TEST_ERROR_GENERATION;
@@ -250,13 +384,46 @@ int file_operations_test()
     return UI_SUCCESS;
 }
 
+/* Точное возведение в степень над целыми числами (field_size == 0) */
+static int input_test_exact(Matrix* matrix, ULL exponent)
+{
+    clock_t start = clock();
+    BigMatrix* result;
+    int matrix_error = matrix_power_exact(matrix, exponent, &result);
+    clock_t end = clock();
+
+    if (matrix_error == MATRIX_SUCCESS)
+    {
+        char* result_str;
+        int string_error = big_matrix_to_string(result, &result_str);
+        if (string_error == STRING_SUCCESS)
+        {
+            printf("\nРезультат возведения в степень %llu: %s\n", exponent, result_str);
+            free(result_str);
+        }
+
+        double time_taken = ((double)(end - start)) / CLOCKS_PER_SEC * 1e6;
+        printf("Время выполнения: %.8f микросекунд\n", time_taken);
+
+        big_matrix_free(result);
+    }
+    else
+    {
+        printf("Ошибка возведения в степень: %s\n", get_matrix_error_message(matrix_error));
+    }
+
+    matrix_free(matrix);
+    return UI_SUCCESS;
+}
+
 int input_test()
 {
     printf("=== РУЧНОЕ ТЕСТИРОВАНИЕ ===\n");
 
     char buffer[32767];
+    char exponent_text[8192];
     int size;
-    ULL exponent, field_size;
+    ULL field_size;
 
     printf("Введите размер матрицы:");
     if (scanf("%d", &size) != 1 || size <= 0)
@@ -265,17 +432,24 @@ int input_test()
         return UI_ERROR_INPUT;
     }
 
-    printf("Введите размер конечного поля:");
-    if (scanf("%llu", &field_size) != 1 || field_size == 0)
+    printf("Введите размер конечного поля (0 — точный результат над целыми числами):");
+    if (scanf("%llu", &field_size) != 1)
     {
         printf("Ошибка ввода размера поля\n");
         return UI_ERROR_INPUT;
     }
 
+    /* Показатель может быть любой длины: над простым полем он приводится по периоду степеней;
+       отрицательный показатель означает степень обратной матрицы */
     printf("Введите степень:");
-    if (scanf("%llu", &exponent) != 1)
+    BigInt exponent;
+    bigint_init(&exponent);
+    int read = scanf("%8191s", exponent_text);
+    int negative_exponent = (read == 1 && exponent_text[0] == '-');
+    if (read != 1 || string_to_bigint(exponent_text + negative_exponent, &exponent) != STRING_SUCCESS)
     {
         printf("Ошибка ввода степени\n");
+        bigint_free(&exponent);
         return UI_ERROR_INPUT;
     }
 
@@ -284,6 +458,7 @@ int input_test()
     if (fgets(buffer, sizeof(buffer), stdin) == NULL)
     {
         printf("Ошибка ввода матрицы\n");
+        bigint_free(&exponent);
         return UI_ERROR_INPUT;
     }
     buffer[strcspn(buffer, "\n")] = 0;
@@ -293,20 +468,87 @@ int input_test()
     if (string_error != STRING_SUCCESS)
     {
         printf("Ошибка преобразования строки в матрицу: %s\n", get_string_error_message(string_error));
+        bigint_free(&exponent);
         return UI_ERROR_INPUT;
     }
 
     printf("\nИсходная матрица:\n");
     matrix_print(matrix);
 
+    if (negative_exponent)
+    {
+        Matrix* inverse;
+        int inverse_error = (field_size == 0) ? MATRIX_ERROR_INVALID_FIELD : matrix_inverse(matrix, &inverse);
+        matrix_free(matrix);
+        if (inverse_error != MATRIX_SUCCESS)
+        {
+            printf("Ошибка обращения матрицы: %s\n", get_matrix_error_message(inverse_error));
+            bigint_free(&exponent);
+            return UI_SUCCESS;
+        }
+        matrix = inverse;
+    }
+
+    if (field_size == 0)
+    {
+        ULL small_exponent;
+        int fits = bigint_to_ull(&exponent, &small_exponent);
+        bigint_free(&exponent);
+        if (!fits)
+        {
+            printf("Ошибка возведения в степень: %s\n", get_matrix_error_message(MATRIX_ERROR_OVERFLOW));
+            matrix_free(matrix);
+            return UI_SUCCESS;
+        }
+        return input_test_exact(matrix, small_exponent);
+    }
+
+    /* Составной модуль считается по компонентам p^k параллельно, над простым показатель приводится */
+    MatrixPowerOptions options = {0};
+    options.decompose_modulus = 1;
+    options.reduce_exponent = 1;
+
+    /* С MATRIX_VERIFY_ENV каждое произведение проверяется методом Фрейвалдса */
+    MatrixVerifier* verifier = NULL;
+    MatrixVerifierStats verify_stats = {0};
+    int verify_rounds = verify_round_count();
+    int matrix_error = verify_rounds > 0 ? matrix_verifier_create(verify_rounds, (ULL)time(NULL), &verifier)
+                                         : MATRIX_SUCCESS;
+
+    /* С SHARD_ENV каждое умножение делится по строкам между процессами (matrix_shard.h) */
+    int shards = shard_process_count();
+    int sharded = 0;
+    ULL small_exponent;
+    ShardReport shard_report;
+
     clock_t start = clock();
     Matrix* result;
-    int matrix_error = matrix_power(matrix, exponent, &result);
+    if (matrix_error == MATRIX_SUCCESS)
+    {
+        MatrixVerifier* previous = matrix_verifier_bind(verifier);
+        if (shards > 0 && bigint_to_ull(&exponent, &small_exponent))
+        {
+            ShardOptions shard_options = {shards, NULL};
+            matrix_error = matrix_power_sharded(matrix, small_exponent, &shard_options, &result, &shard_report);
+            sharded = 1;
+        }
+        else
+        {
+            matrix_error = matrix_power_big(matrix, &exponent, &options, &result);
+        }
+        matrix_verifier_bind(previous);
+        if (verifier)
+        {
+            matrix_verifier_stats(verifier, &verify_stats);
+            matrix_verifier_destroy(verifier);
+        }
+    }
     clock_t end = clock();
+    bigint_free(&exponent);
 
     if (matrix_error == MATRIX_SUCCESS)
     {
-        printf("\nРезультат возведения в степень %llu:\n", exponent);
+        printf("\nРезультат возведения в степень %s:\n", exponent_text);
         matrix_print(result);
 
         char* result_str;
@@ -319,6 +561,7 @@ int input_test()
 
         double time_taken = ((double)(end - start)) / CLOCKS_PER_SEC * 1e6;
         printf("Время выполнения: %.8f микросекунд\n", time_taken);
+        if (sharded) shard_report_print(&shard_report, stdout);
 
         matrix_free(result);
     }
@@ -326,11 +569,71 @@ int input_test()
     {
         printf("Ошибка возведения в степень: %s\n", get_matrix_error_message(matrix_error));
     }
+    if (verify_rounds > 0)
+    {
+        printf("Проверено произведений: %zu (раундов: %zu, ошибок: %zu)\n",
+               verify_stats.checks, verify_stats.rounds, verify_stats.failures);
+    }
 
     matrix_free(matrix);
     return UI_SUCCESS;
 }
 
+/* Совпадают ли размеры и все элементы двух матриц */
+static int matrices_equal(const Matrix* a, const Matrix* b)
+{
+    if (!a || !b || a->rows != b->rows || a->cols != b->cols) return 0;
+    for (int i = 0; i < a->rows; i++)
+    {
+        for (int j = 0; j < a->cols; j++)
+        {
+            if (a->data[i][j] != b->data[i][j]) return 0;
+        }
+    }
+    return 1;
+}
+
+static int matrix_is_identity(const Matrix* a)
+{
+    for (int i = 0; i < a->rows; i++)
+    {
+        for (int j = 0; j < a->cols; j++)
+        {
+            if (a->data[i][j] != (i == j ? 1ULL : 0ULL)) return 0;
+        }
+    }
+    return 1;
+}
+
+/* Напечатать итог проверки с известным ответом. [RETURN] 1, если проверка не пройдена */
+static int manual_check(int error, int passed)
+{
+    if (error != MATRIX_SUCCESS)
+    {
+        printf("Ошибка: %s\n", get_matrix_error_message(error));
+        return 1;
+    }
+    printf("%s\n", passed ? "ОК" : "НЕВЕРНО");
+    return !passed;
+}
+
+/* Возвести string в степень exponent и сравнить с expected */
+static int manual_check_power(const char* string, ULL field_size, ULL exponent, const char* expected)
+{
+    Matrix* base = NULL;
+    Matrix* want = NULL;
+    Matrix* got = NULL;
+    int error = (string_to_matrix(string, field_size, &base) == STRING_SUCCESS &&
+                 string_to_matrix(expected, field_size, &want) == STRING_SUCCESS)
+                ? MATRIX_SUCCESS : MATRIX_ERROR_INVALID_NUMBER;
+    if (error == MATRIX_SUCCESS) error = matrix_power(base, exponent, &got);
+    int failed = manual_check(error, matrices_equal(got, want));
+    matrix_free(base);
+    matrix_free(want);
+    matrix_free(got);
+    return failed;
+}
+
 int manual_test()
 {
     printf("=== ТЕСТИРОВАНИЕ С ИЗВЕСТНЫМИ ДАННЫМИ ===\n");
@@ -410,5 +713,279 @@ int manual_test()
         printf("Ошибка создания матрицы: %s\n", get_string_error_message(str_error));
     }
 
+    /* Проверки с известным ответом: результат сравнивается, а не только печатается */
+    const char* lu_matrix = "(2,1,1;1,3,2;1,0,0)";      /* определитель -1 */
+    const ULL lu_field = 1000003;
+    int failures = 0;
+
+    printf("\nТест 4: Определитель и A * A^-1 = I\n");
+    Matrix* a = NULL;
+    Matrix* inverse = NULL;
+    Matrix* product = NULL;
+    ULL determinant = 0;
+    int error = string_to_matrix(lu_matrix, lu_field, &a) == STRING_SUCCESS ? MATRIX_SUCCESS
+                                                                              : MATRIX_ERROR_INVALID_NUMBER;
+    if (error == MATRIX_SUCCESS) error = matrix_determinant(a, &determinant);
+    if (error == MATRIX_SUCCESS) error = matrix_inverse(a, &inverse);
+    if (error == MATRIX_SUCCESS) error = matrix_multiply(a, inverse, &product);
+    failures += manual_check(error, determinant == lu_field - 1 && matrix_is_identity(product));
+    matrix_free(product);
+    product = NULL;
+
+    printf("\nТест 5: A^-3 = (A^-1)^3 и A^-3 * A^3 = I\n");
+    Matrix* negative = NULL;
+    Matrix* inverse_cubed = NULL;
+    Matrix* cubed = NULL;
+    if (error == MATRIX_SUCCESS) error = matrix_power_signed(a, -3, &negative);
+    if (error == MATRIX_SUCCESS) error = matrix_power(inverse, 3, &inverse_cubed);
+    if (error == MATRIX_SUCCESS) error = matrix_power(a, 3, &cubed);
+    if (error == MATRIX_SUCCESS) error = matrix_multiply(negative, cubed, &product);
+    failures += manual_check(error, matrices_equal(negative, inverse_cubed) && matrix_is_identity(product));
+    matrix_free(product);
+    matrix_free(cubed);
+    matrix_free(inverse_cubed);
+    matrix_free(negative);
+    matrix_free(inverse);
+
+    printf("\nТест 6: A^(2^20 - 1) (серия единичных битов, wNAF)\n");
+    failures += manual_check_power(lu_matrix, lu_field, (1ULL << 20) - 1,
+                                   "(259226,447088,804867;731533,64090,967510;520422,642224,576164)");
+
+    printf("\nТест 7: Сопровождающие матрицы (метод Китамасы)\n");
+    failures += manual_check_power("(1,1;1,0)", 1000000007, 1000, "(107579939,517691607;517691607,589888339)");
+    failures += manual_check_power("(1,1,1;1,0,0;0,1,0)", 1000000007, 1000000,
+                                   "(746580045,708758608,71313044;71313044,675267001,637445564;"
+                                   "637445564,433867487,37821437)");
+
+    printf("\nТест 8: GF(2), (I + P)^32 = I + P^32 для циклического сдвига P 100 x 100\n");
+    const int gf2_size = 100;
+    Matrix* shift = NULL;
+    Matrix* expected = NULL;
+    Matrix* got = NULL;
+    Gf2Matrix* bits = NULL;
+    Gf2Matrix* bits_power = NULL;
+    error = matrix_create(gf2_size, gf2_size, 2, &shift);
+    if (error == MATRIX_SUCCESS) error = matrix_create(gf2_size, gf2_size, 2, &expected);
+    for (int i = 0; error == MATRIX_SUCCESS && i < gf2_size; i++)
+    {
+        shift->data[i][i] = 1;
+        shift->data[i][(i + 1) % gf2_size] = 1;
+        expected->data[i][i] = 1;
+        expected->data[i][(i + 32) % gf2_size] = 1;
+    }
+    if (error == MATRIX_SUCCESS) error = gf2_matrix_from_matrix(shift, &bits);
+    if (error == MATRIX_SUCCESS) error = gf2_matrix_power(bits, 32, &bits_power);
+    if (error == MATRIX_SUCCESS) error = gf2_matrix_to_matrix(bits_power, &got);
+    failures += manual_check(error, matrices_equal(got, expected));
+    gf2_matrix_free(bits_power);
+    gf2_matrix_free(bits);
+    matrix_free(got);
+    matrix_free(expected);
+    matrix_free(shift);
+
+    printf("\nТест 9: Умножение по модулю больше 2^63 через RNS\n");
+    const ULL wide_field = 9223372036854775837ULL;
+    ULL left[9], right[9], rns_product[9];
+    for (int i = 0; i < 9; i++)
+    {
+        left[i] = wide_field - 1 - (ULL)i * 0x123456789ULL;
+        right[i] = wide_field - 2 - (ULL)i * 0x987654321ULL;
+    }
+    error = rns_multiply(left, right, rns_product, 3, 3, 3, wide_field);
+    int rns_passed = 1;
+    for (int i = 0; i < 3; i++)
+    {
+        for (int j = 0; j < 3; j++)
+        {
+            ULL sum = 0;
+            for (int k = 0; k < 3; k++)
+            {
+                ULL term = (ULL)((unsigned __int128)left[i * 3 + k] * right[k * 3 + j] % wide_field);
+                sum = (sum >= wide_field - term) ? sum - (wide_field - term) : sum + term;
+            }
+            if (rns_product[i * 3 + j] != sum) rns_passed = 0;
+        }
+    }
+    failures += manual_check(error, rns_passed);
+
+    printf("\nТест 10: Возведение вне памяти и несколькими процессами против matrix_power\n");
+    const char* tiled_path = "manual-tiled.bin";
+    const char* tiled_result_path = "manual-tiled-result.bin";
+    const ULL power_exponent = 13;
+    Matrix* reference = NULL;
+    Matrix* tiled_matrix = NULL;
+    Matrix* sharded_matrix = NULL;
+    TiledMatrix* tiled_base = NULL;
+    TiledMatrix* tiled_result = NULL;
+    matrix_free(a);
+    a = NULL;
+    error = generate_random_matrix(10, lu_field, &a);
+    if (error == MATRIX_SUCCESS) error = matrix_power(a, power_exponent, &reference);
+    if (error == MATRIX_SUCCESS) error = tiled_matrix_from_matrix(a, tiled_path, 4, &tiled_base);
+    if (error == MATRIX_SUCCESS)
+    {
+        TiledOptions options = {tiled_min_budget(tiled_base)};
+        error = matrix_power_tiled(tiled_base, power_exponent, &options, tiled_result_path, &tiled_result, NULL);
+    }
+    if (error == MATRIX_SUCCESS) error = tiled_matrix_to_matrix(tiled_result, &tiled_matrix);
+    failures += manual_check(error, matrices_equal(tiled_matrix, reference));
+    tiled_matrix_close(tiled_result);
+    tiled_matrix_close(tiled_base);
+    unlink(tiled_result_path);
+    unlink(tiled_path);
+
+    /*
+     * Модуль больше 2^62 при плитках от RNS_MIN_MULTIPLY_SIZE: бюджет остаётся жёстким, если
+     * плитки не уходят в каналы RNS — упакованные матрицы вне арены движка не создаются
+     */
+    Matrix* wide = NULL;
+    Matrix* wide_reference = NULL;
+    Matrix* wide_tiled = NULL;
+    MatrixAllocator* allocator = NULL;
+    MatrixAllocatorStats allocator_stats = {0};
+    TiledReport tiled_report = {0};
+    size_t wide_budget = 0;
+    tiled_base = NULL;
+    tiled_result = NULL;
+    error = generate_random_matrix(192, wide_field, &wide);
+    if (error == MATRIX_SUCCESS) error = matrix_power(wide, 3, &wide_reference);
+    if (error == MATRIX_SUCCESS) error = tiled_matrix_from_matrix(wide, tiled_path, 96, &tiled_base);
+    if (error == MATRIX_SUCCESS) error = matrix_allocator_create(0, &allocator);
+    if (error == MATRIX_SUCCESS)
+    {
+        TiledOptions options = {tiled_min_budget(tiled_base)};
+        wide_budget = options.memory_budget;
+        MatrixAllocator* previous = matrix_allocator_bind(allocator);
+        error = matrix_power_tiled(tiled_base, 3, &options, tiled_result_path, &tiled_result, &tiled_report);
+        matrix_allocator_bind(previous);
+        if (error == MATRIX_SUCCESS) error = matrix_allocator_stats(allocator, &allocator_stats);
+    }
+    if (error == MATRIX_SUCCESS) error = tiled_matrix_to_matrix(tiled_result, &wide_tiled);
+    failures += manual_check(error, matrices_equal(wide_tiled, wide_reference) &&
+                                    tiled_report.memory_used <= wide_budget && allocator_stats.acquired == 0);
+    if (allocator) matrix_allocator_destroy(allocator);
+    tiled_matrix_close(tiled_result);
+    tiled_matrix_close(tiled_base);
+    unlink(tiled_result_path);
+    unlink(tiled_path);
+    matrix_free(wide_tiled);
+    matrix_free(wide_reference);
+    matrix_free(wide);
+
+    if (reference)
+    {
+        ShardOptions options = {2, NULL};
+        error = matrix_power_sharded(a, power_exponent, &options, &sharded_matrix, NULL);
+        failures += manual_check(error, matrices_equal(sharded_matrix, reference));
+    }
+    matrix_free(sharded_matrix);
+    matrix_free(tiled_matrix);
+    matrix_free(reference);
+    matrix_free(a);
+
+    printf("\nПроверок не пройдено: %d\n", failures);
+    return UI_SUCCESS;
+}
+
+/* Наивное транспонирование построчным обходом источника (для сравнения) */
+static void transpose_naive(const Matrix* a, Matrix* result)
+{
+    for (int i = 0; i < a->rows; i++)
+    {
+        for (int j = 0; j < a->cols; j++)
+        {
+            result->data[j][i] = a->data[i][j];
+        }
+    }
+}
+
+/* Пропускная способность в ГБ/с: каждый элемент читается и записывается по разу */
+static double bandwidth_gbs(int n, int repeats, int64_t elapsed_ns)
+{
+    double bytes = 2.0 * (double)n * n * sizeof(ULL) * repeats;
+    return elapsed_ns > 0 ? bytes / (double)elapsed_ns : 0.0;
+}
+
+int transpose_benchmark()
+{
+    printf("=== ПРОПУСКНАЯ СПОСОБНОСТЬ ТРАНСПОНИРОВАНИЯ (ГБ/с) ===\n");
+    printf("%6s %10s %10s %10s %10s\n", "n", "memcpy", "naive", "blocked", "in-place");
+
+    static const int sizes[] = {256, 512, 1024, 2048, 4096};
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+    {
+        int n = sizes[s];
+        /* около 1 ГБ трафика на замер */
+        int repeats = (int)((1LL << 30) / (2LL * n * n * (long long)sizeof(ULL)));
+        if (repeats < 1) repeats = 1;
+
+        Matrix* a = NULL;
+        Matrix* b = NULL;
+        int error = generate_random_matrix(n, 0, &a);
+        if (error == MATRIX_SUCCESS) error = matrix_create_uninit(n, n, 0, &b);
+        if (error != MATRIX_SUCCESS)
+        {
+            matrix_free(a);
+            printf("Ошибка: %s\n", get_matrix_error_message(error));
+            return UI_ERROR_DISPLAY;
+        }
+
+        MatrixView transposed, target;
+        matrix_transpose_view(a, &transposed);
+        matrix_view_of(b, &target);
+
+        int64_t times[4] = {0, 0, 0, 0};
+        for (int kind = 0; kind < 4; kind++)
+        {
+            int64_t start = 0, end = 0;
+            if (get_time_ns(&start) != 0) break;
+            for (int r = 0; r < repeats; r++)
+            {
+                if (kind == 0)
+                {
+                    memcpy(b->data[0], a->data[0], (size_t)n * n * sizeof(ULL));
+                }
+                else if (kind == 1)
+                {
+                    transpose_naive(a, b);
+                }
+                else if (kind == 2)
+                {
+                    /* то же ядро, что в matrix_transpose, но без выделения памяти под результат */
+                    matrix_view_copy(&transposed, &target);
+                }
+                else
+                {
+                    matrix_transpose_in_place(a);
+                }
+            }
+            if (get_time_ns(&end) != 0) break;
+            times[kind] = end - start;
+        }
+
+        printf("%6d %10.2f %10.2f %10.2f %10.2f\n", n,
+               bandwidth_gbs(n, repeats, times[0]), bandwidth_gbs(n, repeats, times[1]),
+               bandwidth_gbs(n, repeats, times[2]), bandwidth_gbs(n, repeats, times[3]));
+        matrix_free(a);
+        matrix_free(b);
+    }
+
     return UI_SUCCESS;
-}
\ No newline at end of file
+}
+
+int tune_multiply()
+{
+    printf("=== АВТОНАСТРОЙКА УМНОЖЕНИЯ ===\n");
+    printf("Лучший вариант для каждого класса поля и размера n (x — ускорение относительно rows):\n");
+
+    int error = matrix_tune_run(NULL, stdout);
+    if (error != TUNE_SUCCESS)
+    {
+        printf("Ошибка замера или записи профиля (TUNE_STATUS): %d\n", error);
+        return UI_ERROR_DISPLAY;
+    }
+
+    const char* path = getenv(MATRIX_TUNE_ENV);
+    printf("Профиль записан в %s и будет загружаться при запуске\n", (path && path[0]) ? path : MATRIX_TUNE_FILE);
+    return UI_SUCCESS;
+}
@@ -0,0 +1,222 @@
+#include "../include/trace.h"
+
+#define TRACE_DEFAULT_CAPACITY 65536
+#define TRACE_MAX_DEPTH 64
+
+typedef struct TraceEvent
+{
+    const char* name;
+    int64_t start_ns;
+    int64_t duration_ns;
+} TraceEvent;
+
+typedef struct TraceBuffer
+{
+    TraceEvent* events;
+    size_t capacity;
+    _Atomic size_t head;            /* число записанных событий (по модулю capacity — позиция) */
+    atomic_int writing;             /* 1, пока поток дописывает событие (дамп ждёт сброса) */
+    int tid;
+    const char* thread_name;
+    int depth;
+    const char* open_names[TRACE_MAX_DEPTH];
+    int64_t open_starts[TRACE_MAX_DEPTH];
+    struct TraceBuffer* next;
+} TraceBuffer;
+
+atomic_int trace_state = -1;
+
+static char trace_path[4096];
+static size_t trace_capacity = TRACE_DEFAULT_CAPACITY;
+static int64_t trace_epoch_ns;
+static _Atomic(TraceBuffer*) trace_buffers = NULL;
+static atomic_int trace_next_tid = 1;
+static _Thread_local TraceBuffer* trace_local = NULL;
+
+static int64_t trace_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + (int64_t)ts.tv_nsec;
+}
+
+static void trace_atexit(void)
+{
+    trace_dump(NULL);
+}
+
+int trace_init(void)
+{
+    static atomic_int initialized = 0;
+    int expected = 0;
+    if (!atomic_compare_exchange_strong(&initialized, &expected, 1))
+    {
+        while (atomic_load(&initialized) != 2);
+        return atomic_load(&trace_state) > 0;
+    }
+
+    const char* path = getenv("MATRIX_TRACE");
+    if (!path || path[0] == '\0' || strlen(path) >= sizeof(trace_path))
+    {
+        atomic_store(&trace_state, 0);
+        atomic_store(&initialized, 2);
+        return 0;
+    }
+    strcpy(trace_path, path);
+
+    const char* capacity = getenv("MATRIX_TRACE_CAPACITY");
+    if (capacity)
+    {
+        unsigned long long value = strtoull(capacity, NULL, 10);
+        if (value >= 16) trace_capacity = (size_t)value;
+    }
+
+    trace_epoch_ns = trace_now_ns();
+    atexit(trace_atexit);
+    atomic_store(&trace_state, 1);
+    atomic_store(&initialized, 2);
+    return 1;
+}
+
+static TraceBuffer* trace_local_buffer(void)
+{
+    if (trace_local) return trace_local;
+
+    TraceBuffer* buffer = (TraceBuffer*)calloc(1, sizeof(TraceBuffer));
+    if (!buffer) return NULL;
+    buffer->events = (TraceEvent*)malloc(trace_capacity * sizeof(TraceEvent));
+    if (!buffer->events)
+    {
+        free(buffer);
+        return NULL;
+    }
+    buffer->capacity = trace_capacity;
+    buffer->tid = atomic_fetch_add(&trace_next_tid, 1);
+
+    /* Буферы потоков не освобождаются до конца программы: дамп читает их при выходе */
+    TraceBuffer* head = atomic_load(&trace_buffers);
+    do
+    {
+        buffer->next = head;
+    } while (!atomic_compare_exchange_weak(&trace_buffers, &head, buffer));
+
+    trace_local = buffer;
+    return buffer;
+}
+
+void trace_begin(const char* name)
+{
+    if (atomic_load_explicit(&trace_state, memory_order_acquire) < 0) trace_init();
+    if (atomic_load_explicit(&trace_state, memory_order_acquire) <= 0) return;
+
+    TraceBuffer* buffer = trace_local_buffer();
+    if (!buffer) return;
+
+    if (buffer->depth < TRACE_MAX_DEPTH)
+    {
+        buffer->open_names[buffer->depth] = name;
+        buffer->open_starts[buffer->depth] = trace_now_ns();
+    }
+    buffer->depth++;
+}
+
+void trace_end(void)
+{
+    TraceBuffer* buffer = trace_local;
+    if (!buffer || buffer->depth == 0) return;
+
+    /* Флаг записи своего буфера поднимается до проверки состояния: дамп, выключивший
+       трассировку, либо увидит флаг и дождётся сброса, либо писатель увидит выключение.
+       Флаг лежит в буфере потока, поэтому запись не задевает общих линий кэша */
+    atomic_store(&buffer->writing, 1);
+    if (atomic_load(&trace_state) <= 0)
+    {
+        atomic_store_explicit(&buffer->writing, 0, memory_order_release);
+        return;
+    }
+
+    buffer->depth--;
+    if (buffer->depth < TRACE_MAX_DEPTH)
+    {
+        size_t head = atomic_load_explicit(&buffer->head, memory_order_relaxed);
+        TraceEvent* event = &buffer->events[head % buffer->capacity];
+        event->name = buffer->open_names[buffer->depth];
+        event->start_ns = buffer->open_starts[buffer->depth];
+        event->duration_ns = trace_now_ns() - event->start_ns;
+        atomic_store_explicit(&buffer->head, head + 1, memory_order_release);
+    }
+    atomic_store_explicit(&buffer->writing, 0, memory_order_release);
+}
+
+void trace_thread_name(const char* name)
+{
+    if (atomic_load_explicit(&trace_state, memory_order_acquire) < 0) trace_init();
+    if (atomic_load_explicit(&trace_state, memory_order_acquire) <= 0) return;
+
+    TraceBuffer* buffer = trace_local_buffer();
+    if (!buffer) return;
+    atomic_store(&buffer->writing, 1);
+    if (atomic_load(&trace_state) > 0) buffer->thread_name = name;
+    atomic_store_explicit(&buffer->writing, 0, memory_order_release);
+}
+
+static void trace_write_string(FILE* out, const char* str)
+{
+    fputc('"', out);
+    for (; *str; str++)
+    {
+        if (*str == '"' || *str == '\\') fputc('\\', out);
+        if ((unsigned char)*str >= 0x20) fputc(*str, out);
+    }
+    fputc('"', out);
+}
+
+int trace_dump(const char* path)
+{
+    /* Выключить запись и дождаться потоков, дописывающих событие (рабочие потоки
+       планировщика не останавливаются к выходу из программы) */
+    int expected = 1;
+    if (!atomic_compare_exchange_strong(&trace_state, &expected, 0)) return SUCCESS;
+    for (TraceBuffer* buffer = atomic_load(&trace_buffers); buffer; buffer = buffer->next)
+    {
+        while (atomic_load(&buffer->writing) != 0);
+    }
+    if (!path) path = trace_path;
+
+    FILE* out = fopen(path, "w");
+    if (!out) return ERROR_FILE_OPERATION;
+
+    int pid = (int)getpid();
+    int first = 1;
+    fprintf(out, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+
+    for (TraceBuffer* buffer = atomic_load(&trace_buffers); buffer; buffer = buffer->next)
+    {
+        if (buffer->thread_name)
+        {
+            fprintf(out, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":",
+                    first ? "" : ",\n", pid, buffer->tid);
+            trace_write_string(out, buffer->thread_name);
+            fprintf(out, "}}");
+            first = 0;
+        }
+
+        size_t head = atomic_load_explicit(&buffer->head, memory_order_acquire);
+        size_t begin = (head > buffer->capacity) ? head - buffer->capacity : 0;
+        for (size_t i = begin; i < head; i++)
+        {
+            const TraceEvent* event = &buffer->events[i % buffer->capacity];
+            fprintf(out, "%s{\"name\":", first ? "" : ",\n");
+            trace_write_string(out, event->name);
+            fprintf(out, ",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                    pid, buffer->tid,
+                    (double)(event->start_ns - trace_epoch_ns) / 1000.0,
+                    (double)event->duration_ns / 1000.0);
+            first = 0;
+        }
+    }
+
+    fprintf(out, "\n]}\n");
+    if (fclose(out) != 0) return ERROR_FILE_OPERATION;
+    return SUCCESS;
+}